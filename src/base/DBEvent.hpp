@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <cstdio>
 
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <set>
@@ -72,13 +73,29 @@ namespace ultraverse::base {
         };
     };
     
+    /**
+     * @brief eventType()으로 타입을 확인하고 RTTI (dynamic_pointer_cast) 없이 캐스팅한다.
+     * @details 이벤트 타입마다 구현 클래스가 하나뿐이므로, T::EVENT_TYPE이 같으면 T로 캐스팅해도 안전하다.
+     * @return 타입이 다르면 nullptr
+     */
+    template <typename T>
+    std::shared_ptr<T> eventCast(const std::shared_ptr<DBEvent> &event) {
+        if (event == nullptr || event->eventType() != T::EVENT_TYPE) {
+            return nullptr;
+        }
+        
+        return std::static_pointer_cast<T>(event);
+    }
+    
     /**
      * @brief 트랜잭션 종료 (ID 발행) 이벤트
      */
     class TransactionIDEventBase: public DBEvent {
     public:
+        static constexpr event_type::Value EVENT_TYPE = event_type::TXNID;
+        
         event_type::Value eventType() override {
-            return event_type::TXNID;
+            return EVENT_TYPE;
         }
         
         virtual uint64_t transactionId() = 0;
@@ -107,8 +124,10 @@ namespace ultraverse::base {
             TRUNCATE_TABLE = 15,
         };
         
+        static constexpr event_type::Value EVENT_TYPE = event_type::QUERY;
+        
         event_type::Value eventType() override {
-            return event_type::QUERY;
+            return EVENT_TYPE;
         }
         
         QueryEventBase();
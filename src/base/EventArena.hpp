@@ -0,0 +1,105 @@
+#ifndef ULTRAVERSE_EVENTARENA_HPP
+#define ULTRAVERSE_EVENTARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace ultraverse::base {
+    /**
+     * @brief 트랜잭션 하나의 binlog 이벤트들을 할당하는 arena
+     * @details 이벤트는 그대로 std::shared_ptr<DBEvent>로 넘겨주며, 타입은 eventType() / eventCast()로 구분한다.
+     *          makeEvent()는 이벤트 객체와 shared_ptr의 control block을 std::allocate_shared()로 이 arena의 블록에서 잘라 쓴다.
+     *          control block의 allocator가 arena를 shared_ptr로 붙잡아 두므로,
+     *          arena는 여기서 할당된 마지막 이벤트가 해제될 때 (= 트랜잭션을 다 처리했을 때) 블록을 한꺼번에 돌려준다.
+     *
+     *          이벤트 안의 std::string / std::vector 멤버는 arena가 아닌 기본 allocator로 할당된다.
+     *
+     * @note 한 arena에는 한 스레드만 할당해야 한다. (해제는 어느 스레드에서 해도 된다)
+     */
+    class EventArena {
+    public:
+        static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+        EventArena():
+            _resource(BLOCK_SIZE)
+        {
+        }
+
+        EventArena(EventArena &) = delete;
+
+        void *allocate(size_t size, size_t alignment) {
+            return _resource.allocate(size, alignment);
+        }
+
+    private:
+        std::pmr::monotonic_buffer_resource _resource;
+    };
+
+    /**
+     * @brief EventArena에서 할당하는 allocator. std::allocate_shared()에 넘기면 control block이 arena를 붙잡아 둔다.
+     */
+    template <typename T>
+    class EventArenaAllocator {
+    public:
+        using value_type = T;
+
+        explicit EventArenaAllocator(std::shared_ptr<EventArena> arena):
+            _arena(std::move(arena))
+        {
+        }
+
+        template <typename U>
+        EventArenaAllocator(const EventArenaAllocator<U> &other):
+            _arena(other.arena())
+        {
+        }
+
+        T *allocate(size_t count) {
+            return static_cast<T *>(_arena->allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, size_t) {
+            // arena가 해제될 때 한꺼번에 돌려준다
+        }
+
+        const std::shared_ptr<EventArena> &arena() const {
+            return _arena;
+        }
+
+        template <typename U>
+        bool operator==(const EventArenaAllocator<U> &other) const {
+            return _arena == other.arena();
+        }
+
+    private:
+        std::shared_ptr<EventArena> _arena;
+    };
+
+    /**
+     * @brief arena에서 이벤트를 만든다. arena가 nullptr면 std::make_shared()와 같다.
+     */
+    template <typename T, typename... Args>
+    std::shared_ptr<T> makeEvent(const std::shared_ptr<EventArena> &arena, Args &&...args) {
+        if (arena == nullptr) {
+            return std::make_shared<T>(std::forward<Args>(args)...);
+        }
+
+        return std::allocate_shared<T>(EventArenaAllocator<T>(arena), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief arena에서 size바이트를 할당한다. 반환된 포인터는 arena를 함께 소유한다.
+     */
+    inline std::shared_ptr<uint8_t> makeEventBuffer(const std::shared_ptr<EventArena> &arena, size_t size) {
+        if (arena == nullptr) {
+            return std::shared_ptr<uint8_t>(new uint8_t[size], std::default_delete<uint8_t[]>());
+        }
+
+        return std::shared_ptr<uint8_t>(arena, static_cast<uint8_t *>(arena->allocate(size, alignof(std::max_align_t))));
+    }
+}
+
+#endif //ULTRAVERSE_EVENTARENA_HPP
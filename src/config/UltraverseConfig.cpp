@@ -197,6 +197,10 @@ namespace ultraverse::config {
         bool validateRangeComparisonMethod(const std::string &value) {
             return value == "intersect" || value == "eqonly";
         }
+
+        bool validateReplayFeederMode(const std::string &value) {
+            return value == "auto" || value == "seek" || value == "scan";
+        }
     } // namespace
 
     std::optional<UltraverseConfig> UltraverseConfig::loadFromFile(const std::string &path) {
@@ -249,6 +253,18 @@ namespace ultraverse::config {
             if (!readStringField(binlogObj, "indexName", config.binlog.indexName, "binlog.indexName", false)) {
                 return std::nullopt;
             }
+            if (!readBoolField(binlogObj, "memoryMappedReader", config.binlog.memoryMappedReader,
+                               "binlog.memoryMappedReader", false)) {
+                return std::nullopt;
+            }
+            if (!readIntField(binlogObj, "payloadDecodeThreads", config.binlog.payloadDecodeThreads,
+                              "binlog.payloadDecodeThreads", false)) {
+                return std::nullopt;
+            }
+            if (config.binlog.payloadDecodeThreads < 0) {
+                logger->error("binlog.payloadDecodeThreads must not be negative");
+                return std::nullopt;
+            }
         }
 
         if (document.contains("stateLog")) {
@@ -264,6 +280,75 @@ namespace ultraverse::config {
             if (!readStringField(stateLogObj, "name", config.stateLog.name, "stateLog.name", true)) {
                 return std::nullopt;
             }
+            if (!readBoolField(stateLogObj, "memoryMappedReader", config.stateLog.memoryMappedReader,
+                               "stateLog.memoryMappedReader", false)) {
+                return std::nullopt;
+            }
+            if (!readIntField(stateLogObj, "compressionBlockSize", config.stateLog.compressionBlockSize,
+                              "stateLog.compressionBlockSize", false)) {
+                return std::nullopt;
+            }
+            if (config.stateLog.compressionBlockSize < 0) {
+                logger->error("stateLog.compressionBlockSize must not be negative");
+                return std::nullopt;
+            }
+            if (!readIntField(stateLogObj, "compressionLevel", config.stateLog.compressionLevel,
+                              "stateLog.compressionLevel", false)) {
+                return std::nullopt;
+            }
+            if (!readBoolField(stateLogObj, "symbolTable", config.stateLog.symbolTable,
+                               "stateLog.symbolTable", false)) {
+                return std::nullopt;
+            }
+            if (!readIntField(stateLogObj, "timestampIndexInterval", config.stateLog.timestampIndexInterval,
+                              "stateLog.timestampIndexInterval", false)) {
+                return std::nullopt;
+            }
+            if (config.stateLog.timestampIndexInterval < 0) {
+                logger->error("stateLog.timestampIndexInterval must not be negative");
+                return std::nullopt;
+            }
+            if (!readBoolField(stateLogObj, "keyIndex", config.stateLog.keyIndex,
+                               "stateLog.keyIndex", false)) {
+                return std::nullopt;
+            }
+            if (!readStringArray(stateLogObj, "keyIndexColumns", config.stateLog.keyIndexColumns,
+                                 "stateLog.keyIndexColumns", false, false)) {
+                return std::nullopt;
+            }
+            if (!readIntField(stateLogObj, "segmentSizeMB", config.stateLog.segmentSizeMB,
+                              "stateLog.segmentSizeMB", false)) {
+                return std::nullopt;
+            }
+            if (config.stateLog.segmentSizeMB < 0) {
+                logger->error("stateLog.segmentSizeMB must not be negative");
+                return std::nullopt;
+            }
+            if (!readIntField(stateLogObj, "retainedSegments", config.stateLog.retainedSegments,
+                              "stateLog.retainedSegments", false)) {
+                return std::nullopt;
+            }
+            if (config.stateLog.retainedSegments < 0) {
+                logger->error("stateLog.retainedSegments must not be negative");
+                return std::nullopt;
+            }
+            if (!readBoolField(stateLogObj, "allowMissingArchivedSegments",
+                               config.stateLog.allowMissingArchivedSegments,
+                               "stateLog.allowMissingArchivedSegments", false)) {
+                return std::nullopt;
+            }
+            if (!readBoolField(stateLogObj, "rwSummary", config.stateLog.rwSummary,
+                               "stateLog.rwSummary", false)) {
+                return std::nullopt;
+            }
+            if (!readIntField(stateLogObj, "zoneMapInterval", config.stateLog.zoneMapInterval,
+                              "stateLog.zoneMapInterval", false)) {
+                return std::nullopt;
+            }
+            if (config.stateLog.zoneMapInterval < 0) {
+                logger->error("stateLog.zoneMapInterval must not be negative");
+                return std::nullopt;
+            }
         } else {
             logger->error("missing required field: stateLog.name");
             return std::nullopt;
@@ -362,6 +447,18 @@ namespace ultraverse::config {
                                  "statelogd.developmentFlags", false, false)) {
                 return std::nullopt;
             }
+            if (!readIntField(statelogdObj, "checkpointInterval", config.statelogd.checkpointInterval,
+                              "statelogd.checkpointInterval", false)) {
+                return std::nullopt;
+            }
+            if (!readIntField(statelogdObj, "parallelFiles", config.statelogd.parallelFiles,
+                              "statelogd.parallelFiles", false)) {
+                return std::nullopt;
+            }
+            if (config.statelogd.parallelFiles < 0) {
+                logger->error("statelogd.parallelFiles must not be negative");
+                return std::nullopt;
+            }
         }
 
         if (document.contains("stateChange")) {
@@ -394,6 +491,73 @@ namespace ultraverse::config {
                 logger->error("stateChange.rangeComparisonMethod must be 'intersect' or 'eqonly'");
                 return std::nullopt;
             }
+            if (!readBoolField(stateChangeObj, "readyQueueScheduler",
+                               config.stateChange.readyQueueScheduler,
+                               "stateChange.readyQueueScheduler", false)) {
+                return std::nullopt;
+            }
+            if (!readBoolField(stateChangeObj, "incrementalGC",
+                               config.stateChange.incrementalGC,
+                               "stateChange.incrementalGC", false)) {
+                return std::nullopt;
+            }
+            if (!readBoolField(stateChangeObj, "compactRowGraph",
+                               config.stateChange.compactRowGraph,
+                               "stateChange.compactRowGraph", false)) {
+                return std::nullopt;
+            }
+            if (!readBoolField(stateChangeObj, "shardedRowGraphWorkers",
+                               config.stateChange.shardedRowGraphWorkers,
+                               "stateChange.shardedRowGraphWorkers", false)) {
+                return std::nullopt;
+            }
+            if (!readIntField(stateChangeObj, "replayPipelineDepth", config.stateChange.replayPipelineDepth,
+                              "stateChange.replayPipelineDepth", false)) {
+                return std::nullopt;
+            }
+            if (config.stateChange.replayPipelineDepth < 1) {
+                logger->error("stateChange.replayPipelineDepth must be at least 1");
+                return std::nullopt;
+            }
+            if (!readBoolField(stateChangeObj, "replayStatementBatching",
+                               config.stateChange.replayStatementBatching,
+                               "stateChange.replayStatementBatching", false)) {
+                return std::nullopt;
+            }
+            if (!readBoolField(stateChangeObj, "parallelFullReplay",
+                               config.stateChange.parallelFullReplay,
+                               "stateChange.parallelFullReplay", false)) {
+                return std::nullopt;
+            }
+            if (!readStringField(stateChangeObj, "replayFeederMode",
+                                 config.stateChange.replayFeederMode,
+                                 "stateChange.replayFeederMode", false)) {
+                return std::nullopt;
+            }
+            if (!validateReplayFeederMode(config.stateChange.replayFeederMode)) {
+                logger->error("stateChange.replayFeederMode must be 'auto', 'seek' or 'scan'");
+                return std::nullopt;
+            }
+            if (!readIntField(stateChangeObj, "logDecodeThreads", config.stateChange.logDecodeThreads,
+                              "stateChange.logDecodeThreads", false)) {
+                return std::nullopt;
+            }
+            if (config.stateChange.logDecodeThreads < 0) {
+                logger->error("stateChange.logDecodeThreads must not be negative");
+                return std::nullopt;
+            }
+            if (!readBoolField(stateChangeObj, "useKeyIndex", config.stateChange.useKeyIndex,
+                               "stateChange.useKeyIndex", false)) {
+                return std::nullopt;
+            }
+            if (!readBoolField(stateChangeObj, "useRWSummary", config.stateChange.useRWSummary,
+                               "stateChange.useRWSummary", false)) {
+                return std::nullopt;
+            }
+            if (!readBoolField(stateChangeObj, "useZoneMap", config.stateChange.useZoneMap,
+                               "stateChange.useZoneMap", false)) {
+                return std::nullopt;
+            }
         }
 
         if (!binlogPathProvided) {
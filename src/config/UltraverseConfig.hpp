@@ -15,11 +15,25 @@ namespace ultraverse::config {
     struct BinlogConfig {
         std::string path = "/var/lib/mysql";
         std::string indexName = "mysql-bin.index";
+        bool memoryMappedReader = false;  // mmap completed binlogs instead of reading them through ifstream
+        int payloadDecodeThreads = 0;  // threads decoding TRANSACTION_PAYLOAD_EVENTs ahead of the reader, 0 = decode inline
     };
 
     struct StateLogConfig {
         std::string path = ".";
         std::string name;  // required
+        bool memoryMappedReader = false;
+        int compressionBlockSize = 0;  // transactions per zstd block, 0 = uncompressed
+        int compressionLevel = 3;
+        bool symbolTable = false;
+        int timestampIndexInterval = 1024;  // transactions per .ulttimeindex entry, 0 = disabled
+        bool keyIndex = false;  // maintain .ultkeyindex for keyColumns
+        std::vector<std::string> keyIndexColumns;  // extra columns to index (e.g. foreign keys to key columns)
+        int segmentSizeMB = 0;  // rotate into <name>.NNNNNN segments of this size, 0 = single file
+        int retainedSegments = 0;  // sealed segments kept next to the live one, older ones go to archive/; 0 = keep all
+        bool allowMissingArchivedSegments = false;  // skip segments deleted from archive/ instead of failing (the gap is logged)
+        bool rwSummary = false;  // maintain .ultsummary (per-transaction read/write column summary)
+        int zoneMapInterval = 0;  // transactions per .ultzonemap zone (key column min/max + bloom), 0 = disabled
     };
 
     struct DatabaseConfig {
@@ -35,6 +49,8 @@ namespace ultraverse::config {
         bool oneshotMode = false;
         std::string procedureLogPath;
         std::vector<std::string> developmentFlags;  // "print-gids", "print-queries"
+        int checkpointInterval = 0;  // transactions per .ultcheckpoint save (resume point after restart), 0 = disabled
+        int parallelFiles = 0;  // binlog files decoded concurrently in oneshot mode, 0 = one reader
     };
 
     struct StateChangeConfig {
@@ -42,6 +58,18 @@ namespace ultraverse::config {
         std::string backupFile;
         bool keepIntermediateDatabase = false;
         std::string rangeComparisonMethod = "eqonly";  // "intersect" | "eqonly"
+        bool readyQueueScheduler = false;
+        bool incrementalGC = false;
+        bool compactRowGraph = false;
+        bool shardedRowGraphWorkers = false;
+        int replayPipelineDepth = 1;  // 1 = synchronous
+        bool replayStatementBatching = false;
+        bool parallelFullReplay = false;
+        std::string replayFeederMode = "auto";  // "auto" | "seek" | "scan"
+        int logDecodeThreads = 0;  // 0 = decode on the scanning thread
+        bool useKeyIndex = false;  // build the cluster from .ultkeyindex when it covers every key column
+        bool useRWSummary = false;  // analyze replay dependencies from .ultsummary, decoding only target bodies
+        bool useZoneMap = false;  // skip .ultzonemap zones that cannot touch the rollback targets
     };
 
     struct UltraverseConfig {
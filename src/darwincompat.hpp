@@ -10,6 +10,8 @@
 // FIXME: is it okay to just map lseek64 to lseek on macOS?
 #define lseek64     lseek
 #define ftruncate64 ftruncate
+#define pwrite64    pwrite
+#define fdatasync   fsync
 
 inline int syncfs(int fd) {
     #warning "XXX: since syncfs(2) is not available on macOS, using fsync(2) as a workaround. This may not have the same behavior (and may cause performance issues)."
@@ -11,6 +11,8 @@
 #include "Application.hpp"
 #include "config/UltraverseConfig.hpp"
 #include "db_state_change.hpp"
+#include "mariadb/state/new/StateLogReader.hpp"
+#include "mariadb/state/new/TimestampIndex.hpp"
 #include "utils/StringUtil.hpp"
 
 using namespace ultraverse::mariadb;
@@ -107,6 +109,8 @@ namespace ultraverse {
             "\n"
             "Options:\n"
             "    --gid-range START...END    GID range to process\n"
+            "    --time-range START...END   Time range to process, resolved to a GID range with the timestamp index\n"
+            "                               (UNIX timestamp or UTC \"YYYY-MM-DD HH:MM:SS\")\n"
             "    --skip-gids GID1,GID2,...  GIDs to skip\n"
             "    --replay-from GID          Replay all transactions from GID before executing replay plan\n"
             "    --no-exec-replace-query    Do not execute replace queries; print them for manual run\n"
@@ -131,12 +135,15 @@ namespace ultraverse {
         bool debugLog = false;
         bool traceLog = false;
         bool gidRangeSet = false;
+        bool timeRangeSet = false;
         bool skipGidsSet = false;
         bool dryRun = false;
         bool replayFromSet = false;
         bool executeReplaceQuery = true;
         gid_t startGid = 0;
         gid_t endGid = 0;
+        uint64_t startTime = 0;
+        uint64_t endTime = 0;
         gid_t replayFromGid = 0;
         std::vector<uint64_t> skipGids;
 
@@ -152,6 +159,7 @@ namespace ultraverse {
 
         static struct option long_options[] = {
             {"gid-range", required_argument, 0, 's'},
+            {"time-range", required_argument, 0, 'T'},
             {"skip-gids", required_argument, 0, 'S'},
             {"replay-from", required_argument, 0, 'R'},
             {"no-exec-replace-query", no_argument, 0, 'M'},
@@ -198,6 +206,28 @@ namespace ultraverse {
                     gidRangeSet = true;
                     break;
                 }
+                case 'T': {
+                    std::string rangeExpr = optarg != nullptr ? std::string(optarg) : "";
+                    auto sepPos = rangeExpr.find("...");
+                    if (sepPos == std::string::npos || rangeExpr.find("...", sepPos + 3) != std::string::npos) {
+                        _logger->error("invalid --time-range format, expected START...END");
+                        return 1;
+                    }
+                    auto start = utility::parseTimestamp(trim(rangeExpr.substr(0, sepPos)));
+                    auto end = utility::parseTimestamp(trim(rangeExpr.substr(sepPos + 3)));
+                    if (!start.has_value() || !end.has_value()) {
+                        _logger->error("invalid --time-range value, expected UNIX timestamp or \"YYYY-MM-DD HH:MM:SS\"");
+                        return 1;
+                    }
+                    if (*start > *end) {
+                        _logger->error("invalid --time-range value, START must be <= END");
+                        return 1;
+                    }
+                    startTime = *start;
+                    endTime = *end;
+                    timeRangeSet = true;
+                    break;
+                }
                 case 'S': {
                     std::string gidsExpr = optarg != nullptr ? std::string(optarg) : "";
                     auto parsed = buildSkipGidList(gidsExpr);
@@ -245,6 +275,11 @@ namespace ultraverse {
             return 0;
         }
 
+        if (gidRangeSet && timeRangeSet) {
+            _logger->error("--gid-range and --time-range cannot be used together");
+            return 1;
+        }
+
         int positionalCount = argc() - optind;
         if (positionalCount != 2) {
             _logger->error("CONFIG_JSON and ACTION must be specified");
@@ -262,6 +297,31 @@ namespace ultraverse {
         }
         const auto &config = *configOpt;
 
+        if (timeRangeSet) {
+            try {
+                TimestampIndexReader timestampIndex(config.stateLog.path, config.stateLog.name);
+                StateLogReader reader(config.stateLog.path, config.stateLog.name);
+                reader.open();
+
+                auto gidRange = resolveTimeRange(reader, timestampIndex, startTime, endTime);
+                reader.close();
+
+                if (!gidRange.has_value()) {
+                    _logger->error("no transactions found in --time-range {}...{}", startTime, endTime);
+                    return 1;
+                }
+
+                _logger->info("--time-range {}...{} resolved to gid range {}...{}",
+                              startTime, endTime, gidRange->first, gidRange->second);
+                startGid = gidRange->first;
+                endGid = gidRange->second;
+                gidRangeSet = true;
+            } catch (std::exception &e) {
+                _logger->error("cannot resolve --time-range: {}", e.what());
+                return 1;
+            }
+        }
+
         if (config.database.host.empty() ||
             config.database.username.empty() ||
             config.database.password.empty()) {
@@ -332,6 +392,8 @@ namespace ultraverse {
 
         changePlan.setStateLogPath(config.stateLog.path);
         changePlan.setStateLogName(config.stateLog.name);
+        changePlan.setMemoryMappedStateLog(config.stateLog.memoryMappedReader);
+        changePlan.setAllowMissingArchivedSegments(config.stateLog.allowMissingArchivedSegments);
         changePlan.setDBName(config.database.name);
 
         changePlan.setKeyColumnGroups(utility::parseKeyColumnGroups(config.keyColumns));
@@ -348,6 +410,24 @@ namespace ultraverse {
         changePlan.setRangeComparisonMethod(
             config.stateChange.rangeComparisonMethod == "intersect" ? INTERSECT : EQ_ONLY
         );
+        changePlan.setReadyQueueScheduler(config.stateChange.readyQueueScheduler);
+        changePlan.setIncrementalGC(config.stateChange.incrementalGC);
+        changePlan.setCompactRowGraph(config.stateChange.compactRowGraph);
+        changePlan.setShardedRowGraphWorkers(config.stateChange.shardedRowGraphWorkers);
+        changePlan.setReplayPipelineDepth(config.stateChange.replayPipelineDepth);
+        changePlan.setReplayStatementBatching(config.stateChange.replayStatementBatching);
+        changePlan.setParallelFullReplay(config.stateChange.parallelFullReplay);
+        if (config.stateChange.replayFeederMode == "seek") {
+            changePlan.setReplayFeederMode(ReplayFeederMode::SEEK);
+        } else if (config.stateChange.replayFeederMode == "scan") {
+            changePlan.setReplayFeederMode(ReplayFeederMode::SCAN);
+        } else {
+            changePlan.setReplayFeederMode(ReplayFeederMode::AUTO);
+        }
+        changePlan.setLogDecodeThreads(config.stateChange.logDecodeThreads);
+        changePlan.setUseKeyIndex(config.stateChange.useKeyIndex);
+        changePlan.setUseRWSummary(config.stateChange.useRWSummary);
+        changePlan.setUseZoneMap(config.stateChange.useZoneMap);
         changePlan.setExecuteReplaceQuery(executeReplaceQuery);
 
         changePlan.setDBHost(config.database.host);
@@ -70,8 +70,10 @@ namespace ultraverse::mariadb {
 
         IntVarEvent(Type type, uint64_t value, uint64_t timestamp);
 
+        static constexpr event_type::Value EVENT_TYPE = event_type::INTVAR;
+
         event_type::Value eventType() override {
-            return event_type::INTVAR;
+            return EVENT_TYPE;
         }
 
         uint64_t timestamp() override;
@@ -88,8 +90,10 @@ namespace ultraverse::mariadb {
     public:
         RandEvent(uint64_t seed1, uint64_t seed2, uint64_t timestamp);
 
+        static constexpr event_type::Value EVENT_TYPE = event_type::RAND;
+
         event_type::Value eventType() override {
-            return event_type::RAND;
+            return EVENT_TYPE;
         }
 
         uint64_t timestamp() override;
@@ -119,8 +123,10 @@ namespace ultraverse::mariadb {
                      std::string value,
                      uint64_t timestamp);
 
+        static constexpr event_type::Value EVENT_TYPE = event_type::USER_VAR;
+
         event_type::Value eventType() override {
-            return event_type::USER_VAR;
+            return EVENT_TYPE;
         }
 
         uint64_t timestamp() override;
@@ -156,8 +162,10 @@ namespace ultraverse::mariadb {
         );
         TableMapEvent() : _timestamp(0), _tableId(0) {};
         
+        static constexpr event_type::Value EVENT_TYPE = event_type::TABLE_MAP;
+
         event_type::Value eventType() override {
-            return event_type::TABLE_MAP;
+            return EVENT_TYPE;
         }
        
         uint64_t timestamp() override;
@@ -209,8 +217,10 @@ namespace ultraverse::mariadb {
                           uint64_t timestamp, uint16_t flags);
         
         
+        static constexpr event_type::Value EVENT_TYPE = event_type::ROW_EVENT;
+
         event_type::Value eventType() override {
-            return event_type::ROW_EVENT;
+            return EVENT_TYPE;
         }
         
         uint64_t timestamp() override;
@@ -285,8 +295,10 @@ namespace ultraverse::mariadb {
             uint64_t timestamp
         );
         
+        static constexpr event_type::Value EVENT_TYPE = event_type::ROW_QUERY;
+
         event_type::Value eventType() override {
-            return event_type::ROW_QUERY;
+            return EVENT_TYPE;
         }
         
         uint64_t timestamp() override;
@@ -2,8 +2,12 @@
 // Created by cheesekun on 8/8/22.
 //
 
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
 
+#include <poll.h>
+
 #include <fmt/core.h>
 
 #include "DBHandle.hpp"
@@ -80,6 +84,19 @@ namespace ultraverse::mariadb {
             std::vector<std::vector<std::string>> _rows;
             size_t _index = 0;
         };
+
+        void appendStatement(std::string &batch, const std::string &statement) {
+            auto end = statement.find_last_not_of(" \t\r\n;");
+            if (end == std::string::npos) {
+                return;
+            }
+
+            if (!batch.empty()) {
+                // 구문이 라인 주석으로 끝나도 구분자가 주석에 먹히지 않도록 줄을 바꾼다
+                batch += "\n;\n";
+            }
+            batch.append(statement, 0, end + 1);
+        }
     }
 
     void DBHandle::consumeResults() {
@@ -89,10 +106,50 @@ namespace ultraverse::mariadb {
         } while (nextResult() == 0);
     }
 
+    size_t DBHandle::executeBatch(const std::vector<std::string> &statements, size_t offset) {
+        for (size_t i = offset; i < statements.size(); i++) {
+            const bool failed = executeQuery(statements[i]) != 0;
+            consumeResults();
+
+            if (failed) {
+                return i;
+            }
+        }
+
+        return statements.size();
+    }
+
+    void DBHandle::startQuery(const std::string &query) {
+        const bool failed = executeQuery(query) != 0;
+        consumeResults();
+        _syncQueryStatus = failed ? AsyncStatus::FAILED : AsyncStatus::COMPLETE;
+    }
+
+    DBHandle::AsyncStatus DBHandle::pollQuery() {
+        return _syncQueryStatus;
+    }
+
+    int DBHandle::socketDescriptor() {
+        return -1;
+    }
+
+    short DBHandle::pollEvents() {
+        return POLLIN;
+    }
+
+    void DBHandle::cancelQuery() {
+        // 기본 구현의 startQuery()는 쿼리를 동기적으로 끝내므로 진행 중인 쿼리가 없다
+    }
+
     MySQLDBHandle::MySQLDBHandle():
-        _handle(mysql_init(nullptr), mysql_close),
         _logger(createLogger("mariadb::MySQLDBHandle"))
     {
+        initHandle();
+    }
+
+    void MySQLDBHandle::initHandle() {
+        _handle = std::shared_ptr<MYSQL>(mysql_init(nullptr), mysql_close);
+
         unsigned int timeout = 15;
         mysql_options(_handle.get(), MYSQL_OPT_CONNECT_TIMEOUT, (const char *)&timeout);
         mysql_options(_handle.get(), MYSQL_OPT_CONNECT_ATTR_RESET, 0);
@@ -103,6 +160,11 @@ namespace ultraverse::mariadb {
     }
     
     void MySQLDBHandle::connect(const std::string &host, int port, const std::string &user, const std::string &password) {
+        _host = host;
+        _port = port;
+        _user = user;
+        _password = password;
+
         mysql_real_connect(_handle.get(), host.c_str(), user.c_str(), password.c_str(), nullptr, port, nullptr, 0);
         if (mysql_errno(_handle.get()) != 0) {
             throw std::runtime_error(
@@ -114,6 +176,15 @@ namespace ultraverse::mariadb {
         // disableBinlogChecksum();
     }
     
+    void MySQLDBHandle::reconnect() {
+        _asyncStage = AsyncStage::IDLE;
+        _asyncQuerySent = false;
+        _multiStatementsEnabled = false;
+
+        initHandle();
+        connect(_host, _port, _user, _password);
+    }
+
     void MySQLDBHandle::disconnect() {
         mysql_close(_handle.get());
     }
@@ -164,6 +235,7 @@ namespace ultraverse::mariadb {
     
     int MySQLDBHandle::executeQuery(const std::string &query) {
         // _logger->trace("executing query: {}", query);
+        disableMultiStatements();
         
         if (mysql_real_query(_handle.get(), query.c_str(), query.size()) != 0) {
             auto mysqlErrno = mysql_errno(_handle.get());
@@ -204,6 +276,198 @@ namespace ultraverse::mariadb {
         return _handle;
     }
 
+    void MySQLDBHandle::startQuery(const std::string &query) {
+        disableMultiStatements();
+
+        _asyncQuery = query;
+        _asyncStage = AsyncStage::QUERY;
+        _asyncFailed = false;
+        _asyncQuerySent = false;
+        _asyncWaitingForWrite = false;
+    }
+
+    DBHandle::AsyncStatus MySQLDBHandle::pollQuery() {
+        auto *mysql = _handle.get();
+        _asyncWaitingForWrite = false;
+
+        while (true) {
+            switch (_asyncStage) {
+                case AsyncStage::IDLE:
+                    return _asyncFailed ? AsyncStatus::FAILED : AsyncStatus::COMPLETE;
+                case AsyncStage::QUERY: {
+                    _asyncQuerySent = true;
+                    auto status = mysql_real_query_nonblocking(mysql, _asyncQuery.c_str(), _asyncQuery.size());
+                    if (status == NET_ASYNC_NOT_READY) {
+                        // 쿼리를 보내는 도중에도 NOT_READY가 반환된다. 이때 소켓에 쓸 수 없으면 응답이 아니라 POLLOUT을 기다려야 한다
+                        const int fd = socketDescriptor();
+                        pollfd pfd { fd, POLLOUT, 0 };
+                        _asyncWaitingForWrite = fd >= 0 && ::poll(&pfd, 1, 0) == 0;
+                        return AsyncStatus::PENDING;
+                    }
+                    if (status == NET_ASYNC_ERROR) {
+                        _logger->warn("pollQuery() returned non-zero code: {} ({})", mysql_errno(mysql), mysql_error(mysql));
+                        _asyncFailed = true;
+                        _asyncStage = AsyncStage::IDLE;
+                        break;
+                    }
+                    _asyncStage = AsyncStage::STORE_RESULT;
+                    break;
+                }
+                case AsyncStage::STORE_RESULT: {
+                    if (mysql_field_count(mysql) == 0) {
+                        _asyncStage = AsyncStage::NEXT_RESULT;
+                        break;
+                    }
+
+                    MYSQL_RES *result = nullptr;
+                    auto status = mysql_store_result_nonblocking(mysql, &result);
+                    if (status == NET_ASYNC_NOT_READY) {
+                        return AsyncStatus::PENDING;
+                    }
+                    if (result != nullptr) {
+                        mysql_free_result(result);
+                    }
+                    if (status == NET_ASYNC_ERROR) {
+                        _asyncFailed = true;
+                    }
+                    _asyncStage = AsyncStage::NEXT_RESULT;
+                    break;
+                }
+                case AsyncStage::NEXT_RESULT: {
+                    // 프로시저에서 반환한 result를 소모하지 않으면 commands out of sync 오류가 난다
+                    if (!mysql_more_results(mysql)) {
+                        _asyncStage = AsyncStage::IDLE;
+                        break;
+                    }
+
+                    auto status = mysql_next_result_nonblocking(mysql);
+                    if (status == NET_ASYNC_NOT_READY) {
+                        return AsyncStatus::PENDING;
+                    }
+                    if (status == NET_ASYNC_ERROR) {
+                        _logger->warn("pollQuery() returned non-zero code: {} ({})", mysql_errno(mysql), mysql_error(mysql));
+                        _asyncFailed = true;
+                        _asyncStage = AsyncStage::IDLE;
+                    } else if (status == NET_ASYNC_COMPLETE_NO_MORE_RESULTS) {
+                        _asyncStage = AsyncStage::IDLE;
+                    } else {
+                        _asyncStage = AsyncStage::STORE_RESULT;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    int MySQLDBHandle::socketDescriptor() {
+        return mysql_get_socket_descriptor(_handle.get());
+    }
+
+    short MySQLDBHandle::pollEvents() {
+        return _asyncWaitingForWrite ? POLLIN | POLLOUT : POLLIN;
+    }
+
+    void MySQLDBHandle::cancelQuery() {
+        if (_asyncStage == AsyncStage::QUERY && !_asyncQuerySent) {
+            _asyncStage = AsyncStage::IDLE;
+            return;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CANCEL_QUERY_TIMEOUT_MS);
+
+        try {
+            while (pollQuery() == AsyncStatus::PENDING) {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()
+                ).count();
+                const int fd = socketDescriptor();
+                if (remaining <= 0 || fd < 0) {
+                    throw std::runtime_error("timed out while draining the pending query");
+                }
+
+                pollfd pfd { fd, pollEvents(), 0 };
+                ::poll(&pfd, 1, static_cast<int>(remaining));
+            }
+            return;
+        } catch (std::exception &e) {
+            _logger->warn("cancelQuery(): {}; reconnecting", e.what());
+        }
+
+        // 응답을 다 읽지 못한 커넥션은 다음 쿼리에서 commands out of sync가 나므로 새로 접속한다
+        reconnect();
+    }
+
+    size_t MySQLDBHandle::executeBatch(const std::vector<std::string> &statements, size_t offset) {
+        auto *mysql = _handle.get();
+
+        // 빈 구문은 서버가 오류로 처리하므로 batch에 넣지 않는다. 실패 위치를 되돌리기 위해 원래 인덱스를 기억한다.
+        std::vector<size_t> indices;
+        std::string batch;
+        for (size_t i = offset; i < statements.size(); i++) {
+            const auto length = batch.size();
+            appendStatement(batch, statements[i]);
+            if (batch.size() != length) {
+                indices.push_back(i);
+            }
+        }
+
+        if (indices.empty()) {
+            return statements.size();
+        }
+
+        // multi-statement는 batch에만 허용한다. 다음 executeQuery() / startQuery()가 보내기 전에 다시 끈다.
+        if (!_multiStatementsEnabled) {
+            if (mysql_set_server_option(mysql, MYSQL_OPTION_MULTI_STATEMENTS_ON) != 0) {
+                throw std::runtime_error(
+                    fmt::format("failed to enable multi-statements: {}", mysql_error(mysql))
+                );
+            }
+            _multiStatementsEnabled = true;
+        }
+
+        const auto failed = executeMultiStatement(batch, indices);
+        return failed < indices.size() ? indices[failed] : statements.size();
+    }
+
+    void MySQLDBHandle::disableMultiStatements() {
+        if (!_multiStatementsEnabled) {
+            return;
+        }
+
+        if (mysql_set_server_option(_handle.get(), MYSQL_OPTION_MULTI_STATEMENTS_OFF) != 0) {
+            throw std::runtime_error(
+                fmt::format("failed to disable multi-statements: {}", mysql_error(_handle.get()))
+            );
+        }
+        _multiStatementsEnabled = false;
+    }
+
+    size_t MySQLDBHandle::executeMultiStatement(const std::string &batch, const std::vector<size_t> &indices) {
+        auto *mysql = _handle.get();
+
+        if (mysql_real_query(mysql, batch.c_str(), batch.size()) != 0) {
+            _logger->warn("executeBatch() returned non-zero code: {} ({})", mysql_errno(mysql), mysql_error(mysql));
+            return 0;
+        }
+
+        // 구문 하나당 result가 하나씩 돌아오므로, mysql_next_result()가 실패하면 그 다음 구문이 실패한 것이다
+        for (size_t position = 0;; position++) {
+            MYSQL_RES *result = mysql_store_result(mysql);
+            if (result != nullptr) {
+                mysql_free_result(result);
+            }
+
+            const int status = mysql_next_result(mysql);
+            if (status < 0) {
+                return indices.size();
+            }
+            if (status > 0) {
+                _logger->warn("executeBatch() returned non-zero code: {} ({})", mysql_errno(mysql), mysql_error(mysql));
+                return std::min(position + 1, indices.size() - 1);
+            }
+        }
+    }
+
     MockedDBHandle::MockedDBHandle():
         _state(defaultSharedState())
     {
@@ -229,7 +493,13 @@ namespace ultraverse::mariadb {
 
     int MockedDBHandle::executeQuery(const std::string &query) {
         std::scoped_lock lock(_state->mutex);
+        if (_pendingPolls > 0) {
+            _state->outOfSyncQueries++;
+        }
         _state->queries.push_back(query);
+        if (_state->failingQueries.count(query) > 0) {
+            return 1;
+        }
         return _state->lastErrno;
     }
 
@@ -265,6 +535,44 @@ namespace ultraverse::mariadb {
         return nullptr;
     }
 
+    void MockedDBHandle::startQuery(const std::string &query) {
+        DBHandle::startQuery(query);
+
+        std::scoped_lock lock(_state->mutex);
+        _pendingPolls = _state->asyncPendingPolls;
+        _throwOnPoll = _state->throwingQueries.count(query) > 0;
+    }
+
+    DBHandle::AsyncStatus MockedDBHandle::pollQuery() {
+        if (_throwOnPoll) {
+            // 응답을 다 받기 전에 실패한 것처럼 쿼리를 진행 중인 상태로 남겨 둔다
+            _throwOnPoll = false;
+            _pendingPolls = std::max(_pendingPolls, 1);
+            throw std::runtime_error("mocked async query failure");
+        }
+        if (_pendingPolls > 0) {
+            _pendingPolls--;
+            return AsyncStatus::PENDING;
+        }
+        return DBHandle::pollQuery();
+    }
+
+    void MockedDBHandle::cancelQuery() {
+        _pendingPolls = 0;
+        _throwOnPoll = false;
+
+        std::scoped_lock lock(_state->mutex);
+        _state->cancels++;
+    }
+
+    size_t MockedDBHandle::executeBatch(const std::vector<std::string> &statements, size_t offset) {
+        {
+            std::scoped_lock lock(_state->mutex);
+            _state->batches++;
+        }
+        return DBHandle::executeBatch(statements, offset);
+    }
+
     std::shared_ptr<MockedDBHandle::SharedState> MockedDBHandle::sharedState() const {
         return _state;
     }
@@ -283,6 +591,12 @@ namespace ultraverse::mariadb {
         }
         state->lastErrno = 0;
         state->lastError.clear();
+        state->asyncPendingPolls = 0;
+        state->batches = 0;
+        state->cancels = 0;
+        state->outOfSyncQueries = 0;
+        state->failingQueries.clear();
+        state->throwingQueries.clear();
     }
  
 }
@@ -8,6 +8,7 @@
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -29,6 +30,12 @@ namespace ultraverse::mariadb {
      */
     class DBHandle: public base::DBHandle {
     public:
+        enum class AsyncStatus {
+            PENDING,
+            COMPLETE,
+            FAILED
+        };
+
         virtual ~DBHandle() override = default;
 
         virtual const char *lastError() const = 0;
@@ -39,6 +46,44 @@ namespace ultraverse::mariadb {
         virtual std::shared_ptr<MYSQL> handle() = 0;
 
         void consumeResults();
+
+        /**
+         * @brief statements[offset..]를 multi-statement 요청 하나로 실행하고, 모든 result set을 소모한다.
+         * @return 실패한 구문의 인덱스. 모두 성공했으면 statements.size()
+         * @note 실패한 구문 뒤의 구문은 실행되지 않는다. 기본 구현은 구문을 하나씩 실행한다.
+         *       MySQLDBHandle은 batch에만 multi-statement를 켜고, 다음 executeQuery() / startQuery() 전에 다시 끈다.
+         *       구문 하나가 result set을 여러 개 반환하면 (CALL 등) 실패 위치를 정확히 알 수 없다.
+         */
+        virtual size_t executeBatch(const std::vector<std::string> &statements, size_t offset);
+
+        /**
+         * @brief 쿼리를 비동기로 실행하기 시작한다. 진행은 pollQuery()로 한다.
+         * @note 기본 구현은 쿼리를 동기적으로 실행하고 결과를 소모한다.
+         */
+        virtual void startQuery(const std::string &query);
+        /**
+         * @brief startQuery()로 시작한 쿼리를 블로킹 없이 진행할 수 있는 만큼 진행한다.
+         * @details 쿼리가 끝나면 모든 result set을 소모한 뒤 COMPLETE (또는 FAILED)를 반환한다.
+         */
+        virtual AsyncStatus pollQuery();
+        /**
+         * @brief pollQuery()가 PENDING을 반환했을 때 poll(2)로 기다릴 수 있는 소켓을 반환한다. 없으면 -1.
+         */
+        virtual int socketDescriptor();
+        /**
+         * @brief pollQuery()가 PENDING을 반환했을 때 socketDescriptor()에서 기다려야 하는 poll(2) 이벤트
+         * @note 기본 구현은 POLLIN을 반환한다.
+         */
+        virtual short pollEvents();
+        /**
+         * @brief startQuery()로 시작한 쿼리가 아직 진행 중이면 끝날 때까지 기다리고 결과를 모두 버린다.
+         * @details 쿼리를 끝까지 진행할 수 없으면 접속을 다시 맺어, 핸들이 새 쿼리를 받을 수 있는 상태가 되게 한다.
+         * @throws std::runtime_error 다시 접속하지 못한 경우
+         */
+        virtual void cancelQuery();
+
+    private:
+        AsyncStatus _syncQueryStatus = AsyncStatus::COMPLETE;
     };
 
     /**
@@ -60,13 +105,61 @@ namespace ultraverse::mariadb {
         int nextResult() override;
         void setAutocommit(bool enabled) override;
         std::shared_ptr<MYSQL> handle() override;
+
+        /**
+         * @brief mysql_real_query_nonblocking() 등 MySQL C API의 non-blocking 함수로 쿼리를 실행한다.
+         */
+        void startQuery(const std::string &query) override;
+        AsyncStatus pollQuery() override;
+        int socketDescriptor() override;
+        /**
+         * @brief 쿼리를 아직 다 보내지 못했으면 POLLOUT도 기다린다.
+         */
+        short pollEvents() override;
+        void cancelQuery() override;
+
+        size_t executeBatch(const std::vector<std::string> &statements, size_t offset) override;
         
     private:
+        enum class AsyncStage {
+            IDLE,
+            QUERY,
+            STORE_RESULT,
+            NEXT_RESULT
+        };
+
+        static constexpr int CANCEL_QUERY_TIMEOUT_MS = 30000;
+
+        void initHandle();
+        /**
+         * @brief multi-statement가 허용된 상태에서 batch를 실행하고 모든 result를 소모한다.
+         * @return 실패한 구문의 indices 내 위치. 모두 성공했으면 indices.size()
+         */
+        size_t executeMultiStatement(const std::string &batch, const std::vector<size_t> &indices);
+        void reconnect();
+        void disableMultiStatements();
         void disableAutoCommit();
         void disableBinlogChecksum();
         
         LoggerPtr _logger;
         std::shared_ptr<MYSQL> _handle;
+
+        /** @brief reconnect()에서 다시 접속하기 위해 접속 정보를 보관한다. */
+        std::string _host;
+        int _port = 0;
+        std::string _user;
+        std::string _password;
+
+        AsyncStage _asyncStage = AsyncStage::IDLE;
+        /** @brief non-blocking 함수는 완료될 때까지 같은 인자로 다시 불러야 하므로 쿼리를 보관한다. */
+        std::string _asyncQuery;
+        bool _asyncFailed = false;
+        /** @brief executeBatch()가 켠 multi-statement가 아직 켜져 있는지 여부 */
+        bool _multiStatementsEnabled = false;
+        /** @brief 현재 쿼리를 서버에 보내기 시작했는지 여부. 보내지 않은 쿼리는 cancelQuery()에서 그냥 버린다. */
+        bool _asyncQuerySent = false;
+        /** @brief 마지막 pollQuery()가 쿼리를 보내다가 소켓 버퍼가 차서 멈췄는지 여부 */
+        bool _asyncWaitingForWrite = false;
     };
 
     /**
@@ -80,6 +173,18 @@ namespace ultraverse::mariadb {
             std::queue<std::vector<std::vector<std::string>>> results;
             int lastErrno = 0;
             std::string lastError;
+            /** @brief startQuery() 후 pollQuery()가 PENDING을 반환할 횟수 (비동기 실행 흉내) */
+            int asyncPendingPolls = 0;
+            /** @brief executeBatch() 호출 횟수 */
+            int batches = 0;
+            /** @brief cancelQuery() 호출 횟수 */
+            int cancels = 0;
+            /** @brief startQuery()로 시작한 쿼리가 끝나기 전에 executeQuery()가 불린 횟수 (commands out of sync) */
+            int outOfSyncQueries = 0;
+            /** @brief 이 쿼리들은 executeQuery()가 실패를 반환한다 */
+            std::set<std::string> failingQueries;
+            /** @brief 이 쿼리들은 startQuery() 후 응답을 기다리는 도중 pollQuery()가 예외를 던진다 */
+            std::set<std::string> throwingQueries;
         };
 
         MockedDBHandle();
@@ -96,12 +201,20 @@ namespace ultraverse::mariadb {
         void setAutocommit(bool enabled) override;
         std::shared_ptr<MYSQL> handle() override;
 
+        void startQuery(const std::string &query) override;
+        AsyncStatus pollQuery() override;
+        void cancelQuery() override;
+
+        size_t executeBatch(const std::vector<std::string> &statements, size_t offset) override;
+
         std::shared_ptr<SharedState> sharedState() const;
         static std::shared_ptr<SharedState> defaultSharedState();
         static void resetDefaultSharedState();
 
     private:
         std::shared_ptr<SharedState> _state;
+        int _pendingPolls = 0;
+        bool _throwOnPoll = false;
     };
 }
 
@@ -2,6 +2,19 @@
 // Created by cheesekun on 2/1/23.
 //
 
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
 #include "BinaryLogSequentialReader.hpp"
 
 #include "MySQLBinaryLogReaderV2.hpp"
@@ -14,18 +27,34 @@ namespace ultraverse::mariadb {
         _indexFile(indexFile),
         
         _currentIndex(0),
-        _isPollDisabled(false)
+        _isPollDisabled(false),
+        _isMemoryMapped(false),
+        
+        _inotifyFd(-1),
+        _wakeupFd(-1)
     {
         updateIndex();
+        initializeWatch();
+        
         if (!_logFileList.empty()) {
             seek(_currentIndex, 4);
         }
     }
     
+    BinaryLogSequentialReader::~BinaryLogSequentialReader() {
+        if (_inotifyFd >= 0) {
+            ::close(_inotifyFd);
+        }
+        if (_wakeupFd >= 0) {
+            ::close(_wakeupFd);
+        }
+    }
+    
     bool BinaryLogSequentialReader::seek(int index, int64_t position) {
         assert(index < _logFileList.size());
         
-        openLog(_logFileList[index]);
+        // 마지막 binlog는 아직 쓰이고 있을 수 있으므로 매핑하지 않는다
+        openLog(_logFileList[index], _isMemoryMapped && index + 1 < _logFileList.size());
         _currentIndex = index;
         
         return _binaryLogReader->seek(position);
@@ -39,8 +68,6 @@ namespace ultraverse::mariadb {
         
             auto result = _binaryLogReader->next();
             if (!result) {
-                using namespace std::chrono_literals;
-                
                 if (pollNext()) {
                     continue;
                 } else {
@@ -48,7 +75,7 @@ namespace ultraverse::mariadb {
                         return false;
                     }
                 }
-                std::this_thread::sleep_for(5s);
+                waitForChange(POLL_INTERVAL);
             } else {
                 return true;
             }
@@ -87,14 +114,126 @@ namespace ultraverse::mariadb {
         }
     }
     
-    void BinaryLogSequentialReader::openLog(const std::string &logFile) {
+    void BinaryLogSequentialReader::openLog(const std::string &logFile, bool memoryMapped) {
         if (_binaryLogReader != nullptr) {
             _binaryLogReader->close();
             _binaryLogReader = nullptr;
         }
         
-        _binaryLogReader = openBinaryLog(logFile);
+        _binaryLogReader = openBinaryLog(logFile, memoryMapped);
         _binaryLogReader->open();
+        
+        watchDirectoryOf(_basePath + "/" + logFile);
+    }
+    
+    void BinaryLogSequentialReader::initializeWatch() {
+#ifdef __linux__
+        _inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (_inotifyFd < 0) {
+            _logger->warn(
+                "inotify_init1() failed: {}, falling back to polling every {}ms",
+                strerror(errno), POLL_INTERVAL.count()
+            );
+            return;
+        }
+        
+        _wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_wakeupFd < 0) {
+            _logger->warn("eventfd() failed: {}", strerror(errno));
+        }
+        
+        watchDirectoryOf(_basePath + "/" + _indexFile);
+#else
+        // inotify가 없는 플랫폼에서는 POLL_INTERVAL마다 다시 확인한다
+        _logger->debug("file change notification is not available, polling every {}ms", POLL_INTERVAL.count());
+#endif
+    }
+    
+    void BinaryLogSequentialReader::watchDirectoryOf(const std::string &path) {
+#ifdef __linux__
+        if (_inotifyFd < 0) {
+            return;
+        }
+        
+        // index 파일은 rename()으로 바꿔 쓰일 수 있고 binlog는 새로 만들어지므로, 파일이 아닌 디렉토리를 감시한다.
+        // 이미 감시하고 있는 디렉토리면 inotify_add_watch()는 같은 watch descriptor를 돌려준다
+        auto directory = std::filesystem::path(path).parent_path();
+        auto directoryPath = directory.empty() ? std::string(".") : directory.string();
+        
+        if (inotify_add_watch(_inotifyFd, directoryPath.c_str(), IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE) < 0) {
+            _logger->warn("could not watch {}: {}", directoryPath, strerror(errno));
+        }
+#endif
+    }
+    
+    bool BinaryLogSequentialReader::waitForChange(std::chrono::milliseconds timeout) {
+        if (_inotifyFd < 0) {
+            std::this_thread::sleep_for(timeout);
+            return false;
+        }
+        
+#ifdef __linux__
+        // binlog가 있는 디렉토리는 보통 datadir이므로 다른 파일의 이벤트는 걸러낸다
+        const auto indexName = std::filesystem::path(_basePath + "/" + _indexFile).filename().string();
+        const auto logName = std::filesystem::path(currentLogFile()).filename().string();
+        
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        alignas(struct inotify_event) char buffer[4096];
+        
+        while (!terminateSignal.load(std::memory_order_acquire)) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()
+            );
+            if (remaining.count() <= 0) {
+                return false;
+            }
+            
+            struct pollfd fds[2] = {
+                { _inotifyFd, POLLIN, 0 },
+                { _wakeupFd, POLLIN, 0 }
+            };
+            int result = poll(fds, _wakeupFd >= 0 ? 2 : 1, static_cast<int>(remaining.count()));
+            
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                
+                _logger->warn("poll() failed: {}", strerror(errno));
+                std::this_thread::sleep_for(remaining);
+                return false;
+            }
+            
+            if (result == 0 || (fds[1].revents & POLLIN)) {
+                return false;
+            }
+            
+            bool isChanged = false;
+            ssize_t length;
+            
+            while ((length = read(_inotifyFd, buffer, sizeof(buffer))) > 0) {
+                for (char *ptr = buffer; ptr < buffer + length;) {
+                    const auto *event = reinterpret_cast<const struct inotify_event *>(ptr);
+                    
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        // 큐가 넘쳐 이벤트를 잃었으므로 바뀌었다고 가정한다
+                        isChanged = true;
+                    } else if (event->len > 0) {
+                        std::string name(event->name);
+                        isChanged |= (name == indexName || name == logName);
+                    }
+                    
+                    ptr += sizeof(struct inotify_event) + event->len;
+                }
+            }
+            
+            if (isChanged) {
+                return true;
+            }
+        }
+#endif
+        
+        return false;
     }
     
     std::shared_ptr<base::DBEvent> BinaryLogSequentialReader::currentEvent() {
@@ -120,16 +259,84 @@ namespace ultraverse::mariadb {
         _isPollDisabled = isPollDisabled;
     }
     
+    void BinaryLogSequentialReader::setMemoryMapped(bool isMemoryMapped) {
+        if (_isMemoryMapped == isMemoryMapped) {
+            return;
+        }
+        
+        _isMemoryMapped = isMemoryMapped;
+        if (_binaryLogReader != nullptr) {
+            seek(_currentIndex, _binaryLogReader->pos());
+        }
+    }
+    
+    void BinaryLogSequentialReader::setPayloadDecodeThreads(int threadCount) {
+        int position = -1;
+        if (_binaryLogReader != nullptr) {
+            // 지금 reader가 기존 executor를 쓰고 있으므로 먼저 닫는다
+            position = _binaryLogReader->pos();
+            _binaryLogReader->close();
+            _binaryLogReader = nullptr;
+        }
+        
+        _payloadDecoder = threadCount > 0 ? std::make_unique<TaskExecutor>(threadCount) : nullptr;
+        
+        if (position >= 0) {
+            seek(_currentIndex, position);
+        }
+    }
+    
     void BinaryLogSequentialReader::terminate() {
         terminateSignal.store(true, std::memory_order_release);
+        
+#ifdef __linux__
+        if (_wakeupFd >= 0) {
+            uint64_t value = 1;
+            [[maybe_unused]] auto written = ::write(_wakeupFd, &value, sizeof(value));
+        }
+#endif
     }
 
     int BinaryLogSequentialReader::logFileListSize() {
         return _logFileList.size();
     }
     
-    std::unique_ptr<BinaryLogReaderBase> BinaryLogSequentialReader::openBinaryLog(const std::string &logFile) {
-        return std::make_unique<MySQLBinaryLogReaderV2>(_basePath + "/" + logFile);
+    int BinaryLogSequentialReader::currentIndex() {
+        return _currentIndex;
+    }
+    
+    std::string BinaryLogSequentialReader::currentLogFile() {
+        if (_currentIndex >= _logFileList.size()) {
+            return "";
+        }
+        return _logFileList[_currentIndex];
+    }
+    
+    int BinaryLogSequentialReader::indexOf(const std::string &logFile) {
+        auto it = std::find(_logFileList.begin(), _logFileList.end(), logFile);
+        if (it == _logFileList.end()) {
+            return -1;
+        }
+        return static_cast<int>(std::distance(_logFileList.begin(), it));
+    }
+    
+    std::string BinaryLogSequentialReader::logFileAt(int index) {
+        assert(index < _logFileList.size());
+        
+        return _logFileList[index];
+    }
+    
+    std::unique_ptr<BinaryLogReaderBase> BinaryLogSequentialReader::openLogFile(int index) {
+        assert(index < _logFileList.size());
+        
+        auto reader = openBinaryLog(_logFileList[index], _isMemoryMapped && index + 1 < _logFileList.size());
+        reader->open();
+        
+        return reader;
+    }
+    
+    std::unique_ptr<BinaryLogReaderBase> BinaryLogSequentialReader::openBinaryLog(const std::string &logFile, bool memoryMapped) {
+        return std::make_unique<MySQLBinaryLogReaderV2>(_basePath + "/" + logFile, memoryMapped, _payloadDecoder.get());
     }
     
     
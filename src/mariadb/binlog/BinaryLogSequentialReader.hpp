@@ -6,31 +6,89 @@
 #define ULTRAVERSE_BINARYLOGSEQUENTIALREADER_HPP
 
 #include <atomic>
+#include <chrono>
+
+#include "base/TaskExecutor.hpp"
 
 #include "BinaryLogReader.hpp"
 
 namespace ultraverse::mariadb {
     class BinaryLogSequentialReader {
     public:
+        /**
+         * @brief inotify 이벤트를 놓쳤을 때를 대비해 binlog 끝에서 다시 확인하기까지 기다리는 최대 시간
+         */
+        static constexpr std::chrono::milliseconds POLL_INTERVAL = std::chrono::seconds(5);
+        
         explicit BinaryLogSequentialReader(const std::string &basePath, const std::string &indexFile);
+        ~BinaryLogSequentialReader();
         
         bool seek(int index, int64_t position);
         bool next();
         int pos();
         int logFileListSize();
         
+        /**
+         * @return 지금 읽고 있는 binlog 파일의 (index 파일 기준) 순번
+         */
+        int currentIndex();
+        /**
+         * @return 지금 읽고 있는 binlog 파일의 이름 (index 파일에 적힌 그대로)
+         */
+        std::string currentLogFile();
+        /**
+         * @return index 파일에서 logFile의 순번. 없으면 (purge된 경우) -1
+         */
+        int indexOf(const std::string &logFile);
+        /**
+         * @return index 파일에서 index번째 binlog 파일의 이름
+         */
+        std::string logFileAt(int index);
+        
+        /**
+         * @brief index번째 binlog를 이 reader와 같은 설정 (mmap, payload 디코딩)으로 따로 연다.
+         * @details 이 reader의 위치와 상관없이 읽을 수 있으며, 다른 스레드에서 읽어도 된다.
+         *          이 reader보다 먼저 해제해야 한다. (payload 디코딩 스레드를 함께 쓴다)
+         */
+        std::unique_ptr<BinaryLogReaderBase> openLogFile(int index);
+        
         std::shared_ptr<base::DBEvent> currentEvent();
         
         bool isPollDisabled() const;
         void setPollDisabled(bool isPollDisabled);
         
+        /**
+         * @brief 다 쓰인 binlog (index 파일의 마지막이 아닌 파일)는 mmap해서 복사 없이 읽는다.
+         *        아직 쓰이고 있는 마지막 binlog는 계속 ifstream으로 읽는다.
+         * @note 지금 열려 있는 파일은 같은 위치에서 다시 연다.
+         */
+        void setMemoryMapped(bool isMemoryMapped);
+        
+        /**
+         * @brief TRANSACTION_PAYLOAD_EVENT의 압축 해제와 디코딩을 threadCount개의 스레드에서 미리 해 둔다.
+         *        0이면 읽는 스레드에서 하나씩 푼다. 이벤트를 넘겨주는 순서는 같다.
+         * @note 지금 열려 있는 파일은 같은 위치에서 다시 연다.
+         */
+        void setPayloadDecodeThreads(int threadCount);
+        
+        /**
+         * @brief next()를 멈춘다. 다른 스레드에서 호출해도 되며, binlog 끝에서 기다리고 있던 next()도 바로 깨어난다.
+         */
         void terminate();
 
     private:
-        std::unique_ptr<BinaryLogReaderBase> openBinaryLog(const std::string &logFile);
+        std::unique_ptr<BinaryLogReaderBase> openBinaryLog(const std::string &logFile, bool memoryMapped);
         void updateIndex();
-        void openLog(const std::string &logFile);
+        void openLog(const std::string &logFile, bool memoryMapped);
         bool pollNext();
+        
+        void initializeWatch();
+        void watchDirectoryOf(const std::string &path);
+        /**
+         * @brief 읽고 있는 binlog나 index 파일이 바뀌거나, terminate()되거나, timeout이 지날 때까지 기다린다.
+         * @return inotify를 쓸 수 없으면 (Linux가 아닌 경우 포함) timeout만큼 잠들고 false를 반환한다.
+         */
+        bool waitForChange(std::chrono::milliseconds timeout);
     
         LoggerPtr _logger;
     
@@ -42,8 +100,16 @@ namespace ultraverse::mariadb {
     
         std::atomic<bool> terminateSignal{false};
         bool _isPollDisabled;
+        bool _isMemoryMapped;
     
+        /** _binaryLogReader가 참조하므로 그보다 먼저 선언해서 나중에 소멸되게 한다 */
+        std::unique_ptr<TaskExecutor> _payloadDecoder;
         std::unique_ptr<BinaryLogReaderBase> _binaryLogReader;
+        
+        /** 쓸 수 없으면 (Linux가 아니면 항상) -1이며, 이때는 POLL_INTERVAL마다 다시 확인한다 */
+        int _inotifyFd;
+        /** terminate()가 waitForChange()를 깨우는 eventfd */
+        int _wakeupFd;
     };
 }
 
@@ -4,6 +4,11 @@
 
 #include "MySQLBinaryLogReaderV2.hpp"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <cerrno>
 #include <cstring>
 #include <utility>
@@ -21,6 +26,12 @@ namespace ultraverse::mariadb {
         constexpr size_t kEventLenOffset = EVENT_LEN_OFFSET;
         constexpr size_t kLogPosOffset = LOG_POS_OFFSET;
         constexpr size_t kBinlogChecksumLen = BINLOG_CHECKSUM_LEN;
+        constexpr int64_t kBinlogHeaderSize = BIN_LOG_HEADER_SIZE;
+
+        /** payloadDecoder가 있을 때 미리 읽어 두는 이벤트 수의 상한 */
+        constexpr size_t kMaxPendingEvents = 1024;
+        /** 동시에 풀고 있는 TRANSACTION_PAYLOAD_EVENT 수의 상한 */
+        constexpr size_t kMaxPendingPayloads = 64;
 
         uint16_t readUint16LE(const unsigned char *ptr) {
             return static_cast<uint16_t>(ptr[0]) |
@@ -128,7 +139,7 @@ namespace ultraverse::mariadb {
             return false;
         }
 
-        uint64_t eventTimestamp(const std::vector<unsigned char> &buffer) {
+        uint64_t eventTimestamp(std::span<const unsigned char> buffer) {
             if (buffer.size() < kLogEventMinimalHeaderLen) {
                 return 0;
             }
@@ -136,16 +147,26 @@ namespace ultraverse::mariadb {
         }
     } // namespace
 
-    MySQLBinaryLogReaderV2::MySQLBinaryLogReaderV2(const std::string &filename):
+    MySQLBinaryLogReaderV2::MySQLBinaryLogReaderV2(const std::string &filename, bool memoryMapped,
+                                                   TaskExecutor *payloadDecoder):
         BinaryLogReaderBase(filename),
         _logger(createLogger("MySQLBinaryLogReaderV2")),
         _filename(filename),
         _pos(0),
-        _checksumAlg(mysql::binlog::event::BINLOG_CHECKSUM_ALG_UNDEF)
+        _readPos(0),
+        _isMemoryMapped(memoryMapped),
+        _checksumAlg(mysql::binlog::event::BINLOG_CHECKSUM_ALG_UNDEF),
+        _eventArena(std::make_shared<base::EventArena>()),
+        _payloadDecoder(payloadDecoder)
     {
         ensureDefaultFde();
     }
 
+    MySQLBinaryLogReaderV2::~MySQLBinaryLogReaderV2() {
+        // 작업 중인 payload 디코딩이 이 객체를 참조하고 있다
+        drainPipeline();
+    }
+
     void MySQLBinaryLogReaderV2::ensureDefaultFde() {
         if (_fde == nullptr) {
             _fde = std::make_unique<mysql::binlog::event::Format_description_event>(
@@ -157,6 +178,16 @@ namespace ultraverse::mariadb {
     }
 
     void MySQLBinaryLogReaderV2::open() {
+        if (_isMemoryMapped) {
+            if (mapFile()) {
+                _logger->info("opening binary log (mmap): {}", _filename);
+                _pos = 0;
+                _readPos = 0;
+                return;
+            }
+            _logger->warn("could not mmap {}, falling back to buffered reads", _filename);
+        }
+
         _logger->info("opening binary log: {}", _filename);
 
         _stream = std::ifstream(
@@ -164,6 +195,7 @@ namespace ultraverse::mariadb {
             std::ios::in | std::ios::binary
         );
         _pos = 0;
+        _readPos = 0;
 
         if (!_stream.good()) {
             throw std::runtime_error(fmt::format(
@@ -175,17 +207,133 @@ namespace ultraverse::mariadb {
 
     void MySQLBinaryLogReaderV2::close() {
         _logger->info("closing binary log: {}", _filename);
+        drainPipeline();
         _stream.close();
+
+        // 매핑 위의 row data를 가진 RowEvent가 남아 있으면 그것들이 해제될 때 munmap()된다
+        _mapping = nullptr;
+        _mappingSize = 0;
+        _mappingPos = 0;
+    }
+
+    bool MySQLBinaryLogReaderV2::mapFile() {
+        int fd = ::open(_filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat fileStat {};
+        if (fstat(fd, &fileStat) < 0 || fileStat.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+
+        auto size = static_cast<size_t>(fileStat.st_size);
+        // event_checksum_test()는 FORMAT_DESCRIPTION_EVENT의 플래그를 잠시 고쳐 쓰므로 쓰기 가능한 private 매핑을 쓴다.
+        // 고쳐 쓴 페이지는 이 프로세스의 사본에만 반영된다
+        void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (address == MAP_FAILED) {
+            return false;
+        }
+        madvise(address, size, MADV_SEQUENTIAL);
+
+        _mapping = std::shared_ptr<const unsigned char>(
+            static_cast<const unsigned char *>(address),
+            [size](const unsigned char *mapping) {
+                munmap(const_cast<unsigned char *>(mapping), size);
+            }
+        );
+        _mappingSize = size;
+        _mappingPos = 0;
+
+        return true;
     }
 
     bool MySQLBinaryLogReaderV2::seek(int64_t position) {
         _logger->trace("seeking offset: {}", position);
+
+        // 미리 읽어 둔 이벤트는 버린다
+        drainPipeline();
+        _payloadEventQueue.clear();
+
+        if (position > kBinlogHeaderSize && !_hasFormatDescription) {
+            // 파일 중간부터 읽으면 offset 4의 FORMAT_DESCRIPTION_EVENT를 건너뛰므로,
+            // 체크섬 알고리즘과 post header 길이를 알 수 있도록 먼저 읽어 둔다
+            readFormatDescription();
+        }
+
+        if (_mapping != nullptr) {
+            if (position < 0 || static_cast<size_t>(position) > _mappingSize) {
+                return false;
+            }
+            _mappingPos = static_cast<size_t>(position);
+            _pos = position;
+            _readPos = position;
+            return true;
+        }
+
         _stream.seekg(position);
         _pos = position;
+        _readPos = position;
 
         return _stream.good();
     }
 
+    void MySQLBinaryLogReaderV2::readFormatDescription() {
+        if (_mapping != nullptr) {
+            _mappingPos = static_cast<size_t>(kBinlogHeaderSize);
+        } else {
+            _stream.clear();
+            _stream.seekg(kBinlogHeaderSize);
+        }
+
+        EventView buffer;
+        if (!readNextEvent(buffer) ||
+            buffer.size() < kLogEventMinimalHeaderLen ||
+            buffer[kEventTypeOffset] != mysql::binlog::event::FORMAT_DESCRIPTION_EVENT) {
+            _logger->warn("could not read format description event of {}", _filename);
+            _stream.clear();
+            return;
+        }
+
+        decodeEventBuffer(buffer, false, nullptr);
+    }
+
+    bool MySQLBinaryLogReaderV2::readNextEvent(EventView &event) {
+        if (_mapping == nullptr) {
+            if (!readNextEventBuffer(_eventBuffer)) {
+                return false;
+            }
+            event = _eventBuffer;
+            return true;
+        }
+
+        if (_mappingPos + kLogEventMinimalHeaderLen > _mappingSize) {
+            return false;
+        }
+
+        const unsigned char *header = _mapping.get() + _mappingPos;
+        uint32_t eventSize = readUint32LE(header + kEventLenOffset);
+        if (eventSize < kLogEventMinimalHeaderLen) {
+            _logger->warn("invalid event size: {}", eventSize);
+            return false;
+        }
+        if (_mappingPos + eventSize > _mappingSize) {
+            _logger->warn("event exceeds mapped file (size={})", eventSize);
+            return false;
+        }
+
+        event = EventView(header, eventSize);
+        _mappingPos += eventSize;
+
+        uint32_t logPos = readUint32LE(header + kLogPosOffset);
+        _readPos = (logPos != 0) ? static_cast<int>(logPos) : static_cast<int>(_mappingPos);
+
+        return true;
+    }
+
     bool MySQLBinaryLogReaderV2::readNextEventBuffer(std::vector<unsigned char> &buffer) {
         buffer.clear();
         unsigned char header[kLogEventMinimalHeaderLen];
@@ -213,7 +361,7 @@ namespace ultraverse::mariadb {
 
         uint32_t logPos = readUint32LE(buffer.data() + kLogPosOffset);
         auto tellPos = static_cast<int>(_stream.tellg());
-        _pos = (logPos != 0) ? static_cast<int>(logPos) : tellPos;
+        _readPos = (logPos != 0) ? static_cast<int>(logPos) : tellPos;
 
         return true;
     }
@@ -222,16 +370,20 @@ namespace ultraverse::mariadb {
         _currentEvent = nullptr;
 
         if (!_payloadEventQueue.empty()) {
-            auto buffer = std::move(_payloadEventQueue.front());
+            _currentEvent = std::move(_payloadEventQueue.front());
             _payloadEventQueue.pop_front();
-            _currentEvent = decodeEventBuffer(buffer, true);
             return true;
         }
 
-        std::vector<unsigned char> buffer;
-        if (!readNextEventBuffer(buffer)) {
+        if (_payloadDecoder != nullptr) {
+            return nextPipelined();
+        }
+
+        EventView buffer;
+        if (!readNextEvent(buffer)) {
             return false;
         }
+        _pos = _readPos;
 
         if (buffer.size() < kLogEventMinimalHeaderLen) {
             _logger->warn("skipping truncated event");
@@ -243,16 +395,135 @@ namespace ultraverse::mariadb {
         );
 
         if (eventType == mysql::binlog::event::TRANSACTION_PAYLOAD_EVENT) {
-            if (!handleTransactionPayloadEvent(buffer)) {
-                _logger->warn("failed to decode transaction payload event, skipping");
+            DecodedEvents events;
+            handleTransactionPayloadEvent(buffer, events);
+            _payloadEventQueue.insert(_payloadEventQueue.end(), events.begin(), events.end());
+            return true;
+        }
+
+        _currentEvent = decodeEvent(buffer);
+        return true;
+    }
+
+    std::shared_ptr<base::DBEvent> MySQLBinaryLogReaderV2::decodeEvent(EventView buffer) {
+        auto event = decodeEventBuffer(buffer, false, _eventArena);
+
+        if (event != nullptr && event->eventType() == event_type::TXNID) {
+            // 트랜잭션이 끝났으므로 다음 트랜잭션은 새 arena에 할당한다.
+            // 이전 arena는 거기서 할당된 이벤트가 모두 해제될 때 함께 해제된다
+            _eventArena = std::make_shared<base::EventArena>();
+        }
+
+        return event;
+    }
+
+    bool MySQLBinaryLogReaderV2::nextPipelined() {
+        fillPipeline();
+
+        if (_pipeline.empty()) {
+            return false;
+        }
+
+        auto pending = std::move(_pipeline.front());
+        _pipeline.pop_front();
+        _pos = pending.pos;
+
+        if (pending.payload.valid()) {
+            _pendingPayloads--;
+
+            auto payload = pending.payload.get();
+            if (payload.error != nullptr) {
+                // 읽는 스레드에서 바로 풀었을 때와 같은 차례에 던진다
+                std::rethrow_exception(payload.error);
             }
+
+            _payloadEventQueue.insert(_payloadEventQueue.end(), payload.events.begin(), payload.events.end());
             return true;
         }
 
-        _currentEvent = decodeEventBuffer(buffer, false);
+        _currentEvent = std::move(pending.event);
         return true;
     }
 
+    void MySQLBinaryLogReaderV2::fillPipeline() {
+        while (_pipeline.size() < kMaxPendingEvents && _pendingPayloads < kMaxPendingPayloads) {
+            EventView buffer;
+            if (!readNextEvent(buffer)) {
+                return;
+            }
+
+            PendingEvent pending;
+            pending.pos = _readPos;
+
+            if (buffer.size() < kLogEventMinimalHeaderLen) {
+                _logger->warn("skipping truncated event");
+                _pipeline.emplace_back(std::move(pending));
+                continue;
+            }
+
+            auto eventType = static_cast<mysql::binlog::event::Log_event_type>(
+                buffer[kEventTypeOffset]
+            );
+
+            if (eventType == mysql::binlog::event::TRANSACTION_PAYLOAD_EVENT) {
+                pending.payload = submitPayload(buffer);
+                _pendingPayloads++;
+            } else {
+                if (eventType == mysql::binlog::event::FORMAT_DESCRIPTION_EVENT) {
+                    // 작업 중인 payload 디코딩이 _fde를 읽고 있으므로, 모두 끝난 뒤에 바꾼다
+                    waitForPayloads();
+                }
+
+                // payload가 아닌 이벤트는 가벼우므로 읽는 스레드에서 바로 디코딩한다
+                pending.event = decodeEvent(buffer);
+            }
+
+            _pipeline.emplace_back(std::move(pending));
+        }
+    }
+
+    std::future<MySQLBinaryLogReaderV2::DecodedPayload> MySQLBinaryLogReaderV2::submitPayload(
+        EventView buffer
+    ) {
+        // 매핑 위의 이벤트는 매핑을 붙잡아 두고, 그렇지 않으면 _eventBuffer가 다음 이벤트에 다시 쓰이므로 복사한다
+        std::shared_ptr<const unsigned char> owner = _mapping;
+        if (owner == nullptr) {
+            auto copy = std::make_shared<std::vector<unsigned char>>(buffer.begin(), buffer.end());
+            buffer = EventView(copy->data(), copy->size());
+            owner = std::shared_ptr<const unsigned char>(copy, copy->data());
+        }
+
+        return _payloadDecoder->post<DecodedPayload>(
+            [this, owner = std::move(owner), buffer]() -> DecodedPayload {
+                DecodedPayload payload;
+
+                try {
+                    handleTransactionPayloadEvent(buffer, payload.events);
+                } catch (...) {
+                    // TaskExecutor는 예외를 promise로 넘기지 않으므로 여기서 잡아 nextPipelined()에서 다시 던진다
+                    payload.events.clear();
+                    payload.error = std::current_exception();
+                }
+
+                return payload;
+            }
+        )->get_future();
+    }
+
+    void MySQLBinaryLogReaderV2::waitForPayloads() {
+        for (auto &pending : _pipeline) {
+            if (pending.payload.valid()) {
+                pending.payload.wait();
+            }
+        }
+    }
+
+    void MySQLBinaryLogReaderV2::drainPipeline() {
+        waitForPayloads();
+        _pipeline.clear();
+        _pendingPayloads = 0;
+    }
+
     int MySQLBinaryLogReaderV2::pos() {
         return _pos;
     }
@@ -262,8 +533,9 @@ namespace ultraverse::mariadb {
     }
 
     std::shared_ptr<base::DBEvent> MySQLBinaryLogReaderV2::decodeEventBuffer(
-        const std::vector<unsigned char> &buffer,
-        bool fromPayload
+        EventView buffer,
+        bool fromPayload,
+        const std::shared_ptr<base::EventArena> &arena
     ) {
         if (buffer.size() < kLogEventMinimalHeaderLen) {
             return nullptr;
@@ -317,6 +589,7 @@ namespace ultraverse::mariadb {
 
             _fde = std::move(nextFde);
             _checksumAlg = _fde->footer()->checksum_alg;
+            _hasFormatDescription = true;
 
             return nullptr;
         }
@@ -340,7 +613,7 @@ namespace ultraverse::mariadb {
 
                 std::string schema(event.db, event.db_len);
                 std::string statement(event.query, event.q_len);
-                return std::make_shared<QueryEvent>(schema, statement, event.header()->when.tv_sec);
+                return base::makeEvent<QueryEvent>(arena, schema, statement, event.header()->when.tv_sec);
             }
             case mysql::binlog::event::XID_EVENT: {
                 mysql::binlog::event::Xid_event event(
@@ -351,7 +624,7 @@ namespace ultraverse::mariadb {
                     _logger->warn("invalid xid event, skipping");
                     return nullptr;
                 }
-                return std::make_shared<TransactionIDEvent>(event.xid, event.header()->when.tv_sec);
+                return base::makeEvent<TransactionIDEvent>(arena, event.xid, event.header()->when.tv_sec);
             }
             case mysql::binlog::event::INTVAR_EVENT: {
                 mysql::binlog::event::Intvar_event event(
@@ -362,7 +635,8 @@ namespace ultraverse::mariadb {
                     _logger->warn("invalid intvar event, skipping");
                     return nullptr;
                 }
-                return std::make_shared<IntVarEvent>(
+                return base::makeEvent<IntVarEvent>(
+                    arena,
                     mapIntVarType(event.type),
                     event.val,
                     event.header()->when.tv_sec
@@ -377,7 +651,8 @@ namespace ultraverse::mariadb {
                     _logger->warn("invalid rand event, skipping");
                     return nullptr;
                 }
-                return std::make_shared<RandEvent>(
+                return base::makeEvent<RandEvent>(
+                    arena,
                     event.seed1,
                     event.seed2,
                     event.header()->when.tv_sec
@@ -405,7 +680,8 @@ namespace ultraverse::mariadb {
 
                 bool isUnsigned = (event.flags & mysql::binlog::event::User_var_event::UNSIGNED_F) != 0;
 
-                return std::make_shared<UserVarEvent>(
+                return base::makeEvent<UserVarEvent>(
+                    arena,
                     std::move(name),
                     mapUserVarType(static_cast<uint8_t>(event.type)),
                     event.is_null,
@@ -424,17 +700,17 @@ namespace ultraverse::mariadb {
                     _logger->warn("invalid table map event, skipping");
                     return nullptr;
                 }
-                return decodeTableMapEvent(event);
+                return decodeTableMapEvent(event, arena);
             }
             case mysql::binlog::event::ROWS_QUERY_LOG_EVENT:
-                return decodeRowsQueryEvent(buffer, fromPayload);
+                return decodeRowsQueryEvent(buffer, fromPayload, arena);
             case mysql::binlog::event::OBSOLETE_WRITE_ROWS_EVENT_V1:
             case mysql::binlog::event::OBSOLETE_UPDATE_ROWS_EVENT_V1:
             case mysql::binlog::event::OBSOLETE_DELETE_ROWS_EVENT_V1:
             case mysql::binlog::event::WRITE_ROWS_EVENT:
             case mysql::binlog::event::UPDATE_ROWS_EVENT:
             case mysql::binlog::event::DELETE_ROWS_EVENT:
-                return decodeRowsEvent(buffer, eventType, fromPayload);
+                return decodeRowsEvent(buffer, eventType, fromPayload, arena);
             case mysql::binlog::event::PARTIAL_UPDATE_ROWS_EVENT:
                 _logger->warn("partial update rows event is not supported, skipping");
                 return nullptr;
@@ -445,7 +721,8 @@ namespace ultraverse::mariadb {
     }
 
     std::shared_ptr<TableMapEvent> MySQLBinaryLogReaderV2::decodeTableMapEvent(
-        mysql::binlog::event::Table_map_event &event
+        mysql::binlog::event::Table_map_event &event,
+        const std::shared_ptr<base::EventArena> &arena
     ) {
         if (event.m_colcnt == 0) {
             _logger->warn("table map event has zero columns, skipping");
@@ -705,7 +982,8 @@ namespace ultraverse::mariadb {
         }
 
         auto timestamp = event.header()->when.tv_sec;
-        return std::make_shared<TableMapEvent>(
+        return base::makeEvent<TableMapEvent>(
+            arena,
             event.get_table_id(),
             event.get_db_name(),
             event.get_table_name(),
@@ -719,8 +997,9 @@ namespace ultraverse::mariadb {
     }
 
     std::shared_ptr<base::DBEvent> MySQLBinaryLogReaderV2::decodeRowsQueryEvent(
-        const std::vector<unsigned char> &buffer,
-        bool fromPayload
+        EventView buffer,
+        bool fromPayload,
+        const std::shared_ptr<base::EventArena> &arena
     ) {
         if (_fde == nullptr) {
             return nullptr;
@@ -744,13 +1023,14 @@ namespace ultraverse::mariadb {
 
         size_t queryLen = eventSize - checksumLen - offset;
         std::string query(reinterpret_cast<const char *>(buffer.data() + offset), queryLen);
-        return std::make_shared<RowQueryEvent>(query, eventTimestamp(buffer));
+        return base::makeEvent<RowQueryEvent>(arena, query, eventTimestamp(buffer));
     }
 
     std::shared_ptr<base::DBEvent> MySQLBinaryLogReaderV2::decodeRowsEvent(
-        const std::vector<unsigned char> &buffer,
+        EventView buffer,
         mysql::binlog::event::Log_event_type eventType,
-        bool fromPayload
+        bool fromPayload,
+        const std::shared_ptr<base::EventArena> &arena
     ) {
         if (_fde == nullptr) {
             return nullptr;
@@ -839,8 +1119,14 @@ namespace ultraverse::mariadb {
             return nullptr;
         }
 
-        auto rowData = std::shared_ptr<uint8_t>(new uint8_t[rowDataSize], std::default_delete<uint8_t[]>());
-        std::memcpy(rowData.get(), ptr, rowDataSize);
+        std::shared_ptr<uint8_t> rowData;
+        if (!fromPayload && _mapping != nullptr) {
+            // 매핑을 함께 소유하는 포인터로 넘겨서 row data를 복사하지 않는다
+            rowData = std::shared_ptr<uint8_t>(_mapping, const_cast<uint8_t *>(ptr));
+        } else {
+            rowData = base::makeEventBuffer(arena, rowDataSize);
+            std::memcpy(rowData.get(), ptr, rowDataSize);
+        }
 
         RowEvent::Type type;
         switch (eventType) {
@@ -860,7 +1146,8 @@ namespace ultraverse::mariadb {
                 return nullptr;
         }
 
-        return std::make_shared<RowEvent>(
+        return base::makeEvent<RowEvent>(
+            arena,
             type,
             tableId,
             static_cast<int>(width),
@@ -873,16 +1160,18 @@ namespace ultraverse::mariadb {
         );
     }
 
-    bool MySQLBinaryLogReaderV2::handleTransactionPayloadEvent(const std::vector<unsigned char> &buffer) {
+    void MySQLBinaryLogReaderV2::handleTransactionPayloadEvent(EventView buffer, DecodedEvents &events) {
         ensureDefaultFde();
 
+        // payload 하나가 트랜잭션 하나이므로, 건너뛰면 트랜잭션을 통째로 잃는다
         if (_checksumAlg == mysql::binlog::event::BINLOG_CHECKSUM_ALG_CRC32 &&
             mysql::binlog::event::Log_event_footer::event_checksum_test(
                 const_cast<unsigned char *>(buffer.data()),
                 buffer.size(),
                 _checksumAlg)) {
-            _logger->warn("transaction payload event checksum mismatch");
-            return false;
+            throw std::runtime_error(fmt::format(
+                "transaction payload event checksum mismatch in {}", _filename
+            ));
         }
 
         mysql::binlog::event::Transaction_payload_event event(
@@ -890,10 +1179,14 @@ namespace ultraverse::mariadb {
             _fde.get()
         );
         if (!event.header()->get_is_valid()) {
-            _logger->warn("invalid transaction payload event");
-            return false;
+            throw std::runtime_error(fmt::format(
+                "invalid transaction payload event in {}", _filename
+            ));
         }
 
+        // payload 하나가 트랜잭션 하나이며, 다른 스레드에서 풀 수도 있으므로 arena를 따로 만든다
+        auto arena = std::make_shared<base::EventArena>();
+
         using BufferIStream = mysql::binlog::event::compression::Payload_event_buffer_istream;
         BufferIStream istream(event);
         BufferIStream::Buffer_ptr_t eventBuffer;
@@ -902,17 +1195,24 @@ namespace ultraverse::mariadb {
             if (!eventBuffer) {
                 continue;
             }
-            std::vector<unsigned char> payload(eventBuffer->data(), eventBuffer->data() + eventBuffer->size());
-            _payloadEventQueue.emplace_back(std::move(payload));
+
+            // 풀어낸 버퍼는 다음 이벤트를 풀 때 다시 쓰일 수 있으므로, 복사해 두지 않고 바로 디코딩한다
+            auto decoded = decodeEventBuffer(
+                EventView(reinterpret_cast<const unsigned char *>(eventBuffer->data()), eventBuffer->size()),
+                true,
+                arena
+            );
+            if (decoded != nullptr) {
+                events.emplace_back(std::move(decoded));
+            }
         }
 
         auto status = istream.get_status();
         if (istream.has_error() &&
             status != mysql::binlog::event::compression::Decompress_status::end) {
-            _logger->warn("payload decompression error: {}", istream.get_error_str());
-            return false;
+            throw std::runtime_error(fmt::format(
+                "could not decompress transaction payload event in {}: {}", _filename, istream.get_error_str()
+            ));
         }
-
-        return true;
     }
 }
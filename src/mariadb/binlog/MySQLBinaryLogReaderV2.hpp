@@ -8,12 +8,17 @@
 #include <cstdint>
 
 #include <deque>
+#include <exception>
 #include <fstream>
+#include <future>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
 #include "base/DBEvent.hpp"
+#include "base/EventArena.hpp"
+#include "base/TaskExecutor.hpp"
 #include "mariadb/DBEvent.hpp"
 #include "utils/log.hpp"
 
@@ -28,12 +33,25 @@
 namespace ultraverse::mariadb {
     class MySQLBinaryLogReaderV2: public BinaryLogReaderBase {
     public:
-        explicit MySQLBinaryLogReaderV2(const std::string &filename);
+        /**
+         * @param memoryMapped true면 파일 전체를 mmap해서, 이벤트를 버퍼로 복사하지 않고 매핑 위에서 바로 디코딩한다.
+         *                     매핑은 open()할 때의 파일 크기로 고정되므로, 아직 쓰이고 있는 (마지막) binlog에는 쓰지 않는다.
+         *                     mmap에 실패하면 ifstream으로 읽는다.
+         * @param payloadDecoder nullptr가 아니면 TRANSACTION_PAYLOAD_EVENT의 압축 해제와 디코딩을 이 executor에서 미리 해 둔다.
+         *                       이벤트는 여전히 binlog 순서대로 넘겨주며, executor는 이 reader보다 오래 살아 있어야 한다.
+         */
+        explicit MySQLBinaryLogReaderV2(const std::string &filename, bool memoryMapped = false,
+                                        TaskExecutor *payloadDecoder = nullptr);
+        ~MySQLBinaryLogReaderV2() override;
 
         void open() override;
         void close() override;
 
         bool seek(int64_t position) override;
+        /**
+         * @throws std::runtime_error TRANSACTION_PAYLOAD_EVENT를 풀거나 디코딩할 수 없는 경우.
+         *                            payloadDecoder를 쓸 때도 그 payload의 차례에 읽는 스레드에서 던진다.
+         */
         bool next() override;
 
         int pos() override;
@@ -41,14 +59,66 @@ namespace ultraverse::mariadb {
         std::shared_ptr<base::DBEvent> currentEvent() override;
 
     private:
+        /**
+         * @brief 이벤트 하나 (헤더 + 본문 + 체크섬)의 바이트. 매핑이나 _eventBuffer를 가리키며, 다음 이벤트를 읽기 전까지만 유효하다.
+         */
+        using EventView = std::span<const unsigned char>;
+        using DecodedEvents = std::vector<std::shared_ptr<base::DBEvent>>;
+
+        /**
+         * @brief payloadDecoder에서 TRANSACTION_PAYLOAD_EVENT를 풀어서 디코딩한 결과
+         */
+        struct DecodedPayload {
+            DecodedEvents events;
+            /** 실패했을 때의 예외. TaskExecutor는 예외를 넘기지 않으므로 여기에 담아 읽는 스레드에서 다시 던진다 */
+            std::exception_ptr error;
+        };
+
+        /**
+         * @brief 미리 읽어 둔 이벤트 하나
+         */
+        struct PendingEvent {
+            /** 이 이벤트를 넘겨준 뒤의 pos() */
+            int pos = 0;
+            std::shared_ptr<base::DBEvent> event;
+            /** TRANSACTION_PAYLOAD_EVENT를 풀어서 디코딩하는 작업 */
+            std::future<DecodedPayload> payload;
+        };
+
+        bool mapFile();
+        /**
+         * @brief offset 4의 FORMAT_DESCRIPTION_EVENT를 읽어 _fde에 반영한다. 읽는 위치는 호출한 쪽에서 다시 정해야 한다.
+         */
+        void readFormatDescription();
+        bool readNextEvent(EventView &event);
         bool readNextEventBuffer(std::vector<unsigned char> &buffer);
-        std::shared_ptr<base::DBEvent> decodeEventBuffer(const std::vector<unsigned char> &buffer, bool fromPayload);
-        std::shared_ptr<TableMapEvent> decodeTableMapEvent(mysql::binlog::event::Table_map_event &event);
-        std::shared_ptr<base::DBEvent> decodeRowsQueryEvent(const std::vector<unsigned char> &buffer, bool fromPayload);
-        std::shared_ptr<base::DBEvent> decodeRowsEvent(const std::vector<unsigned char> &buffer,
+        /**
+         * @brief 읽는 스레드에서 이벤트를 디코딩한다. XID 이벤트를 만나면 _eventArena를 새로 만든다.
+         */
+        std::shared_ptr<base::DBEvent> decodeEvent(EventView buffer);
+        /**
+         * @param arena 디코딩한 이벤트를 할당할 arena. 한 arena에는 한 스레드만 할당한다.
+         */
+        std::shared_ptr<base::DBEvent> decodeEventBuffer(EventView buffer, bool fromPayload,
+                                                         const std::shared_ptr<base::EventArena> &arena);
+        std::shared_ptr<TableMapEvent> decodeTableMapEvent(mysql::binlog::event::Table_map_event &event,
+                                                           const std::shared_ptr<base::EventArena> &arena);
+        std::shared_ptr<base::DBEvent> decodeRowsQueryEvent(EventView buffer, bool fromPayload,
+                                                            const std::shared_ptr<base::EventArena> &arena);
+        std::shared_ptr<base::DBEvent> decodeRowsEvent(EventView buffer,
                                                        mysql::binlog::event::Log_event_type eventType,
-                                                       bool fromPayload);
-        bool handleTransactionPayloadEvent(const std::vector<unsigned char> &buffer);
+                                                       bool fromPayload,
+                                                       const std::shared_ptr<base::EventArena> &arena);
+        /**
+         * @throws std::runtime_error 체크섬이 맞지 않거나, payload를 풀거나 디코딩할 수 없는 경우
+         */
+        void handleTransactionPayloadEvent(EventView buffer, DecodedEvents &events);
+
+        bool nextPipelined();
+        void fillPipeline();
+        std::future<DecodedPayload> submitPayload(EventView buffer);
+        void waitForPayloads();
+        void drainPipeline();
 
         void ensureDefaultFde();
 
@@ -56,14 +126,37 @@ namespace ultraverse::mariadb {
         std::string _filename;
 
         std::ifstream _stream;
+        std::vector<unsigned char> _eventBuffer;
+        /** 마지막으로 넘겨준 이벤트가 끝나는 위치 */
         int _pos;
+        /** 마지막으로 읽은 (미리 읽은 것 포함) 이벤트가 끝나는 위치 */
+        int _readPos;
+
+        bool _isMemoryMapped;
+        /** 파일 전체의 매핑. 매핑 위의 row data를 가리키는 RowEvent들도 함께 소유한다 */
+        std::shared_ptr<const unsigned char> _mapping;
+        size_t _mappingSize = 0;
+        size_t _mappingPos = 0;
 
         std::shared_ptr<base::DBEvent> _currentEvent;
+        /**
+         * 읽는 스레드에서 디코딩하는 이벤트의 arena. XID 이벤트 (트랜잭션의 끝)마다 새로 만든다.
+         * TRANSACTION_PAYLOAD_EVENT는 그 자체가 트랜잭션 하나이므로 payload마다 따로 arena를 만든다.
+         */
+        std::shared_ptr<base::EventArena> _eventArena;
 
         std::unique_ptr<mysql::binlog::event::Format_description_event> _fde;
         mysql::binlog::event::enum_binlog_checksum_alg _checksumAlg;
+        /** 이 파일의 FORMAT_DESCRIPTION_EVENT를 읽었는지. false면 _fde는 ensureDefaultFde()의 기본값이다 */
+        bool _hasFormatDescription = false;
+
+        /** TRANSACTION_PAYLOAD_EVENT에서 풀어서 디코딩한 이벤트들 */
+        std::deque<std::shared_ptr<base::DBEvent>> _payloadEventQueue;
 
-        std::deque<std::vector<unsigned char>> _payloadEventQueue;
+        TaskExecutor *_payloadDecoder;
+        /** payloadDecoder가 있을 때 미리 읽어 둔 이벤트들 (binlog 순서) */
+        std::deque<PendingEvent> _pipeline;
+        size_t _pendingPayloads = 0;
     };
 }
 
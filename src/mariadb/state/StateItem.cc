@@ -10,6 +10,7 @@
 #include <boost/tuple/tuple.hpp>
 
 #include "ultraverse_state.pb.h"
+#include "mariadb/state/new/StateSymbolTable.hpp"
 
 namespace {
 
@@ -1986,7 +1987,8 @@ void StateRange::fromProtobuf(const ultraverse::state::v2::proto::StateRange &ms
     }
 }
 
-void StateItem::toProtobuf(ultraverse::state::v2::proto::StateItem *out) const {
+void StateItem::toProtobuf(ultraverse::state::v2::proto::StateItem *out,
+                           ultraverse::state::v2::StateSymbolTable *symbols) const {
     if (out == nullptr) {
         return;
     }
@@ -1994,11 +1996,15 @@ void StateItem::toProtobuf(ultraverse::state::v2::proto::StateItem *out) const {
     out->Clear();
     out->set_condition_type(static_cast<uint32_t>(condition_type));
     out->set_function_type(static_cast<uint32_t>(function_type));
-    out->set_name(name);
+    if (symbols != nullptr && !name.empty()) {
+        out->set_name_id(symbols->intern(name));
+    } else {
+        out->set_name(name);
+    }
 
     for (const auto &arg : arg_list) {
         auto *argMsg = out->add_arg_list();
-        arg.toProtobuf(argMsg);
+        arg.toProtobuf(argMsg, symbols);
     }
 
     for (const auto &data : data_list) {
@@ -2008,23 +2014,28 @@ void StateItem::toProtobuf(ultraverse::state::v2::proto::StateItem *out) const {
 
     for (const auto &subQuery : sub_query_list) {
         auto *subMsg = out->add_sub_query_list();
-        subQuery.toProtobuf(subMsg);
+        subQuery.toProtobuf(subMsg, symbols);
     }
 
     _rangeCache.toProtobuf(out->mutable_range_cache());
     out->set_is_range_cache_built(_isRangeCacheBuilt);
 }
 
-void StateItem::fromProtobuf(const ultraverse::state::v2::proto::StateItem &msg) {
+void StateItem::fromProtobuf(const ultraverse::state::v2::proto::StateItem &msg,
+                             const ultraverse::state::v2::StateSymbolTable *symbols) {
     condition_type = static_cast<EN_CONDITION_TYPE>(msg.condition_type());
     function_type = static_cast<EN_FUNCTION_TYPE>(msg.function_type());
-    name = msg.name();
+    if (msg.name_id() != 0 && symbols != nullptr) {
+        name = symbols->symbol(msg.name_id());
+    } else {
+        name = msg.name();
+    }
 
     arg_list.clear();
     arg_list.reserve(static_cast<size_t>(msg.arg_list_size()));
     for (const auto &argMsg : msg.arg_list()) {
         StateItem arg;
-        arg.fromProtobuf(argMsg);
+        arg.fromProtobuf(argMsg, symbols);
         arg_list.emplace_back(std::move(arg));
     }
 
@@ -2040,7 +2051,7 @@ void StateItem::fromProtobuf(const ultraverse::state::v2::proto::StateItem &msg)
     sub_query_list.reserve(static_cast<size_t>(msg.sub_query_list_size()));
     for (const auto &subMsg : msg.sub_query_list()) {
         StateItem sub;
-        sub.fromProtobuf(subMsg);
+        sub.fromProtobuf(subMsg, symbols);
         sub_query_list.emplace_back(std::move(sub));
     }
 
@@ -11,6 +11,10 @@
 
 #include "mariadb/state/new/proto/ultraverse_state_fwd.hpp"
 
+namespace ultraverse::state::v2 {
+    class StateSymbolTable;
+}
+
 #include "state_log_hdr.h"
 
 enum EN_CONDITION_TYPE
@@ -403,8 +407,13 @@ public:
   template <typename Archive>
   void serialize(Archive &archive);
 
-  void toProtobuf(ultraverse::state::v2::proto::StateItem *out) const;
-  void fromProtobuf(const ultraverse::state::v2::proto::StateItem &msg);
+  /**
+   * @param symbols nullptr가 아니면 name (하위 항목 포함)을 symbols의 id로 기록한다.
+   */
+  void toProtobuf(ultraverse::state::v2::proto::StateItem *out,
+                  ultraverse::state::v2::StateSymbolTable *symbols = nullptr) const;
+  void fromProtobuf(const ultraverse::state::v2::proto::StateItem &msg,
+                    const ultraverse::state::v2::StateSymbolTable *symbols = nullptr);
 private:
   static bool is_data_ok(const StateItem &item);
 
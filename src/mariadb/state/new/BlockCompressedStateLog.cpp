@@ -0,0 +1,393 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <zstd.h>
+#include <zdict.h>
+
+#include <fmt/format.h>
+
+#include "BlockCompressedStateLog.hpp"
+
+namespace ultraverse::state::v2 {
+    namespace {
+        /** 사전 학습에 필요한 최소 레코드 수. 이보다 적으면 사전 없이 압축한다 */
+        constexpr size_t kMinDictionarySamples = 16;
+
+        std::string logFilePath(const std::string &logPath, const std::string &logName, const char *extension) {
+            return fmt::format("{}/{}.{}", logPath, logName, extension);
+        }
+
+        std::string readFile(const std::string &path) {
+            std::ifstream stream(path, std::ios::binary);
+            if (!stream) {
+                return "";
+            }
+
+            return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        }
+    }
+
+    bool isBlockCompressedStateLog(const std::string &logPath, const std::string &logName) {
+        std::ifstream stream(logFilePath(logPath, logName, "ultstatelog"), std::ios::binary);
+
+        char magic[sizeof(StateLogFileHeader::MAGIC)];
+        if (!stream.read(magic, sizeof(magic))) {
+            return false;
+        }
+
+        return std::memcmp(magic, StateLogFileHeader::MAGIC, sizeof(magic)) == 0;
+    }
+
+    uint64_t scanStateLogBlocks(std::streambuf &file, uint64_t offset, std::vector<StateLogBlockIndexEntry> &blocks) {
+        const auto fileSize = static_cast<uint64_t>(file.pubseekoff(0, std::ios::end, std::ios::in));
+
+        while (offset + sizeof(StateLogBlockHeader) <= fileSize) {
+            StateLogBlockIndexEntry entry {};
+            entry.fileOffset = offset;
+
+            file.pubseekpos(offset, std::ios::in);
+            if (file.sgetn((char *) &entry.header, sizeof(StateLogBlockHeader)) != sizeof(StateLogBlockHeader) ||
+                entry.header.magic != StateLogBlockHeader::MAGIC) {
+                break;
+            }
+
+            const uint64_t blockEnd = offset + sizeof(StateLogBlockHeader) + entry.header.compressedSize;
+            if (blockEnd > fileSize) {
+                // 아직 쓰는 중인 블록
+                break;
+            }
+
+            blocks.push_back(entry);
+            offset = blockEnd;
+        }
+
+        return offset;
+    }
+
+    StateLogBlockCompressor::StateLogBlockCompressor(const std::string &logPath, const std::string &logName,
+                                                     uint32_t transactionsPerBlock, int level):
+        _logPath(logPath),
+        _logName(logName),
+        _transactionsPerBlock(std::max<uint32_t>(transactionsPerBlock, 1)),
+        _level(level),
+        _cctx(ZSTD_createCCtx())
+    {
+    }
+
+    StateLogBlockCompressor::~StateLogBlockCompressor() {
+        ZSTD_freeCDict(_cdict);
+        ZSTD_freeCCtx(_cctx);
+    }
+
+    void StateLogBlockCompressor::open(std::ostream &stream, bool isAppend) {
+        const auto logFile = logFilePath(_logPath, _logName, "ultstatelog");
+        const auto indexFile = logFilePath(_logPath, _logName, "ultblockindex");
+
+        _block.clear();
+        _recordSizes.clear();
+
+        std::error_code ec;
+        const bool hasContent = isAppend && std::filesystem::file_size(logFile, ec) > 0 && !ec;
+
+        if (!hasContent) {
+            StateLogFileHeader fileHeader {};
+            std::memcpy(fileHeader.magic, StateLogFileHeader::MAGIC, sizeof(fileHeader.magic));
+            fileHeader.version = StateLogFileHeader::VERSION;
+
+            stream.write((char *) &fileHeader, sizeof(StateLogFileHeader));
+            stream.flush();
+
+            std::ofstream(indexFile, std::ios::binary | std::ios::trunc);
+            std::filesystem::remove(logFilePath(_logPath, _logName, "ultdict"), ec);
+
+            _fileOffset = sizeof(StateLogFileHeader);
+            _blockPos = 0;
+            _hasBlocks = false;
+            return;
+        }
+
+        if (!isBlockCompressedStateLog(_logPath, _logName)) {
+            throw std::runtime_error(fmt::format("cannot append compressed blocks to uncompressed state log {}", logFile));
+        }
+
+        std::vector<StateLogBlockIndexEntry> blocks;
+        {
+            std::filebuf file;
+            file.open(logFile, std::ios::in | std::ios::binary);
+            _fileOffset = scanStateLogBlocks(file, sizeof(StateLogFileHeader), blocks);
+        }
+
+        // 쓰다 만 블록은 잘라내고, 인덱스는 온전한 블록들로 다시 쓴다
+        std::filesystem::resize_file(logFile, _fileOffset);
+
+        std::ofstream indexStream(indexFile, std::ios::binary | std::ios::trunc);
+        indexStream.write((char *) blocks.data(), blocks.size() * sizeof(StateLogBlockIndexEntry));
+
+        _hasBlocks = !blocks.empty();
+        _blockPos = _hasBlocks ? blocks.back().header.logicalPos + blocks.back().header.uncompressedSize : 0;
+
+        loadDictionary();
+    }
+
+    uint64_t StateLogBlockCompressor::logicalPos() const {
+        return _blockPos + _block.size();
+    }
+
+    void StateLogBlockCompressor::append(gid_t gid, const std::string &record, std::ostream &stream) {
+        if (_recordSizes.empty()) {
+            _firstGid = gid;
+        }
+        _lastGid = gid;
+
+        _block += record;
+        _recordSizes.push_back(record.size());
+
+        if (_recordSizes.size() >= _transactionsPerBlock || _block.size() >= kMaxBlockBytes) {
+            flush(stream);
+        }
+    }
+
+    void StateLogBlockCompressor::flush(std::ostream &stream) {
+        if (_recordSizes.empty()) {
+            return;
+        }
+
+        if (!_hasBlocks && _cdict == nullptr) {
+            trainDictionary();
+        }
+
+        _compressed.resize(ZSTD_compressBound(_block.size()));
+        const size_t compressedSize = _cdict != nullptr ?
+            ZSTD_compress_usingCDict(_cctx, _compressed.data(), _compressed.size(), _block.data(), _block.size(), _cdict) :
+            ZSTD_compressCCtx(_cctx, _compressed.data(), _compressed.size(), _block.data(), _block.size(), _level);
+
+        if (ZSTD_isError(compressedSize)) {
+            throw std::runtime_error(fmt::format("failed to compress state log block: {}", ZSTD_getErrorName(compressedSize)));
+        }
+
+        StateLogBlockIndexEntry entry {};
+        entry.fileOffset = _fileOffset;
+        entry.header.magic = StateLogBlockHeader::MAGIC;
+        entry.header.flags = _cdict != nullptr ? StateLogBlockHeader::FLAG_DICTIONARY : 0;
+        entry.header.compressedSize = compressedSize;
+        entry.header.uncompressedSize = _block.size();
+        entry.header.transactionCount = _recordSizes.size();
+        entry.header.firstGid = _firstGid;
+        entry.header.lastGid = _lastGid;
+        entry.header.logicalPos = _blockPos;
+
+        stream.write((char *) &entry.header, sizeof(StateLogBlockHeader));
+        stream.write(_compressed.data(), compressedSize);
+        stream.flush();
+
+        // 인덱스는 블록이 파일에 쓰인 뒤에 추가한다. 인덱스에 없는 블록은 reader가 파일을 훑어서 찾는다
+        std::ofstream indexStream(logFilePath(_logPath, _logName, "ultblockindex"), std::ios::binary | std::ios::app);
+        indexStream.write((char *) &entry, sizeof(StateLogBlockIndexEntry));
+
+        _fileOffset += sizeof(StateLogBlockHeader) + compressedSize;
+        _blockPos += _block.size();
+        _hasBlocks = true;
+
+        _block.clear();
+        _recordSizes.clear();
+    }
+
+    void StateLogBlockCompressor::trainDictionary() {
+        if (_recordSizes.size() < kMinDictionarySamples) {
+            return;
+        }
+
+        std::string dictionary(kDictionaryCapacity, '\0');
+        const size_t dictionarySize = ZDICT_trainFromBuffer(
+            dictionary.data(), dictionary.size(),
+            _block.data(), _recordSizes.data(), static_cast<unsigned>(_recordSizes.size())
+        );
+
+        if (ZDICT_isError(dictionarySize)) {
+            // 레코드가 너무 비슷하거나 적으면 학습에 실패한다. 이 경우 사전 없이 압축한다
+            return;
+        }
+        dictionary.resize(dictionarySize);
+
+        std::ofstream stream(logFilePath(_logPath, _logName, "ultdict"), std::ios::binary | std::ios::trunc);
+        stream.write(dictionary.data(), dictionary.size());
+        stream.close();
+
+        _cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), _level);
+    }
+
+    void StateLogBlockCompressor::loadDictionary() {
+        auto dictionary = readFile(logFilePath(_logPath, _logName, "ultdict"));
+        if (dictionary.empty()) {
+            return;
+        }
+
+        _cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), _level);
+    }
+
+    StateLogBlockStreamBuf::StateLogBlockStreamBuf(std::streambuf &file, const std::string &logPath, const std::string &logName):
+        _file(file),
+        _dctx(ZSTD_createDCtx())
+    {
+        auto index = readFile(logFilePath(logPath, logName, "ultblockindex"));
+        _blocks.resize(index.size() / sizeof(StateLogBlockIndexEntry));
+        std::memcpy(_blocks.data(), index.data(), _blocks.size() * sizeof(StateLogBlockIndexEntry));
+
+        _scanOffset = _blocks.empty() ?
+            sizeof(StateLogFileHeader) :
+            _blocks.back().fileOffset + sizeof(StateLogBlockHeader) + _blocks.back().header.compressedSize;
+        scanNewBlocks();
+
+        auto dictionary = readFile(logFilePath(logPath, logName, "ultdict"));
+        if (!dictionary.empty()) {
+            _ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+        }
+
+        setg(nullptr, nullptr, nullptr);
+    }
+
+    StateLogBlockStreamBuf::~StateLogBlockStreamBuf() {
+        ZSTD_freeDDict(_ddict);
+        ZSTD_freeDCtx(_dctx);
+    }
+
+    std::optional<uint64_t> StateLogBlockStreamBuf::blockPosOf(gid_t gid) {
+        auto find = [this, gid]() -> std::optional<uint64_t> {
+            auto it = std::partition_point(_blocks.begin(), _blocks.end(), [gid](const StateLogBlockIndexEntry &entry) {
+                return entry.header.firstGid <= gid;
+            });
+
+            if (it == _blocks.begin() || std::prev(it)->header.lastGid < gid) {
+                return std::nullopt;
+            }
+
+            return static_cast<uint64_t>(std::prev(it)->header.logicalPos);
+        };
+
+        auto pos = find();
+        if (!pos.has_value()) {
+            scanNewBlocks();
+            pos = find();
+        }
+
+        return pos;
+    }
+
+    StateLogBlockStreamBuf::int_type StateLogBlockStreamBuf::underflow() {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        const size_t next = _currentBlock == SIZE_MAX ? 0 : _currentBlock + 1;
+        if (next >= _blocks.size()) {
+            scanNewBlocks();
+        }
+
+        if (next >= _blocks.size() || !loadBlock(next)) {
+            return traits_type::eof();
+        }
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+    StateLogBlockStreamBuf::pos_type StateLogBlockStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                                     std::ios_base::openmode which) {
+        if (!(which & std::ios::in)) {
+            return pos_type(off_type(-1));
+        }
+
+        const uint64_t current = _currentBlock == SIZE_MAX ?
+            0 : _blocks[_currentBlock].header.logicalPos + (gptr() - eback());
+
+        if (dir == std::ios::cur) {
+            if (off == 0) {
+                return pos_type(current);
+            }
+            return seekpos(pos_type(current + off), which);
+        } else if (dir == std::ios::end) {
+            scanNewBlocks();
+            return seekpos(pos_type(logicalEnd() + off), which);
+        }
+
+        return seekpos(pos_type(off), which);
+    }
+
+    StateLogBlockStreamBuf::pos_type StateLogBlockStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which) {
+        if (!(which & std::ios::in) || off_type(pos) < 0) {
+            return pos_type(off_type(-1));
+        }
+
+        const auto target = static_cast<uint64_t>(off_type(pos));
+
+        if (target > logicalEnd()) {
+            scanNewBlocks();
+            if (target > logicalEnd()) {
+                return pos_type(off_type(-1));
+            }
+        }
+
+        if (_blocks.empty()) {
+            _currentBlock = SIZE_MAX;
+            setg(nullptr, nullptr, nullptr);
+            return pos;
+        }
+
+        auto it = std::partition_point(_blocks.begin(), _blocks.end(), [target](const StateLogBlockIndexEntry &entry) {
+            return entry.header.logicalPos <= target;
+        });
+        const size_t index = std::distance(_blocks.begin(), it) - 1;
+
+        if (index != _currentBlock && !loadBlock(index)) {
+            return pos_type(off_type(-1));
+        }
+
+        const auto offset = target - _blocks[index].header.logicalPos;
+        setg(eback(), eback() + offset, egptr());
+
+        return pos;
+    }
+
+    bool StateLogBlockStreamBuf::loadBlock(size_t index) {
+        const auto &entry = _blocks[index];
+
+        _compressed.resize(entry.header.compressedSize);
+        _file.pubseekpos(entry.fileOffset + sizeof(StateLogBlockHeader), std::ios::in);
+        if (_file.sgetn(_compressed.data(), _compressed.size()) != static_cast<std::streamsize>(_compressed.size())) {
+            return false;
+        }
+
+        const bool useDictionary = entry.header.flags & StateLogBlockHeader::FLAG_DICTIONARY;
+        if (useDictionary && _ddict == nullptr) {
+            throw std::runtime_error("state log block requires a dictionary, but .ultdict is missing");
+        }
+
+        _buffer.resize(entry.header.uncompressedSize);
+        const size_t size = useDictionary ?
+            ZSTD_decompress_usingDDict(_dctx, _buffer.data(), _buffer.size(), _compressed.data(), _compressed.size(), _ddict) :
+            ZSTD_decompressDCtx(_dctx, _buffer.data(), _buffer.size(), _compressed.data(), _compressed.size());
+
+        if (ZSTD_isError(size) || size != _buffer.size()) {
+            return false;
+        }
+
+        _currentBlock = index;
+        setg(_buffer.data(), _buffer.data(), _buffer.data() + _buffer.size());
+
+        return true;
+    }
+
+    void StateLogBlockStreamBuf::scanNewBlocks() {
+        _scanOffset = scanStateLogBlocks(_file, _scanOffset, _blocks);
+    }
+
+    uint64_t StateLogBlockStreamBuf::logicalEnd() const {
+        if (_blocks.empty()) {
+            return 0;
+        }
+
+        return _blocks.back().header.logicalPos + _blocks.back().header.uncompressedSize;
+    }
+}
@@ -0,0 +1,162 @@
+#ifndef ULTRAVERSE_STATE_BLOCKCOMPRESSEDSTATELOG_HPP
+#define ULTRAVERSE_STATE_BLOCKCOMPRESSEDSTATELOG_HPP
+
+#include <cstdint>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "Transaction.hpp"
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace ultraverse::state::v2 {
+    /**
+     * @brief 블록 압축된 .ultstatelog의 파일 헤더
+     * @details 압축된 로그는 이 헤더로 시작하고, 그 뒤로 [StateLogBlockHeader][zstd frame]이 반복된다.
+     *          (기존 비압축 로그는 TransactionHeader로 바로 시작한다)
+     *
+     *          블록 안의 내용은 비압축 로그와 같은 [TransactionHeader][protobuf] 레코드의 연속이다.
+     *          pos(), nextPos, .ultindex의 오프셋은 모두 "압축하지 않았다면 가졌을" 논리 위치를 쓰므로,
+     *          reader를 쓰는 쪽은 압축 여부를 알 필요가 없다.
+     */
+    struct StateLogFileHeader {
+        static constexpr char MAGIC[8] = {'U', 'L', 'T', 'S', 'L', 'O', 'G', 'Z'};
+        static constexpr uint32_t VERSION = 2;
+
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+    } __attribute__ ((packed));
+
+    struct StateLogBlockHeader {
+        static constexpr uint32_t MAGIC = 0x4b4c4255; // "UBLK"
+        static constexpr uint32_t FLAG_DICTIONARY = 0b00000001;
+
+        uint32_t magic;
+        uint32_t flags;
+
+        uint32_t compressedSize;
+        uint32_t uncompressedSize;
+        uint32_t transactionCount;
+
+        gid_t firstGid;
+        gid_t lastGid;
+
+        /** 블록 첫 레코드의 논리 위치 */
+        uint64_t logicalPos;
+    } __attribute__ ((packed));
+
+    /**
+     * @brief .ultblockindex의 엔트리. 블록 헤더와 블록 헤더의 파일 오프셋
+     */
+    struct StateLogBlockIndexEntry {
+        uint64_t fileOffset;
+        StateLogBlockHeader header;
+    } __attribute__ ((packed));
+
+    /**
+     * @brief 주어진 로그가 블록 압축 포맷인지 확인한다.
+     */
+    bool isBlockCompressedStateLog(const std::string &logPath, const std::string &logName);
+
+    /**
+     * @brief 파일의 offset부터 온전한 블록 헤더들을 읽어 blocks에 추가한다.
+     * @return 마지막으로 온전한 블록의 끝 오프셋
+     */
+    uint64_t scanStateLogBlocks(std::streambuf &file, uint64_t offset, std::vector<StateLogBlockIndexEntry> &blocks);
+
+    /**
+     * @brief StateLogWriter에서 레코드를 모아 블록 단위로 압축해서 쓴다.
+     * @details 새 로그의 첫 블록을 쓸 때 그 블록의 레코드들로 zstd 사전을 학습해서 .ultdict에 저장하고,
+     *          이후 블록은 (이어 쓰는 경우도 포함해서) 그 사전으로 압축한다.
+     */
+    class StateLogBlockCompressor {
+    public:
+        /** 트랜잭션 수와 상관없이 블록을 닫는 크기 */
+        static constexpr size_t kMaxBlockBytes = 16 * 1024 * 1024;
+        static constexpr size_t kDictionaryCapacity = 64 * 1024;
+
+        StateLogBlockCompressor(const std::string &logPath, const std::string &logName,
+                                uint32_t transactionsPerBlock, int level);
+        StateLogBlockCompressor(StateLogBlockCompressor &) = delete;
+        ~StateLogBlockCompressor();
+
+        /**
+         * @brief 비어 있는 로그면 파일 헤더를 쓰고, 기존 로그면 마지막 온전한 블록 뒤로 이어 쓸 준비를 한다.
+         * @note 기존 로그가 비압축 포맷이면 std::runtime_error를 던진다.
+         */
+        void open(std::ostream &stream, bool isAppend);
+
+        /** 다음에 쓸 레코드의 논리 위치 */
+        uint64_t logicalPos() const;
+
+        void append(gid_t gid, const std::string &record, std::ostream &stream);
+        void flush(std::ostream &stream);
+    private:
+        void trainDictionary();
+        void loadDictionary();
+
+        std::string _logPath;
+        std::string _logName;
+        uint32_t _transactionsPerBlock;
+        int _level;
+
+        /** 다음 블록을 쓸 파일 오프셋 */
+        uint64_t _fileOffset = 0;
+        /** 버퍼에 모으고 있는 블록의 논리 위치 */
+        uint64_t _blockPos = 0;
+        std::string _block;
+        std::vector<size_t> _recordSizes;
+        gid_t _firstGid = 0;
+        gid_t _lastGid = 0;
+
+        bool _hasBlocks = false;
+        std::string _compressed;
+
+        ZSTD_CCtx_s *_cctx = nullptr;
+        ZSTD_CDict_s *_cdict = nullptr;
+    };
+
+    /**
+     * @brief 블록 압축된 로그를 비압축 로그의 논리 위치 공간으로 보여주는 streambuf
+     * @details 블록을 하나씩 풀어서 get area로 내어주며, seek은 블록 인덱스로 블록을 찾아 그 안에서 위치를 맞춘다.
+     *          인덱스 뒤에 추가된 블록 (쓰는 중인 로그)은 끝에 닿을 때마다 파일을 다시 훑어서 찾는다.
+     */
+    class StateLogBlockStreamBuf: public std::streambuf {
+    public:
+        StateLogBlockStreamBuf(std::streambuf &file, const std::string &logPath, const std::string &logName);
+        StateLogBlockStreamBuf(StateLogBlockStreamBuf &) = delete;
+        ~StateLogBlockStreamBuf() override;
+
+        /**
+         * @brief gid를 담고 있는 블록의 논리 위치를 반환한다.
+         */
+        std::optional<uint64_t> blockPosOf(gid_t gid);
+    protected:
+        int_type underflow() override;
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+    private:
+        bool loadBlock(size_t index);
+        void scanNewBlocks();
+        uint64_t logicalEnd() const;
+
+        std::streambuf &_file;
+        std::vector<StateLogBlockIndexEntry> _blocks;
+        uint64_t _scanOffset = 0;
+
+        size_t _currentBlock = SIZE_MAX;
+        std::vector<char> _buffer;
+        std::vector<char> _compressed;
+
+        ZSTD_DCtx_s *_dctx = nullptr;
+        ZSTD_DDict_s *_ddict = nullptr;
+    };
+}
+
+#endif //ULTRAVERSE_STATE_BLOCKCOMPRESSEDSTATELOG_HPP
@@ -6,11 +6,15 @@
 #include <unistd.h>
 #include <sys/mman.h>
 
+#include <filesystem>
+#include <fstream>
+
 #include <fmt/format.h>
 
 #include "darwincompat.hpp"
 
 #include "GIDIndexReader.hpp"
+#include "StateIO.hpp"
 
 namespace ultraverse::state::v2 {
     GIDIndexReader::GIDIndexReader(const std::string &logPath, const std::string &logName) {
@@ -22,6 +26,13 @@ namespace ultraverse::state::v2 {
         }
 
         _fsize = lseek64(_fd, 0, SEEK_END);
+        // statelogd가 쓰고 있는 인덱스는 마지막 항목이 덜 쓰였을 수 있다
+        _entries = _fsize / sizeof(uint64_t);
+        _addr = nullptr;
+
+        if (_fsize == 0) {
+            return;
+        }
 
         _addr = mmap(nullptr, _fsize, PROT_READ, MAP_PRIVATE, _fd, 0);
         if (_addr == MAP_FAILED) {
@@ -30,11 +41,80 @@ namespace ultraverse::state::v2 {
     }
     
     GIDIndexReader::~GIDIndexReader() {
-        munmap(_addr, _fsize);
+        if (_addr != nullptr) {
+            munmap(_addr, _fsize);
+        }
         close(_fd);
     }
     
     uint64_t GIDIndexReader::offsetOf(gid_t gid) {
         return reinterpret_cast<uint64_t *>(_addr)[gid];
     }
-}
\ No newline at end of file
+
+    size_t GIDIndexReader::size() const {
+        return _entries;
+    }
+
+    bool GIDIndexReader::seek(IStateLogReader &reader, gid_t gid) {
+        if (gid < _entries) {
+            reader.seek(offsetOf(gid));
+            return true;
+        }
+
+        // 아직 색인되지 않은 트랜잭션은 색인된 마지막 트랜잭션부터 헤더를 따라가며 찾는다
+        reader.seek(_entries > 0 ? offsetOf(_entries - 1) : 0);
+        while (reader.nextHeader()) {
+            if (reader.txnHeader()->gid == gid) {
+                reader.seek(reader.pos() - sizeof(TransactionHeader));
+                return true;
+            }
+            reader.skipTransaction();
+        }
+
+        return false;
+    }
+
+    GIDIndexReader::Coverage GIDIndexReader::coverageOf(const std::string &logPath, const std::string &logName,
+                                                        IStateLogReader &reader) {
+        auto path = fmt::format("{}/{}.ultindex", logPath, logName);
+
+        std::error_code ec;
+        const auto indexSize = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return Coverage::MISSING;
+        }
+
+        const size_t entries = indexSize / sizeof(uint64_t);
+        uint64_t lastOffset = 0;
+        if (entries > 0) {
+            std::ifstream stream(path, std::ios::binary);
+            stream.seekg(static_cast<std::streamoff>((entries - 1) * sizeof(uint64_t)));
+            if (!stream.read(reinterpret_cast<char *>(&lastOffset), sizeof(lastOffset))) {
+                return Coverage::MISSING;
+            }
+        }
+
+        reader.open();
+        reader.seek(lastOffset);
+
+        auto coverage = Coverage::COMPLETE;
+        if (entries > 0) {
+            if (!reader.nextHeader() || reader.txnHeader()->gid != entries - 1) {
+                coverage = Coverage::MISMATCHED;
+            } else {
+                reader.skipTransaction();
+            }
+        }
+
+        if (coverage == Coverage::COMPLETE && reader.nextHeader()) {
+            coverage = Coverage::PARTIAL;
+        }
+
+        reader.close();
+        return coverage;
+    }
+
+    bool GIDIndexReader::isUpToDate(const std::string &logPath, const std::string &logName, IStateLogReader &reader) {
+        return coverageOf(logPath, logName, reader) == Coverage::COMPLETE;
+    }
+}
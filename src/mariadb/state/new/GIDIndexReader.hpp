@@ -10,11 +10,29 @@
 #include "Transaction.hpp"
 
 namespace ultraverse::state::v2 {
+    class IStateLogReader;
+
     /**
      * @brief state log에서 특정 GID로 빠르게 seek할 수 있도록, GID를 인덱싱한 파일을 읽어주는 클래스
      */
     class GIDIndexReader {
     public:
+        /**
+         * @brief .ultindex가 로그를 어디까지 색인했는지
+         */
+        enum class Coverage {
+            /** 인덱스 파일이 없다 */
+            MISSING,
+            /** 인덱스의 마지막 항목이 그 gid의 트랜잭션을 가리키지 않는다 */
+            MISMATCHED,
+            /** 로그 앞부분만 색인했다. statelogd가 아직 쓰지 않은 오프셋이 버퍼에 남아 있을 수 있다 */
+            PARTIAL,
+            COMPLETE
+        };
+
+        /**
+         * @note 매핑은 생성할 때의 파일 크기로 고정되며, 쓰이는 중인 마지막 항목은 읽지 않는다.
+         */
         GIDIndexReader(const std::string &logPath, const std::string &logName);
         GIDIndexReader(GIDIndexReader &) = delete;
         
@@ -24,9 +42,38 @@ namespace ultraverse::state::v2 {
          * 주어진 GID를 가진 트랜잭션의 로그 오프셋을 반환한다.
          */
         uint64_t offsetOf(gid_t gid);
+
+        /**
+         * @brief 색인된 항목의 수. gid가 이보다 작은 트랜잭션만 offsetOf()로 찾을 수 있다.
+         */
+        size_t size() const;
+
+        /**
+         * @brief reader를 gid인 트랜잭션의 헤더 위치로 옮긴다.
+         * @details 색인되지 않은 gid는 색인된 마지막 트랜잭션부터 헤더를 따라가며 찾는다.
+         * @return 로그에서 gid를 찾지 못하면 false
+         */
+        bool seek(IStateLogReader &reader, gid_t gid);
+
+        /**
+         * @brief .ultindex가 로그를 어디까지 색인했는지 확인한다.
+         * @details 인덱스의 마지막 항목이 가리키는 위치에 그 gid를 가진 트랜잭션이 있어야 하며,
+         *          그 뒤에 트랜잭션이 더 있으면 PARTIAL이다.
+         *          statelogd는 오프셋을 버퍼에 모았다가 쓰므로, 실행 중이면 인덱스가 로그보다 뒤처져 있을 수 있다.
+         * @param reader 같은 로그를 읽는 reader. open()하고 확인한 뒤 close()한다.
+         */
+        static Coverage coverageOf(const std::string &logPath, const std::string &logName, IStateLogReader &reader);
+
+        /**
+         * @brief .ultindex가 로그 끝까지 색인했는지 확인한다.
+         * @see coverageOf()
+         */
+        static bool isUpToDate(const std::string &logPath, const std::string &logName, IStateLogReader &reader);
     private:
         int _fd;
         size_t _fsize;
+        /** 온전히 쓰인 항목의 수 */
+        size_t _entries;
         
         void *_addr;
     };
@@ -5,6 +5,10 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
 #include <fmt/format.h>
 
 #include "darwincompat.hpp"
@@ -12,36 +16,99 @@
 #include "GIDIndexWriter.hpp"
 
 namespace ultraverse::state::v2 {
-    GIDIndexWriter::GIDIndexWriter(const std::string &logPath, const std::string &logName) {
+    GIDIndexWriter::GIDIndexWriter(const std::string &logPath, const std::string &logName, bool truncate):
+        _bufferStartGid(0),
+        _unsyncedEntries(0)
+    {
         auto path = fmt::format("{}/{}.ultindex", logPath, logName);
-        _fd = open(path.c_str(), O_CREAT | O_WRONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
-        _fsize = 0;
-        
+        int flags = O_CREAT | O_WRONLY | (truncate ? O_TRUNC : 0);
+        _fd = open(path.c_str(), flags, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+
         if (_fd < 0) {
             throw std::runtime_error(fmt::format("failed to open {}", path));
         }
+
+        _buffer.reserve(BUFFER_ENTRIES);
     }
-    
+
     GIDIndexWriter::~GIDIndexWriter() {
-        syncfs(_fd);
+        try {
+            sync();
+        } catch (std::exception &) {
+            // 소멸자에서는 예외를 던지지 않는다
+        }
         close(_fd);
     }
-    
+
     void GIDIndexWriter::write(gid_t gid, uint64_t offset) {
-        if (needsResize(gid)) {
-            ftruncate64(_fd, gid * sizeof(uint64_t));
-            _fsize = gid * sizeof(uint64_t);
+        if (!_buffer.empty() && gid != _bufferStartGid + _buffer.size()) {
+            flush();
+        }
+
+        if (_buffer.empty()) {
+            _bufferStartGid = gid;
+        }
+
+        _buffer.push_back(offset);
+
+        if (_buffer.size() >= BUFFER_ENTRIES) {
+            flush();
         }
-        
-        lseek64(_fd, gid * sizeof(uint64_t), SEEK_SET);
-        ::write(_fd, &offset, sizeof(uint64_t));
     }
-    
+
     void GIDIndexWriter::append(uint64_t offset) {
-        ::write(_fd, &offset, sizeof(uint64_t));
+        write(_bufferStartGid + _buffer.size(), offset);
     }
-    
-    bool GIDIndexWriter::needsResize(gid_t gid) {
-        return _fsize < (gid * sizeof(uint64_t));
+
+    void GIDIndexWriter::flush() {
+        if (_buffer.empty()) {
+            return;
+        }
+
+        // 쓰는 위치가 파일 끝보다 뒤면 그 사이는 0으로 채워진다
+        auto data = reinterpret_cast<const char *>(_buffer.data());
+        size_t remaining = _buffer.size() * sizeof(uint64_t);
+        int64_t position = static_cast<int64_t>(_bufferStartGid) * sizeof(uint64_t);
+
+        while (remaining > 0) {
+            auto written = pwrite64(_fd, data, remaining, position);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(fmt::format("pwrite() failed: {} (errno {})", strerror(errno), errno));
+            }
+
+            data += written;
+            remaining -= written;
+            position += written;
+        }
+
+        _unsyncedEntries += _buffer.size();
+        _bufferStartGid += _buffer.size();
+        _buffer.clear();
+
+        if (_unsyncedEntries >= SYNC_INTERVAL) {
+            syncFile();
+        }
+    }
+
+    void GIDIndexWriter::sync() {
+        flush();
+
+        if (_unsyncedEntries > 0) {
+            syncFile();
+        }
+    }
+
+    void GIDIndexWriter::syncFile() {
+        while (fdatasync(_fd) != 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(fmt::format("fdatasync() failed: {} (errno {})", strerror(errno), errno));
+        }
+
+        _unsyncedEntries = 0;
     }
-}
\ No newline at end of file
+}
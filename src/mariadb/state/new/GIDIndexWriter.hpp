@@ -6,20 +6,31 @@
 #define ULTRAVERSE_GIDINDEXWRITER_HPP
 
 #include <string>
+#include <vector>
 
 #include "Transaction.hpp"
 
 namespace ultraverse::state::v2 {
     /**
      * @brief state log에서 특정 GID로 빠르게 seek할 수 있도록, 각 트랜잭션의 로그 오프셋을 인덱싱한 파일을 생성해주는 클래스
+     * @details 연속된 gid의 오프셋은 메모리에 모았다가 한 번의 pwrite()로 쓰고,
+     *          SYNC_INTERVAL개를 쓸 때마다 fdatasync()를 호출한다.
+     *          버퍼에 남은 오프셋은 flush()를 호출하거나 객체가 소멸될 때 쓰인다.
      */
     class GIDIndexWriter {
     public:
-        GIDIndexWriter(const std::string &logPath, const std::string &logName);
+        static constexpr size_t BUFFER_ENTRIES = 4096;
+        static constexpr size_t SYNC_INTERVAL = 65536;
+
+        /**
+         * @param truncate true면 기존 인덱스를 비우고 새로 쓴다.
+         *                 다른 프로세스 (statelogd)가 쓰고 있을 수 있는 인덱스에는 쓰지 않는다.
+         */
+        GIDIndexWriter(const std::string &logPath, const std::string &logName, bool truncate = false);
         GIDIndexWriter(GIDIndexWriter &) = delete;
-        
+
         ~GIDIndexWriter();
-        
+
         /**
          * 특정 gid를 가진 트랜잭션의 로그 오프셋을 기록한다.
          */
@@ -28,11 +39,24 @@ namespace ultraverse::state::v2 {
          * 마지막 오프셋 뒤에 다음 트랜잭션의 로그 오프셋을 기록한다.
          */
         void append(uint64_t offset);
+
+        /**
+         * 버퍼에 모인 오프셋을 파일에 쓴다.
+         */
+        void flush();
+        /**
+         * flush()한 뒤 fdatasync()를 호출한다.
+         */
+        void sync();
     private:
-        bool needsResize(gid_t gid);
-        
+        void syncFile();
+
         int _fd;
-        size_t _fsize;
+
+        std::vector<uint64_t> _buffer;
+        gid_t _bufferStartGid;
+
+        size_t _unsyncedEntries;
     };
 }
 
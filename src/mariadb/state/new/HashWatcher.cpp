@@ -54,7 +54,7 @@ namespace ultraverse::state::v2 {
             
             switch (event->eventType()) {
                 case event_type::QUERY: {
-                    auto queryEvent = std::dynamic_pointer_cast<mariadb::QueryEvent>(event);
+                    auto queryEvent = base::eventCast<mariadb::QueryEvent>(event);
                     if (queryEvent->statement() == fmt::format("/* ULTRAVERSE_HASHWATCHER_START_{} */ CREATE TABLE __ULTRAVERSE_HASHWATCHER_START__( dummy INTEGER )", _database)) {
                         _isWatcherEnabled = true;
                     }
@@ -63,11 +63,11 @@ namespace ultraverse::state::v2 {
                 case event_type::TXNID:
                     break;
                 case event_type::TABLE_MAP:
-                    processTableMapEvent(std::dynamic_pointer_cast<mariadb::TableMapEvent>(event));
+                    processTableMapEvent(base::eventCast<mariadb::TableMapEvent>(event));
                     break;
                 case event_type::ROW_EVENT: {
                     if (_isWatcherEnabled) {
-                        processRowEvent(std::dynamic_pointer_cast<mariadb::RowEvent>(event));
+                        processRowEvent(base::eventCast<mariadb::RowEvent>(event));
                     }
                 }
                     break;
@@ -0,0 +1,206 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include "BlockCompressedStateLog.hpp"
+#include "GIDIndexReader.hpp"
+#include "MmapStateLogReader.hpp"
+
+#include "ultraverse_state.pb.h"
+
+namespace ultraverse::state::v2 {
+    namespace {
+        /** @brief arena의 초기 블록 크기. 대부분의 트랜잭션은 이 안에서 파싱된다. */
+        constexpr size_t kArenaBlockSize = 256 * 1024;
+    }
+
+    class MmapStateLogReader::Mapping {
+    public:
+        explicit Mapping(const std::string &path) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return;
+            }
+
+            struct stat st {};
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                void *addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED) {
+                    _addr = static_cast<const char *>(addr);
+                    _size = static_cast<size_t>(st.st_size);
+                }
+            }
+
+            // 매핑은 fd를 닫아도 유지된다
+            ::close(fd);
+        }
+
+        Mapping(const Mapping &) = delete;
+
+        ~Mapping() {
+            if (_addr != nullptr) {
+                ::munmap(const_cast<char *>(_addr), _size);
+            }
+        }
+
+        const char *data() const {
+            return _addr;
+        }
+
+        size_t size() const {
+            return _size;
+        }
+
+    private:
+        const char *_addr = nullptr;
+        size_t _size = 0;
+    };
+
+    MmapStateLogReader::MmapStateLogReader(const std::string &logPath, const std::string &logName):
+        _logPath(logPath),
+        _logName(logName),
+        _arenaBlock(kArenaBlockSize)
+    {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = _arenaBlock.data();
+        options.initial_block_size = _arenaBlock.size();
+        _arena = std::make_unique<google::protobuf::Arena>(options);
+    }
+
+    MmapStateLogReader::~MmapStateLogReader() {
+
+    }
+
+    void MmapStateLogReader::open() {
+        _mapping = std::make_shared<Mapping>(_logPath + "/" + _logName + ".ultstatelog");
+        _pos = 0;
+
+        if (_mapping->size() >= sizeof(StateLogFileHeader::MAGIC) &&
+            std::memcmp(_mapping->data(), StateLogFileHeader::MAGIC, sizeof(StateLogFileHeader::MAGIC)) == 0) {
+            _mapping = nullptr;
+            throw std::runtime_error("block-compressed state log cannot be memory-mapped; use StateLogReader instead");
+        }
+        _currentHeader = nullptr;
+        _currentBody = nullptr;
+
+        applyAdvice();
+    }
+
+    void MmapStateLogReader::close() {
+        _mapping = nullptr;
+        _pos = 0;
+    }
+
+    void MmapStateLogReader::reset() {
+        // 다시 매핑해서 그 사이에 늘어난 로그도 읽을 수 있게 한다
+        open();
+    }
+
+    uint64_t MmapStateLogReader::pos() {
+        return _pos;
+    }
+
+    void MmapStateLogReader::seek(uint64_t pos) {
+        _pos = pos;
+
+        _currentHeader = nullptr;
+        _currentBody = nullptr;
+    }
+
+    bool MmapStateLogReader::nextHeader() {
+        if (_mapping == nullptr || _pos + sizeof(TransactionHeader) > _mapping->size()) {
+            _currentHeader = nullptr;
+            return false;
+        }
+
+        // TransactionHeader는 packed 구조체이므로 정렬되지 않은 위치를 그대로 가리켜도 된다.
+        // aliasing constructor: 헤더마다 할당하지 않고 매핑의 수명을 공유한다.
+        auto *header = reinterpret_cast<TransactionHeader *>(const_cast<char *>(_mapping->data() + _pos));
+        _currentHeader = std::shared_ptr<TransactionHeader>(_mapping, header);
+        _pos += sizeof(TransactionHeader);
+
+        return true;
+    }
+
+    bool MmapStateLogReader::nextTransaction() {
+        if (_currentHeader == nullptr) {
+            _currentBody = nullptr;
+            return false;
+        }
+
+        const uint64_t endPos = _currentHeader->nextPos;
+        if (endPos <= _pos || endPos > _mapping->size()) {
+            _currentBody = nullptr;
+            return false;
+        }
+
+        _arena->Reset();
+        auto *protoTxn = google::protobuf::Arena::Create<ultraverse::state::v2::proto::Transaction>(_arena.get());
+        if (!protoTxn->ParseFromArray(_mapping->data() + _pos, static_cast<int>(endPos - _pos))) {
+            _currentBody = nullptr;
+            return false;
+        }
+
+        auto transaction = std::make_shared<Transaction>();
+        transaction->fromProtobuf(*protoTxn);
+        _currentBody = transaction;
+        _pos = endPos;
+
+        return true;
+    }
+
+    bool MmapStateLogReader::nextTransactionBytes(std::string &bytes) {
+        if (_currentHeader == nullptr) {
+            return false;
+        }
+
+        const uint64_t endPos = _currentHeader->nextPos;
+        if (endPos <= _pos || endPos > _mapping->size()) {
+            return false;
+        }
+
+        bytes.assign(_mapping->data() + _pos, endPos - _pos);
+        _pos = endPos;
+        return true;
+    }
+
+    void MmapStateLogReader::skipTransaction() {
+        if (_currentHeader != nullptr) {
+            _pos = _currentHeader->nextPos;
+        }
+    }
+
+    std::shared_ptr<TransactionHeader> MmapStateLogReader::txnHeader() {
+        return _currentHeader;
+    }
+
+    std::shared_ptr<Transaction> MmapStateLogReader::txnBody() {
+        return _currentBody;
+    }
+
+    bool MmapStateLogReader::seekGid(gid_t gid) {
+        if (_gidIndexReader == nullptr) {
+            _gidIndexReader = std::make_unique<GIDIndexReader>(_logPath, _logName);
+        }
+
+        return _gidIndexReader->seek(*this, gid);
+    }
+
+    void MmapStateLogReader::setReadAheadSize(size_t bytes) {
+        _readAheadSize = bytes;
+        applyAdvice();
+    }
+
+    void MmapStateLogReader::applyAdvice() {
+        if (_mapping == nullptr || _mapping->data() == nullptr) {
+            return;
+        }
+
+        ::madvise(const_cast<char *>(_mapping->data()), _mapping->size(),
+                  _readAheadSize > 0 ? MADV_SEQUENTIAL : MADV_NORMAL);
+    }
+}
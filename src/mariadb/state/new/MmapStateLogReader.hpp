@@ -0,0 +1,74 @@
+#ifndef ULTRAVERSE_STATE_MMAPSTATELOGREADER_HPP
+#define ULTRAVERSE_STATE_MMAPSTATELOGREADER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/arena.h>
+
+#include "StateIO.hpp"
+#include "Transaction.hpp"
+
+namespace ultraverse::state::v2 {
+    class GIDIndexReader;
+
+    /**
+     * @brief .ultstatelog를 mmap해서 읽는 IStateLogReader 구현
+     * @details StateLogReader와 달리 레코드마다 버퍼를 할당하거나 복사하지 않는다.
+     *          - txnHeader()는 매핑 안의 헤더를 가리킨다. (매핑은 반환된 포인터가 남아 있는 동안 유지된다)
+     *          - 본문은 매핑된 영역에서 바로 protobuf arena로 파싱하며, arena는 레코드마다 재사용한다.
+     *
+     * @note 블록 압축된 로그는 읽을 수 없다. (open()에서 std::runtime_error를 던진다)
+     */
+    class MmapStateLogReader: public IStateLogReader {
+    public:
+        MmapStateLogReader(const std::string &logPath, const std::string &logName);
+        ~MmapStateLogReader() override;
+
+        void open() override;
+        void close() override;
+
+        void reset() override;
+
+        uint64_t pos() override;
+        void seek(uint64_t pos) override;
+
+        bool nextHeader() override;
+        bool nextTransaction() override;
+        bool nextTransactionBytes(std::string &bytes) override;
+
+        void skipTransaction() override;
+
+        std::shared_ptr<TransactionHeader> txnHeader() override;
+        std::shared_ptr<Transaction> txnBody() override;
+
+        bool seekGid(gid_t gid) override;
+
+        /**
+         * @brief 0보다 크면 매핑에 MADV_SEQUENTIAL을 건다.
+         */
+        void setReadAheadSize(size_t bytes) override;
+    private:
+        class Mapping;
+
+        void applyAdvice();
+
+        std::string _logPath;
+        std::string _logName;
+
+        std::shared_ptr<Mapping> _mapping;
+        uint64_t _pos = 0;
+        size_t _readAheadSize = 0;
+
+        std::shared_ptr<TransactionHeader> _currentHeader;
+        std::shared_ptr<Transaction> _currentBody;
+
+        std::vector<char> _arenaBlock;
+        std::unique_ptr<google::protobuf::Arena> _arena;
+
+        std::unique_ptr<GIDIndexReader> _gidIndexReader;
+    };
+}
+
+#endif //ULTRAVERSE_STATE_MMAPSTATELOGREADER_HPP
@@ -0,0 +1,142 @@
+#include <algorithm>
+
+#include "PrefetchingStateLogReader.hpp"
+
+namespace ultraverse::state::v2 {
+    PrefetchingStateLogReader::PrefetchingStateLogReader(IStateLogReader &reader, int decodeThreads, size_t windowSize):
+        _reader(reader),
+        _decoders(std::max(decodeThreads, 1)),
+        _windowSize(std::max<size_t>(windowSize, 1))
+    {
+
+    }
+
+    void PrefetchingStateLogReader::open() {
+        discard();
+        _reader.open();
+    }
+
+    void PrefetchingStateLogReader::close() {
+        discard();
+        _reader.close();
+    }
+
+    void PrefetchingStateLogReader::reset() {
+        discard();
+        _reader.reset();
+    }
+
+    uint64_t PrefetchingStateLogReader::pos() {
+        if (_current == nullptr) {
+            return _window.empty() ? _reader.pos() : _window.front().headerEndPos - sizeof(TransactionHeader);
+        }
+
+        return _isBodyConsumed ? _current->bodyEndPos : _current->headerEndPos;
+    }
+
+    void PrefetchingStateLogReader::seek(uint64_t pos) {
+        discard();
+        _reader.seek(pos);
+    }
+
+    void PrefetchingStateLogReader::fill() {
+        while (!_isEOF && _window.size() < _windowSize) {
+            if (!_reader.nextHeader()) {
+                _isEOF = true;
+                return;
+            }
+
+            Entry entry;
+            entry.header = _reader.txnHeader();
+            entry.headerEndPos = _reader.pos();
+            entry.bytes = std::make_shared<std::string>();
+            entry.hasBody = _reader.nextTransactionBytes(*entry.bytes);
+            entry.bodyEndPos = _reader.pos();
+
+            if (entry.hasBody) {
+                auto bytes = entry.bytes;
+                entry.body = _decoders.post<std::shared_ptr<Transaction>>([bytes]() {
+                    return decodeTransaction(bytes->data(), bytes->size());
+                })->get_future();
+            } else {
+                // 본문이 잘린 레코드 이후는 읽지 않는다.
+                _isEOF = true;
+            }
+
+            _window.push_back(std::move(entry));
+        }
+    }
+
+    void PrefetchingStateLogReader::discard() {
+        _window.clear();
+        _isEOF = false;
+        _current = nullptr;
+        _isBodyConsumed = false;
+        _currentBody = nullptr;
+    }
+
+    bool PrefetchingStateLogReader::nextHeader() {
+        fill();
+
+        _currentBody = nullptr;
+        _isBodyConsumed = false;
+
+        if (_window.empty()) {
+            _current = nullptr;
+            return false;
+        }
+
+        _current = std::make_unique<Entry>(std::move(_window.front()));
+        _window.pop_front();
+
+        return true;
+    }
+
+    bool PrefetchingStateLogReader::nextTransaction() {
+        if (_current == nullptr || !_current->hasBody) {
+            _currentBody = nullptr;
+            return false;
+        }
+
+        if (_current->body.valid()) {
+            _currentBody = _current->body.get();
+        }
+        _isBodyConsumed = true;
+
+        return _currentBody != nullptr;
+    }
+
+    bool PrefetchingStateLogReader::nextTransactionBytes(std::string &bytes) {
+        if (_current == nullptr || !_current->hasBody) {
+            return false;
+        }
+
+        bytes = *_current->bytes;
+        _isBodyConsumed = true;
+
+        return true;
+    }
+
+    void PrefetchingStateLogReader::skipTransaction() {
+        if (_current != nullptr) {
+            _isBodyConsumed = true;
+        }
+    }
+
+    std::shared_ptr<TransactionHeader> PrefetchingStateLogReader::txnHeader() {
+        return _current != nullptr ? _current->header : nullptr;
+    }
+
+    std::shared_ptr<Transaction> PrefetchingStateLogReader::txnBody() {
+        return _currentBody;
+    }
+
+    bool PrefetchingStateLogReader::seekGid(gid_t gid) {
+        discard();
+        return _reader.seekGid(gid);
+    }
+
+    void PrefetchingStateLogReader::setReadAheadSize(size_t bytes) {
+        _reader.setReadAheadSize(bytes);
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef ULTRAVERSE_STATE_PREFETCHINGSTATELOGREADER_HPP
+#define ULTRAVERSE_STATE_PREFETCHINGSTATELOGREADER_HPP
+
+#include <deque>
+#include <future>
+#include <memory>
+
+#include "base/TaskExecutor.hpp"
+
+#include "StateIO.hpp"
+#include "Transaction.hpp"
+
+namespace ultraverse::state::v2 {
+
+    /**
+     * @brief 다른 IStateLogReader를 감싸서 트랜잭션 본문을 미리 읽고 병렬로 디코딩하는 reader
+     * @details 순차 스캔에서 protobuf 디코딩이 병목이 되는 것을 막기 위해,
+     *          내부 reader에서 최대 windowSize개의 레코드를 앞서 읽어 (레코드 경계는 헤더의 nextPos로 나뉜다)
+     *          decoder 스레드에 넘기고, 결과는 로그 순서대로 돌려준다.
+     *
+     *          - 호출자 입장에서는 내부 reader와 같은 순서 / 같은 pos()로 동작한다.
+     *          - seek(), seekGid(), reset(), open()은 미리 읽은 레코드를 버리고 내부 reader로 전달한다.
+     *
+     * @note 내부 reader의 수명은 호출자가 관리한다. 감싸는 동안 내부 reader를 직접 읽으면 안 된다.
+     */
+    class PrefetchingStateLogReader: public IStateLogReader {
+    public:
+        static constexpr size_t kDefaultWindowSize = 1024;
+
+        PrefetchingStateLogReader(IStateLogReader &reader, int decodeThreads, size_t windowSize = kDefaultWindowSize);
+
+        void open() override;
+        void close() override;
+        void reset() override;
+
+        uint64_t pos() override;
+        void seek(uint64_t pos) override;
+
+        bool nextHeader() override;
+        bool nextTransaction() override;
+        bool nextTransactionBytes(std::string &bytes) override;
+
+        void skipTransaction() override;
+
+        std::shared_ptr<TransactionHeader> txnHeader() override;
+        std::shared_ptr<Transaction> txnBody() override;
+
+        bool seekGid(gid_t gid) override;
+
+        void setReadAheadSize(size_t bytes) override;
+    private:
+        struct Entry {
+            std::shared_ptr<TransactionHeader> header;
+            uint64_t headerEndPos;
+            uint64_t bodyEndPos;
+
+            /** 본문 읽기에 실패했으면 false */
+            bool hasBody;
+            std::shared_ptr<std::string> bytes;
+            std::future<std::shared_ptr<Transaction>> body;
+        };
+
+        void fill();
+        void discard();
+
+        IStateLogReader &_reader;
+        TaskExecutor _decoders;
+        size_t _windowSize;
+
+        std::deque<Entry> _window;
+        bool _isEOF = false;
+
+        std::unique_ptr<Entry> _current;
+        bool _isBodyConsumed = false;
+        std::shared_ptr<Transaction> _currentBody;
+    };
+}
+
+#endif //ULTRAVERSE_STATE_PREFETCHINGSTATELOGREADER_HPP
@@ -35,6 +35,11 @@ namespace ultraverse::state::v2 {
         _current = nullptr;
     }
     
+    uint64_t ProcLogReader::pos() {
+        auto position = static_cast<std::streamoff>(_stream.tellg());
+        return position < 0 ? 0 : static_cast<uint64_t>(position);
+    }
+    
     bool ProcLogReader::nextHeader() {
         auto header = std::make_shared<ProcCallHeader>();
         _stream.read((char *) header.get(), sizeof(ProcCallHeader));
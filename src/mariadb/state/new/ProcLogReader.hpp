@@ -20,6 +20,7 @@ namespace ultraverse::state::v2 {
         bool close();
         
         void seek(uint64_t pos);
+        uint64_t pos();
     
         bool nextHeader();
         bool nextProcCall();
@@ -10,6 +10,7 @@
 #include "ultraverse_state.pb.h"
 
 #include "Query.hpp"
+#include "StateSymbolTable.hpp"
 
 namespace ultraverse::state::v2 {
     Query::Query():
@@ -231,7 +232,7 @@ namespace ultraverse::state::v2 {
         }
     }
 
-    void Query::toProtobuf(ultraverse::state::v2::proto::Query *out) const {
+    void Query::toProtobuf(ultraverse::state::v2::proto::Query *out, StateSymbolTable *symbols) const {
         if (out == nullptr) {
             return;
         }
@@ -244,47 +245,65 @@ namespace ultraverse::state::v2 {
         out->set_flags(_flags);
         out->set_affected_rows(_affectedRows);
 
-        auto *beforeMap = out->mutable_before_hash();
-        beforeMap->clear();
-        for (const auto &entry : _beforeHash) {
-            auto &hashMsg = (*beforeMap)[entry.first];
-            entry.second.toProtobuf(&hashMsg);
-        }
-
-        auto *afterMap = out->mutable_after_hash();
-        afterMap->clear();
-        for (const auto &entry : _afterHash) {
-            auto &hashMsg = (*afterMap)[entry.first];
-            entry.second.toProtobuf(&hashMsg);
+        if (symbols != nullptr) {
+            for (const auto &entry : _beforeHash) {
+                entry.second.toProtobuf(&(*out->mutable_before_hash_ids())[symbols->intern(entry.first)]);
+            }
+
+            for (const auto &entry : _afterHash) {
+                entry.second.toProtobuf(&(*out->mutable_after_hash_ids())[symbols->intern(entry.first)]);
+            }
+        } else {
+            auto *beforeMap = out->mutable_before_hash();
+            beforeMap->clear();
+            for (const auto &entry : _beforeHash) {
+                auto &hashMsg = (*beforeMap)[entry.first];
+                entry.second.toProtobuf(&hashMsg);
+            }
+
+            auto *afterMap = out->mutable_after_hash();
+            afterMap->clear();
+            for (const auto &entry : _afterHash) {
+                auto &hashMsg = (*afterMap)[entry.first];
+                entry.second.toProtobuf(&hashMsg);
+            }
         }
 
         for (const auto &item : _readSet) {
             auto *itemMsg = out->add_read_set();
-            item.toProtobuf(itemMsg);
+            item.toProtobuf(itemMsg, symbols);
         }
 
         for (const auto &item : _writeSet) {
             auto *itemMsg = out->add_write_set();
-            item.toProtobuf(itemMsg);
+            item.toProtobuf(itemMsg, symbols);
         }
 
         for (const auto &item : _varMap) {
             auto *itemMsg = out->add_var_map();
-            item.toProtobuf(itemMsg);
+            item.toProtobuf(itemMsg, symbols);
         }
 
         for (const auto &column : _readColumns) {
-            out->add_read_columns(column);
+            if (symbols != nullptr) {
+                out->add_read_column_ids(symbols->intern(column));
+            } else {
+                out->add_read_columns(column);
+            }
         }
 
         for (const auto &column : _writeColumns) {
-            out->add_write_columns(column);
+            if (symbols != nullptr) {
+                out->add_write_column_ids(symbols->intern(column));
+            } else {
+                out->add_write_columns(column);
+            }
         }
 
         _statementContext.toProtobuf(out->mutable_statement_context());
     }
 
-    void Query::fromProtobuf(const ultraverse::state::v2::proto::Query &msg) {
+    void Query::fromProtobuf(const ultraverse::state::v2::proto::Query &msg, const StateSymbolTable *symbols) {
         _type = static_cast<QueryType>(msg.type());
         _timestamp = msg.timestamp();
         _database = msg.database();
@@ -306,11 +325,25 @@ namespace ultraverse::state::v2 {
             _afterHash.emplace(entry.first, std::move(hash));
         }
 
+        if (symbols != nullptr) {
+            for (const auto &entry : msg.before_hash_ids()) {
+                StateHash hash;
+                hash.fromProtobuf(entry.second);
+                _beforeHash.emplace(symbols->symbol(entry.first), std::move(hash));
+            }
+
+            for (const auto &entry : msg.after_hash_ids()) {
+                StateHash hash;
+                hash.fromProtobuf(entry.second);
+                _afterHash.emplace(symbols->symbol(entry.first), std::move(hash));
+            }
+        }
+
         _readSet.clear();
         _readSet.reserve(static_cast<size_t>(msg.read_set_size()));
         for (const auto &itemMsg : msg.read_set()) {
             StateItem item;
-            item.fromProtobuf(itemMsg);
+            item.fromProtobuf(itemMsg, symbols);
             _readSet.emplace_back(std::move(item));
         }
 
@@ -318,7 +351,7 @@ namespace ultraverse::state::v2 {
         _writeSet.reserve(static_cast<size_t>(msg.write_set_size()));
         for (const auto &itemMsg : msg.write_set()) {
             StateItem item;
-            item.fromProtobuf(itemMsg);
+            item.fromProtobuf(itemMsg, symbols);
             _writeSet.emplace_back(std::move(item));
         }
 
@@ -326,7 +359,7 @@ namespace ultraverse::state::v2 {
         _varMap.reserve(static_cast<size_t>(msg.var_map_size()));
         for (const auto &itemMsg : msg.var_map()) {
             StateItem item;
-            item.fromProtobuf(itemMsg);
+            item.fromProtobuf(itemMsg, symbols);
             _varMap.emplace_back(std::move(item));
         }
 
@@ -340,6 +373,16 @@ namespace ultraverse::state::v2 {
             _writeColumns.insert(column);
         }
 
+        if (symbols != nullptr) {
+            for (const auto id : msg.read_column_ids()) {
+                _readColumns.insert(symbols->symbol(id));
+            }
+
+            for (const auto id : msg.write_column_ids()) {
+                _writeColumns.insert(symbols->symbol(id));
+            }
+        }
+
         _statementContext.fromProtobuf(msg.statement_context());
     }
 }
@@ -20,6 +20,8 @@
 
 namespace ultraverse::state::v2 {
     using ColumnSet = std::set<std::string>;
+
+    class StateSymbolTable;
     
     class Query {
     public:
@@ -140,8 +142,11 @@ namespace ultraverse::state::v2 {
 
         std::string varMappedStatement(const std::vector<StateItem> &variableSet) const;
 
-        void toProtobuf(ultraverse::state::v2::proto::Query *out) const;
-        void fromProtobuf(const ultraverse::state::v2::proto::Query &msg);
+        /**
+         * @param symbols nullptr가 아니면 컬럼 / 테이블 이름을 symbols의 id로 기록한다.
+         */
+        void toProtobuf(ultraverse::state::v2::proto::Query *out, StateSymbolTable *symbols = nullptr) const;
+        void fromProtobuf(const ultraverse::state::v2::proto::Query &msg, const StateSymbolTable *symbols = nullptr);
     private:
         QueryType _type;
         uint64_t _timestamp;
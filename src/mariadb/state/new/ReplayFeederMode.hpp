@@ -0,0 +1,18 @@
+#ifndef ULTRAVERSE_REPLAYFEEDERMODE_HPP
+#define ULTRAVERSE_REPLAYFEEDERMODE_HPP
+
+namespace ultraverse::state::v2 {
+    /**
+     * @brief replay 대상 트랜잭션을 상태 로그에서 읽어오는 방식
+     */
+    enum ReplayFeederMode {
+        /** @brief replay 대상의 밀도에 따라 SEEK / SCAN 중 하나를 고른다 */
+        AUTO = 0,
+        /** @brief GID 인덱스로 대상 트랜잭션마다 seek한다 */
+        SEEK = 1,
+        /** @brief 로그를 한 번 순서대로 읽으며 대상이 아닌 트랜잭션은 헤더만 읽고 건너뛴다 */
+        SCAN = 2
+    };
+}
+
+#endif //ULTRAVERSE_REPLAYFEEDERMODE_HPP
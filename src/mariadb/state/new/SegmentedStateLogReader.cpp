@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+#include <fmt/format.h>
+
+#include "StateLogReader.hpp"
+#include "SegmentedStateLogReader.hpp"
+
+namespace ultraverse::state::v2 {
+    namespace {
+        constexpr uint64_t kSegmentPosMask = (1ULL << SegmentedStateLogReader::SEGMENT_POS_SHIFT) - 1;
+    }
+
+    SegmentedStateLogReader::SegmentedStateLogReader(const std::string &logPath, const std::string &logName,
+                                                     bool allowMissingArchivedSegments):
+        _logPath(logPath),
+        _logName(logName),
+        _allowMissingArchivedSegments(allowMissingArchivedSegments),
+        _manifest(logPath, logName)
+    {
+        if (!StateLogManifest::exists(logPath, logName)) {
+            throw std::runtime_error(fmt::format("manifest not found for state log {}/{}", logPath, logName));
+        }
+    }
+
+    SegmentedStateLogReader::~SegmentedStateLogReader() {
+
+    }
+
+    void SegmentedStateLogReader::setGidRange(gid_t startGid, gid_t endGid) {
+        _segments.clear();
+        _missingSegments.clear();
+
+        for (const auto &segment : _manifest.segments()) {
+            if (!segment.overlaps(startGid, endGid)) {
+                continue;
+            }
+
+            auto path = fmt::format("{}/{}.ultstatelog", segmentPath(segment), segment.name);
+            if (!std::filesystem::exists(path)) {
+                // archive/ 에서 지워진 세그먼트를 건너뛰면 그 gid 구간이 조용히 빠지므로, 명시적으로 허용한 경우에만 건너뛴다
+                if (segment.archived && _allowMissingArchivedSegments) {
+                    _missingSegments.push_back(segment);
+                    continue;
+                }
+                throw std::runtime_error(fmt::format("state log segment {} not found", path));
+            }
+
+            _segments.push_back(segment);
+        }
+
+        _reader = nullptr;
+        _current = 0;
+        _isSegmentsSelected = true;
+    }
+
+    void SegmentedStateLogReader::ensureSegments() {
+        if (!_isSegmentsSelected) {
+            setGidRange(0, std::numeric_limits<gid_t>::max());
+        }
+    }
+
+    const StateLogManifest &SegmentedStateLogReader::manifest() const {
+        return _manifest;
+    }
+
+    const std::vector<StateLogSegment> &SegmentedStateLogReader::missingSegments() {
+        ensureSegments();
+        return _missingSegments;
+    }
+
+    void SegmentedStateLogReader::open() {
+        ensureSegments();
+        openSegment(0);
+    }
+
+    void SegmentedStateLogReader::close() {
+        if (_reader != nullptr) {
+            _reader->close();
+        }
+        _reader = nullptr;
+    }
+
+    void SegmentedStateLogReader::reset() {
+        ensureSegments();
+        openSegment(0);
+    }
+
+    uint64_t SegmentedStateLogReader::pos() {
+        if (_reader == nullptr) {
+            return static_cast<uint64_t>(_segments.size()) << SEGMENT_POS_SHIFT;
+        }
+
+        return (static_cast<uint64_t>(_current) << SEGMENT_POS_SHIFT) | (_reader->pos() & kSegmentPosMask);
+    }
+
+    void SegmentedStateLogReader::seek(uint64_t pos) {
+        ensureSegments();
+
+        auto index = static_cast<size_t>(pos >> SEGMENT_POS_SHIFT);
+        if (_reader == nullptr || index != _current) {
+            if (!openSegment(index)) {
+                return;
+            }
+        }
+
+        _reader->seek(pos & kSegmentPosMask);
+    }
+
+    bool SegmentedStateLogReader::nextHeader() {
+        while (_reader != nullptr) {
+            if (_reader->nextHeader()) {
+                return true;
+            }
+
+            openSegment(_current + 1);
+        }
+
+        return false;
+    }
+
+    bool SegmentedStateLogReader::nextTransaction() {
+        return _reader != nullptr && _reader->nextTransaction();
+    }
+
+    bool SegmentedStateLogReader::nextTransactionBytes(std::string &bytes) {
+        return _reader != nullptr && _reader->nextTransactionBytes(bytes);
+    }
+
+    void SegmentedStateLogReader::skipTransaction() {
+        if (_reader != nullptr) {
+            _reader->skipTransaction();
+        }
+    }
+
+    std::shared_ptr<TransactionHeader> SegmentedStateLogReader::txnHeader() {
+        return _reader != nullptr ? _reader->txnHeader() : nullptr;
+    }
+
+    std::shared_ptr<Transaction> SegmentedStateLogReader::txnBody() {
+        return _reader != nullptr ? _reader->txnBody() : nullptr;
+    }
+
+    bool SegmentedStateLogReader::seekGid(gid_t gid) {
+        ensureSegments();
+
+        std::optional<size_t> found;
+
+        for (size_t i = 0; i < _segments.size(); i++) {
+            const auto &segment = _segments[i];
+
+            if (segment.sealed) {
+                if (segment.transactionCount > 0 && segment.firstGid <= gid && gid <= segment.lastGid) {
+                    found = i;
+                    break;
+                }
+            } else if (segment.transactionCount == 0 || segment.firstGid <= gid) {
+                // 쓰고 있는 세그먼트는 manifest에 gid 범위가 아직 기록되지 않았을 수 있다
+                found = i;
+                break;
+            }
+        }
+
+        if (!found.has_value() || !openSegment(*found)) {
+            return false;
+        }
+
+        return _reader->seekGid(gid);
+    }
+
+    void SegmentedStateLogReader::setReadAheadSize(size_t bytes) {
+        _readAheadSize = bytes;
+    }
+
+    void SegmentedStateLogReader::forEachSegment(int threadNum, const SegmentCallback &callback) {
+        ensureSegments();
+
+        std::atomic_size_t next = 0;
+        std::atomic_bool failed = false;
+        std::exception_ptr exception;
+        std::mutex exceptionLock;
+
+        auto worker = [&]() {
+            while (!failed) {
+                size_t index = next++;
+                if (index >= _segments.size()) {
+                    return;
+                }
+
+                try {
+                    auto reader = makeSegmentReader(_segments[index]);
+                    reader->open();
+                    callback(_segments[index], *reader);
+                    reader->close();
+                } catch (...) {
+                    std::scoped_lock _lock(exceptionLock);
+                    if (exception == nullptr) {
+                        exception = std::current_exception();
+                    }
+                    failed = true;
+                }
+            }
+        };
+
+        size_t workerNum = std::min<size_t>(std::max(threadNum, 1), _segments.size());
+        std::vector<std::thread> workers;
+        workers.reserve(workerNum);
+        for (size_t i = 0; i < workerNum; i++) {
+            workers.emplace_back(worker);
+        }
+        for (auto &thread : workers) {
+            thread.join();
+        }
+
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    std::string SegmentedStateLogReader::segmentPath(const StateLogSegment &segment) const {
+        if (segment.archived) {
+            return fmt::format("{}/{}", _logPath, StateLogManifest::ARCHIVE_DIRECTORY);
+        }
+
+        return _logPath;
+    }
+
+    std::unique_ptr<IStateLogReader> SegmentedStateLogReader::makeSegmentReader(const StateLogSegment &segment) const {
+        auto reader = std::make_unique<StateLogReader>(segmentPath(segment), segment.name);
+        reader->setReadAheadSize(_readAheadSize);
+
+        return reader;
+    }
+
+    bool SegmentedStateLogReader::openSegment(size_t index) {
+        if (_reader != nullptr) {
+            _reader->close();
+        }
+        _reader = nullptr;
+        _current = index;
+
+        if (index >= _segments.size()) {
+            return false;
+        }
+
+        _reader = makeSegmentReader(_segments[index]);
+        _reader->open();
+
+        return true;
+    }
+}
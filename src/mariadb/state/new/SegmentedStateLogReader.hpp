@@ -0,0 +1,109 @@
+#ifndef ULTRAVERSE_STATE_SEGMENTEDSTATELOGREADER_HPP
+#define ULTRAVERSE_STATE_SEGMENTEDSTATELOGREADER_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "StateIO.hpp"
+#include "StateLogManifest.hpp"
+#include "Transaction.hpp"
+
+namespace ultraverse::state::v2 {
+    /**
+     * @brief 세그먼트로 나뉜 state log (<name>.ultmanifest)를 하나의 로그처럼 읽는 IStateLogReader 구현
+     * @details 각 세그먼트는 StateLogReader로 읽는다. archive/ 로 옮겨진 세그먼트도 그 자리에서 읽는다.
+     *
+     *          pos()는 (세그먼트 순번 << SEGMENT_POS_SHIFT) | 세그먼트 안의 위치 를 반환하므로,
+     *          같은 세그먼트 안에서는 StateLogReader와 같이 위치를 더하고 뺄 수 있다.
+     *          seek(0)은 (gid 범위 안의) 첫 세그먼트의 처음으로 간다.
+     */
+    class SegmentedStateLogReader: public IStateLogReader {
+    public:
+        static constexpr int SEGMENT_POS_SHIFT = 48;
+
+        using SegmentCallback = std::function<void(const StateLogSegment &segment, IStateLogReader &reader)>;
+
+        /**
+         * @param allowMissingArchivedSegments true면 archive/ 에서 지워진 세그먼트를 건너뛰고 missingSegments()에 남긴다.
+         *                                     false면 세그먼트 파일이 없을 때 예외를 던진다.
+         * @throws std::runtime_error manifest를 읽을 수 없는 경우
+         * @note 읽을 세그먼트는 setGidRange()나 처음 읽을 때 정해지므로, 세그먼트 파일이 없다는 예외는 그때 던진다.
+         */
+        SegmentedStateLogReader(const std::string &logPath, const std::string &logName,
+                                bool allowMissingArchivedSegments = false);
+        ~SegmentedStateLogReader() override;
+
+        /**
+         * @brief [startGid, endGid]와 겹치지 않는 세그먼트는 읽지 않는다.
+         * @note 세그먼트 단위로 건너뛰므로, 범위 밖의 트랜잭션이 일부 읽힐 수 있다.
+         * @throws std::runtime_error 범위 안의 세그먼트 파일이 없는 경우 (allowMissingArchivedSegments인 archive 세그먼트 제외)
+         */
+        void setGidRange(gid_t startGid, gid_t endGid);
+
+        const StateLogManifest &manifest() const;
+
+        /**
+         * @brief gid 범위 안에 있지만 archive/ 에서 지워져 건너뛴 세그먼트들 (allowMissingArchivedSegments일 때만)
+         * @details 이 세그먼트의 [firstGid, lastGid]는 읽히지 않으므로, 호출하는 쪽에서 빠진 구간을 알려야 한다.
+         */
+        const std::vector<StateLogSegment> &missingSegments();
+
+        void open() override;
+        void close() override;
+        void reset() override;
+
+        uint64_t pos() override;
+        void seek(uint64_t pos) override;
+
+        bool nextHeader() override;
+        bool nextTransaction() override;
+        bool nextTransactionBytes(std::string &bytes) override;
+
+        void skipTransaction() override;
+
+        std::shared_ptr<TransactionHeader> txnHeader() override;
+        std::shared_ptr<Transaction> txnBody() override;
+
+        bool seekGid(gid_t gid) override;
+
+        void setReadAheadSize(size_t bytes) override;
+
+        /**
+         * @brief 세그먼트마다 별도의 reader를 열어 threadNum개의 스레드에서 callback을 호출한다.
+         * @details 세그먼트 사이의 순서는 보장하지 않는다. callback이 던진 첫 예외를 모든 스레드가 끝난 뒤 다시 던진다.
+         */
+        void forEachSegment(int threadNum, const SegmentCallback &callback);
+    private:
+        /**
+         * @brief setGidRange()가 불리지 않았으면 전체 범위로 읽을 세그먼트를 정한다.
+         */
+        void ensureSegments();
+
+        std::string segmentPath(const StateLogSegment &segment) const;
+        std::unique_ptr<IStateLogReader> makeSegmentReader(const StateLogSegment &segment) const;
+
+        /**
+         * @brief _segments[index]를 열고 처음으로 간다. 범위를 벗어나면 false를 반환한다.
+         */
+        bool openSegment(size_t index);
+
+        std::string _logPath;
+        std::string _logName;
+        bool _allowMissingArchivedSegments;
+
+        StateLogManifest _manifest;
+        /** gid 범위 안에 있는, 읽을 수 있는 세그먼트들 */
+        std::vector<StateLogSegment> _segments;
+        std::vector<StateLogSegment> _missingSegments;
+        bool _isSegmentsSelected = false;
+
+        size_t _readAheadSize = 0;
+
+        size_t _current = 0;
+        std::unique_ptr<IStateLogReader> _reader;
+    };
+}
+
+#endif //ULTRAVERSE_STATE_SEGMENTEDSTATELOGREADER_HPP
@@ -14,7 +14,21 @@ namespace ultraverse::state::v2 {
         _threadNum(4),
         _writeStateLog(false),
         _executeReplaceQuery(true),
-        _rangeComparisonMethod(RangeComparisonMethod::EQ_ONLY)
+        _rangeComparisonMethod(RangeComparisonMethod::EQ_ONLY),
+        _readyQueueScheduler(false),
+        _incrementalGC(false),
+        _compactRowGraph(false),
+        _shardedRowGraphWorkers(false),
+        _replayPipelineDepth(1),
+        _replayStatementBatching(false),
+        _parallelFullReplay(false),
+        _replayFeederMode(ReplayFeederMode::AUTO),
+        _memoryMappedStateLog(false),
+        _allowMissingArchivedSegments(false),
+        _logDecodeThreads(0),
+        _useKeyIndex(false),
+        _useRWSummary(false),
+        _useZoneMap(false)
     {
     
     }
@@ -286,4 +300,116 @@ namespace ultraverse::state::v2 {
     void StateChangePlan::setRangeComparisonMethod(RangeComparisonMethod rangeComparisonMethod) {
         _rangeComparisonMethod = rangeComparisonMethod;
     }
+
+    bool StateChangePlan::readyQueueScheduler() const {
+        return _readyQueueScheduler;
+    }
+
+    void StateChangePlan::setReadyQueueScheduler(bool readyQueueScheduler) {
+        _readyQueueScheduler = readyQueueScheduler;
+    }
+
+    bool StateChangePlan::incrementalGC() const {
+        return _incrementalGC;
+    }
+
+    void StateChangePlan::setIncrementalGC(bool incrementalGC) {
+        _incrementalGC = incrementalGC;
+    }
+
+    bool StateChangePlan::compactRowGraph() const {
+        return _compactRowGraph;
+    }
+
+    void StateChangePlan::setCompactRowGraph(bool compactRowGraph) {
+        _compactRowGraph = compactRowGraph;
+    }
+
+    bool StateChangePlan::shardedRowGraphWorkers() const {
+        return _shardedRowGraphWorkers;
+    }
+
+    void StateChangePlan::setShardedRowGraphWorkers(bool shardedRowGraphWorkers) {
+        _shardedRowGraphWorkers = shardedRowGraphWorkers;
+    }
+
+    int StateChangePlan::replayPipelineDepth() const {
+        return _replayPipelineDepth;
+    }
+
+    void StateChangePlan::setReplayPipelineDepth(int replayPipelineDepth) {
+        _replayPipelineDepth = replayPipelineDepth;
+    }
+
+    bool StateChangePlan::replayStatementBatching() const {
+        return _replayStatementBatching;
+    }
+
+    void StateChangePlan::setReplayStatementBatching(bool replayStatementBatching) {
+        _replayStatementBatching = replayStatementBatching;
+    }
+
+    bool StateChangePlan::parallelFullReplay() const {
+        return _parallelFullReplay;
+    }
+
+    void StateChangePlan::setParallelFullReplay(bool parallelFullReplay) {
+        _parallelFullReplay = parallelFullReplay;
+    }
+
+    ReplayFeederMode StateChangePlan::replayFeederMode() const {
+        return _replayFeederMode;
+    }
+
+    void StateChangePlan::setReplayFeederMode(ReplayFeederMode replayFeederMode) {
+        _replayFeederMode = replayFeederMode;
+    }
+
+    bool StateChangePlan::memoryMappedStateLog() const {
+        return _memoryMappedStateLog;
+    }
+
+    void StateChangePlan::setMemoryMappedStateLog(bool memoryMappedStateLog) {
+        _memoryMappedStateLog = memoryMappedStateLog;
+    }
+
+    bool StateChangePlan::allowMissingArchivedSegments() const {
+        return _allowMissingArchivedSegments;
+    }
+
+    void StateChangePlan::setAllowMissingArchivedSegments(bool allowMissingArchivedSegments) {
+        _allowMissingArchivedSegments = allowMissingArchivedSegments;
+    }
+
+    int StateChangePlan::logDecodeThreads() const {
+        return _logDecodeThreads;
+    }
+
+    void StateChangePlan::setLogDecodeThreads(int logDecodeThreads) {
+        _logDecodeThreads = logDecodeThreads;
+    }
+
+    bool StateChangePlan::useKeyIndex() const {
+        return _useKeyIndex;
+    }
+
+    void StateChangePlan::setUseKeyIndex(bool useKeyIndex) {
+        _useKeyIndex = useKeyIndex;
+    }
+
+    bool StateChangePlan::useRWSummary() const {
+        return _useRWSummary;
+    }
+
+    void StateChangePlan::setUseRWSummary(bool useRWSummary) {
+        _useRWSummary = useRWSummary;
+    }
+
+    bool StateChangePlan::useZoneMap() const {
+        return _useZoneMap;
+    }
+
+    void StateChangePlan::setUseZoneMap(bool useZoneMap) {
+        _useZoneMap = useZoneMap;
+    }
 }
@@ -11,6 +11,7 @@
 
 #include "Transaction.hpp"
 #include "RangeComparisonMethod.hpp"
+#include "ReplayFeederMode.hpp"
 
 namespace ultraverse::state::v2 {
 
@@ -62,6 +63,19 @@ namespace ultraverse::state::v2 {
         const std::string &stateLogName() const;
         void setStateLogName(const std::string &stateLogName);
 
+        /**
+         * @brief 상태 로그를 mmap해서 읽을지 여부 (MmapStateLogReader)
+         */
+        bool memoryMappedStateLog() const;
+        void setMemoryMappedStateLog(bool memoryMappedStateLog);
+
+        /**
+         * @brief archive/ 에서 지워진 세그먼트를 건너뛰고 읽을지 여부 (SegmentedStateLogReader)
+         * @details false면 세그먼트 파일이 없을 때 상태 로그를 열지 못한다.
+         */
+        bool allowMissingArchivedSegments() const;
+        void setAllowMissingArchivedSegments(bool allowMissingArchivedSegments);
+
         const std::string &procCallLogPath() const;
         void setProcCallLogPath(const std::string &procCallLogPath);
         
@@ -97,6 +111,67 @@ namespace ultraverse::state::v2 {
         
         RangeComparisonMethod rangeComparisonMethod() const;
         void setRangeComparisonMethod(RangeComparisonMethod rangeComparisonMethod);
+
+        bool readyQueueScheduler() const;
+        void setReadyQueueScheduler(bool readyQueueScheduler);
+
+        bool incrementalGC() const;
+        void setIncrementalGC(bool incrementalGC);
+
+        bool compactRowGraph() const;
+        void setCompactRowGraph(bool compactRowGraph);
+
+        bool shardedRowGraphWorkers() const;
+        void setShardedRowGraphWorkers(bool shardedRowGraphWorkers);
+
+        /**
+         * @brief replay 워커 하나가 동시에 실행할 수 있는 트랜잭션 수 (1이면 동기 실행)
+         */
+        int replayPipelineDepth() const;
+        void setReplayPipelineDepth(int replayPipelineDepth);
+
+        /**
+         * @brief 트랜잭션의 구문들을 multi-statement 요청 하나로 묶어 실행할지 여부
+         */
+        bool replayStatementBatching() const;
+        void setReplayStatementBatching(bool replayStatementBatching);
+
+        /**
+         * @brief full replay를 replay()와 같은 RowGraph 스케줄러로 병렬 실행할지 여부
+         */
+        bool parallelFullReplay() const;
+        void setParallelFullReplay(bool parallelFullReplay);
+
+        ReplayFeederMode replayFeederMode() const;
+        void setReplayFeederMode(ReplayFeederMode replayFeederMode);
+
+        /**
+         * @brief 상태 로그 전체 스캔 (makeCluster, analyzeReplayPlan 등)에서 트랜잭션을 디코딩할 스레드 수
+         * @note 0이면 스캔하는 스레드에서 직접 디코딩한다.
+         */
+        int logDecodeThreads() const;
+        void setLogDecodeThreads(int logDecodeThreads);
+
+        /**
+         * @brief prepare에서 클러스터를 .ultkeyindex로부터 만든다.
+         * @note 인덱스가 없거나 키 컬럼을 모두 덮지 못하면 makeCluster()가 저장한 클러스터를 읽는다.
+         */
+        bool useKeyIndex() const;
+        void setUseKeyIndex(bool useKeyIndex);
+
+        /**
+         * @brief replay 대상 분석에서 .ultsummary로 관련 없는 트랜잭션을 거르고, 본문은 rollback / prepend 대상만 디코딩한다.
+         * @note 요약이 없거나 row alias가 설정되어 있으면 모든 트랜잭션을 디코딩한다.
+         */
+        bool useRWSummary() const;
+        void setUseRWSummary(bool useRWSummary);
+
+        /**
+         * @brief replay 대상 분석에서 rollback 대상과 겹칠 수 없는 .ultzonemap의 zone을 통째로 건너뛴다.
+         * @note zone map이 없거나, row alias가 설정되어 있거나, 세그먼트로 나뉜 로그이면 쓰지 않는다.
+         */
+        bool useZoneMap() const;
+        void setUseZoneMap(bool useZoneMap);
         
         std::set<std::string> &keyColumns();
         std::vector<std::vector<std::string>> &keyColumnGroups();
@@ -152,6 +227,21 @@ namespace ultraverse::state::v2 {
         int _threadNum;
         
         RangeComparisonMethod _rangeComparisonMethod;
+
+        bool _readyQueueScheduler;
+        bool _incrementalGC;
+        bool _compactRowGraph;
+        bool _shardedRowGraphWorkers;
+        int _replayPipelineDepth;
+        bool _replayStatementBatching;
+        bool _memoryMappedStateLog;
+        bool _allowMissingArchivedSegments;
+        bool _parallelFullReplay;
+        ReplayFeederMode _replayFeederMode;
+        int _logDecodeThreads;
+        bool _useKeyIndex;
+        bool _useRWSummary;
+        bool _useZoneMap;
     };
     
 }
@@ -9,6 +9,7 @@
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "ultraverse_state.pb.h"
@@ -22,6 +23,8 @@ namespace ultraverse::state::v2 {
         std::map<gid_t, Transaction> userQueries;
         std::vector<gid_t> rollbackGids;
         std::vector<std::string> replaceQueries;
+        /** 상태 로그에서 빠져 분석하지 못한 [firstGid, lastGid] 구간들 */
+        std::vector<std::pair<gid_t, gid_t>> missingGidRanges;
 
         void toProtobuf(ultraverse::state::v2::proto::StateChangeReplayPlan *out) const {
             if (out == nullptr) {
@@ -47,6 +50,12 @@ namespace ultraverse::state::v2 {
             for (const auto &query : replaceQueries) {
                 out->add_replace_queries(query);
             }
+
+            for (const auto &range : missingGidRanges) {
+                auto *protoRange = out->add_missing_gid_ranges();
+                protoRange->set_first_gid(range.first);
+                protoRange->set_last_gid(range.second);
+            }
         }
 
         void fromProtobuf(const ultraverse::state::v2::proto::StateChangeReplayPlan &msg) {
@@ -74,6 +83,12 @@ namespace ultraverse::state::v2 {
             for (const auto &query : msg.replace_queries()) {
                 replaceQueries.emplace_back(query);
             }
+
+            missingGidRanges.clear();
+            missingGidRanges.reserve(static_cast<size_t>(msg.missing_gid_ranges_size()));
+            for (const auto &range : msg.missing_gid_ranges()) {
+                missingGidRanges.emplace_back(range.first_gid(), range.last_gid());
+            }
         }
 
         void save(const std::string &path) const {
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cstring>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 
 #include <fmt/color.h>
@@ -20,6 +21,10 @@
 
 #include "StateChangeReport.hpp"
 #include "StateLogReader.hpp"
+#include "MmapStateLogReader.hpp"
+#include "BlockCompressedStateLog.hpp"
+#include "PrefetchingStateLogReader.hpp"
+#include "SegmentedStateLogReader.hpp"
 
 #include "StateChanger.hpp"
 
@@ -138,9 +143,27 @@ namespace ultraverse::state::v2 {
             return "NULL";
         }
 
+        std::unique_ptr<IStateLogReader> makeStateLogReader(const StateChangePlan &plan) {
+            if (StateLogManifest::exists(plan.stateLogPath(), plan.stateLogName())) {
+                auto reader = std::make_unique<SegmentedStateLogReader>(plan.stateLogPath(), plan.stateLogName(),
+                                                                    plan.allowMissingArchivedSegments());
+                // gid 범위 밖의 세그먼트는 열지도 않는다
+                if (plan.hasGidRange()) {
+                    reader->setGidRange(plan.startGid(), plan.endGid());
+                }
+                return reader;
+            }
+
+            // 블록 압축된 로그는 풀어서 읽어야 하므로 mmap reader를 쓰지 않는다
+            if (plan.memoryMappedStateLog() && !isBlockCompressedStateLog(plan.stateLogPath(), plan.stateLogName())) {
+                return std::make_unique<MmapStateLogReader>(plan.stateLogPath(), plan.stateLogName());
+            }
+            return std::make_unique<StateLogReader>(plan.stateLogPath(), plan.stateLogName());
+        }
+
         StateChangerIO makeDefaultIO(const StateChangePlan &plan) {
             StateChangerIO io;
-            io.stateLogReader = std::make_unique<StateLogReader>(plan.stateLogPath(), plan.stateLogName());
+            io.stateLogReader = makeStateLogReader(plan);
             io.clusterStore = std::make_unique<FileStateClusterStore>(plan.stateLogPath(), plan.stateLogName());
             io.backupLoader = std::make_unique<MySQLBackupLoader>(plan.dbHost(), plan.dbUsername(), plan.dbPassword());
             io.closeStandardFds = true;
@@ -169,7 +192,14 @@ namespace ultraverse::state::v2 {
         _replayedQueries(0)
     {
         if (_reader == nullptr) {
-            _reader = std::make_unique<StateLogReader>(plan.stateLogPath(), plan.stateLogName());
+            _reader = makeStateLogReader(plan);
+        }
+
+        if (auto *segmentedReader = dynamic_cast<SegmentedStateLogReader *>(_reader.get())) {
+            for (const auto &segment : segmentedReader->missingSegments()) {
+                _logger->warn("state log segment {} (gid {} - {}) was deleted from the archive; its transactions will not be read",
+                              segment.name, segment.firstGid, segment.lastGid);
+            }
         }
 
         if (_clusterStore == nullptr) {
@@ -180,6 +210,19 @@ namespace ultraverse::state::v2 {
             _backupLoader = std::make_unique<MySQLBackupLoader>(plan.dbHost(), plan.dbUsername(), plan.dbPassword());
         }
     }
+
+    IStateLogReader &StateChanger::scanReader() {
+        if (_plan.logDecodeThreads() <= 0) {
+            return *_reader;
+        }
+
+        if (_scanReader == nullptr) {
+            _logger->info("decoding state log with {} threads", _plan.logDecodeThreads());
+            _scanReader = std::make_unique<PrefetchingStateLogReader>(*_reader, _plan.logDecodeThreads());
+        }
+
+        return *_scanReader;
+    }
     
     void StateChanger::fullReplay() {
         _mode = OperationMode::FULL_REPLAY;
@@ -202,62 +245,93 @@ namespace ultraverse::state::v2 {
             report.setSQLLoadTime(time.count());
         }
         
-        _logger->info("opening state log");
-        _reader->open();
-        
         _isRunning = true;
         
         auto phase_main_start = std::chrono::steady_clock::now();
         
-        while (_reader->nextHeader()) {
-            auto transactionHeader = _reader->txnHeader();
-            auto pos = _reader->pos() - sizeof(TransactionHeader);
-            
-            _reader->nextTransaction();
-            auto transaction = _reader->txnBody();
-            auto gid = transactionHeader->gid;
-            auto flags = transactionHeader->flags;
+        // RowGraph는 key column으로만 트랜잭션 사이의 의존성을 만드므로, key column이 없으면 모든 트랜잭션이
+        // 순서 없이 동시에 실행된다. 이 경우에는 순차 replay로 돌아간다.
+        const bool parallel = _plan.parallelFullReplay() && !_plan.keyColumns().empty();
+        if (_plan.parallelFullReplay() && !parallel) {
+            _logger->warn("fullReplay(): no key columns configured; falling back to sequential full replay");
+        }
+        
+        if (parallel) {
+            if (_plan.dbDumpPath().empty()) {
+                auto dbHandle = _dbHandlePool.take();
+                updatePrimaryKeys(dbHandle->get(), 0, _plan.dbName());
+                updateForeignKeys(dbHandle->get(), 0, _plan.dbName());
+            }
             
-            if (_plan.isRollbackGid(gid)) {
-                _logger->info("skipping rollback transaction #{}", gid);
-                continue;
+            for (int i = 0; i < _dbHandlePool.poolSize(); i++) {
+                auto dbHandle = _dbHandlePool.take();
+                dbHandle->get().executeQuery("USE " + _intermediateDBName);
             }
             
-            auto dbHandle = _dbHandlePool.take();
-            auto &handle = dbHandle->get();
+            // 모든 트랜잭션을 replay 대상으로 삼아 replay()와 같은 RowGraph 스케줄러로 실행한다
+            auto replayed = replayLogRange(0, std::numeric_limits<gid_t>::max(), [this](const Transaction &transaction) {
+                if (_plan.isRollbackGid(transaction.gid())) {
+                    _logger->info("skipping rollback transaction #{}", transaction.gid());
+                    return false;
+                }
+                return true;
+            });
+            
+            _logger->info("fullReplay(): {} transactions replayed in parallel", replayed);
+        } else {
+            _logger->info("opening state log");
+            _reader->open();
+            
+            while (_reader->nextHeader()) {
+                auto transactionHeader = _reader->txnHeader();
+                auto pos = _reader->pos() - sizeof(TransactionHeader);
+            
+                _reader->nextTransaction();
+                auto transaction = _reader->txnBody();
+                auto gid = transactionHeader->gid;
+                auto flags = transactionHeader->flags;
+            
+                if (_plan.isRollbackGid(gid)) {
+                    _logger->info("skipping rollback transaction #{}", gid);
+                    continue;
+                }
+            
+                auto dbHandle = _dbHandlePool.take();
+                auto &handle = dbHandle->get();
  
-            // _logger->info("replaying transaction #{}", gid);
+                // _logger->info("replaying transaction #{}", gid);
             
-            handle.executeQuery("USE " + _intermediateDBName);
-            handle.executeQuery("START TRANSACTION");
+                handle.executeQuery("USE " + _intermediateDBName);
+                handle.executeQuery("START TRANSACTION");
             
-            bool isProcedureCall = transaction->flags() & Transaction::FLAG_IS_PROCEDURE_CALL;
+                bool isProcedureCall = transaction->flags() & Transaction::FLAG_IS_PROCEDURE_CALL;
             
-            try {
-                for (const auto &query: transaction->queries()) {
-                    bool isProcedureCallQuery = query->flags() & Query::FLAG_IS_PROCCALL_QUERY;
-                    if (isProcedureCall && !isProcedureCallQuery) {
-                        goto NEXT_QUERY;
-                    }
+                try {
+                    for (const auto &query: transaction->queries()) {
+                        bool isProcedureCallQuery = query->flags() & Query::FLAG_IS_PROCCALL_QUERY;
+                        if (isProcedureCall && !isProcedureCallQuery) {
+                            goto NEXT_QUERY;
+                        }
                     
-                    applyStatementContext(handle, *query);
-                    if (handle.executeQuery(query->statement()) != 0) {
-                        _logger->error("query execution failed: {}", handle.lastError());
-                    }
+                        applyStatementContext(handle, *query);
+                        if (handle.executeQuery(query->statement()) != 0) {
+                            _logger->error("query execution failed: {}", handle.lastError());
+                        }
                     
-                    // 프로시저에서 반환한 result를 소모하지 않으면 commands out of sync 오류가 난다
-                    handle.consumeResults();
+                        // 프로시저에서 반환한 result를 소모하지 않으면 commands out of sync 오류가 난다
+                        handle.consumeResults();
                     
-                    NEXT_QUERY:
+                        NEXT_QUERY:
+                        continue;
+                    }
+                } catch (std::exception &e) {
+                    _logger->error("exception occurred while replaying transaction #{}: {}", gid, e.what());
+                    handle.executeQuery("ROLLBACK");
                     continue;
                 }
-            } catch (std::exception &e) {
-                _logger->error("exception occurred while replaying transaction #{}: {}", gid, e.what());
-                handle.executeQuery("ROLLBACK");
-                continue;
-            }
             
-            handle.executeQuery("COMMIT");
+                handle.executeQuery("COMMIT");
+            }
         }
         
         
@@ -411,27 +485,37 @@ namespace ultraverse::state::v2 {
     }
 
     void StateChanger::applyStatementContext(mariadb::DBHandle &dbHandle, const Query &query) {
+        for (const auto &statement : statementContextQueries(query)) {
+            dbHandle.executeQuery(statement);
+        }
+    }
+
+    std::vector<std::string> StateChanger::statementContextQueries(const Query &query) {
+        std::vector<std::string> statements;
+        
         const auto &context = query.statementContext();
         if (query.timestamp() > 0) {
-            dbHandle.executeQuery(fmt::format("SET TIMESTAMP={}", query.timestamp()));
+            statements.push_back(fmt::format("SET TIMESTAMP={}", query.timestamp()));
         }
 
         if (context.hasLastInsertId) {
-            dbHandle.executeQuery(fmt::format("SET LAST_INSERT_ID={}", context.lastInsertId));
+            statements.push_back(fmt::format("SET LAST_INSERT_ID={}", context.lastInsertId));
         }
         if (context.hasInsertId) {
-            dbHandle.executeQuery(fmt::format("SET INSERT_ID={}", context.insertId));
+            statements.push_back(fmt::format("SET INSERT_ID={}", context.insertId));
         }
         if (context.hasRandSeed) {
-            dbHandle.executeQuery(fmt::format("SET @@RAND_SEED1={}, @@RAND_SEED2={}",
-                                              context.randSeed1, context.randSeed2));
+            statements.push_back(fmt::format("SET @@RAND_SEED1={}, @@RAND_SEED2={}",
+                                             context.randSeed1, context.randSeed2));
         }
 
         for (const auto &userVar : context.userVars) {
             std::string name = quoteUserVarName(userVar.name);
             std::string value = formatUserVarValue(userVar);
-            dbHandle.executeQuery(fmt::format("SET @{} := {}", name, value));
+            statements.push_back(fmt::format("SET @{} := {}", name, value));
         }
+        
+        return statements;
     }
     
     int64_t StateChanger::getAutoIncrement(mariadb::DBHandle &dbHandle, std::string table) {
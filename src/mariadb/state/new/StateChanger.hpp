@@ -8,6 +8,8 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Transaction.hpp"
 #include "StateIO.hpp"
@@ -83,12 +85,67 @@ namespace ultraverse::state::v2 {
             StateChangeReplayPlan *replayPlan,
             const std::function<bool(gid_t, size_t)> &isRollbackTarget,
             const std::function<std::optional<std::string>(gid_t)> &userQueryPath,
-            const std::function<bool(gid_t)> &shouldRevalidateTarget);
+            const std::function<bool(gid_t)> &shouldRevalidateTarget,
+            const std::function<bool(gid_t, gid_t)> &hasTargetInRange = nullptr);
+        
+        /**
+         * @brief 상태 로그를 startGid부터 endGid까지 순서대로 읽으며, RowGraph와 replay 워커로 병렬 replay한다.
+         * @param filter false를 반환하는 트랜잭션은 replay하지 않는다.
+         * @return replay한 트랜잭션 수
+         */
+        uint64_t replayLogRange(gid_t startGid, gid_t endGid,
+                                const std::function<bool(const Transaction &)> &filter);
         
         void replayThreadMain(int workerId,
                               RowGraph &rowGraph,
                               std::atomic_bool &running,
                               std::atomic_uint64_t &replayedTxns);
+
+        /**
+         * @brief replayThreadMain()과 같으나, 서로 독립적인 ready 트랜잭션을 최대 pipelineDepth개까지
+         *        각자의 커넥션에서 non-blocking으로 동시에 실행한다.
+         */
+        void replayPipelinedThreadMain(int workerId,
+                                       RowGraph &rowGraph,
+                                       std::atomic_bool &running,
+                                       std::atomic_uint64_t &replayedTxns,
+                                       int pipelineDepth);
+
+        /**
+         * @brief 플랜 설정에 따라 replay 워커 스레드들을 시작한다.
+         */
+        std::vector<std::thread> startReplayWorkers(RowGraph &rowGraph,
+                                                    std::atomic_bool &running,
+                                                    std::atomic_uint64_t &replayedTxns);
+
+        /**
+         * @brief 트랜잭션을 replay할 때 실행할 구문들 (START TRANSACTION ~ COMMIT)을 순서대로 반환한다.
+         */
+        std::vector<std::string> replayStatements(Transaction &transaction);
+
+        /**
+         * @brief 상태 로그 전체를 순차 스캔할 때 쓸 reader를 반환한다.
+         * @details logDecodeThreads가 설정되어 있으면 _reader를 PrefetchingStateLogReader로 감싼 것을 반환한다.
+         */
+        IStateLogReader &scanReader();
+
+        /**
+         * @brief prepare에서 쓸 클러스터를 읽어 relationshipResolver로 정규화한다.
+         * @details useKeyIndex가 설정되어 있고 rollback / prepend 대상을 미리 알 수 있으면 먼저 .ultkeyindex로 클러스터를 만들어 보고,
+         *          쓸 수 없으면 makeCluster()가 저장한 클러스터를 읽는다.
+         * @param hasKnownTargets 대상이 plan의 rollbackGids / userQueries로 정해져 있는지 (bench auto-rollback에서는 false)
+         */
+        void loadCluster(StateCluster &rowCluster, StateRelationshipResolver &relationshipResolver, bool hasKnownTargets);
+        /**
+         * @brief rollback / prepend 대상의 키 컬럼 범위에서 시작해, 그와 병합되는 posting만 .ultkeyindex에서 찾아 클러스터를 만든다.
+         * @return row alias나 composite key group을 쓰거나, 인덱스가 없거나 로그 끝까지 색인하지 않았거나,
+         *         인덱싱되지 않은 컬럼이 키 컬럼으로 해결되면 false
+         */
+        bool loadClusterFromKeyIndex(StateCluster &rowCluster, StateRelationshipResolver &relationshipResolver);
+        /**
+         * @brief 로그에 gid보다 뒤에 쓰인 트랜잭션이 있는지 확인한다. gid를 찾을 수 없어도 true를 반환한다.
+         */
+        bool hasTransactionsAfter(gid_t gid);
         
         std::shared_ptr<Transaction> loadUserQuery(const std::string &path);
         std::shared_ptr<Transaction> parseUserQuery(const std::string &sql);
@@ -120,6 +177,10 @@ namespace ultraverse::state::v2 {
         void setAutoIncrement(mariadb::DBHandle &dbHandle, std::string table, int64_t value);
 
         void applyStatementContext(mariadb::DBHandle &dbHandle, const Query &query);
+        /**
+         * @brief 쿼리의 statement context (TIMESTAMP, INSERT_ID, 사용자 변수 등)를 재현하는 SET 문들을 반환한다.
+         */
+        std::vector<std::string> statementContextQueries(const Query &query);
         
         LoggerPtr _logger;
         
@@ -131,6 +192,7 @@ namespace ultraverse::state::v2 {
         std::string _intermediateDBName;
         
         std::unique_ptr<IStateLogReader> _reader;
+        std::unique_ptr<IStateLogReader> _scanReader;
         std::unique_ptr<IStateClusterStore> _clusterStore;
         std::unique_ptr<IBackupLoader> _backupLoader;
         bool _closeStandardFds;
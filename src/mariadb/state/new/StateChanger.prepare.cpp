@@ -6,6 +6,7 @@
 #include <atomic>
 #include <cmath>
 #include <future>
+#include <map>
 #include <set>
 #include <sstream>
 #include <stdexcept>
@@ -16,7 +17,12 @@
 
 #include <fmt/color.h>
 
+#include "GIDIndexReader.hpp"
 #include "GIDIndexWriter.hpp"
+#include "SegmentedStateLogReader.hpp"
+#include "StateRWSummary.hpp"
+#include "StateZoneMap.hpp"
+#include "StateKeyIndex.hpp"
 #include "StateLogWriter.hpp"
 #include "analysis/TaintAnalyzer.hpp"
 #include "cluster/StateCluster.hpp"
@@ -30,13 +36,9 @@
 
 
 namespace {
-    bool isTransactionInScope(const ultraverse::state::v2::StateChangePlan &plan,
-                              const std::unordered_set<ultraverse::state::v2::gid_t> &skipGids,
-                              ultraverse::state::v2::gid_t gid,
-                              const ultraverse::state::v2::Transaction &transaction) {
-        if (!transaction.isRelatedToDatabase(plan.dbName())) {
-            return false;
-        }
+    bool isGidInScope(const ultraverse::state::v2::StateChangePlan &plan,
+                      const std::unordered_set<ultraverse::state::v2::gid_t> &skipGids,
+                      ultraverse::state::v2::gid_t gid) {
         if (plan.hasGidRange()) {
             if (gid < plan.startGid() || gid > plan.endGid()) {
                 return false;
@@ -48,6 +50,13 @@ namespace {
         return true;
     }
 
+    bool isTransactionInScope(const ultraverse::state::v2::StateChangePlan &plan,
+                              const std::unordered_set<ultraverse::state::v2::gid_t> &skipGids,
+                              ultraverse::state::v2::gid_t gid,
+                              const ultraverse::state::v2::Transaction &transaction) {
+        return transaction.isRelatedToDatabase(plan.dbName()) && isGidInScope(plan, skipGids, gid);
+    }
+
     std::vector<size_t> buildAutoRollbackIndices(size_t totalCount, double ratio) {
         std::vector<size_t> indices;
         if (totalCount == 0) {
@@ -103,7 +112,34 @@ namespace ultraverse::state::v2 {
         StateRelationshipResolver relationshipResolver(_plan, *_context);
         CachedRelationshipResolver cachedResolver(relationshipResolver, 1000);
 
-        GIDIndexWriter gidIndexWriter(_plan.stateLogPath(), _plan.stateLogName());
+        // 세그먼트로 나뉜 로그는 세그먼트마다 .ultindex를 가지고 있다
+        auto *segmentedReader = dynamic_cast<SegmentedStateLogReader *>(_reader.get());
+
+        // statelogd가 아직 .ultindex를 열어 두고 쓰고 있을 수 있으므로, 있는 인덱스는 바꾸지 않는다.
+        // 색인되지 않은 마지막 트랜잭션들은 seekGid()가 색인된 마지막 트랜잭션부터 따라가며 찾는다
+        std::unique_ptr<GIDIndexWriter> gidIndexWriter;
+        if (segmentedReader != nullptr) {
+            _logger->info("makeCluster(): using gid indexes of state log segments");
+        } else {
+            switch (GIDIndexReader::coverageOf(_plan.stateLogPath(), _plan.stateLogName(), *_reader)) {
+                case GIDIndexReader::Coverage::COMPLETE:
+                    _logger->info("makeCluster(): using gid index written by statelogd");
+                    break;
+                case GIDIndexReader::Coverage::PARTIAL:
+                    _logger->info("makeCluster(): gid index written by statelogd ends before the state log; "
+                                  "later transactions will be found by scanning");
+                    break;
+                case GIDIndexReader::Coverage::MISSING:
+                    _logger->info("makeCluster(): gid index is missing; building");
+                    gidIndexWriter = std::make_unique<GIDIndexWriter>(_plan.stateLogPath(), _plan.stateLogName(), true);
+                    break;
+                case GIDIndexReader::Coverage::MISMATCHED:
+                    throw std::runtime_error(fmt::format(
+                        "gid index {}/{}.ultindex does not match the state log; stop statelogd and remove it to rebuild",
+                        _plan.stateLogPath(), _plan.stateLogName()
+                    ));
+            }
+        }
 
         std::mutex graphLock;
 
@@ -129,7 +165,8 @@ namespace ultraverse::state::v2 {
         _tableGraph->addRelationship(_context->foreignKeys);
         rowCluster.normalizeWithResolver(relationshipResolver);
 
-        _reader->open();
+        auto &reader = scanReader();
+        reader.open();
 
         auto phase_main_start = std::chrono::steady_clock::now();
         _logger->info("makeCluster(): building cluster");
@@ -137,14 +174,16 @@ namespace ultraverse::state::v2 {
         const bool useRowAlias = !_plan.columnAliases().empty();
         if (useRowAlias) {
             _logger->info("makeCluster(): row-alias enabled; processing sequentially");
-            while (_reader->nextHeader()) {
-                auto header = _reader->txnHeader();
-                auto pos = _reader->pos() - sizeof(TransactionHeader);
+            while (reader.nextHeader()) {
+                auto header = reader.txnHeader();
+                auto pos = reader.pos() - sizeof(TransactionHeader);
 
-                _reader->nextTransaction();
-                auto transaction = _reader->txnBody();
+                reader.nextTransaction();
+                auto transaction = reader.txnBody();
 
-                gidIndexWriter.append(pos);
+                if (gidIndexWriter != nullptr) {
+                    gidIndexWriter->write(header->gid, pos);
+                }
 
                 if (!transaction->isRelatedToDatabase(_plan.dbName())) {
                     _logger->trace("skipping transaction #{} because it is not related to database {}",
@@ -192,76 +231,98 @@ namespace ultraverse::state::v2 {
                 }
             }
         } else {
-            TaskExecutor taskExecutor(_plan.threadNum());
-            std::queue<std::shared_ptr<std::promise<int>>> tasks;
-
-            while (_reader->nextHeader()) {
-                auto header = _reader->txnHeader();
-                auto pos = _reader->pos() - sizeof(TransactionHeader);
+            auto processTransaction = [this, &graphLock, &rowCluster, &cachedResolver](const std::shared_ptr<Transaction> &transaction) {
+                if (!transaction->isRelatedToDatabase(_plan.dbName())) {
+                    _logger->trace("skipping transaction #{} because it is not related to database {}",
+                                   transaction->gid(), _plan.dbName());
+                    return;
+                }
 
-                _reader->nextTransaction();
-                auto transaction = _reader->txnBody();
+                rowCluster.insert(transaction, cachedResolver);
 
-                gidIndexWriter.append(pos);
+                for (auto &query: transaction->queries()) {
+                    if (query->flags() & Query::FLAG_IS_PROCCALL_QUERY) {
+                        // FIXME: 프로시저 쿼리 어케할려고?
+                        continue;
+                    }
+                    if (query->flags() & Query::FLAG_IS_DDL) {
+                        _logger->warn(
+                            "DDL statement found in transaction #{}, but this version of ultraverse does not support DDL statement yet",
+                            transaction->gid());
+                        _logger->warn("DDL query will be skipped: {}", query->statement());
+                        continue;
+                    }
 
-                auto promise = taskExecutor.post<int>(
-                    [this, &graphLock, &rowCluster, &cachedResolver, transaction]() {
-                        if (!transaction->isRelatedToDatabase(_plan.dbName())) {
-                            _logger->trace("skipping transaction #{} because it is not related to database {}",
-                                           transaction->gid(), _plan.dbName());
-                            return 0;
-                        }
+                    std::scoped_lock _lock(graphLock);
 
-                        rowCluster.insert(transaction, cachedResolver);
+                    bool isColumnGraphChanged = false;
+                    if (!query->readColumns().empty()) {
+                        isColumnGraphChanged |= _columnGraph->add(query->readColumns(), READ, _context->foreignKeys);
+                    }
+                    if (!query->writeColumns().empty()) {
+                        isColumnGraphChanged |= _columnGraph->add(query->writeColumns(), WRITE, _context->foreignKeys);
+                    }
 
-                        for (auto &query: transaction->queries()) {
-                            if (query->flags() & Query::FLAG_IS_PROCCALL_QUERY) {
-                                // FIXME: 프로시저 쿼리 어케할려고?
-                                continue;
-                            }
-                            if (query->flags() & Query::FLAG_IS_DDL) {
-                                _logger->warn(
-                                    "DDL statement found in transaction #{}, but this version of ultraverse does not support DDL statement yet",
-                                    transaction->gid());
-                                _logger->warn("DDL query will be skipped: {}", query->statement());
-                                continue;
-                            }
+                    bool isTableGraphChanged =
+                        _tableGraph->addRelationship(query->readColumns(), query->writeColumns());
 
-                            std::scoped_lock _lock(graphLock);
+                    if (isColumnGraphChanged) {
+                        _logger->info("updating column dependency graph");
+                    }
 
-                            bool isColumnGraphChanged = false;
-                            if (!query->readColumns().empty()) {
-                                isColumnGraphChanged |= _columnGraph->add(query->readColumns(), READ, _context->foreignKeys);
-                            }
-                            if (!query->writeColumns().empty()) {
-                                isColumnGraphChanged |= _columnGraph->add(query->writeColumns(), WRITE, _context->foreignKeys);
-                            }
+                    if (isTableGraphChanged) {
+                        _logger->info("updating table dependency graph");
+                    }
+                }
+            };
+
+            if (segmentedReader != nullptr) {
+                // 세그먼트마다 reader를 따로 열어, 읽기와 디코딩까지 스레드마다 나누어 한다
+                _logger->info("makeCluster(): reading state log segments with {} threads", _plan.threadNum());
+                segmentedReader->forEachSegment(_plan.threadNum(), [&processTransaction](const StateLogSegment &, IStateLogReader &segmentReader) {
+                    while (segmentReader.nextHeader()) {
+                        if (!segmentReader.nextTransaction()) {
+                            break;
+                        }
+                        processTransaction(segmentReader.txnBody());
+                    }
+                });
+            } else {
+                TaskExecutor taskExecutor(_plan.threadNum());
+                std::queue<std::shared_ptr<std::promise<int>>> tasks;
 
-                            bool isTableGraphChanged =
-                                _tableGraph->addRelationship(query->readColumns(), query->writeColumns());
+                while (reader.nextHeader()) {
+                    auto header = reader.txnHeader();
+                    auto pos = reader.pos() - sizeof(TransactionHeader);
 
-                            if (isColumnGraphChanged) {
-                                _logger->info("updating column dependency graph");
-                            }
+                    reader.nextTransaction();
+                    auto transaction = reader.txnBody();
 
-                            if (isTableGraphChanged) {
-                                _logger->info("updating table dependency graph");
-                            }
-                        }
+                    if (gidIndexWriter != nullptr) {
+                        gidIndexWriter->write(header->gid, pos);
+                    }
 
+                    auto promise = taskExecutor.post<int>([&processTransaction, transaction]() {
+                        processTransaction(transaction);
                         return 0;
                     });
 
-                tasks.emplace(std::move(promise));
-            }
+                    tasks.emplace(std::move(promise));
+                }
+
+                while (!tasks.empty()) {
+                    _logger->info("make_cluster(): {} tasks remaining", tasks.size());
+                    tasks.front()->get_future().wait();
+                    tasks.pop();
+                }
 
-            while (!tasks.empty()) {
-                _logger->info("make_cluster(): {} tasks remaining", tasks.size());
-                tasks.front()->get_future().wait();
-                tasks.pop();
+                taskExecutor.shutdown();
             }
+        }
 
-            taskExecutor.shutdown();
+        if (gidIndexWriter != nullptr) {
+            gidIndexWriter->sync();
+            gidIndexWriter.reset();
         }
 
         rowCluster.merge();
@@ -299,7 +360,8 @@ namespace ultraverse::state::v2 {
         StateChangeReplayPlan *replayPlan,
         const std::function<bool(gid_t, size_t)> &isRollbackTarget,
         const std::function<std::optional<std::string>(gid_t)> &userQueryPath,
-        const std::function<bool(gid_t)> &shouldRevalidateTarget) {
+        const std::function<bool(gid_t)> &shouldRevalidateTarget,
+        const std::function<bool(gid_t, gid_t)> &hasTargetInRange) {
         TaskExecutor taskExecutor(_plan.threadNum());
         std::vector<std::future<gid_t>> replayTasks;
         replayTasks.reserve(1024);
@@ -311,8 +373,98 @@ namespace ultraverse::state::v2 {
 
         ColumnSet columnTaint;
 
-        _reader->open();
-        _reader->seek(0);
+        // 요약을 쓰면 대부분의 본문을 건너뛰므로, 본문을 미리 디코딩하는 scanReader()를 쓰지 않는다
+        std::unique_ptr<StateRWSummaryReader> summaryReader;
+        if (_plan.useRWSummary()) {
+            if (!_plan.columnAliases().empty()) {
+                // row alias는 모든 트랜잭션의 본문을 보아야 해결할 수 있다
+                _logger->info("analyzeReplayPlan(): row-alias enabled; decoding every transaction");
+            } else if (!StateRWSummaryReader::exists(_plan.stateLogPath(), _plan.stateLogName())) {
+                _logger->warn("analyzeReplayPlan(): transaction summary not found; decoding every transaction");
+            } else {
+                summaryReader = std::make_unique<StateRWSummaryReader>(_plan.stateLogPath(), _plan.stateLogName());
+            }
+        }
+
+        // rollback 대상을 미리 알 수 있을 때에만 (hasTargetInRange) zone을 건너뛸 수 있다
+        std::unique_ptr<StateZoneMapReader> zoneMap;
+        if (_plan.useZoneMap() && hasTargetInRange) {
+            if (!_plan.columnAliases().empty()) {
+                _logger->info("analyzeReplayPlan(): row-alias enabled; not using zone map");
+            } else if (StateLogManifest::exists(_plan.stateLogPath(), _plan.stateLogName())) {
+                _logger->info("analyzeReplayPlan(): segmented state log; not using zone map");
+            } else if (!StateZoneMapReader::exists(_plan.stateLogPath(), _plan.stateLogName())) {
+                _logger->warn("analyzeReplayPlan(): zone map not found; scanning every transaction");
+            } else {
+                zoneMap = std::make_unique<StateZoneMapReader>(_plan.stateLogPath(), _plan.stateLogName());
+            }
+        }
+
+        size_t zoneIndex = 0;
+        size_t skippedZones = 0;
+        std::unordered_map<std::string, std::vector<StateRange>> targetRanges;
+        bool isTargetRangesStale = true;
+
+        // StateCluster::extractItems()와 같은 방식으로 컬럼이 속하는 키 컬럼을 찾는다
+        auto resolveKeyColumn = [&cachedResolver, &rowCluster](const std::string &column) {
+            auto realColumn = utility::toLower(cachedResolver.resolveChain(column));
+            if (realColumn.empty()) {
+                realColumn = column;
+            }
+
+            const auto &keyColumns = rowCluster.keyColumns();
+            return keyColumns.find(realColumn) != keyColumns.end() ? realColumn : std::string();
+        };
+
+        /*
+         * zone 안의 트랜잭션이 하나도 replay 대상이 될 수 없으면 true를 반환한다.
+         *  - rollback / prepend 대상이 없고,
+         *  - 지금까지 오염된 컬럼에 접근하지 않으며,
+         *  - 키 컬럼 값이 rollback 대상과 겹치는 클러스터 범위에 닿지 않음 (= shouldReplay()가 모두 false)
+         */
+        auto canSkipZone = [&](const StateZone &zone) {
+            if (hasTargetInRange(zone.firstGid, zone.lastGid)) {
+                return false;
+            }
+            if (analysis::TaintAnalyzer::columnSetsRelated(columnTaint, zone.columns, _context->foreignKeys)) {
+                return false;
+            }
+
+            if (isTargetRangesStale) {
+                targetRanges = rowCluster.targetClusterRanges();
+                isTargetRangesStale = false;
+            }
+
+            for (const auto &column : zone.itemColumns) {
+                auto keyColumn = resolveKeyColumn(column);
+                if (keyColumn.empty()) {
+                    continue;
+                }
+
+                auto zoneColumn = zone.keyColumns.find(column);
+                if (zoneColumn == zone.keyColumns.end()) {
+                    // zone map에 기록되지 않은 컬럼
+                    return false;
+                }
+
+                auto ranges = targetRanges.find(keyColumn);
+                if (ranges == targetRanges.end()) {
+                    continue;
+                }
+
+                for (const auto &range : ranges->second) {
+                    if (zoneColumn->second.mayIntersect(range)) {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        };
+
+        auto &reader = summaryReader != nullptr ? *_reader : scanReader();
+        reader.open();
+        reader.seek(0);
 
         auto flushReplayTasks = [&replayTasks, &result]() {
             for (auto &future : replayTasks) {
@@ -327,27 +479,82 @@ namespace ultraverse::state::v2 {
         size_t candidateIndex = 0;
         bool pendingTargetCacheRefresh = false;
 
-        while (_reader->nextHeader()) {
-            auto header = _reader->txnHeader();
+        while (reader.nextHeader()) {
+            auto header = reader.txnHeader();
             gid_t gid = header->gid;
 
-            _reader->nextTransaction();
-            auto transaction = _reader->txnBody();
+            if (zoneMap != nullptr) {
+                const auto &zones = zoneMap->zones();
+                while (zoneIndex < zones.size() && zones[zoneIndex].lastGid < gid) {
+                    zoneIndex++;
+                }
 
-            if (!isTransactionInScope(_plan, skipGids, gid, *transaction)) {
+                // zone의 첫 트랜잭션에서만 판단한다
+                if (zoneIndex < zones.size() && zones[zoneIndex].firstGid == gid &&
+                    reader.pos() - sizeof(TransactionHeader) == zones[zoneIndex].beginPos) {
+                    const auto &zone = zones[zoneIndex];
+                    const auto database = zone.databases.find(_plan.dbName());
+
+                    const bool isOutOfScope =
+                        database == zone.databases.end() ||
+                        (_plan.hasGidRange() && (zone.lastGid < _plan.startGid() || zone.firstGid > _plan.endGid()));
+                    const bool isInScope =
+                        (!_plan.hasGidRange() || (zone.firstGid >= _plan.startGid() && zone.lastGid <= _plan.endGid())) &&
+                        std::none_of(skipGids.begin(), skipGids.end(), [&zone](gid_t skipGid) {
+                            return zone.firstGid <= skipGid && skipGid <= zone.lastGid;
+                        });
+
+                    if (!isOutOfScope && isInScope && pendingTargetCacheRefresh) {
+                        rowCluster.refreshTargetCache(cachedResolver);
+                        pendingTargetCacheRefresh = false;
+                    }
+
+                    if (isOutOfScope || (isInScope && canSkipZone(zone))) {
+                        if (!isOutOfScope) {
+                            result.totalCount += database->second.first;
+                            result.totalQueryCount += database->second.second;
+                            candidateIndex += database->second.first;
+                        }
+
+                        skippedZones++;
+                        reader.seek(zone.endPos);
+                        continue;
+                    }
+                }
+            }
+
+            // 요약이 없는 트랜잭션 (statelogd가 요약을 다 쓰기 전에 멈춘 경우 등)은 본문을 디코딩한다
+            const auto *summary = summaryReader != nullptr ? summaryReader->advanceTo(gid) : nullptr;
+
+            std::shared_ptr<Transaction> transaction;
+            if (summary == nullptr) {
+                reader.nextTransaction();
+                transaction = reader.txnBody();
+            }
+
+            const bool isInScope = summary != nullptr ?
+                summaryReader->isRelatedToDatabase(*summary, _plan.dbName()) && isGidInScope(_plan, skipGids, gid) :
+                isTransactionInScope(_plan, skipGids, gid, *transaction);
+
+            if (!isInScope) {
+                if (summary != nullptr) {
+                    reader.skipTransaction();
+                }
                 continue;
             }
 
             result.totalCount++;
-            size_t queryCount = transaction->queries().size();
+            size_t queryCount = summary != nullptr ? summary->queryCount : transaction->queries().size();
             result.totalQueryCount += queryCount;
             queryCounts.emplace(gid, queryCount);
 
-            if (relationshipResolver.addTransaction(*transaction)) {
+            if (transaction != nullptr && relationshipResolver.addTransaction(*transaction)) {
                 cachedResolver.clearCache();
             }
 
-            auto txnColumns = analysis::TaintAnalyzer::collectColumnRW(*transaction);
+            auto txnColumns = summary != nullptr ?
+                analysis::TaintAnalyzer::collectColumnRW(*summary, *summaryReader) :
+                analysis::TaintAnalyzer::collectColumnRW(*transaction);
             ColumnSet txnAccess = txnColumns.read;
             txnAccess.insert(txnColumns.write.begin(), txnColumns.write.end());
 
@@ -355,7 +562,19 @@ namespace ultraverse::state::v2 {
             auto userQueryOpt = userQueryPath ? userQueryPath(gid) : std::nullopt;
             candidateIndex++;
 
+            if (summary != nullptr) {
+                // 본문은 rollback / prepend 대상에만 필요하다
+                if (rollbackTarget || userQueryOpt.has_value()) {
+                    reader.nextTransaction();
+                    transaction = reader.txnBody();
+                } else {
+                    reader.skipTransaction();
+                }
+            }
+
             if (rollbackTarget || userQueryOpt.has_value()) {
+                isTargetRangesStale = true;
+
                 if (rollbackTarget) {
                     rowCluster.addRollbackTarget(transaction, cachedResolver, shouldRevalidateTarget(gid));
                     columnTaint.insert(txnColumns.write.begin(), txnColumns.write.end());
@@ -406,7 +625,9 @@ namespace ultraverse::state::v2 {
             }
 
             bool isColumnDependent = analysis::TaintAnalyzer::columnSetsRelated(columnTaint, txnAccess, _context->foreignKeys);
-            bool hasKeyColumns = analysis::TaintAnalyzer::hasKeyColumnItems(*transaction, rowCluster, cachedResolver);
+            bool hasKeyColumns = summary != nullptr ?
+                analysis::TaintAnalyzer::hasKeyColumnItems(*summary, *summaryReader, rowCluster, cachedResolver) :
+                analysis::TaintAnalyzer::hasKeyColumnItems(*transaction, rowCluster, cachedResolver);
 
             if (isColumnDependent) {
                 columnTaint.insert(txnColumns.write.begin(), txnColumns.write.end());
@@ -462,6 +683,10 @@ namespace ultraverse::state::v2 {
 
         taskExecutor.shutdown();
 
+        if (zoneMap != nullptr) {
+            _logger->info("analyzeReplayPlan(): skipped {} / {} zones", skippedZones, zoneMap->zones().size());
+        }
+
         std::sort(result.replayGids.begin(), result.replayGids.end());
         result.replayGids.erase(std::unique(result.replayGids.begin(), result.replayGids.end()),
                                 result.replayGids.end());
@@ -480,6 +705,220 @@ namespace ultraverse::state::v2 {
         return result;
     }
 
+    void StateChanger::loadCluster(StateCluster &rowCluster, StateRelationshipResolver &relationshipResolver,
+                                   bool hasKnownTargets) {
+        if (_plan.useKeyIndex()) {
+            if (!hasKnownTargets) {
+                // 대상은 분석 중에 정해지므로, 대상에서 시작해 필요한 posting만 찾아 읽을 수 없다
+                _logger->info("loadCluster(): rollback targets are not known in advance; not using key index");
+            } else {
+                rowCluster.normalizeWithResolver(relationshipResolver);
+
+                if (loadClusterFromKeyIndex(rowCluster, relationshipResolver)) {
+                    return;
+                }
+            }
+        }
+
+        _clusterStore->load(rowCluster);
+        rowCluster.normalizeWithResolver(relationshipResolver);
+    }
+
+    bool StateChanger::loadClusterFromKeyIndex(StateCluster &rowCluster, StateRelationshipResolver &relationshipResolver) {
+        if (!_plan.columnAliases().empty()) {
+            // row alias는 로그를 순서대로 읽어야 해결할 수 있다
+            _logger->info("loadClusterFromKeyIndex(): row-alias enabled; falling back to cluster store");
+            return false;
+        }
+
+        const auto &keyColumnGroups = _plan.keyColumnGroups();
+        if (std::any_of(keyColumnGroups.begin(), keyColumnGroups.end(), [](const auto &group) { return group.size() > 1; })) {
+            // composite key group은 일부 컬럼만 접근한 트랜잭션이 나머지 컬럼에 wildcard로 들어가므로, 컬럼별로 찾을 수 없다
+            _logger->info("loadClusterFromKeyIndex(): composite key column group; falling back to cluster store");
+            return false;
+        }
+
+        if (!StateKeyIndexReader::exists(_plan.stateLogPath(), _plan.stateLogName())) {
+            _logger->warn("loadClusterFromKeyIndex(): key index not found; falling back to cluster store");
+            return false;
+        }
+
+        StateKeyIndexReader keyIndex(_plan.stateLogPath(), _plan.stateLogName());
+
+        // statelogd는 트랜잭션을 run 단위로 모아 쓰므로, 실행 중이면 마지막 트랜잭션들이 아직 색인되지 않았을 수 있다.
+        // 색인되지 않은 트랜잭션은 posting으로 찾을 수 없으므로 클러스터가 빠짐없이 만들어지지 않는다
+        const auto lastIndexedGid = keyIndex.lastGid();
+        const auto &rollbackGids = _plan.rollbackGids();
+        if (!lastIndexedGid.has_value() ||
+            std::any_of(rollbackGids.begin(), rollbackGids.end(), [&](gid_t gid) { return gid > *lastIndexedGid; }) ||
+            hasTransactionsAfter(*lastIndexedGid)) {
+            _logger->info("loadClusterFromKeyIndex(): key index does not cover the whole state log; falling back to cluster store");
+            return false;
+        }
+
+        const auto &keyColumns = rowCluster.keyColumns();
+
+        // StateCluster::extractItems()와 같은 방식으로 컬럼이 속하는 키 컬럼을 찾는다
+        auto resolveKeyColumn = [&relationshipResolver, &keyColumns](const std::string &column) {
+            auto realColumn = utility::toLower(relationshipResolver.resolveChain(column));
+            if (realColumn.empty()) {
+                realColumn = utility::toLower(column);
+            }
+
+            return keyColumns.find(realColumn) != keyColumns.end() ? realColumn : std::string();
+        };
+
+        // 키 컬럼 -> 그 키 컬럼으로 해결되는 (인덱스에 기록된) 컬럼들
+        std::map<std::string, std::vector<std::string>> sourceColumns;
+        for (const auto &column : keyIndex.observedColumns()) {
+            auto keyColumn = resolveKeyColumn(column);
+            if (keyColumn.empty()) {
+                continue;
+            }
+
+            if (keyIndex.indexedColumns().find(column) == keyIndex.indexedColumns().end()) {
+                _logger->warn("loadClusterFromKeyIndex(): {} is not indexed; falling back to cluster store", column);
+                return false;
+            }
+
+            sourceColumns[keyColumn].push_back(column);
+        }
+
+        /*
+         * rollback / prepend 대상이 접근하는 범위에서 시작한다.
+         * shouldReplay()는 대상의 범위와 겹치는 (병합된) 클러스터 범위만 보므로, 그 범위를 이루는 트랜잭션만 읽으면 된다.
+         */
+        std::map<std::string, std::vector<StateRange>> seeds;
+
+        for (auto gid : _plan.rollbackGids()) {
+            keyIndex.forEachPostingOf(gid, [&](StateCluster::ClusterType, const std::string &column,
+                                               const StateRange &range, const std::vector<gid_t> &) {
+                auto keyColumn = resolveKeyColumn(column);
+                if (!keyColumn.empty()) {
+                    seeds[keyColumn].push_back(range);
+                }
+            });
+        }
+
+        for (const auto &pair : _plan.userQueries()) {
+            auto userQuery = loadUserQuery(pair.second);
+            if (userQuery == nullptr) {
+                _logger->warn("loadClusterFromKeyIndex(): failed to load user query {}; falling back to cluster store", pair.second);
+                return false;
+            }
+
+            auto collect = [&](CombinedIterator<StateItem> it) {
+                const auto end = it.end();
+                for (; it != end; ++it) {
+                    const auto &item = *it;
+                    auto keyColumn = resolveKeyColumn(item.name);
+                    if (!keyColumn.empty()) {
+                        seeds[keyColumn].push_back(item.MakeRange2());
+                    }
+                }
+            };
+            collect(userQuery->readSet_begin());
+            collect(userQuery->writeSet_begin());
+        }
+
+        std::unordered_map<gid_t, bool> isRelated;
+        auto isRelatedGid = [&](gid_t gid) {
+            auto it = isRelated.find(gid);
+            if (it == isRelated.end()) {
+                it = isRelated.emplace(gid, keyIndex.hasDatabase(gid, _plan.dbName())).first;
+            }
+            return it->second;
+        };
+
+        // 한 트랜잭션이 키 컬럼에 접근한 범위는 하나로 합쳐 클러스터에 들어가므로, 범위 전체를 읽는다
+        auto rangeOf = [&](gid_t gid, StateCluster::ClusterType type, const std::string &keyColumn) {
+            std::map<std::string, StateRange> ranges;
+            keyIndex.forEachPostingOf(gid, [&](StateCluster::ClusterType postingType, const std::string &column,
+                                               const StateRange &range, const std::vector<gid_t> &) {
+                if (postingType == type && resolveKeyColumn(column) == keyColumn) {
+                    mergeKeyIndexRange(ranges, keyColumn, range);
+                }
+            });
+            return ranges;
+        };
+
+        /*
+         * frontier와 겹치는 posting을 찾고, 새로 찾은 트랜잭션의 범위를 다시 frontier로 삼아 더 이상 늘지 않을 때까지 반복한다.
+         * (Cluster::merge()가 만드는 병합된 범위와 같다)
+         */
+        auto expand = [&](StateCluster::ClusterType type, const std::string &keyColumn,
+                          std::vector<StateRange> frontier, std::vector<StateRange> *visitedRanges) {
+            std::unordered_set<gid_t> visited;
+            size_t count = 0;
+
+            while (!frontier.empty()) {
+                std::vector<StateRange> next;
+
+                for (const auto &column : sourceColumns[keyColumn]) {
+                    for (const auto &range : frontier) {
+                        for (auto gid : keyIndex.find(type, column, range)) {
+                            if (!visited.insert(gid).second || !isRelatedGid(gid)) {
+                                continue;
+                            }
+
+                            auto ranges = rangeOf(gid, type, keyColumn);
+                            if (ranges.empty()) {
+                                continue;
+                            }
+
+                            rowCluster.insert(type, ranges, gid);
+                            next.push_back(ranges.begin()->second);
+                            count++;
+                        }
+                    }
+                }
+
+                if (visitedRanges != nullptr) {
+                    visitedRanges->insert(visitedRanges->end(), next.begin(), next.end());
+                }
+                frontier = std::move(next);
+            }
+
+            return count;
+        };
+
+        size_t writeCount = 0;
+        size_t readCount = 0;
+
+        for (auto &pair : seeds) {
+            const auto &keyColumn = pair.first;
+
+            // cache.read는 대상과 겹치는 WRITE 범위와 겹치는 READ 범위이므로, WRITE 쪽에서 찾은 범위도 READ의 시작점이 된다
+            std::vector<StateRange> readSeeds = pair.second;
+            writeCount += expand(StateCluster::WRITE, keyColumn, pair.second, &readSeeds);
+            readCount += expand(StateCluster::READ, keyColumn, std::move(readSeeds), nullptr);
+        }
+
+        rowCluster.merge();
+
+        _logger->info("loadClusterFromKeyIndex(): built cluster from {} write / {} read postings ({} / {} runs read)",
+                      writeCount, readCount, keyIndex.loadedRunCount(), keyIndex.runCount());
+        return true;
+    }
+
+    bool StateChanger::hasTransactionsAfter(gid_t gid) {
+        // gid를 찾지 못하면 로그와 맞지 않으므로, 뒤에 트랜잭션이 있다고 본다
+        bool hasTransactions = true;
+
+        _reader->open();
+        try {
+            if (_reader->seekGid(gid) && _reader->nextHeader() && _reader->txnHeader()->gid == gid) {
+                _reader->skipTransaction();
+                hasTransactions = _reader->nextHeader();
+            }
+        } catch (std::exception &e) {
+            _logger->warn("hasTransactionsAfter(): could not seek to gid #{}: {}", gid, e.what());
+        }
+        _reader->close();
+
+        return hasTransactions;
+    }
+
     void StateChanger::bench_prepareRollback() {
         StateChangeReport report(StateChangeReport::PREPARE_AUTO, _plan);
 
@@ -487,30 +926,31 @@ namespace ultraverse::state::v2 {
         StateRelationshipResolver relationshipResolver(_plan, *_context);
         CachedRelationshipResolver cachedResolver(relationshipResolver, 1000);
 
-        {
-            _logger->info("prepare(): loading cluster");
-            _clusterStore->load(rowCluster);
-            _logger->info("prepare(): loading cluster end");
-        }
-
         {
             auto dbHandle = _dbHandlePool.take();
             updatePrimaryKeys(dbHandle->get(), 0, _plan.dbName());
             updateForeignKeys(dbHandle->get(), 0, _plan.dbName());
         }
-        rowCluster.normalizeWithResolver(relationshipResolver);
+
+        {
+            // key index를 쓰려면 foreign key가 먼저 로드되어 있어야 한다
+            _logger->info("prepare(): loading cluster");
+            loadCluster(rowCluster, relationshipResolver, false);
+            _logger->info("prepare(): loading cluster end");
+        }
 
         std::unordered_set<gid_t> skipGids(_plan.skipGids().begin(), _plan.skipGids().end());
 
-        _reader->open();
-        _reader->seek(0);
+        auto &reader = scanReader();
+        reader.open();
+        reader.seek(0);
 
         size_t totalCount = 0;
-        while (_reader->nextHeader()) {
-            auto header = _reader->txnHeader();
+        while (reader.nextHeader()) {
+            auto header = reader.txnHeader();
             gid_t gid = header->gid;
-            _reader->nextTransaction();
-            auto transaction = _reader->txnBody();
+            reader.nextTransaction();
+            auto transaction = reader.txnBody();
 
             if (!isTransactionInScope(_plan, skipGids, gid, *transaction)) {
                 continue;
@@ -620,10 +1060,9 @@ namespace ultraverse::state::v2 {
 
         {
             _logger->info("prepare(): loading cluster");
-            _clusterStore->load(rowCluster);
+            loadCluster(rowCluster, relationshipResolver, true);
             _logger->info("prepare(): loading cluster end");
         }
-        rowCluster.normalizeWithResolver(relationshipResolver);
 
         auto phase_main_start = std::chrono::steady_clock::now();
 
@@ -642,6 +1081,15 @@ namespace ultraverse::state::v2 {
             return !_plan.isRollbackGid(nextGid) && !_plan.hasUserQuery(nextGid);
         };
 
+        std::set<gid_t> targetGids(_plan.rollbackGids().begin(), _plan.rollbackGids().end());
+        for (const auto &pair : _plan.userQueries()) {
+            targetGids.insert(pair.first);
+        }
+        auto hasTargetInRange = [&targetGids](gid_t firstGid, gid_t lastGid) {
+            auto it = targetGids.lower_bound(firstGid);
+            return it != targetGids.end() && *it <= lastGid;
+        };
+
         auto analysis = analyzeReplayPlan(
             rowCluster,
             relationshipResolver,
@@ -649,7 +1097,8 @@ namespace ultraverse::state::v2 {
             &replayPlan,
             isRollbackTarget,
             userQueryPath,
-            shouldRevalidate
+            shouldRevalidate,
+            hasTargetInRange
         );
 
         {
@@ -663,6 +1112,13 @@ namespace ultraverse::state::v2 {
         replayPlan.rollbackGids.erase(std::unique(replayPlan.rollbackGids.begin(), replayPlan.rollbackGids.end()),
                                       replayPlan.rollbackGids.end());
 
+        // 분석하지 못한 구간을 replay plan에 남겨, replay 단계에서도 알 수 있게 한다
+        if (auto *segmentedReader = dynamic_cast<SegmentedStateLogReader *>(_reader.get())) {
+            for (const auto &segment : segmentedReader->missingSegments()) {
+                replayPlan.missingGidRanges.emplace_back(segment.firstGid, segment.lastGid);
+            }
+        }
+
         report.setReplayGidCount(analysis.replayGids.size());
         report.setTotalCount(analysis.totalCount);
         report.setExecutionTime(_phase2Time);
@@ -3,8 +3,11 @@
 //
 
 #include <algorithm>
+#include <condition_variable>
 #include <sstream>
 
+#include <poll.h>
+
 #include <fmt/color.h>
 
 #include "graph/RowGraph.hpp"
@@ -15,6 +18,47 @@
 #include "utils/StringUtil.hpp"
 
 namespace ultraverse::state::v2 {
+    namespace {
+        /** @brief 그래프에 동시에 쌓아둘 수 있는 미완료 트랜잭션 수 */
+        constexpr uint64_t kReplayWindowSize = 4000;
+        constexpr auto kReplayGCInterval = std::chrono::milliseconds(10000);
+
+        /**
+         * @brief 로그 구간 안에서 replay 대상이 이 비율 이상이면 순차 스캔한다.
+         * @details 대상 하나를 seek하는 비용을 트랜잭션 수십 개를 순차로 읽는 비용 정도로 본다.
+         */
+        constexpr double kReplayScanDensity = 0.05;
+        /** @brief 순차 스캔할 때 상태 로그 스트림의 버퍼 크기 */
+        constexpr size_t kReplayScanReadAhead = 8 * 1024 * 1024;
+
+        bool shouldScanReplayGids(const StateChangePlan &plan, const std::vector<gid_t> &gids) {
+            if (gids.empty() || !std::is_sorted(gids.begin(), gids.end())) {
+                return false;
+            }
+
+            switch (plan.replayFeederMode()) {
+                case ReplayFeederMode::SEEK:
+                    return false;
+                case ReplayFeederMode::SCAN:
+                    return true;
+                case ReplayFeederMode::AUTO:
+                default:
+                    break;
+            }
+
+            const double span = static_cast<double>(gids.back() - gids.front()) + 1;
+            return static_cast<double>(gids.size()) / span >= kReplayScanDensity;
+        }
+
+        /** @brief RowGraph 샤드 워커 풀 크기 (0이면 키 컬럼마다 전용 스레드) */
+        size_t rowGraphWorkerShards(const StateChangePlan &plan) {
+            if (!plan.shardedRowGraphWorkers()) {
+                return 0;
+            }
+            return std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+    }
+
     void StateChanger::replay() {
         StateChangeReport report(StateChangeReport::EXECUTE, _plan);
         
@@ -26,6 +70,10 @@ namespace ultraverse::state::v2 {
         _plan.setReplaceQueries(replayPlan.replaceQueries);
         _logger->info("replay(): loaded replay plan from {} ({} gids, {} user queries)",
                       replayPlanPath, replayPlan.gids.size(), replayPlan.userQueries.size());
+        for (const auto &range : replayPlan.missingGidRanges) {
+            _logger->warn("replay(): gid {} - {} was missing from the state log when the plan was prepared",
+                          range.first, range.second);
+        }
 
         gid_t firstTargetGid = 0;
         bool hasTargetGid = false;
@@ -77,97 +125,11 @@ namespace ultraverse::state::v2 {
 
             _logger->info("replay(): pre-replay range {}..{}", startGid, endGid);
 
-            StateRelationshipResolver preResolver(_plan, *_context);
-            CachedRelationshipResolver preCachedResolver(preResolver, 8000);
-
-            RowGraph preGraph(_plan.keyColumns(), preCachedResolver, _plan.keyColumnGroups());
-            preGraph.setRangeComparisonMethod(_plan.rangeComparisonMethod());
-
-            std::atomic_bool preRunning = true;
-            std::atomic_uint64_t preReplayedTxns = 0;
-
-            _reader->open();
-            if (!_reader->seekGid(startGid)) {
-                _logger->warn("replay(): pre-replay start gid #{} not found in state log", startGid);
-                _reader->close();
-                return;
-            }
-
-            std::thread feeder([&]() {
-                uint64_t added = 0;
-                while (_reader->nextHeader()) {
-                    auto header = _reader->txnHeader();
-                    if (!header) {
-                        break;
-                    }
-                    if (header->gid < startGid) {
-                        _reader->skipTransaction();
-                        continue;
-                    }
-                    if (header->gid > endGid) {
-                        break;
-                    }
-
-                    while (added - preReplayedTxns.load() > 4000) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / 60));
-                    }
-
-                    _reader->nextTransaction();
-                    const auto transaction = _reader->txnBody();
-
-                    if (!transaction || !transaction->isRelatedToDatabase(_plan.dbName())) {
-                        continue;
-                    }
-
-                    if (preResolver.addTransaction(*transaction)) {
-                        preCachedResolver.clearCache();
-                    }
-
-                    auto nodeId = preGraph.addNode(transaction);
-                    if (++added % 1000 == 0) {
-                        auto gid = header->gid;
-                        _logger->info("replay(): pre-replay transaction #{} added as node #{}; {} / {} executed",
-                                      gid, nodeId, (int) preReplayedTxns.load(), added);
-                    }
-                }
+            auto replayed = replayLogRange(startGid, endGid, [this](const Transaction &transaction) {
+                return transaction.isRelatedToDatabase(_plan.dbName());
             });
 
-            std::thread gcThread([&]() {
-                while (preRunning) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10000));
-                    preGraph.gc();
-                }
-            });
-
-            std::vector<std::thread> workerThreads;
-            for (int i = 0; i < _plan.threadNum(); i++) {
-                workerThreads.emplace_back(&StateChanger::replayThreadMain, this, i, std::ref(preGraph),
-                                           std::ref(preRunning), std::ref(preReplayedTxns));
-            }
-
-            if (feeder.joinable()) {
-                feeder.join();
-            }
-
-            _reader->close();
-
-            while (!preGraph.isFinalized()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
-
-            preRunning = false;
-
-            for (auto &thread : workerThreads) {
-                if (thread.joinable()) {
-                    thread.join();
-                }
-            }
-
-            if (gcThread.joinable()) {
-                gcThread.join();
-            }
-
-            _logger->info("replay(): pre-replay finished ({} transactions)", (uint64_t) preReplayedTxns.load());
+            _logger->info("replay(): pre-replay finished ({} transactions)", replayed);
         };
 
         if (_plan.hasReplayFromGid()) {
@@ -185,27 +147,80 @@ namespace ultraverse::state::v2 {
         StateRelationshipResolver relationshipResolver(_plan, *_context);
         CachedRelationshipResolver cachedResolver(relationshipResolver, 8000);
 
-        RowGraph rowGraph(_plan.keyColumns(), cachedResolver, _plan.keyColumnGroups());
+        RowGraph rowGraph(_plan.keyColumns(), cachedResolver, _plan.keyColumnGroups(),
+                          rowGraphWorkerShards(_plan));
         rowGraph.setRangeComparisonMethod(_plan.rangeComparisonMethod());
+        rowGraph.setCompactStorageEnabled(_plan.compactRowGraph());
+        rowGraph.setReadyQueueEnabled(_plan.readyQueueScheduler());
+        rowGraph.setIncrementalGCEnabled(_plan.incrementalGC());
 
         this->_isRunning = true;
         this->_replayedTxns = 0;
 
+        const bool scanReplayGids = shouldScanReplayGids(_plan, replayPlan.gids);
+        if (!scanReplayGids && _plan.replayFeederMode() == ReplayFeederMode::SCAN) {
+            _logger->warn("replay(): replay plan gids are not sorted; falling back to per-gid seek");
+        }
+        _logger->info("replay(): feeding replay plan by {}", scanReplayGids ? "sequential scan" : "per-gid seek");
+
         std::thread replayThread([&]() {
             int i = 0;
             
+            _reader->setReadAheadSize(scanReplayGids ? kReplayScanReadAhead : 0);
             _reader->open();
 
+            // 순차 스캔 중, 아직 처리하지 않은 (다음 대상보다 뒤에 있는) 트랜잭션의 헤더를 읽어 두었는지 여부
+            bool hasPendingHeader = false;
+            if (scanReplayGids && !_reader->seekGid(replayPlan.gids.front())) {
+                _reader->seek(0);
+            }
+
+            /**
+             * @brief replay 대상 트랜잭션을 읽는다. 로그에 없으면 nullptr를 반환한다.
+             */
+            auto readTransaction = [&](gid_t gid) -> std::shared_ptr<Transaction> {
+                if (!scanReplayGids) {
+                    if (!_reader->seekGid(gid)) {
+                        return nullptr;
+                    }
+                    _reader->nextHeader();
+                    _reader->nextTransaction();
+                    return _reader->txnBody();
+                }
+
+                while (hasPendingHeader || _reader->nextHeader()) {
+                    hasPendingHeader = false;
+
+                    auto header = _reader->txnHeader();
+                    if (header == nullptr) {
+                        break;
+                    }
+                    if (header->gid < gid) {
+                        _reader->skipTransaction();
+                        continue;
+                    }
+                    if (header->gid > gid) {
+                        hasPendingHeader = true;
+                        return nullptr;
+                    }
+
+                    _reader->nextTransaction();
+                    return _reader->txnBody();
+                }
+
+                return nullptr;
+            };
+
             auto userIt = replayPlan.userQueries.begin();
             auto userEnd = replayPlan.userQueries.end();
 
-            auto addUserQueryNode = [&](gid_t userGid, const Transaction &userTxn) -> RowGraphId {
+            auto addUserQueryNode = [&](gid_t userGid, const Transaction &userTxn, bool hold = false) -> RowGraphId {
                 auto txnPtr = std::make_shared<Transaction>(userTxn);
                 txnPtr->setGid(userGid);
                 if (relationshipResolver.addTransaction(*txnPtr)) {
                     cachedResolver.clearCache();
                 }
-                auto nodeId = rowGraph.addNode(txnPtr);
+                auto nodeId = rowGraph.addNode(txnPtr, hold);
                 if (i++ % 1000 == 0) {
                     _logger->info("replay(): user query for gid #{} added as node #{}; {} / {} executed",
                                   userGid, nodeId, (int) _replayedTxns, i);
@@ -215,36 +230,30 @@ namespace ultraverse::state::v2 {
 
             for (gid_t gid : replayPlan.gids) {
                 while (userIt != userEnd && userIt->first < gid) {
-                    while (i - _replayedTxns > 4000) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / 60));
-                    }
+                    rowGraph.waitForCapacity(kReplayWindowSize);
                     addUserQueryNode(userIt->first, userIt->second);
                     ++userIt;
                 }
 
                 RowGraphId prependNodeId = nullptr;
                 if (userIt != userEnd && userIt->first == gid) {
-                    while (i - _replayedTxns > 4000) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / 60));
-                    }
-                    prependNodeId = addUserQueryNode(userIt->first, userIt->second);
+                    rowGraph.waitForCapacity(kReplayWindowSize);
+                    // 대상 트랜잭션과 간선을 잇기 전에 처리 / 회수되지 않도록 hold 한다.
+                    prependNodeId = addUserQueryNode(userIt->first, userIt->second, true);
                     ++userIt;
                 }
 
-                while (i - _replayedTxns > 4000) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1000 / 60));
-                }
+                rowGraph.waitForCapacity(kReplayWindowSize);
 
-                if (!_reader->seekGid(gid)) {
+                const auto transaction = readTransaction(gid);
+                if (transaction == nullptr) {
                     _logger->warn("replay(): gid #{} not found in state log", gid);
+                    if (prependNodeId != nullptr) {
+                        rowGraph.releaseNode(prependNodeId);
+                    }
                     continue;
                 }
 
-                _reader->nextHeader();
-                _reader->nextTransaction();
-
-                const auto transaction = _reader->txnBody();
-
                 if (relationshipResolver.addTransaction(*transaction)) {
                     cachedResolver.clearCache();
                 }
@@ -253,6 +262,7 @@ namespace ultraverse::state::v2 {
                 auto nodeId = rowGraph.addNode(transaction, holdTarget);
                 if (prependNodeId != nullptr) {
                     rowGraph.addEdge(prependNodeId, nodeId);
+                    rowGraph.releaseNode(prependNodeId);
                     rowGraph.releaseNode(nodeId);
                 }
 
@@ -263,42 +273,41 @@ namespace ultraverse::state::v2 {
             }
 
             while (userIt != userEnd) {
-                while (i - _replayedTxns > 4000) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1000 / 60));
-                }
+                rowGraph.waitForCapacity(kReplayWindowSize);
                 addUserQueryNode(userIt->first, userIt->second);
                 ++userIt;
             }
         });
         
+        std::mutex gcMutex;
+        std::condition_variable gcCv;
         std::thread gcThread([&]() {
-            while (_isRunning) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10000));
-                
+            std::unique_lock<std::mutex> lock(gcMutex);
+            while (!gcCv.wait_for(lock, kReplayGCInterval, [this]() { return !_isRunning; })) {
+                lock.unlock();
                 // _logger->info("replay(): GC thread running...");
                 rowGraph.gc();
+                lock.lock();
             }
         });
         
-        std::vector<std::thread> workerThreads;
-        
         auto phase_main_start = std::chrono::steady_clock::now();
         _logger->info("replay(): executing replay plan...");
 
-        for (int i = 0; i < _plan.threadNum(); i++) {
-            workerThreads.emplace_back(&StateChanger::replayThreadMain, this, i, std::ref(rowGraph),
-                                       std::ref(_isRunning), std::ref(_replayedTxns));
-        }
+        auto workerThreads = startReplayWorkers(rowGraph, _isRunning, _replayedTxns);
         
         if (replayThread.joinable()) {
             replayThread.join();
         }
         
-        while (!rowGraph.isFinalized()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
+        rowGraph.waitUntilAllFinalized();
         
-        _isRunning = false;
+        {
+            std::lock_guard<std::mutex> lock(gcMutex);
+            _isRunning = false;
+        }
+        gcCv.notify_all();
+        rowGraph.closeReadyQueue();
         
         for (auto &thread: workerThreads) {
             if (thread.joinable()) {
@@ -383,6 +392,108 @@ namespace ultraverse::state::v2 {
         // dropIntermediateDB();
     }
     
+    uint64_t StateChanger::replayLogRange(gid_t startGid, gid_t endGid,
+                                          const std::function<bool(const Transaction &)> &filter) {
+        StateRelationshipResolver resolver(_plan, *_context);
+        CachedRelationshipResolver cachedResolver(resolver, 8000);
+
+        RowGraph rowGraph(_plan.keyColumns(), cachedResolver, _plan.keyColumnGroups(),
+                          rowGraphWorkerShards(_plan));
+        rowGraph.setRangeComparisonMethod(_plan.rangeComparisonMethod());
+        rowGraph.setCompactStorageEnabled(_plan.compactRowGraph());
+        rowGraph.setReadyQueueEnabled(_plan.readyQueueScheduler());
+        rowGraph.setIncrementalGCEnabled(_plan.incrementalGC());
+
+        std::atomic_bool running = true;
+        std::atomic_uint64_t replayedTxns = 0;
+
+        _reader->setReadAheadSize(kReplayScanReadAhead);
+        _reader->open();
+        // gid 0부터라면 인덱스 없이 처음부터 읽는다
+        if (startGid > 0 && !_reader->seekGid(startGid)) {
+            _logger->warn("replayLogRange(): start gid #{} not found in state log", startGid);
+            _reader->close();
+            return 0;
+        }
+
+        std::thread feeder([&]() {
+            uint64_t added = 0;
+            while (_reader->nextHeader()) {
+                auto header = _reader->txnHeader();
+                if (!header) {
+                    break;
+                }
+                if (header->gid < startGid) {
+                    _reader->skipTransaction();
+                    continue;
+                }
+                if (header->gid > endGid) {
+                    break;
+                }
+
+                rowGraph.waitForCapacity(kReplayWindowSize);
+
+                _reader->nextTransaction();
+                const auto transaction = _reader->txnBody();
+
+                if (!transaction || !filter(*transaction)) {
+                    continue;
+                }
+
+                if (resolver.addTransaction(*transaction)) {
+                    cachedResolver.clearCache();
+                }
+
+                auto nodeId = rowGraph.addNode(transaction);
+                if (++added % 1000 == 0) {
+                    auto gid = header->gid;
+                    _logger->info("replayLogRange(): transaction #{} added as node #{}; {} / {} executed",
+                                  gid, nodeId, (int) replayedTxns.load(), added);
+                }
+            }
+        });
+
+        std::mutex gcMutex;
+        std::condition_variable gcCv;
+        std::thread gcThread([&]() {
+            std::unique_lock<std::mutex> lock(gcMutex);
+            while (!gcCv.wait_for(lock, kReplayGCInterval, [&]() { return !running; })) {
+                lock.unlock();
+                rowGraph.gc();
+                lock.lock();
+            }
+        });
+
+        auto workerThreads = startReplayWorkers(rowGraph, running, replayedTxns);
+
+        if (feeder.joinable()) {
+            feeder.join();
+        }
+
+        _reader->close();
+
+        rowGraph.waitUntilAllFinalized();
+
+        {
+            std::lock_guard<std::mutex> lock(gcMutex);
+            running = false;
+        }
+        gcCv.notify_all();
+        rowGraph.closeReadyQueue();
+
+        for (auto &thread : workerThreads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+
+        if (gcThread.joinable()) {
+            gcThread.join();
+        }
+
+        return replayedTxns.load();
+    }
+    
     void StateChanger::replayThreadMain(int workerId,
                                         RowGraph &rowGraph,
                                         std::atomic_bool &running,
@@ -391,10 +502,9 @@ namespace ultraverse::state::v2 {
         logger->info("thread started");
         
         while (running) {
-            auto nodeId = rowGraph.entrypoint(workerId);
+            auto nodeId = rowGraph.waitEntrypoint(workerId, std::chrono::milliseconds(100));
             
             if (nodeId == nullptr) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(5));
                 continue;
             }
             
@@ -406,6 +516,7 @@ namespace ultraverse::state::v2 {
 
                 const auto transaction = std::atomic_load(&node->transaction);
                 if (!transaction) {
+                    rowGraph.markFinalized(nodeId);
                     goto NEXT_LOOP;
                 }
                 
@@ -432,6 +543,26 @@ namespace ultraverse::state::v2 {
                     
                     logger->info("replaying transaction #{}", transaction->gid());
                     
+                    // CALL은 result set을 여러 개 반환해 batch 안에서 실패한 구문을 특정할 수 없으므로 하나씩 실행한다
+                    if (_plan.replayStatementBatching() && !isProcedureCall) {
+                        try {
+                            const auto statements = replayStatements(*transaction);
+                            size_t offset = 0;
+                            
+                            // 실패한 구문은 로그만 남기고, 기존 경로처럼 나머지 구문을 이어서 실행한다
+                            while ((offset = handle.executeBatch(statements, offset)) < statements.size()) {
+                                logger->error("query execution failed: {} / {}", handle.lastError(), statements[offset]);
+                                offset++;
+                            }
+                        } catch (std::exception &e) {
+                            logger->error("exception occurred while replaying transaction #{}: {}", transaction->gid(),
+                                          e.what());
+                            handle.executeQuery("ROLLBACK");
+                        }
+                        
+                        goto FINALIZE;
+                    }
+                    
                     handle.executeQuery("SET autocommit=0");
                     handle.executeQuery("START TRANSACTION");
                     
@@ -463,6 +594,7 @@ namespace ultraverse::state::v2 {
                     }
                 }
                 
+                FINALIZE:
                 replayedTxns++;
                 
                 /*
@@ -486,7 +618,7 @@ namespace ultraverse::state::v2 {
                  */
                 
                 
-                node->finalized = true;
+                rowGraph.markFinalized(nodeId);
                 std::atomic_store(&node->transaction, std::shared_ptr<Transaction>{});
             }
             
@@ -495,4 +627,173 @@ namespace ultraverse::state::v2 {
         }
     
     }
+    
+    std::vector<std::thread> StateChanger::startReplayWorkers(RowGraph &rowGraph,
+                                                              std::atomic_bool &running,
+                                                              std::atomic_uint64_t &replayedTxns) {
+        std::vector<std::thread> workerThreads;
+        
+        const int poolSize = std::max(1, _dbHandlePool.poolSize());
+        const int pipelineDepth = std::min(_plan.replayPipelineDepth(), poolSize);
+        
+        if (pipelineDepth <= 1) {
+            for (int i = 0; i < _plan.threadNum(); i++) {
+                workerThreads.emplace_back(&StateChanger::replayThreadMain, this, i, std::ref(rowGraph),
+                                           std::ref(running), std::ref(replayedTxns));
+            }
+            return workerThreads;
+        }
+        
+        // 워커 하나가 커넥션을 최대 pipelineDepth개까지 잡고 있으므로,
+        // 전체 커넥션 수가 풀 크기를 넘어 take()에서 서로 기다리지 않도록 워커 수를 줄인다.
+        const int workerCount = std::max(1, std::min(_plan.threadNum(), poolSize) / pipelineDepth);
+        _logger->info("replay(): using {} pipelined workers (depth {})", workerCount, pipelineDepth);
+        
+        for (int i = 0; i < workerCount; i++) {
+            workerThreads.emplace_back(&StateChanger::replayPipelinedThreadMain, this, i, std::ref(rowGraph),
+                                       std::ref(running), std::ref(replayedTxns), pipelineDepth);
+        }
+        
+        return workerThreads;
+    }
+    
+    std::vector<std::string> StateChanger::replayStatements(Transaction &transaction) {
+        std::vector<std::string> statements { "SET autocommit=0", "START TRANSACTION" };
+        bool isProcedureCall = transaction.flags() & Transaction::FLAG_IS_PROCEDURE_CALL;
+        
+        for (const auto &query: transaction.queries()) {
+            bool isProcedureCallQuery = query->flags() & Query::FLAG_IS_PROCCALL_QUERY;
+            if (isProcedureCall && !isProcedureCallQuery) {
+                continue;
+            }
+            
+            auto contextStatements = statementContextQueries(*query);
+            std::move(contextStatements.begin(), contextStatements.end(), std::back_inserter(statements));
+            statements.push_back(query->statement());
+        }
+        
+        statements.emplace_back("COMMIT");
+        return statements;
+    }
+    
+    void StateChanger::replayPipelinedThreadMain(int workerId,
+                                                 RowGraph &rowGraph,
+                                                 std::atomic_bool &running,
+                                                 std::atomic_uint64_t &replayedTxns,
+                                                 int pipelineDepth) {
+        auto logger = createLogger(fmt::format("ReplayThread #{}", workerId));
+        logger->info("thread started (pipeline depth {})", pipelineDepth);
+        
+        struct InFlightTransaction {
+            RowGraphId nodeId = nullptr;
+            std::shared_ptr<RowGraphNode> node;
+            std::shared_ptr<Transaction> transaction;
+            std::unique_ptr<mariadb::DBHandleLeaseBase> dbHandle;
+            std::vector<std::string> statements;
+            size_t current = 0;
+        };
+        
+        /**
+         * @return 트랜잭션의 모든 구문이 끝났으면 true
+         */
+        auto advance = [&logger](InFlightTransaction &entry) {
+            auto &handle = entry.dbHandle->get();
+            
+            try {
+                while (true) {
+                    auto status = handle.pollQuery();
+                    if (status == mariadb::DBHandle::AsyncStatus::PENDING) {
+                        return false;
+                    }
+                    if (status == mariadb::DBHandle::AsyncStatus::FAILED) {
+                        logger->error("query execution failed: {} / {}", handle.lastError(), entry.statements[entry.current]);
+                    }
+                    
+                    if (++entry.current >= entry.statements.size()) {
+                        return true;
+                    }
+                    handle.startQuery(entry.statements[entry.current]);
+                }
+            } catch (std::exception &e) {
+                logger->error("exception occurred while replaying transaction #{}: {}", entry.transaction->gid(),
+                              e.what());
+                // 진행 중인 쿼리를 끝내지 않고 ROLLBACK을 보내면 commands out of sync가 나고, 망가진 커넥션이 풀로 돌아간다
+                handle.cancelQuery();
+                handle.executeQuery("ROLLBACK");
+                return true;
+            }
+        };
+        
+        std::vector<InFlightTransaction> inFlight;
+        inFlight.reserve(pipelineDepth);
+        
+        std::vector<pollfd> pollFds;
+        pollFds.reserve(pipelineDepth);
+        
+        while (running || !inFlight.empty()) {
+            // 1. 남는 자리만큼 ready 트랜잭션을 가져와 실행을 시작한다.
+            while (running && inFlight.size() < static_cast<size_t>(pipelineDepth)) {
+                const auto timeout = inFlight.empty() ? std::chrono::milliseconds(100) : std::chrono::milliseconds(0);
+                auto nodeId = rowGraph.waitEntrypoint(workerId, timeout);
+                if (nodeId == nullptr) {
+                    break;
+                }
+                
+                auto node = rowGraph.nodeFor(nodeId);
+                if (node == nullptr || node->finalized) {
+                    continue;
+                }
+                
+                auto transaction = std::atomic_load(&node->transaction);
+                if (!transaction) {
+                    rowGraph.markFinalized(nodeId);
+                    continue;
+                }
+                
+                logger->info("replaying transaction #{}", transaction->gid());
+                
+                InFlightTransaction entry;
+                entry.nodeId = nodeId;
+                entry.node = std::move(node);
+                entry.transaction = std::move(transaction);
+                entry.statements = replayStatements(*entry.transaction);
+                entry.dbHandle = _dbHandlePool.take();
+                entry.dbHandle->get().startQuery(entry.statements.front());
+                
+                inFlight.push_back(std::move(entry));
+            }
+            
+            if (inFlight.empty()) {
+                continue;
+            }
+            
+            // 2. 진행할 수 있는 만큼 진행하고, 끝난 트랜잭션은 finalize한다.
+            for (auto it = inFlight.begin(); it != inFlight.end();) {
+                if (!advance(*it)) {
+                    ++it;
+                    continue;
+                }
+                
+                replayedTxns++;
+                rowGraph.markFinalized(it->nodeId);
+                std::atomic_store(&it->node->transaction, std::shared_ptr<Transaction>{});
+                it = inFlight.erase(it);
+            }
+            
+            // 3. 아직 진행 중인 커넥션이 있으면 그 중 하나가 진행할 수 있게 될 때까지 잠깐 기다린다.
+            //    쿼리를 다 보내지 못한 커넥션은 응답이 아니라 소켓에 쓸 수 있게 되기를 기다린다.
+            pollFds.clear();
+            for (auto &entry : inFlight) {
+                auto &handle = entry.dbHandle->get();
+                const int fd = handle.socketDescriptor();
+                if (fd >= 0) {
+                    pollFds.push_back(pollfd { fd, handle.pollEvents(), 0 });
+                }
+            }
+            
+            if (!pollFds.empty()) {
+                ::poll(pollFds.data(), pollFds.size(), 10);
+            }
+        }
+    }
 }
@@ -0,0 +1,158 @@
+#include <algorithm>
+
+#include "ultraverse_state.pb.h"
+
+#include "StateColumnSummary.hpp"
+
+namespace {
+    /**
+     * @brief 프로세스가 바뀌어도 같은 값을 내는 StateData 해시 (FNV-1a)
+     * @note StateData::hash()는 std::hash에 의존하므로 파일에 남길 수 없다.
+     *       같은 값 (StateData::operator==)은 같은 해시를 갖는다.
+     */
+    uint64_t stableHash(const StateData &value) {
+        std::string bytes;
+        value.Get(bytes);
+
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        auto mix = [&hash](uint8_t byte) {
+            hash ^= byte;
+            hash *= 0x100000001b3ULL;
+        };
+
+        mix(static_cast<uint8_t>(value.Type()));
+        for (auto byte : bytes) {
+            mix(static_cast<uint8_t>(byte));
+        }
+
+        return hash;
+    }
+
+    bool isPoint(const StateRange::ST_RANGE &interval) {
+        return interval.begin.IsEqual() && interval.end.IsEqual() && interval.begin == interval.end;
+    }
+}
+
+namespace ultraverse::state::v2 {
+    void StateColumnSummary::add(const StateRange &range) {
+        if (isUnbounded) {
+            return;
+        }
+
+        const auto *intervals = range.GetRange();
+        if (range.wildcard() || intervals == nullptr || intervals->empty()) {
+            isUnbounded = true;
+            return;
+        }
+
+        for (const auto &interval : *intervals) {
+            const auto &begin = interval.begin;
+            const auto &end = interval.end;
+
+            if (begin.IsNone() || end.IsNone() || begin.Type() != end.Type() ||
+                (!min.IsNone() && min.Type() != begin.Type())) {
+                // 타입이 섞이면 대소를 비교할 수 없다
+                isUnbounded = true;
+                return;
+            }
+
+            if (min.IsNone() || begin < min) {
+                min = begin;
+            }
+            if (max.IsNone() || max < end) {
+                max = end;
+            }
+
+            if (isPoint(interval)) {
+                addPoint(begin);
+            } else {
+                isPointsOnly = false;
+            }
+        }
+    }
+
+    bool StateColumnSummary::mayIntersect(const StateRange &range) const {
+        if (isUnbounded || range.wildcard()) {
+            return true;
+        }
+        if (min.IsNone()) {
+            // 요약한 범위가 없음
+            return false;
+        }
+
+        StateRange::ST_RANGE hull { min, max };
+        hull.begin.SetEqual();
+        hull.end.SetEqual();
+
+        const auto *intervals = range.GetRange();
+        if (intervals == nullptr) {
+            return false;
+        }
+
+        return std::any_of(intervals->begin(), intervals->end(), [this, &hull](const auto &interval) {
+            if (isPointsOnly && isPoint(interval) && !mayContainPoint(interval.begin)) {
+                return false;
+            }
+
+            return hull.isIntersection(interval);
+        });
+    }
+
+    void StateColumnSummary::toProtobuf(proto::ColumnSummary *out) const {
+        out->set_unbounded(isUnbounded);
+        out->set_points_only(isPointsOnly);
+
+        if (!isUnbounded) {
+            min.toProtobuf(out->mutable_min());
+            max.toProtobuf(out->mutable_max());
+            if (isPointsOnly) {
+                out->set_bloom(bloom);
+            }
+        }
+    }
+
+    void StateColumnSummary::fromProtobuf(const proto::ColumnSummary &msg) {
+        isUnbounded = msg.unbounded();
+        isPointsOnly = msg.points_only();
+
+        if (!isUnbounded) {
+            min.fromProtobuf(msg.min());
+            max.fromProtobuf(msg.max());
+            bloom = msg.bloom();
+        }
+    }
+
+    void StateColumnSummary::addPoint(const StateData &value) {
+        if (bloom.empty()) {
+            bloom.resize(BLOOM_BITS / 8, '\0');
+        }
+
+        auto hash = stableHash(value);
+        auto h1 = static_cast<uint32_t>(hash);
+        auto h2 = static_cast<uint32_t>(hash >> 32) | 1;
+
+        for (size_t i = 0; i < BLOOM_HASHES; i++) {
+            auto bit = (h1 + i * h2) % BLOOM_BITS;
+            bloom[bit / 8] = static_cast<char>(bloom[bit / 8] | (1 << (bit % 8)));
+        }
+    }
+
+    bool StateColumnSummary::mayContainPoint(const StateData &value) const {
+        if (bloom.size() != BLOOM_BITS / 8) {
+            return true;
+        }
+
+        auto hash = stableHash(value);
+        auto h1 = static_cast<uint32_t>(hash);
+        auto h2 = static_cast<uint32_t>(hash >> 32) | 1;
+
+        for (size_t i = 0; i < BLOOM_HASHES; i++) {
+            auto bit = (h1 + i * h2) % BLOOM_BITS;
+            if (!(static_cast<uint8_t>(bloom[bit / 8]) & (1 << (bit % 8)))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef ULTRAVERSE_STATE_STATECOLUMNSUMMARY_HPP
+#define ULTRAVERSE_STATE_STATECOLUMNSUMMARY_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "Transaction.hpp"
+#include "mariadb/state/StateItem.h"
+
+namespace ultraverse::state::v2 {
+    /**
+     * @brief 컬럼 하나가 가진 범위들의 요약 (min / max + bloom filter)
+     * @details 요약한 범위와 겹칠 수 없는 범위를 걸러내는 데 쓴다. (.ultkeyindex의 run 요약 등)
+     */
+    struct StateColumnSummary {
+        static constexpr size_t BLOOM_BITS = 4096;
+        static constexpr size_t BLOOM_HASHES = 3;
+
+        /** 끝이 열린 범위나 wildcard가 있어 값을 요약할 수 없음 */
+        bool isUnbounded = false;
+        /** 모든 값이 단일 값이어서 bloom filter를 쓸 수 있음 */
+        bool isPointsOnly = true;
+
+        StateData min;
+        StateData max;
+        std::string bloom;
+
+        void add(const StateRange &range);
+
+        /**
+         * @brief 요약한 값이 range와 겹칠 수 있는지 확인한다. false면 겹치지 않음이 보장된다.
+         */
+        bool mayIntersect(const StateRange &range) const;
+
+        void toProtobuf(proto::ColumnSummary *out) const;
+        void fromProtobuf(const proto::ColumnSummary &msg);
+    private:
+        void addPoint(const StateData &value);
+        bool mayContainPoint(const StateData &value) const;
+    };
+}
+
+#endif //ULTRAVERSE_STATE_STATECOLUMNSUMMARY_HPP
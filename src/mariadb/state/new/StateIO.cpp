@@ -49,6 +49,27 @@ namespace {
 }
 
 namespace ultraverse::state::v2 {
+    std::shared_ptr<Transaction> decodeTransaction(const char *data, size_t size) {
+        ultraverse::state::v2::proto::Transaction protoTxn;
+        if (!protoTxn.ParseFromArray(data, static_cast<int>(size))) {
+            return nullptr;
+        }
+
+        auto transaction = std::make_shared<Transaction>();
+        transaction->fromProtobuf(protoTxn);
+        return transaction;
+    }
+
+    bool readSizedRecord(std::istream &stream, std::string &buffer) {
+        uint32_t size = 0;
+        if (!stream.read(reinterpret_cast<char *>(&size), sizeof(uint32_t))) {
+            return false;
+        }
+
+        buffer.resize(size);
+        return static_cast<bool>(stream.read(buffer.data(), static_cast<std::streamsize>(size)));
+    }
+
     MockedStateLogReader::MockedStateLogReader() {
         rebuildIndex();
     }
@@ -108,6 +129,17 @@ namespace ultraverse::state::v2 {
         return true;
     }
 
+    bool MockedStateLogReader::nextTransactionBytes(std::string &bytes) {
+        if (_cursor >= _entries.size()) {
+            return false;
+        }
+
+        ultraverse::state::v2::proto::Transaction protoTxn;
+        _entries[_cursor].body->toProtobuf(&protoTxn);
+        _cursor++;
+        return protoTxn.SerializeToString(&bytes);
+    }
+
     void MockedStateLogReader::skipTransaction() {
         if (_cursor < _entries.size()) {
             _cursor++;
@@ -137,6 +169,10 @@ namespace ultraverse::state::v2 {
         return true;
     }
 
+    void MockedStateLogReader::setReadAheadSize(size_t bytes) {
+        (void) bytes;
+    }
+
     void MockedStateLogReader::addTransaction(const std::shared_ptr<Transaction> &transaction,
                                               gid_t gid,
                                               uint64_t timestamp,
@@ -6,6 +6,9 @@
 #define ULTRAVERSE_STATE_IO_HPP
 
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -29,6 +32,11 @@ namespace ultraverse::state::v2 {
 
         virtual bool nextHeader() = 0;
         virtual bool nextTransaction() = 0;
+        /**
+         * @brief nextTransaction()과 같으나, 본문을 디코딩하지 않고 직렬화된 그대로 읽는다.
+         * @see decodeTransaction()
+         */
+        virtual bool nextTransactionBytes(std::string &bytes) = 0;
 
         virtual void skipTransaction() = 0;
 
@@ -36,8 +44,57 @@ namespace ultraverse::state::v2 {
         virtual std::shared_ptr<Transaction> txnBody() = 0;
 
         virtual bool seekGid(gid_t gid) = 0;
+
+        /**
+         * @brief 순차 읽기용 버퍼 크기를 지정한다. 0이면 기본 버퍼를 쓴다.
+         * @note 다음 open() / reset()부터 적용된다.
+         */
+        virtual void setReadAheadSize(size_t bytes) = 0;
     };
 
+    /**
+     * @brief nextTransactionBytes()로 읽은 트랜잭션 본문을 디코딩한다. 실패하면 nullptr를 반환한다.
+     */
+    std::shared_ptr<Transaction> decodeTransaction(const char *data, size_t size);
+
+    /**
+     * @brief [uint32_t size][본문] 레코드의 본문 하나를 buffer에 읽는다. 덜 쓰인 레코드를 만나면 false를 반환한다.
+     */
+    bool readSizedRecord(std::istream &stream, std::string &buffer);
+
+    /**
+     * @brief [uint32_t size][protobuf] 레코드 하나를 읽는다. 덜 쓰였거나 파싱할 수 없는 레코드를 만나면 false를 반환한다.
+     */
+    template <typename Message>
+    bool readRecord(std::istream &stream, std::string &buffer, Message &record) {
+        return readSizedRecord(stream, buffer) && record.ParseFromString(buffer);
+    }
+
+    /**
+     * @brief path의 [uint32_t size][protobuf] 레코드를 앞에서부터 읽어 callback에 넘기고, 읽을 수 없는 레코드부터 끝까지 잘라낸다.
+     * @details 덜 쓰인 레코드 뒤에 이어 쓰면 그 뒤의 레코드를 읽을 수 없게 되므로, 이어 쓰기 전에 호출한다.
+     */
+    template <typename Message, typename Callback>
+    void truncateTornRecords(const std::string &path, Callback &&callback) {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        std::string buffer;
+        Message record;
+        uint64_t validSize = 0;
+
+        while (readRecord(stream, buffer, record)) {
+            callback(record);
+            validSize += sizeof(uint32_t) + buffer.size();
+        }
+        stream.close();
+
+        std::filesystem::resize_file(path, validSize);
+    }
+
+    template <typename Message>
+    void truncateTornRecords(const std::string &path) {
+        truncateTornRecords<Message>(path, [](const Message &) {});
+    }
+
     class IStateClusterStore {
     public:
         virtual ~IStateClusterStore() = default;
@@ -77,6 +134,7 @@ namespace ultraverse::state::v2 {
 
         bool nextHeader() override;
         bool nextTransaction() override;
+        bool nextTransactionBytes(std::string &bytes) override;
 
         void skipTransaction() override;
 
@@ -85,6 +143,8 @@ namespace ultraverse::state::v2 {
 
         bool seekGid(gid_t gid) override;
 
+        void setReadAheadSize(size_t bytes) override;
+
         void addTransaction(const std::shared_ptr<Transaction> &transaction,
                             gid_t gid,
                             uint64_t timestamp = 0,
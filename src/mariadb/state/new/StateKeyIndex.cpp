@@ -0,0 +1,463 @@
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "ultraverse_state.pb.h"
+
+#include "utils/StringUtil.hpp"
+#include "StateKeyIndex.hpp"
+
+namespace {
+    std::string keyIndexPath(const std::string &logPath, const std::string &logName) {
+        return fmt::format("{}/{}.ultkeyindex", logPath, logName);
+    }
+
+    /**
+     * @brief 오름차순 gid 목록을 차분 + varint로 인코딩한다.
+     */
+    std::string encodeGids(std::vector<ultraverse::state::v2::gid_t> &gids) {
+        std::sort(gids.begin(), gids.end());
+        gids.erase(std::unique(gids.begin(), gids.end()), gids.end());
+
+        std::string encoded;
+        encoded.reserve(gids.size() * 2);
+
+        uint64_t previous = 0;
+        for (auto gid : gids) {
+            uint64_t delta = gid - previous;
+            previous = gid;
+
+            while (delta >= 0x80) {
+                encoded.push_back(static_cast<char>((delta & 0x7f) | 0x80));
+                delta >>= 7;
+            }
+            encoded.push_back(static_cast<char>(delta));
+        }
+
+        return encoded;
+    }
+
+    void decodeGids(const std::string &encoded, std::vector<ultraverse::state::v2::gid_t> &out) {
+        uint64_t previous = 0;
+        uint64_t delta = 0;
+        int shift = 0;
+
+        for (auto byte : encoded) {
+            auto value = static_cast<uint8_t>(byte);
+            delta |= static_cast<uint64_t>(value & 0x7f) << shift;
+
+            if (value & 0x80) {
+                shift += 7;
+                continue;
+            }
+
+            previous += delta;
+            out.push_back(previous);
+
+            delta = 0;
+            shift = 0;
+        }
+    }
+}
+
+namespace ultraverse::state::v2 {
+    void mergeKeyIndexRange(std::map<std::string, StateRange> &ranges, const std::string &column, const StateRange &range) {
+        auto it = ranges.find(column);
+        if (it == ranges.end()) {
+            ranges.emplace(column, range);
+        } else if (it->second.wildcard()) {
+            return;
+        } else if (range.wildcard()) {
+            it->second = range;
+        } else {
+            it->second.OR_FAST(range);
+        }
+    }
+
+
+    StateKeyIndexWriter::StateKeyIndexWriter(const std::string &logPath, const std::string &logName,
+                                             const std::set<std::string> &indexedColumns, bool truncate):
+        _firstGid(0),
+        _lastGid(0),
+        _pendingTransactions(0)
+    {
+        for (const auto &column : indexedColumns) {
+            _indexedColumns.insert(utility::toLower(column));
+        }
+
+        auto path = keyIndexPath(logPath, logName);
+        _stream.open(path, std::ios::out | std::ios::binary | (truncate ? std::ios::trunc : std::ios::app));
+        if (!_stream) {
+            throw std::runtime_error(fmt::format("failed to open {}", path));
+        }
+    }
+
+    StateKeyIndexWriter::~StateKeyIndexWriter() {
+        try {
+            flush();
+        } catch (std::exception &) {
+            // 소멸자에서는 예외를 던지지 않는다
+        }
+        _stream.close();
+    }
+
+    void StateKeyIndexWriter::write(Transaction &transaction) {
+        const gid_t gid = transaction.gid();
+
+        auto collect = [this](CombinedIterator<StateItem> it) {
+            std::map<std::string, StateRange> ranges;
+            const auto end = it.end();
+
+            for (; it != end; ++it) {
+                const auto &item = *it;
+                if (item.name.empty()) {
+                    continue;
+                }
+
+                auto column = utility::toLower(item.name);
+                _observedColumns.insert(column);
+
+                if (_indexedColumns.find(column) == _indexedColumns.end()) {
+                    continue;
+                }
+
+                // 한 트랜잭션 안에서 같은 컬럼에 대한 범위는 하나로 합친다
+                mergeKeyIndexRange(ranges, column, item.MakeRange2());
+            }
+
+            return ranges;
+        };
+
+        for (const auto &pair : collect(transaction.readSet_begin())) {
+            _postings[{ StateCluster::READ, pair.first }][pair.second].push_back(gid);
+        }
+        for (const auto &pair : collect(transaction.writeSet_begin())) {
+            _postings[{ StateCluster::WRITE, pair.first }][pair.second].push_back(gid);
+        }
+
+        std::set<std::string> databases;
+        for (const auto &query : transaction.queries()) {
+            databases.insert(query->database());
+        }
+        for (const auto &database : databases) {
+            _databases[database].push_back(gid);
+        }
+
+        if (_pendingTransactions == 0) {
+            _firstGid = gid;
+            _lastGid = gid;
+        } else {
+            _firstGid = std::min(_firstGid, gid);
+            _lastGid = std::max(_lastGid, gid);
+        }
+
+        if (++_pendingTransactions >= RUN_TRANSACTIONS) {
+            flush();
+        }
+    }
+
+    void StateKeyIndexWriter::flush() {
+        if (_pendingTransactions == 0) {
+            return;
+        }
+
+        proto::KeyIndexRunSummary summary;
+        proto::KeyIndexRun run;
+
+        summary.set_first_gid(_firstGid);
+        summary.set_last_gid(_lastGid);
+
+        for (const auto &column : _indexedColumns) {
+            summary.add_indexed_columns(column);
+        }
+        for (const auto &column : _observedColumns) {
+            summary.add_observed_columns(column);
+        }
+
+        for (auto &pair : _postings) {
+            StateColumnSummary columnSummary;
+
+            for (auto &posting : pair.second) {
+                columnSummary.add(posting.first);
+
+                auto *protoPosting = run.add_postings();
+                protoPosting->set_type(static_cast<uint32_t>(pair.first.first));
+                protoPosting->set_column(pair.first.second);
+                posting.first.toProtobuf(protoPosting->mutable_range());
+                protoPosting->set_gids(encodeGids(posting.second));
+            }
+
+            auto *protoColumn = summary.add_columns();
+            protoColumn->set_type(static_cast<uint32_t>(pair.first.first));
+            protoColumn->set_name(pair.first.second);
+            columnSummary.toProtobuf(protoColumn->mutable_summary());
+        }
+
+        for (auto &pair : _databases) {
+            auto *protoDatabase = run.add_databases();
+            protoDatabase->set_name(pair.first);
+            protoDatabase->set_gids(encodeGids(pair.second));
+        }
+
+        std::string serializedSummary;
+        std::string serializedRun;
+        if (!summary.SerializeToString(&serializedSummary) || !run.SerializeToString(&serializedRun)) {
+            throw std::runtime_error("failed to serialize key index run protobuf");
+        }
+
+        uint64_t summarySize = serializedSummary.size();
+        uint64_t runSize = serializedRun.size();
+        _stream.write(reinterpret_cast<const char *>(&summarySize), sizeof(uint64_t));
+        _stream.write(serializedSummary.data(), static_cast<std::streamsize>(summarySize));
+        _stream.write(reinterpret_cast<const char *>(&runSize), sizeof(uint64_t));
+        _stream.write(serializedRun.data(), static_cast<std::streamsize>(runSize));
+        _stream.flush();
+
+        _observedColumns.clear();
+        _postings.clear();
+        _databases.clear();
+        _pendingTransactions = 0;
+    }
+
+    StateKeyIndexReader::StateKeyIndexReader(const std::string &logPath, const std::string &logName):
+        _path(keyIndexPath(logPath, logName))
+    {
+        _stream.open(_path, std::ios::in | std::ios::binary);
+        if (!_stream) {
+            throw std::runtime_error(fmt::format("failed to open {}", _path));
+        }
+
+        _stream.seekg(0, std::ios::end);
+        const uint64_t fileSize = _stream.tellg();
+        _stream.seekg(0, std::ios::beg);
+
+        std::string serialized;
+        bool isFirstRun = true;
+        while (true) {
+            uint64_t summarySize = 0;
+            if (!_stream.read(reinterpret_cast<char *>(&summarySize), sizeof(uint64_t))) {
+                break;
+            }
+
+            serialized.resize(summarySize);
+            // 마지막 run이 덜 쓰여 있으면 버린다
+            if (!_stream.read(serialized.data(), static_cast<std::streamsize>(summarySize))) {
+                break;
+            }
+
+            uint64_t runSize = 0;
+            if (!_stream.read(reinterpret_cast<char *>(&runSize), sizeof(uint64_t))) {
+                break;
+            }
+
+            const uint64_t offset = _stream.tellg();
+            if (offset + runSize > fileSize) {
+                break;
+            }
+
+            proto::KeyIndexRunSummary summary;
+            if (!summary.ParseFromString(serialized)) {
+                throw std::runtime_error(fmt::format("failed to parse key index run summary in {}", _path));
+            }
+
+            // 설정이 바뀌어 run마다 인덱싱한 컬럼이 다를 수 있으므로, 모든 run에서 인덱싱된 컬럼만 남긴다
+            std::set<std::string> indexedColumns(summary.indexed_columns().begin(), summary.indexed_columns().end());
+            if (isFirstRun) {
+                _indexedColumns = std::move(indexedColumns);
+                isFirstRun = false;
+            } else {
+                for (auto it = _indexedColumns.begin(); it != _indexedColumns.end();) {
+                    it = indexedColumns.find(*it) == indexedColumns.end() ? _indexedColumns.erase(it) : std::next(it);
+                }
+            }
+            _observedColumns.insert(summary.observed_columns().begin(), summary.observed_columns().end());
+
+            Run run;
+            run.firstGid = summary.first_gid();
+            run.lastGid = summary.last_gid();
+            run.offset = offset;
+            run.size = runSize;
+
+            for (const auto &protoColumn : summary.columns()) {
+                auto type = static_cast<StateCluster::ClusterType>(protoColumn.type());
+                run.columns[{ type, protoColumn.name() }].fromProtobuf(protoColumn.summary());
+            }
+
+            _runs.emplace_back(std::move(run));
+
+            // run 본문은 필요할 때 읽는다
+            _stream.seekg(static_cast<std::streamoff>(runSize), std::ios::cur);
+        }
+
+        _stream.clear();
+
+        std::sort(_runs.begin(), _runs.end(), [](const Run &a, const Run &b) {
+            return a.firstGid < b.firstGid;
+        });
+    }
+
+    bool StateKeyIndexReader::exists(const std::string &logPath, const std::string &logName) {
+        return std::filesystem::exists(keyIndexPath(logPath, logName));
+    }
+
+    const std::set<std::string> &StateKeyIndexReader::indexedColumns() const {
+        return _indexedColumns;
+    }
+
+    const std::set<std::string> &StateKeyIndexReader::observedColumns() const {
+        return _observedColumns;
+    }
+
+    std::vector<gid_t> StateKeyIndexReader::find(StateCluster::ClusterType type, const std::string &column,
+                                                 const StateRange &range) {
+        std::vector<gid_t> gids;
+
+        forEachMatching(type, column, range, [&gids](auto, const auto &, const auto &, const std::vector<gid_t> &postingGids) {
+            gids.insert(gids.end(), postingGids.begin(), postingGids.end());
+        });
+
+        std::sort(gids.begin(), gids.end());
+        gids.erase(std::unique(gids.begin(), gids.end()), gids.end());
+
+        return gids;
+    }
+
+    void StateKeyIndexReader::forEachMatching(StateCluster::ClusterType type, const std::string &column,
+                                              const StateRange &range, const PostingCallback &callback) {
+        const auto lowerColumn = utility::toLower(column);
+        const PostingKey key { type, lowerColumn };
+
+        for (auto &run : _runs) {
+            auto it = run.columns.find(key);
+            if (it == run.columns.end()) {
+                continue;
+            }
+
+            if (!range.wildcard() && !it->second.mayIntersect(range)) {
+                continue;
+            }
+
+            for (const auto &posting : load(run).postings) {
+                if (posting.type != type || posting.column != lowerColumn) {
+                    continue;
+                }
+
+                if (range.wildcard() || posting.range.wildcard() || StateRange::isIntersects(posting.range, range)) {
+                    callback(posting.type, posting.column, posting.range, posting.gids);
+                }
+            }
+        }
+    }
+
+    void StateKeyIndexReader::forEachPostingOf(gid_t gid, const PostingCallback &callback) {
+        auto *run = runOf(gid);
+        if (run == nullptr) {
+            return;
+        }
+
+        auto &decoded = load(*run);
+        auto it = decoded.postingsByGid.find(gid);
+        if (it == decoded.postingsByGid.end()) {
+            return;
+        }
+
+        const std::vector<gid_t> gids { gid };
+        for (auto index : it->second) {
+            const auto &posting = decoded.postings[index];
+            callback(posting.type, posting.column, posting.range, gids);
+        }
+    }
+
+    bool StateKeyIndexReader::hasDatabase(gid_t gid, const std::string &database) {
+        auto *run = runOf(gid);
+        if (run == nullptr) {
+            return false;
+        }
+
+        auto &decoded = load(*run);
+        auto it = decoded.databases.find(database);
+        return it != decoded.databases.end() && it->second.find(gid) != it->second.end();
+    }
+
+    std::optional<gid_t> StateKeyIndexReader::lastGid() const {
+        if (_runs.empty()) {
+            return std::nullopt;
+        }
+
+        return _runs.back().lastGid;
+    }
+
+    size_t StateKeyIndexReader::runCount() const {
+        return _runs.size();
+    }
+
+    size_t StateKeyIndexReader::loadedRunCount() const {
+        return _loadedRuns;
+    }
+
+    StateKeyIndexReader::DecodedRun &StateKeyIndexReader::load(Run &run) {
+        if (run.decoded != nullptr) {
+            return *run.decoded;
+        }
+
+        std::string serialized(run.size, '\0');
+        _stream.seekg(static_cast<std::streamoff>(run.offset), std::ios::beg);
+        if (!_stream.read(serialized.data(), static_cast<std::streamsize>(run.size))) {
+            _stream.clear();
+            throw std::runtime_error(fmt::format("failed to read key index run at {} in {}", run.offset, _path));
+        }
+
+        proto::KeyIndexRun protoRun;
+        if (!protoRun.ParseFromString(serialized)) {
+            throw std::runtime_error(fmt::format("failed to parse key index run in {}", _path));
+        }
+
+        auto decoded = std::make_unique<DecodedRun>();
+        decoded->postings.reserve(protoRun.postings_size());
+
+        for (const auto &protoPosting : protoRun.postings()) {
+            Posting posting;
+            posting.type = static_cast<StateCluster::ClusterType>(protoPosting.type());
+            posting.column = protoPosting.column();
+            posting.range.fromProtobuf(protoPosting.range());
+            decodeGids(protoPosting.gids(), posting.gids);
+
+            const size_t index = decoded->postings.size();
+            for (auto gid : posting.gids) {
+                decoded->postingsByGid[gid].push_back(index);
+            }
+
+            decoded->postings.emplace_back(std::move(posting));
+        }
+
+        for (const auto &protoDatabase : protoRun.databases()) {
+            std::vector<gid_t> gids;
+            decodeGids(protoDatabase.gids(), gids);
+            decoded->databases[protoDatabase.name()].insert(gids.begin(), gids.end());
+        }
+
+        run.decoded = std::move(decoded);
+        _loadedRuns++;
+
+        return *run.decoded;
+    }
+
+    StateKeyIndexReader::Run *StateKeyIndexReader::runOf(gid_t gid) {
+        auto it = std::upper_bound(_runs.begin(), _runs.end(), gid, [](gid_t value, const Run &run) {
+            return value < run.firstGid;
+        });
+
+        if (it == _runs.begin()) {
+            return nullptr;
+        }
+
+        --it;
+        if (gid > it->lastGid) {
+            return nullptr;
+        }
+
+        return &*it;
+    }
+}
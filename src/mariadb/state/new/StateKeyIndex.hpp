@@ -0,0 +1,172 @@
+#ifndef ULTRAVERSE_STATE_STATEKEYINDEX_HPP
+#define ULTRAVERSE_STATE_STATEKEYINDEX_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Transaction.hpp"
+#include "StateColumnSummary.hpp"
+#include "cluster/StateCluster.hpp"
+
+namespace ultraverse::state::v2 {
+    /**
+     * @brief ranges[column]에 range를 OR로 합친다. wildcard 범위가 있으면 wildcard가 된다.
+     */
+    void mergeKeyIndexRange(std::map<std::string, StateRange> &ranges, const std::string &column, const StateRange &range);
+
+    /**
+     * @brief 키 컬럼 값 -> gid 목록의 역색인(.ultkeyindex)을 이어 쓰는 클래스
+     * @details .ultkeyindex는 [uint64_t size][proto::KeyIndexRunSummary][uint64_t size][proto::KeyIndexRun]의 연속이다.
+     *          트랜잭션 RUN_TRANSACTIONS개마다 (type, 컬럼, 범위)별 gid 목록을 run 하나로 묶어 쓰며,
+     *          gid 목록은 차분 + varint로 압축한다. run 앞의 요약에는 gid 범위와 (type, 컬럼)별 min / max + bloom filter가 있어,
+     *          읽는 쪽은 찾는 범위와 겹칠 수 없는 run을 읽지 않고 건너뛴다.
+     *
+     *          컬럼 이름은 foreign key를 해결하기 전의 이름 그대로 기록하므로,
+     *          읽는 쪽에서 RelationshipResolver로 키 컬럼을 찾아야 한다. (StateCluster::extractItems()와 동일)
+     */
+    class StateKeyIndexWriter {
+    public:
+        static constexpr size_t RUN_TRANSACTIONS = 4096;
+
+        /**
+         * @param indexedColumns 인덱싱할 컬럼 (table.column, 소문자)
+         * @param truncate true면 기존 인덱스를 비우고 새로 쓴다.
+         */
+        StateKeyIndexWriter(const std::string &logPath, const std::string &logName,
+                            const std::set<std::string> &indexedColumns, bool truncate);
+        StateKeyIndexWriter(StateKeyIndexWriter &) = delete;
+
+        ~StateKeyIndexWriter();
+
+        void write(Transaction &transaction);
+        /**
+         * 모인 posting을 run 하나로 쓴다.
+         */
+        void flush();
+    private:
+        using PostingKey = std::pair<StateCluster::ClusterType, std::string>;
+
+        std::ofstream _stream;
+
+        std::set<std::string> _indexedColumns;
+        std::set<std::string> _observedColumns;
+
+        std::map<PostingKey, std::unordered_map<StateRange, std::vector<gid_t>>> _postings;
+        std::map<std::string, std::vector<gid_t>> _databases;
+        gid_t _firstGid;
+        gid_t _lastGid;
+        size_t _pendingTransactions;
+    };
+
+    /**
+     * @brief .ultkeyindex에서 키 컬럼 값으로 gid를 찾는다.
+     * @details 생성할 때는 run 요약만 읽고, run 본문은 찾는 범위와 겹칠 수 있거나 찾는 gid를 가진 run만 읽어 디코딩한다.
+     */
+    class StateKeyIndexReader {
+    public:
+        using PostingCallback = std::function<void(StateCluster::ClusterType type,
+                                                   const std::string &column,
+                                                   const StateRange &range,
+                                                   const std::vector<gid_t> &gids)>;
+
+        /**
+         * @throws std::runtime_error 인덱스 파일이 없는 경우
+         */
+        StateKeyIndexReader(const std::string &logPath, const std::string &logName);
+
+        static bool exists(const std::string &logPath, const std::string &logName);
+
+        /**
+         * @brief 인덱스를 쓸 때 지정된 컬럼들 (모든 run에서 인덱싱된 컬럼만)
+         */
+        const std::set<std::string> &indexedColumns() const;
+        /**
+         * @brief 로그에 나타난 모든 컬럼들. (인덱싱되지 않은 컬럼도 포함한다)
+         */
+        const std::set<std::string> &observedColumns() const;
+
+        /**
+         * @brief column의 range와 겹치는 범위에 접근한 트랜잭션의 gid를 반환한다.
+         * @return 오름차순으로 정렬된 gid 목록
+         */
+        std::vector<gid_t> find(StateCluster::ClusterType type, const std::string &column, const StateRange &range);
+
+        /**
+         * @brief column의 range와 겹치는 posting마다 callback을 호출한다. 한 posting의 gid는 같은 run에 속한다.
+         */
+        void forEachMatching(StateCluster::ClusterType type, const std::string &column, const StateRange &range,
+                             const PostingCallback &callback);
+
+        /**
+         * @brief gid가 가진 모든 posting에 대해 callback을 호출한다. gids 인자는 { gid }이다.
+         */
+        void forEachPostingOf(gid_t gid, const PostingCallback &callback);
+
+        /**
+         * @brief gid인 트랜잭션이 database에 대한 쿼리를 가졌는지 확인한다.
+         */
+        bool hasDatabase(gid_t gid, const std::string &database);
+
+        /**
+         * @brief 색인된 마지막 트랜잭션의 gid. 쓰인 run이 없으면 std::nullopt
+         * @note writer는 트랜잭션을 RUN_TRANSACTIONS개씩 모아 쓰므로, 로그의 마지막 트랜잭션들은 아직 색인되지 않았을 수 있다.
+         */
+        std::optional<gid_t> lastGid() const;
+
+        size_t runCount() const;
+        /**
+         * @brief 지금까지 본문을 읽은 run의 수
+         */
+        size_t loadedRunCount() const;
+    private:
+        using PostingKey = std::pair<StateCluster::ClusterType, std::string>;
+
+        struct Posting {
+            StateCluster::ClusterType type;
+            std::string column;
+            StateRange range;
+            std::vector<gid_t> gids;
+        };
+
+        struct DecodedRun {
+            std::vector<Posting> postings;
+            std::unordered_map<gid_t, std::vector<size_t>> postingsByGid;
+            std::map<std::string, std::unordered_set<gid_t>> databases;
+        };
+
+        struct Run {
+            gid_t firstGid = 0;
+            gid_t lastGid = 0;
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            std::map<PostingKey, StateColumnSummary> columns;
+
+            std::unique_ptr<DecodedRun> decoded;
+        };
+
+        DecodedRun &load(Run &run);
+        Run *runOf(gid_t gid);
+
+        std::string _path;
+        std::ifstream _stream;
+
+        std::set<std::string> _indexedColumns;
+        std::set<std::string> _observedColumns;
+
+        /** gid 순으로 정렬된 run 목록 */
+        std::vector<Run> _runs;
+        size_t _loadedRuns = 0;
+    };
+}
+
+#endif //ULTRAVERSE_STATE_STATEKEYINDEX_HPP
@@ -0,0 +1,131 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "ultraverse_state.pb.h"
+
+#include "StateLogCheckpoint.hpp"
+
+namespace {
+    std::string checkpointPath(const std::string &logPath, const std::string &logName) {
+        return fmt::format("{}/{}.ultcheckpoint", logPath, logName);
+    }
+}
+
+namespace ultraverse::state::v2 {
+    bool StateLogCheckpoint::exists(const std::string &logPath, const std::string &logName) {
+        return std::filesystem::exists(checkpointPath(logPath, logName));
+    }
+
+    std::optional<StateLogCheckpoint> StateLogCheckpoint::load(const std::string &logPath, const std::string &logName) {
+        auto path = checkpointPath(logPath, logName);
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if (!stream) {
+            return std::nullopt;
+        }
+
+        proto::StateLogCheckpoint protoCheckpoint;
+        if (!protoCheckpoint.ParseFromIstream(&stream)) {
+            throw std::runtime_error(fmt::format("failed to parse {}", path));
+        }
+
+        StateLogCheckpoint checkpoint;
+        checkpoint.binlogIndex = static_cast<int>(protoCheckpoint.binlog_index());
+        checkpoint.binlogFile = protoCheckpoint.binlog_file();
+        checkpoint.binlogPos = protoCheckpoint.binlog_pos();
+        checkpoint.nextGid = protoCheckpoint.next_gid();
+        checkpoint.procLogPos = protoCheckpoint.proc_log_pos();
+        checkpoint.timestamp = protoCheckpoint.timestamp();
+        checkpoint.logName = protoCheckpoint.log_name();
+        checkpoint.logOffset = protoCheckpoint.log_offset();
+
+        for (const auto &file : protoCheckpoint.files()) {
+            checkpoint.files[file.name()] = file.size();
+        }
+
+        if (protoCheckpoint.has_segment()) {
+            const auto &protoSegment = protoCheckpoint.segment();
+
+            StateLogSegment segment;
+            segment.index = protoSegment.index();
+            segment.name = protoSegment.name();
+            segment.firstGid = protoSegment.first_gid();
+            segment.lastGid = protoSegment.last_gid();
+            segment.minTimestamp = protoSegment.min_timestamp();
+            segment.maxTimestamp = protoSegment.max_timestamp();
+            segment.transactionCount = protoSegment.transaction_count();
+
+            checkpoint.segment = std::move(segment);
+        }
+
+        return checkpoint;
+    }
+
+    void StateLogCheckpoint::save(const std::string &logPath, const std::string &logName) const {
+        proto::StateLogCheckpoint protoCheckpoint;
+        protoCheckpoint.set_binlog_index(static_cast<uint32_t>(binlogIndex));
+        protoCheckpoint.set_binlog_file(binlogFile);
+        protoCheckpoint.set_binlog_pos(binlogPos);
+        protoCheckpoint.set_next_gid(nextGid);
+        protoCheckpoint.set_proc_log_pos(procLogPos);
+        protoCheckpoint.set_timestamp(timestamp);
+        protoCheckpoint.set_log_name(this->logName);
+        protoCheckpoint.set_log_offset(logOffset);
+
+        for (const auto &[name, size] : files) {
+            auto *protoFile = protoCheckpoint.add_files();
+            protoFile->set_name(name);
+            protoFile->set_size(size);
+        }
+
+        if (segment.has_value()) {
+            // 봉인 정보는 남기지 않는다. 체크포인트로 되돌린 세그먼트는 다시 쓰는 중인 세그먼트가 된다
+            auto *protoSegment = protoCheckpoint.mutable_segment();
+            protoSegment->set_index(segment->index);
+            protoSegment->set_name(segment->name);
+            protoSegment->set_first_gid(segment->firstGid);
+            protoSegment->set_last_gid(segment->lastGid);
+            protoSegment->set_min_timestamp(segment->minTimestamp);
+            protoSegment->set_max_timestamp(segment->maxTimestamp);
+            protoSegment->set_transaction_count(segment->transactionCount);
+        }
+
+        auto path = checkpointPath(logPath, logName);
+        auto tmpPath = path + ".tmp";
+        {
+            std::ofstream stream(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!protoCheckpoint.SerializeToOstream(&stream)) {
+                throw std::runtime_error(fmt::format("failed to write {}", tmpPath));
+            }
+        }
+        syncFile(tmpPath);
+
+        std::filesystem::rename(tmpPath, path);
+
+        // rename()도 디렉토리에 기록되어야 살아남는다
+        auto directory = std::filesystem::path(path).parent_path();
+        syncFile(directory.empty() ? "." : directory.string());
+    }
+
+    void syncFile(const std::string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error(fmt::format("failed to open {}", path));
+        }
+
+        if (fsync(fd) < 0) {
+            auto error = errno;
+            close(fd);
+            throw std::runtime_error(fmt::format("fsync() failed: {} (errno {})", strerror(error), error));
+        }
+
+        close(fd);
+    }
+}
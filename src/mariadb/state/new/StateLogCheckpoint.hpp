@@ -0,0 +1,62 @@
+#ifndef ULTRAVERSE_STATE_STATELOGCHECKPOINT_HPP
+#define ULTRAVERSE_STATE_STATELOGCHECKPOINT_HPP
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+#include "Transaction.hpp"
+#include "StateLogManifest.hpp"
+
+namespace ultraverse::state::v2 {
+    /**
+     * @brief statelogd가 재시작할 때 이어서 처리하기 위한 체크포인트 (<name>.ultcheckpoint)
+     * @details binlog 쪽 위치 (binlog*, nextGid, procLogPos)는 statelogd가 채우고,
+     *          로그 쪽 위치 (logName, logOffset, files, segment)는 StateLogWriter::checkpoint()가 채운다.
+     *
+     *          files에는 이어 쓰는 파일들 (로그와 사이드카)의 체크포인트 시점 크기가 담긴다.
+     *          StateLogWriter::restore()는 이 크기로 파일을 잘라 덜 쓰인 레코드와 체크포인트 뒤의 레코드를 버린다.
+     *          버려진 트랜잭션은 binlog를 체크포인트 위치부터 다시 읽으면서 같은 gid로 다시 쓰인다.
+     */
+    struct StateLogCheckpoint {
+        /** 다음에 읽을 binlog 파일의 (index 파일 기준) 순번과 이름 */
+        int binlogIndex = 0;
+        std::string binlogFile;
+        /** 마지막으로 기록한 트랜잭션의 XID 이벤트가 끝나는 위치 */
+        uint64_t binlogPos = 0;
+
+        gid_t nextGid = 0;
+        uint64_t procLogPos = 0;
+        uint64_t timestamp = 0;
+
+        /** 쓰고 있던 로그 (세그먼트)의 이름 */
+        std::string logName;
+        /** 다음 트랜잭션이 쓰일 위치 (압축된 로그에서는 논리 위치) */
+        uint64_t logOffset = 0;
+        /** 로그 경로 기준 파일 이름 -> 체크포인트 시점의 크기 */
+        std::map<std::string, uint64_t> files;
+        /** 세그먼트로 나뉜 로그에서 쓰고 있던 세그먼트 */
+        std::optional<StateLogSegment> segment;
+
+        static bool exists(const std::string &logPath, const std::string &logName);
+
+        /**
+         * @return 체크포인트가 없으면 std::nullopt
+         * @throws std::runtime_error 체크포인트를 읽을 수 없는 경우
+         */
+        static std::optional<StateLogCheckpoint> load(const std::string &logPath, const std::string &logName);
+
+        /**
+         * @brief 임시 파일에 쓰고 fsync()한 뒤 rename()한다. 도중에 죽어도 이전 체크포인트가 남는다.
+         */
+        void save(const std::string &logPath, const std::string &logName) const;
+    };
+
+    /**
+     * @brief 파일을 fsync()한다.
+     */
+    void syncFile(const std::string &path);
+}
+
+#endif //ULTRAVERSE_STATE_STATELOGCHECKPOINT_HPP
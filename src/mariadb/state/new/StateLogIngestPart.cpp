@@ -0,0 +1,85 @@
+#include <filesystem>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "StateLogReader.hpp"
+#include "StateLogWriter.hpp"
+
+#include "StateLogIngestPart.hpp"
+
+namespace ultraverse::state::v2 {
+    StateLogIngestPart::StateLogIngestPart(const std::string &ingestPath, int binlogIndex):
+        _ingestPath(ingestPath),
+        _name(fmt::format("part-{}", binlogIndex))
+    {
+    }
+
+    StateLogIngestPart::~StateLogIngestPart() {
+        close();
+    }
+
+    const std::string &StateLogIngestPart::name() const {
+        return _name;
+    }
+
+    void StateLogIngestPart::open() {
+        remove();
+
+        _writer = std::make_unique<StateLogWriter>(_ingestPath, _name);
+        _writer->setGidIndexEnabled(false);
+        _writer->setTimestampIndexInterval(0);
+        _writer->setKeyIndexColumns({});
+        _writer->setRWSummaryEnabled(false);
+        _writer->setZoneMap(0, {});
+        _writer->open(std::ios::out | std::ios::binary | std::ios::trunc);
+    }
+
+    void StateLogIngestPart::write(Transaction &transaction) {
+        *_writer << transaction;
+    }
+
+    void StateLogIngestPart::close() {
+        if (_writer != nullptr) {
+            _writer->close();
+            _writer = nullptr;
+        }
+    }
+
+    gid_t StateLogIngestPart::merge(gid_t firstGid, size_t transactionCount, const MergeCallback &callback) {
+        if (transactionCount == 0) {
+            return firstGid;
+        }
+
+        StateLogReader reader(_ingestPath, _name);
+        reader.open();
+
+        for (size_t i = 0; i < transactionCount; i++) {
+            if (!reader.next()) {
+                throw std::runtime_error(fmt::format(
+                    "intermediate state log {} ended after {} of {} transactions", _name, i, transactionCount
+                ));
+            }
+
+            auto transaction = reader.txnBody();
+            transaction->setGid(firstGid + i);
+
+            callback(std::move(transaction));
+        }
+
+        reader.close();
+
+        return firstGid + transactionCount;
+    }
+
+    void StateLogIngestPart::remove() {
+        namespace fs = std::filesystem;
+
+        std::error_code errorCode;
+        for (const auto &entry: fs::directory_iterator(_ingestPath, errorCode)) {
+            if (entry.path().filename().string().rfind(_name + ".", 0) == 0) {
+                fs::remove(entry.path(), errorCode);
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef ULTRAVERSE_STATE_STATELOGINGESTPART_HPP
+#define ULTRAVERSE_STATE_STATELOGINGESTPART_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "Transaction.hpp"
+
+namespace ultraverse::state::v2 {
+    class StateLogWriter;
+
+    /**
+     * @brief 병렬 ingest에서 binlog 파일 하나의 트랜잭션을 gid 없이 모아 두는 임시 state log (<ingestPath>/part-N)
+     * @details gid는 병합할 때 binlog 순서대로 매기므로, 쓸 때는 gid에 의존하는 사이드카 (.ultindex, .ulttimeindex,
+     *          .ultkeyindex, .ultsummary, .ultzonemap)를 쓰지 않는다. 사이드카는 병합한 트랜잭션을 최종 로그에 쓸 때 만들어진다.
+     */
+    class StateLogIngestPart {
+    public:
+        using MergeCallback = std::function<void(std::shared_ptr<Transaction> transaction)>;
+
+        StateLogIngestPart(const std::string &ingestPath, int binlogIndex);
+        ~StateLogIngestPart();
+
+        const std::string &name() const;
+
+        /**
+         * @brief 이전 실행에서 남은 내용은 버리고 새로 쓴다.
+         */
+        void open();
+        /**
+         * @note transaction의 gid는 기록되지만 병합할 때 다시 매긴다.
+         */
+        void write(Transaction &transaction);
+        void close();
+
+        /**
+         * @brief 쓴 트랜잭션 transactionCount개를 쓴 순서대로 읽어 firstGid부터 gid를 매긴 뒤 callback에 넘긴다.
+         * @return 다음 part가 이어서 매길 gid (firstGid + transactionCount)
+         * @throws std::runtime_error part 로그가 transactionCount개보다 먼저 끝나는 경우
+         */
+        gid_t merge(gid_t firstGid, size_t transactionCount, const MergeCallback &callback);
+
+        /**
+         * @brief part 로그와 (있다면) 사이드카를 지운다.
+         */
+        void remove();
+    private:
+        std::string _ingestPath;
+        std::string _name;
+
+        std::unique_ptr<StateLogWriter> _writer;
+    };
+}
+
+#endif //ULTRAVERSE_STATE_STATELOGINGESTPART_HPP
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#include <openssl/evp.h>
+
+#include <fmt/format.h>
+
+#include "ultraverse_state.pb.h"
+
+#include "StateLogManifest.hpp"
+
+namespace ultraverse::state::v2 {
+    bool StateLogSegment::overlaps(gid_t startGid, gid_t endGid) const {
+        if (transactionCount == 0) {
+            // 아직 아무것도 쓰이지 않은 (쓰는 중인) 세그먼트
+            return !sealed;
+        }
+
+        if (firstGid > endGid) {
+            return false;
+        }
+
+        return !sealed || lastGid >= startGid;
+    }
+
+    StateLogManifest::StateLogManifest(const std::string &logPath, const std::string &logName):
+        _logPath(logPath),
+        _logName(logName)
+    {
+        std::ifstream stream(manifestPath(), std::ios::in | std::ios::binary);
+        if (!stream) {
+            return;
+        }
+
+        proto::StateLogManifest protoManifest;
+        if (!protoManifest.ParseFromIstream(&stream)) {
+            throw std::runtime_error(fmt::format("failed to parse {}", manifestPath()));
+        }
+
+        for (const auto &protoSegment : protoManifest.segments()) {
+            StateLogSegment segment;
+            segment.index = protoSegment.index();
+            segment.name = protoSegment.name();
+            segment.firstGid = protoSegment.first_gid();
+            segment.lastGid = protoSegment.last_gid();
+            segment.minTimestamp = protoSegment.min_timestamp();
+            segment.maxTimestamp = protoSegment.max_timestamp();
+            segment.transactionCount = protoSegment.transaction_count();
+            segment.size = protoSegment.size();
+            segment.checksum = protoSegment.checksum();
+            segment.sealed = protoSegment.sealed();
+            segment.archived = protoSegment.archived();
+
+            _segments.push_back(std::move(segment));
+        }
+    }
+
+    bool StateLogManifest::exists(const std::string &logPath, const std::string &logName) {
+        return std::filesystem::exists(fmt::format("{}/{}.ultmanifest", logPath, logName));
+    }
+
+    std::string StateLogManifest::segmentName(const std::string &logName, uint32_t index) {
+        return fmt::format("{}.{:06}", logName, index);
+    }
+
+    std::vector<StateLogSegment> &StateLogManifest::segments() {
+        return _segments;
+    }
+
+    const std::vector<StateLogSegment> &StateLogManifest::segments() const {
+        return _segments;
+    }
+
+    StateLogSegment &StateLogManifest::addSegment() {
+        StateLogSegment segment;
+        segment.index = _segments.empty() ? 0 : _segments.back().index + 1;
+        segment.name = segmentName(_logName, segment.index);
+
+        _segments.push_back(std::move(segment));
+        return _segments.back();
+    }
+
+    void StateLogManifest::clear() {
+        _segments.clear();
+    }
+
+    void StateLogManifest::save() const {
+        proto::StateLogManifest protoManifest;
+
+        for (const auto &segment : _segments) {
+            auto *protoSegment = protoManifest.add_segments();
+            protoSegment->set_index(segment.index);
+            protoSegment->set_name(segment.name);
+            protoSegment->set_first_gid(segment.firstGid);
+            protoSegment->set_last_gid(segment.lastGid);
+            protoSegment->set_min_timestamp(segment.minTimestamp);
+            protoSegment->set_max_timestamp(segment.maxTimestamp);
+            protoSegment->set_transaction_count(segment.transactionCount);
+            protoSegment->set_size(segment.size);
+            protoSegment->set_checksum(segment.checksum);
+            protoSegment->set_sealed(segment.sealed);
+            protoSegment->set_archived(segment.archived);
+        }
+
+        auto path = manifestPath();
+        auto tmpPath = path + ".tmp";
+        {
+            std::ofstream stream(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!protoManifest.SerializeToOstream(&stream)) {
+                throw std::runtime_error(fmt::format("failed to write {}", tmpPath));
+            }
+        }
+
+        std::filesystem::rename(tmpPath, path);
+    }
+
+    void StateLogManifest::seal(StateLogSegment &segment) const {
+        auto path = fmt::format("{}/{}.ultstatelog", _logPath, segment.name);
+
+        segment.size = std::filesystem::file_size(path);
+        segment.checksum = sha256File(path);
+        segment.sealed = true;
+    }
+
+    bool StateLogManifest::verify(const StateLogSegment &segment) const {
+        if (!segment.sealed || segment.archived) {
+            return true;
+        }
+
+        return sha256File(fmt::format("{}/{}.ultstatelog", _logPath, segment.name)) == segment.checksum;
+    }
+
+    size_t StateLogManifest::applyRetention(uint32_t retainedSegments) {
+        if (retainedSegments == 0) {
+            return 0;
+        }
+
+        size_t sealedSegments = std::count_if(_segments.begin(), _segments.end(), [](const auto &segment) {
+            return segment.sealed && !segment.archived;
+        });
+
+        size_t archivedSegments = 0;
+        std::filesystem::path archivePath = std::filesystem::path(_logPath) / ARCHIVE_DIRECTORY;
+
+        for (auto &segment : _segments) {
+            if (sealedSegments <= retainedSegments) {
+                break;
+            }
+            if (!segment.sealed || segment.archived) {
+                continue;
+            }
+
+            std::filesystem::create_directories(archivePath);
+
+            // 세그먼트의 로그와 사이드카 파일 (<name>.000000.*)을 모두 옮긴다
+            auto prefix = segment.name + ".";
+            for (const auto &entry : std::filesystem::directory_iterator(_logPath)) {
+                auto fileName = entry.path().filename().string();
+                if (fileName.rfind(prefix, 0) == 0) {
+                    std::filesystem::rename(entry.path(), archivePath / fileName);
+                }
+            }
+
+            segment.archived = true;
+            sealedSegments--;
+            archivedSegments++;
+        }
+
+        return archivedSegments;
+    }
+
+    std::string StateLogManifest::manifestPath() const {
+        return fmt::format("{}/{}.ultmanifest", _logPath, _logName);
+    }
+
+    std::string sha256File(const std::string &path) {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if (!stream) {
+            throw std::runtime_error(fmt::format("failed to open {}", path));
+        }
+
+        std::shared_ptr<EVP_MD_CTX> context(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+        EVP_DigestInit_ex(context.get(), EVP_sha256(), nullptr);
+
+        std::vector<char> buffer(1024 * 1024);
+        while (stream) {
+            stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            EVP_DigestUpdate(context.get(), buffer.data(), static_cast<size_t>(stream.gcount()));
+        }
+
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digestSize = 0;
+        EVP_DigestFinal_ex(context.get(), digest, &digestSize);
+
+        std::string hex;
+        hex.reserve(digestSize * 2);
+        for (unsigned int i = 0; i < digestSize; i++) {
+            hex += fmt::format("{:02x}", digest[i]);
+        }
+
+        return hex;
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef ULTRAVERSE_STATE_STATELOGMANIFEST_HPP
+#define ULTRAVERSE_STATE_STATELOGMANIFEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Transaction.hpp"
+
+namespace ultraverse::state::v2 {
+    /**
+     * @brief 세그먼트로 나뉜 state log의 세그먼트 하나
+     * @details 세그먼트는 그 자체로 온전한 state log이며 (<name>.000000.ultstatelog, <name>.000000.ultindex, ...),
+     *          StateLogReader로 따로 읽을 수 있다.
+     */
+    struct StateLogSegment {
+        uint32_t index = 0;
+        /** 세그먼트의 로그 이름 (<name>.000000) */
+        std::string name;
+
+        gid_t firstGid = 0;
+        gid_t lastGid = 0;
+        uint64_t minTimestamp = 0;
+        uint64_t maxTimestamp = 0;
+        uint64_t transactionCount = 0;
+
+        /** .ultstatelog 파일 크기 (봉인될 때 기록) */
+        uint64_t size = 0;
+        /** .ultstatelog의 SHA-256 (봉인될 때 기록) */
+        std::string checksum;
+
+        /** 더 이상 쓰지 않는 세그먼트 */
+        bool sealed = false;
+        /** 보존 개수를 넘어 archive/ 로 옮겨진 세그먼트 */
+        bool archived = false;
+
+        /**
+         * @brief [startGid, endGid]와 겹치는 트랜잭션이 있을 수 있는지 확인한다.
+         * @note 봉인되지 않은 세그먼트는 lastGid가 아직 정해지지 않았으므로 끝이 열려 있다고 본다.
+         */
+        bool overlaps(gid_t startGid, gid_t endGid) const;
+    };
+
+    /**
+     * @brief 세그먼트로 나뉜 state log의 목록 (<name>.ultmanifest)
+     * @details 세그먼트가 봉인될 때마다 다시 쓴다. 임시 파일에 쓴 뒤 rename()하므로, 도중에 죽어도 이전 manifest가 남는다.
+     */
+    class StateLogManifest {
+    public:
+        static constexpr const char *ARCHIVE_DIRECTORY = "archive";
+
+        /**
+         * @brief manifest가 있으면 읽어들인다.
+         */
+        StateLogManifest(const std::string &logPath, const std::string &logName);
+
+        /**
+         * @brief 주어진 로그가 세그먼트로 나뉘어 있는지 확인한다.
+         */
+        static bool exists(const std::string &logPath, const std::string &logName);
+
+        static std::string segmentName(const std::string &logName, uint32_t index);
+
+        std::vector<StateLogSegment> &segments();
+        const std::vector<StateLogSegment> &segments() const;
+
+        /**
+         * @brief 새 세그먼트를 추가하고 반환한다.
+         */
+        StateLogSegment &addSegment();
+
+        void clear();
+        void save() const;
+
+        /**
+         * @brief 세그먼트를 봉인하고 크기와 체크섬을 기록한다.
+         */
+        void seal(StateLogSegment &segment) const;
+        /**
+         * @brief 봉인할 때 기록한 체크섬과 현재 파일이 일치하는지 확인한다.
+         */
+        bool verify(const StateLogSegment &segment) const;
+
+        /**
+         * @brief 보존할 세그먼트 수를 넘는 오래된 봉인 세그먼트들을 archive/ 로 옮긴다.
+         * @return 옮긴 세그먼트 수
+         */
+        size_t applyRetention(uint32_t retainedSegments);
+    private:
+        std::string manifestPath() const;
+
+        std::string _logPath;
+        std::string _logName;
+
+        std::vector<StateLogSegment> _segments;
+    };
+
+    /**
+     * @brief 파일의 SHA-256을 hex 문자열로 반환한다.
+     */
+    std::string sha256File(const std::string &path);
+}
+
+#endif //ULTRAVERSE_STATE_STATELOGMANIFEST_HPP
@@ -2,9 +2,11 @@
 // Created by cheesekun on 8/21/22.
 //
 
+#include "BlockCompressedStateLog.hpp"
 #include "GIDIndexReader.hpp"
 #include "StateLogReader.hpp"
 
+#include <cstring>
 #include <stdexcept>
 
 #include "ultraverse_state.pb.h"
@@ -22,18 +24,48 @@ namespace ultraverse::state::v2 {
     }
     
     void StateLogReader::open() {
+        openStream();
+    }
+
+    void StateLogReader::openStream() {
         std::string path = _logPath + "/" + _logName + ".ultstatelog";
-        _stream = std::ifstream(path, std::ios::in | std::ios::binary);
+        _stream.rdbuf(nullptr);
+        _blockBuf = nullptr;
+        _file.close();
+        // 버퍼는 열려 있던 스트림을 닫은 뒤에만 바꾼다
+        _readAheadBuffer.assign(_readAheadSize, '\0');
+        if (!_readAheadBuffer.empty()) {
+            // filebuf는 파일을 열기 전에 지정한 버퍼만 사용한다
+            _file.pubsetbuf(_readAheadBuffer.data(), static_cast<std::streamsize>(_readAheadBuffer.size()));
+        }
+        if (_file.open(path, std::ios::in | std::ios::binary) == nullptr) {
+            // 열리지 않은 ifstream처럼 모든 읽기가 실패한다
+            _stream.setstate(std::ios::failbit);
+            return;
+        }
+
+        char magic[sizeof(StateLogFileHeader::MAGIC)];
+        const bool isCompressed = _file.sgetn(magic, sizeof(magic)) == sizeof(magic) &&
+                                  std::memcmp(magic, StateLogFileHeader::MAGIC, sizeof(magic)) == 0;
+        _file.pubseekpos(0, std::ios::in);
+
+        if (isCompressed) {
+            _blockBuf = std::make_unique<StateLogBlockStreamBuf>(_file, _logPath, _logName);
+            _stream.rdbuf(_blockBuf.get());
+        } else {
+            _stream.rdbuf(&_file);
+        }
     }
     
     void StateLogReader::close() {
-        _stream.close();
+        _stream.rdbuf(nullptr);
+        _blockBuf = nullptr;
+        _file.close();
     }
     
     void StateLogReader::reset() {
-        _stream.close();
-        std::string path = _logPath + "/" + _logName + ".ultstatelog";
-        _stream = std::ifstream(path, std::ios::in | std::ios::binary);
+        close();
+        openStream();
         _currentHeader = nullptr;
         _currentBody = nullptr;
     }
@@ -64,48 +96,53 @@ namespace ultraverse::state::v2 {
     }
     
     bool StateLogReader::nextTransaction() {
-        if (_currentHeader == nullptr) {
+        std::string buffer;
+        if (!nextTransactionBytes(buffer)) {
             _currentBody = nullptr;
             return false;
         }
 
-        const auto startPos = static_cast<std::streamoff>(_stream.tellg());
-        if (!_stream.good()) {
-            _currentBody = nullptr;
-            return false;
-        }
+        _currentBody = decodeTransaction(buffer.data(), buffer.size());
+        return _currentBody != nullptr;
+    }
 
-        const auto endPos = static_cast<std::streamoff>(_currentHeader->nextPos);
-        if (endPos <= startPos) {
-            _currentBody = nullptr;
+    bool StateLogReader::nextTransactionBytes(std::string &bytes) {
+        if (_currentHeader == nullptr) {
             return false;
         }
 
-        const auto size = static_cast<size_t>(endPos - startPos);
-        std::string buffer(size, '\0');
-        _stream.read(buffer.data(), static_cast<std::streamsize>(size));
+        const auto startPos = static_cast<std::streamoff>(_stream.tellg());
         if (!_stream.good()) {
-            _currentBody = nullptr;
             return false;
         }
 
-        ultraverse::state::v2::proto::Transaction protoTxn;
-        if (!protoTxn.ParseFromString(buffer)) {
-            _currentBody = nullptr;
+        const auto endPos = static_cast<std::streamoff>(_currentHeader->nextPos);
+        if (endPos <= startPos) {
             return false;
         }
 
-        auto transaction = std::make_shared<Transaction>();
-        transaction->fromProtobuf(protoTxn);
-        _currentBody = transaction;
-
-        return true;
+        const auto size = static_cast<size_t>(endPos - startPos);
+        bytes.resize(size);
+        _stream.read(bytes.data(), static_cast<std::streamsize>(size));
+        return _stream.good();
     }
     
     void StateLogReader::skipTransaction() {
-        if (_currentHeader != nullptr) {
-            _stream.seekg(_currentHeader->nextPos);
+        if (_currentHeader == nullptr) {
+            return;
         }
+
+        if (!_readAheadBuffer.empty()) {
+            // seekg()는 버퍼를 버리고 다시 채우므로, 버퍼보다 가까운 거리는 읽어서 건너뛴다
+            const auto current = static_cast<std::streamoff>(_stream.tellg());
+            const auto distance = static_cast<std::streamoff>(_currentHeader->nextPos) - current;
+            if (current >= 0 && distance >= 0 && distance <= static_cast<std::streamoff>(_readAheadBuffer.size())) {
+                _stream.ignore(distance);
+                return;
+            }
+        }
+
+        _stream.seekg(_currentHeader->nextPos);
     }
     
     bool StateLogReader::next() {
@@ -121,13 +158,34 @@ namespace ultraverse::state::v2 {
     }
 
     bool StateLogReader::seekGid(gid_t gid) {
+        if (_blockBuf != nullptr) {
+            // 블록 인덱스로 gid가 들어 있는 블록을 찾고, 블록 안에서는 헤더를 따라간다
+            auto blockPos = _blockBuf->blockPosOf(gid);
+            if (!blockPos.has_value()) {
+                return false;
+            }
+
+            seek(*blockPos);
+            while (nextHeader()) {
+                if (_currentHeader->gid == gid) {
+                    seek(pos() - sizeof(TransactionHeader));
+                    return true;
+                }
+                skipTransaction();
+            }
+
+            return false;
+        }
+
         if (_gidIndexReader == nullptr) {
             _gidIndexReader = std::make_unique<GIDIndexReader>(_logPath, _logName);
         }
 
-        auto offset = _gidIndexReader->offsetOf(gid);
-        seek(offset);
-        return true;
+        return _gidIndexReader->seek(*this, gid);
+    }
+    
+    void StateLogReader::setReadAheadSize(size_t bytes) {
+        _readAheadSize = bytes;
     }
     
     void StateLogReader::operator>>(RowCluster &rowCluster) {
@@ -7,6 +7,7 @@
 
 #include <fstream>
 #include <memory>
+#include <vector>
 
 #include "StateIO.hpp"
 #include "Transaction.hpp"
@@ -17,7 +18,12 @@
 
 namespace ultraverse::state::v2 {
     class GIDIndexReader;
+    class StateLogBlockStreamBuf;
 
+    /**
+     * @brief .ultstatelog를 순차적으로 읽는 IStateLogReader 구현
+     * @note 블록 압축된 로그 (StateLogFileHeader로 시작하는 로그)도 그대로 읽는다. 이 경우 pos()는 논리 위치를 반환한다.
+     */
     class StateLogReader: public IStateLogReader {
     public:
         StateLogReader(const std::string &logPath, const std::string &logName);
@@ -33,6 +39,7 @@ namespace ultraverse::state::v2 {
         
         bool nextHeader() override;
         bool nextTransaction() override;
+        bool nextTransactionBytes(std::string &bytes) override;
         
         void skipTransaction() override;
         
@@ -42,6 +49,11 @@ namespace ultraverse::state::v2 {
         std::shared_ptr<Transaction> txnBody() override;
 
         bool seekGid(gid_t gid) override;
+
+        /**
+         * @brief 버퍼를 키우면 skipTransaction()도 버퍼 안에서는 seek 대신 건너뛰어 읽는다.
+         */
+        void setReadAheadSize(size_t bytes) override;
     
         void operator>>(RowCluster &rowCluster);
         void operator>>(ColumnDependencyGraph &graph);
@@ -51,10 +63,17 @@ namespace ultraverse::state::v2 {
         void loadColumnDependencyGraph(ColumnDependencyGraph &graph);
         void loadTableDependencyGraph(TableDependencyGraph &graph);
     private:
+        void openStream();
+
         std::string _logPath;
         std::string _logName;
         
-        std::ifstream _stream;
+        std::filebuf _file;
+        std::unique_ptr<StateLogBlockStreamBuf> _blockBuf;
+        /** _file 또는 _blockBuf를 읽는다 */
+        std::istream _stream {nullptr};
+        size_t _readAheadSize = 0;
+        std::vector<char> _readAheadBuffer;
         
         std::shared_ptr<TransactionHeader> _currentHeader;
         std::shared_ptr<Transaction> _currentBody;
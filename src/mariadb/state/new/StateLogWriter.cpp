@@ -3,9 +3,21 @@
 //
 
 #include "StateLogWriter.hpp"
+#include "BlockCompressedStateLog.hpp"
+#include "GIDIndexWriter.hpp"
+#include "TimestampIndex.hpp"
+#include "StateKeyIndex.hpp"
+#include "StateLogManifest.hpp"
+#include "StateRWSummary.hpp"
+#include "StateZoneMap.hpp"
+#include "StateLogCheckpoint.hpp"
 
+#include <algorithm>
+#include <filesystem>
 #include <stdexcept>
 
+#include <fmt/format.h>
+
 #include "ultraverse_state.pb.h"
 
 namespace ultraverse::state::v2 {
@@ -18,21 +30,212 @@ namespace ultraverse::state::v2 {
     StateLogWriter::~StateLogWriter() {
     
     }
+
+    void StateLogWriter::setBlockCompression(uint32_t transactionsPerBlock, int level) {
+        std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        _transactionsPerBlock = transactionsPerBlock;
+        _compressionLevel = level;
+    }
+    
+    void StateLogWriter::setSymbolTableEncoding(bool useSymbolTable) {
+        std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        _useSymbolTable = useSymbolTable;
+    }
+    
+    void StateLogWriter::setGidIndexEnabled(bool enabled) {
+        std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        _isGidIndexEnabled = enabled;
+    }
+    
+    void StateLogWriter::setTimestampIndexInterval(uint32_t interval) {
+        std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        _timestampIndexInterval = interval;
+    }
+    
+    void StateLogWriter::setKeyIndexColumns(const std::set<std::string> &columns) {
+        std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        _keyIndexColumns = columns;
+    }
     
+    void StateLogWriter::setRWSummaryEnabled(bool enabled) {
+        std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        _isRWSummaryEnabled = enabled;
+    }
+    
+    void StateLogWriter::setZoneMap(uint32_t transactionsPerZone, const std::set<std::string> &columns) {
+        std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        _transactionsPerZone = transactionsPerZone;
+        _zoneMapColumns = columns;
+    }
+    
+    void StateLogWriter::setSegmentation(uint64_t segmentSize, uint32_t retainedSegments) {
+        std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        _segmentSize = segmentSize;
+        _retainedSegments = retainedSegments;
+    }
+    
+    void StateLogWriter::restore(const StateLogCheckpoint &checkpoint) {
+        std::scoped_lock<std::mutex> _scopedLock(_mutex);
+
+        for (const auto &[name, size] : checkpoint.files) {
+            auto path = _logPath + "/" + name;
+
+            std::error_code ec;
+            auto fileSize = std::filesystem::file_size(path, ec);
+            if (ec) {
+                fileSize = 0;
+            }
+
+            if (fileSize < size) {
+                throw std::runtime_error(fmt::format(
+                    "{} is shorter than the checkpoint ({} < {} bytes)", path, fileSize, size
+                ));
+            }
+            if (fileSize > size) {
+                // 덜 쓰인 레코드와 체크포인트 뒤에 쓰인 레코드를 버린다
+                std::filesystem::resize_file(path, size);
+            }
+        }
+
+        if (!checkpoint.segment.has_value()) {
+            return;
+        }
+
+        StateLogManifest manifest(_logPath, _logName);
+        auto &segments = manifest.segments();
+
+        auto it = std::find_if(segments.begin(), segments.end(), [&checkpoint](const auto &segment) {
+            return segment.index == checkpoint.segment->index;
+        });
+        if (it == segments.end() || it->archived) {
+            throw std::runtime_error(fmt::format("segment {} of the checkpoint is not available", checkpoint.segment->name));
+        }
+
+        // 체크포인트 뒤에 만들어진 세그먼트를 지운다
+        for (auto next = std::next(it); next != segments.end(); ++next) {
+            auto segmentPath = std::filesystem::path(_logPath) / next->name;
+            auto directory = segmentPath.parent_path();
+            auto prefix = segmentPath.filename().string() + ".";
+
+            for (const auto &entry : std::filesystem::directory_iterator(directory.empty() ? "." : directory)) {
+                if (entry.path().filename().string().rfind(prefix, 0) == 0) {
+                    std::filesystem::remove(entry.path());
+                }
+            }
+        }
+        segments.erase(std::next(it), segments.end());
+
+        // 봉인된 세그먼트였더라도 다시 쓰는 중인 세그먼트가 된다
+        *it = *checkpoint.segment;
+        manifest.save();
+    }
+
     void StateLogWriter::open(std::ios_base::openmode openMode) {
         std::scoped_lock<std::mutex> _scopedLock(_mutex);
-        std::string fileName = _logPath + "/" + _logName + ".ultstatelog";
+        const bool isAppend = (openMode & std::ios::app) && !(openMode & std::ios::trunc);
+
+        _manifest = nullptr;
+        if (_segmentSize > 0) {
+            _manifest = std::make_unique<StateLogManifest>(_logPath, _logName);
+            if (!isAppend) {
+                _manifest->clear();
+            }
+
+            if (_manifest->segments().empty() || _manifest->segments().back().sealed) {
+                openLog(_manifest->addSegment().name, std::ios::out | std::ios::binary | std::ios::trunc);
+            } else {
+                openLog(_manifest->segments().back().name, openMode);
+            }
+            _manifest->save();
+        } else {
+            openLog(_logName, openMode);
+        }
+
+        _keyIndexWriter = nullptr;
+        if (!_keyIndexColumns.empty()) {
+            _keyIndexWriter = std::make_unique<StateKeyIndexWriter>(_logPath, _logName, _keyIndexColumns, !isAppend);
+        }
+
+        _rwSummaryWriter = nullptr;
+        if (_isRWSummaryEnabled) {
+            _rwSummaryWriter = std::make_unique<StateRWSummaryWriter>(_logPath, _logName, !isAppend);
+        }
+    }
+
+    void StateLogWriter::openLog(const std::string &logName, std::ios_base::openmode openMode) {
+        std::string fileName = _logPath + "/" + logName + ".ultstatelog";
         _stream = std::ofstream(fileName, openMode);
+        _currentLogName = logName;
+
+        _compressor = nullptr;
+        if (_transactionsPerBlock > 0) {
+            _compressor = std::make_unique<StateLogBlockCompressor>(_logPath, logName, _transactionsPerBlock, _compressionLevel);
+            _compressor->open(_stream, (openMode & std::ios::app) && !(openMode & std::ios::trunc));
+        } else if ((openMode & std::ios::app) && isBlockCompressedStateLog(_logPath, logName)) {
+            throw std::runtime_error("cannot append uncompressed transactions to block-compressed state log " + fileName);
+        }
+
+        const bool isAppend = (openMode & std::ios::app) && !(openMode & std::ios::trunc);
+
+        _gidIndexWriter = nullptr;
+        if (_isGidIndexEnabled) {
+            _gidIndexWriter = std::make_unique<GIDIndexWriter>(_logPath, logName, !isAppend);
+        }
+
+        _timestampIndexWriter = nullptr;
+        if (_timestampIndexInterval > 0) {
+            _timestampIndexWriter = std::make_unique<TimestampIndexWriter>(_logPath, logName, _timestampIndexInterval, !isAppend);
+        }
+
+        _zoneMapWriter = nullptr;
+        if (_transactionsPerZone > 0) {
+            _zoneMapWriter = std::make_unique<StateZoneMapWriter>(_logPath, logName, _zoneMapColumns, _transactionsPerZone, !isAppend);
+        }
     }
     
     void StateLogWriter::close() {
         std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        closeLog();
+
+        if (_manifest != nullptr) {
+            // 쓰고 있던 세그먼트의 gid / timestamp 범위를 남긴다
+            _manifest->save();
+        }
+        _keyIndexWriter = nullptr;
+        _rwSummaryWriter = nullptr;
+    }
+
+    void StateLogWriter::closeLog() {
+        if (_compressor != nullptr) {
+            _compressor->flush(_stream);
+        }
         _stream.flush();
         _stream.close();
+
+        // 인덱스가 로그보다 나중에 갱신되도록 로그를 닫은 뒤에 닫는다
+        _gidIndexWriter = nullptr;
+        _timestampIndexWriter = nullptr;
+        _zoneMapWriter = nullptr;
+    }
+
+    void StateLogWriter::rotateSegment() {
+        closeLog();
+
+        _manifest->seal(_manifest->segments().back());
+        _manifest->applyRetention(_retainedSegments);
+
+        // 새 세그먼트를 만든 뒤에 manifest를 쓴다
+        openLog(_manifest->addSegment().name, std::ios::out | std::ios::binary | std::ios::trunc);
+        _manifest->save();
     }
 
     bool StateLogWriter::seek(int64_t position) {
         std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        if (_compressor != nullptr) {
+            // 압축된 블록은 덮어쓸 수 없다
+            return false;
+        }
+
         _stream.seekp(position);
 
         return _stream.good();
@@ -40,6 +243,10 @@ namespace ultraverse::state::v2 {
 
     int64_t StateLogWriter::pos() {
         std::scoped_lock<std::mutex> _scopedLock(_mutex);
+        if (_compressor != nullptr) {
+            return _compressor->logicalPos();
+        }
+
         return _stream.tellp();
     }
     
@@ -47,19 +254,127 @@ namespace ultraverse::state::v2 {
         std::scoped_lock<std::mutex> _scopedLock(_mutex);
         auto header = transaction.header();
         ultraverse::state::v2::proto::Transaction protoTxn;
-        transaction.toProtobuf(&protoTxn);
+        transaction.toProtobuf(&protoTxn, _useSymbolTable);
         std::string transactionString;
         if (!protoTxn.SerializeToString(&transactionString)) {
             throw std::runtime_error("failed to serialize transaction protobuf");
         }
 
-        const auto currentPos = static_cast<std::streamoff>(_stream.tellp());
-        auto nextPos = static_cast<uint64_t>(currentPos) + sizeof(TransactionHeader) + transactionString.size();
-        header.nextPos = nextPos;
+        if (_keyIndexWriter != nullptr) {
+            _keyIndexWriter->write(transaction);
+        }
+        if (_rwSummaryWriter != nullptr) {
+            _rwSummaryWriter->write(transaction);
+        }
+
+        if (_manifest != nullptr) {
+            auto &segment = _manifest->segments().back();
+            if (segment.transactionCount == 0) {
+                segment.firstGid = header.gid;
+                segment.minTimestamp = header.timestamp;
+            }
+            segment.lastGid = header.gid;
+            segment.minTimestamp = std::min<uint64_t>(segment.minTimestamp, header.timestamp);
+            segment.maxTimestamp = std::max<uint64_t>(segment.maxTimestamp, header.timestamp);
+            segment.transactionCount++;
+        }
+
+        if (_compressor != nullptr) {
+            header.nextPos = _compressor->logicalPos() + sizeof(TransactionHeader) + transactionString.size();
 
-        _stream.write((char *)&header, sizeof(TransactionHeader));
-        _stream.write(transactionString.c_str(), transactionString.size());
+            if (_gidIndexWriter != nullptr) {
+                _gidIndexWriter->write(header.gid, _compressor->logicalPos());
+            }
+            if (_timestampIndexWriter != nullptr) {
+                _timestampIndexWriter->write(header.gid, header.timestamp, _compressor->logicalPos());
+            }
+            if (_zoneMapWriter != nullptr) {
+                _zoneMapWriter->write(transaction, _compressor->logicalPos(), header.nextPos);
+            }
+
+            std::string record((char *) &header, sizeof(TransactionHeader));
+            record += transactionString;
+            _compressor->append(header.gid, record, _stream);
+        } else {
+            const auto currentPos = static_cast<std::streamoff>(_stream.tellp());
+            auto nextPos = static_cast<uint64_t>(currentPos) + sizeof(TransactionHeader) + transactionString.size();
+            header.nextPos = nextPos;
+
+            if (_gidIndexWriter != nullptr) {
+                _gidIndexWriter->write(header.gid, currentPos);
+            }
+            if (_timestampIndexWriter != nullptr) {
+                _timestampIndexWriter->write(header.gid, header.timestamp, currentPos);
+            }
+            if (_zoneMapWriter != nullptr) {
+                _zoneMapWriter->write(transaction, currentPos, nextPos);
+            }
+
+            _stream.write((char *)&header, sizeof(TransactionHeader));
+            _stream.write(transactionString.c_str(), transactionString.size());
+            _stream.flush();
+        }
+
+        // 압축된 로그는 블록이 쓰일 때에만 파일이 커지므로, 세그먼트는 블록 경계에서 넘어간다
+        if (_manifest != nullptr && static_cast<uint64_t>(_stream.tellp()) >= _segmentSize) {
+            rotateSegment();
+        }
+    }
+    
+    void StateLogWriter::checkpoint(StateLogCheckpoint &checkpoint) {
+        std::scoped_lock<std::mutex> _scopedLock(_mutex);
+
+        if (_compressor != nullptr) {
+            _compressor->flush(_stream);
+        }
         _stream.flush();
+
+        if (_gidIndexWriter != nullptr) {
+            _gidIndexWriter->flush();
+        }
+        if (_timestampIndexWriter != nullptr) {
+            _timestampIndexWriter->flush();
+        }
+        if (_zoneMapWriter != nullptr) {
+            _zoneMapWriter->flush();
+        }
+        if (_keyIndexWriter != nullptr) {
+            _keyIndexWriter->flush();
+        }
+        if (_rwSummaryWriter != nullptr) {
+            _rwSummaryWriter->flush();
+        }
+
+        checkpoint.logName = _currentLogName;
+        checkpoint.logOffset = _compressor != nullptr ?
+            _compressor->logicalPos() :
+            static_cast<uint64_t>(static_cast<std::streamoff>(_stream.tellp()));
+        checkpoint.files.clear();
+
+        auto addFile = [this, &checkpoint](const std::string &name) {
+            auto path = _logPath + "/" + name;
+            if (!std::filesystem::exists(path)) {
+                return;
+            }
+
+            syncFile(path);
+            checkpoint.files[name] = std::filesystem::file_size(path);
+        };
+
+        for (const auto *extension : { "ultstatelog", "ultindex", "ulttimeindex", "ultblockindex", "ultdict", "ultzonemap" }) {
+            addFile(fmt::format("{}.{}", _currentLogName, extension));
+        }
+        for (const auto *extension : { "ultkeyindex", "ultsummary" }) {
+            addFile(fmt::format("{}.{}", _logName, extension));
+        }
+
+        checkpoint.segment = std::nullopt;
+        if (_manifest != nullptr) {
+            checkpoint.segment = _manifest->segments().back();
+            _manifest->save();
+        }
+
+        checkpoint.save(_logPath, _logName);
     }
     
     void StateLogWriter::operator<<(RowCluster &rowCluster) {
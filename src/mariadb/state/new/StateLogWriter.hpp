@@ -6,7 +6,9 @@
 #define ULTRAVERSE_STATE_STATELOGWRITER_HPP
 
 #include <fstream>
+#include <memory>
 #include <mutex>
+#include <set>
 
 #include "Transaction.hpp"
 #include "ColumnDependencyGraph.hpp"
@@ -14,11 +16,88 @@
 #include "cluster/RowCluster.hpp"
 
 namespace ultraverse::state::v2 {
+    class StateLogBlockCompressor;
+    class GIDIndexWriter;
+    class TimestampIndexWriter;
+    class StateKeyIndexWriter;
+    class StateLogManifest;
+    class StateRWSummaryWriter;
+    class StateZoneMapWriter;
+    struct StateLogCheckpoint;
+
     class StateLogWriter {
     public:
         StateLogWriter(const std::string &logPath, const std::string &logName);
         ~StateLogWriter();
         
+        /**
+         * @brief 트랜잭션을 transactionsPerBlock개씩 묶어 zstd로 압축해서 쓴다. 0이면 압축하지 않는다.
+         * @note open() 전에 호출해야 한다. 블록이 다 차기 전까지의 트랜잭션은 close()할 때까지 파일에 쓰이지 않는다.
+         * @see StateLogFileHeader
+         */
+        void setBlockCompression(uint32_t transactionsPerBlock, int level);
+
+        /**
+         * @brief 트랜잭션마다 컬럼 / 테이블 이름을 심볼 테이블로 모아 id로 기록한다.
+         * @note 로그 크기만 줄인다. 읽을 때는 이름을 다시 문자열로 풀어 쓴다.
+         * @see StateSymbolTable
+         */
+        void setSymbolTableEncoding(bool useSymbolTable);
+
+        /**
+         * @brief 트랜잭션을 쓸 때마다 .ultindex에 gid -> 오프셋을 함께 기록한다. (기본값: true)
+         * @note open() 전에 호출해야 한다. 인덱스는 버퍼링되어 close()할 때 모두 쓰인다.
+         * @see GIDIndexWriter
+         */
+        void setGidIndexEnabled(bool enabled);
+
+        /**
+         * @brief 트랜잭션 interval개마다 .ulttimeindex에 (timestamp, gid, offset)을 기록한다. 0이면 기록하지 않는다.
+         * @note open() 전에 호출해야 한다.
+         * @see TimestampIndexWriter
+         */
+        void setTimestampIndexInterval(uint32_t interval);
+
+        /**
+         * @brief 주어진 컬럼들에 대해 .ultkeyindex에 (컬럼, 범위) -> gid 역색인을 기록한다. 비어 있으면 기록하지 않는다.
+         * @note open() 전에 호출해야 한다.
+         * @see StateKeyIndexWriter
+         */
+        void setKeyIndexColumns(const std::set<std::string> &columns);
+
+        /**
+         * @brief 트랜잭션마다 .ultsummary에 읽기 / 쓰기 컬럼 요약을 기록한다.
+         * @note open() 전에 호출해야 한다.
+         * @see StateRWSummaryWriter
+         */
+        void setRWSummaryEnabled(bool enabled);
+
+        /**
+         * @brief 트랜잭션 transactionsPerZone개마다 .ultzonemap에 columns의 min / max와 bloom filter를 기록한다.
+         *        transactionsPerZone이 0이면 기록하지 않는다.
+         * @note open() 전에 호출해야 한다. 세그먼트로 나뉜 로그에서는 세그먼트마다 따로 기록한다.
+         * @see StateZoneMapWriter
+         */
+        void setZoneMap(uint32_t transactionsPerZone, const std::set<std::string> &columns);
+
+        /**
+         * @brief 로그가 segmentSize 바이트를 넘을 때마다 새 세그먼트로 넘어간다. 0이면 나누지 않는다.
+         * @details 세그먼트는 자체 .ultindex / .ulttimeindex를 가진 온전한 로그 (<name>.000000.ultstatelog, ...)이며,
+         *          목록은 <name>.ultmanifest에 기록된다. .ultkeyindex는 세그먼트와 관계없이 <name>으로 하나만 쓴다.
+         *          retainedSegments가 0이 아니면, 그 수를 넘는 오래된 봉인 세그먼트는 archive/ 로 옮긴다.
+         * @note open() 전에 호출해야 한다.
+         * @see StateLogManifest, SegmentedStateLogReader
+         */
+        void setSegmentation(uint64_t segmentSize, uint32_t retainedSegments);
+
+        /**
+         * @brief 체크포인트 뒤에 쓰인 내용을 버린다. 로그와 사이드카를 체크포인트 시점의 크기로 자르고,
+         *        세그먼트로 나뉜 로그라면 그 뒤에 만들어진 세그먼트를 지우고 manifest를 되돌린다.
+         * @note open() 전에 호출해야 하며, 그 뒤에는 std::ios::app으로 open()해야 한다.
+         * @throws std::runtime_error 파일이 체크포인트보다 짧은 경우 (체크포인트 뒤에 유실된 경우)
+         */
+        void restore(const StateLogCheckpoint &checkpoint);
+
         void open(std::ios_base::openmode openMode);
         void close();
         bool seek(int64_t position);
@@ -33,13 +112,52 @@ namespace ultraverse::state::v2 {
         void writeRowCluster(RowCluster &rowCluster);
         void writeColumnDependencyGraph(ColumnDependencyGraph &graph);
         void writeTableDependencyGraph(TableDependencyGraph &graph);
-        void writeCheckpoint();
+
+        /**
+         * @brief 지금까지 쓴 트랜잭션을 (압축 중인 블록과 사이드카 버퍼까지) 모두 파일에 쓰고 fsync()한 뒤,
+         *        로그 쪽 위치를 checkpoint에 채워 .ultcheckpoint에 저장한다.
+         * @note binlog 쪽 위치는 호출하는 쪽에서 미리 채워야 한다.
+         *       압축 중인 블록과 zone / key index run은 transactionsPerBlock 등을 채우지 않았더라도 이 때 쓰인다.
+         * @see StateLogCheckpoint
+         */
+        void checkpoint(StateLogCheckpoint &checkpoint);
     private:
+        void openLog(const std::string &logName, std::ios_base::openmode openMode);
+        void closeLog();
+        void rotateSegment();
+
         std::string _logPath;
         std::string _logName;
+        /** 쓰고 있는 로그 (세그먼트)의 이름 */
+        std::string _currentLogName;
         
         std::ofstream _stream;
         std::mutex _mutex;
+
+        uint32_t _transactionsPerBlock = 0;
+        int _compressionLevel = 0;
+        bool _useSymbolTable = false;
+        std::unique_ptr<StateLogBlockCompressor> _compressor;
+
+        bool _isGidIndexEnabled = true;
+        std::unique_ptr<GIDIndexWriter> _gidIndexWriter;
+
+        uint32_t _timestampIndexInterval = 0;
+        std::unique_ptr<TimestampIndexWriter> _timestampIndexWriter;
+
+        std::set<std::string> _keyIndexColumns;
+        std::unique_ptr<StateKeyIndexWriter> _keyIndexWriter;
+
+        bool _isRWSummaryEnabled = false;
+        std::unique_ptr<StateRWSummaryWriter> _rwSummaryWriter;
+
+        uint32_t _transactionsPerZone = 0;
+        std::set<std::string> _zoneMapColumns;
+        std::unique_ptr<StateZoneMapWriter> _zoneMapWriter;
+
+        uint64_t _segmentSize = 0;
+        uint32_t _retainedSegments = 0;
+        std::unique_ptr<StateLogManifest> _manifest;
     };
 }
 
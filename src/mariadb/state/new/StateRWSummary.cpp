@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "ultraverse_state.pb.h"
+
+#include "Query.hpp"
+#include "StateIO.hpp"
+#include "StateRWSummary.hpp"
+
+namespace {
+    std::string summaryPath(const std::string &logPath, const std::string &logName) {
+        return fmt::format("{}/{}.ultsummary", logPath, logName);
+    }
+
+    std::string encodeBitset(const std::vector<uint32_t> &ids) {
+        std::string bitset;
+        for (auto id : ids) {
+            if (bitset.size() <= id / 8) {
+                bitset.resize(id / 8 + 1, '\0');
+            }
+            bitset[id / 8] = static_cast<char>(bitset[id / 8] | (1 << (id % 8)));
+        }
+
+        return bitset;
+    }
+
+    void decodeBitset(const std::string &bitset, std::vector<uint32_t> &out) {
+        out.clear();
+        for (size_t i = 0; i < bitset.size(); i++) {
+            auto byte = static_cast<uint8_t>(bitset[i]);
+            for (uint32_t bit = 0; byte != 0; bit++, byte >>= 1) {
+                if (byte & 1) {
+                    out.push_back(static_cast<uint32_t>(i * 8 + bit));
+                }
+            }
+        }
+    }
+}
+
+namespace ultraverse::state::v2 {
+    StateRWSummaryWriter::StateRWSummaryWriter(const std::string &logPath, const std::string &logName, bool truncate) {
+        auto path = summaryPath(logPath, logName);
+
+        if (!truncate && std::filesystem::exists(path)) {
+            // 심볼 id를 이어서 매기기 위해 기존 심볼 테이블을 복원한다
+            truncateTornRecords<proto::TransactionRWSummary>(path, [this](const proto::TransactionRWSummary &record) {
+                for (const auto &symbol : record.new_symbols()) {
+                    _symbols.intern(symbol);
+                }
+            });
+        }
+
+        _stream.open(path, std::ios::out | std::ios::binary | (truncate ? std::ios::trunc : std::ios::app));
+        if (!_stream) {
+            throw std::runtime_error(fmt::format("failed to open {}", path));
+        }
+    }
+
+    StateRWSummaryWriter::~StateRWSummaryWriter() {
+        _stream.flush();
+        _stream.close();
+    }
+
+    void StateRWSummaryWriter::write(Transaction &transaction) {
+        proto::TransactionRWSummary record;
+        record.set_gid(transaction.gid());
+        record.set_flags(transaction.flags());
+        record.set_query_count(static_cast<uint32_t>(transaction.queries().size()));
+
+        std::vector<uint32_t> databases;
+        std::vector<uint32_t> readColumns;
+        std::vector<uint32_t> writeColumns;
+        std::vector<uint32_t> itemColumns;
+
+        for (const auto &query : transaction.queries()) {
+            databases.push_back(intern(query->database(), record));
+
+            if (query->flags() & Query::FLAG_IS_DDL) {
+                continue;
+            }
+
+            for (const auto &column : query->readColumns()) {
+                readColumns.push_back(intern(column, record));
+            }
+            for (const auto &column : query->writeColumns()) {
+                writeColumns.push_back(intern(column, record));
+            }
+
+            for (const auto &item : query->readSet()) {
+                if (!item.name.empty()) {
+                    itemColumns.push_back(intern(item.name, record));
+                }
+            }
+            for (const auto &item : query->writeSet()) {
+                if (!item.name.empty()) {
+                    itemColumns.push_back(intern(item.name, record));
+                }
+            }
+        }
+
+        record.set_databases(encodeBitset(databases));
+        record.set_read_columns(encodeBitset(readColumns));
+        record.set_write_columns(encodeBitset(writeColumns));
+        record.set_item_columns(encodeBitset(itemColumns));
+
+        std::string serialized;
+        if (!record.SerializeToString(&serialized)) {
+            throw std::runtime_error("failed to serialize transaction summary protobuf");
+        }
+
+        auto size = static_cast<uint32_t>(serialized.size());
+        _stream.write(reinterpret_cast<const char *>(&size), sizeof(uint32_t));
+        _stream.write(serialized.data(), static_cast<std::streamsize>(serialized.size()));
+    }
+
+    void StateRWSummaryWriter::flush() {
+        _stream.flush();
+    }
+
+    uint32_t StateRWSummaryWriter::intern(const std::string &symbol, proto::TransactionRWSummary &record) {
+        const auto symbolCount = _symbols.size();
+        const auto id = _symbols.intern(symbol);
+
+        if (_symbols.size() != symbolCount) {
+            record.add_new_symbols(symbol);
+        }
+
+        return id;
+    }
+
+    StateRWSummaryReader::StateRWSummaryReader(const std::string &logPath, const std::string &logName) {
+        auto path = summaryPath(logPath, logName);
+        _stream.open(path, std::ios::in | std::ios::binary);
+        if (!_stream) {
+            throw std::runtime_error(fmt::format("failed to open {}", path));
+        }
+    }
+
+    bool StateRWSummaryReader::exists(const std::string &logPath, const std::string &logName) {
+        return std::filesystem::exists(summaryPath(logPath, logName));
+    }
+
+    const TransactionRWSummary *StateRWSummaryReader::advanceTo(gid_t gid) {
+        while (!_hasCurrent || _current.gid < gid) {
+            if (!readNext()) {
+                return nullptr;
+            }
+        }
+
+        return _current.gid == gid ? &_current : nullptr;
+    }
+
+    const std::string &StateRWSummaryReader::symbol(uint32_t id) const {
+        return _symbols.symbol(id);
+    }
+
+    bool StateRWSummaryReader::isRelatedToDatabase(const TransactionRWSummary &summary, const std::string &database) const {
+        return std::any_of(summary.databases.begin(), summary.databases.end(), [this, &database](uint32_t id) {
+            return _symbols.symbol(id) == database;
+        });
+    }
+
+    bool StateRWSummaryReader::readNext() {
+        if (_isEOF) {
+            return false;
+        }
+
+        std::string buffer;
+        proto::TransactionRWSummary record;
+        if (!readRecord(_stream, buffer, record)) {
+            _isEOF = true;
+            _hasCurrent = false;
+            return false;
+        }
+
+        for (const auto &symbol : record.new_symbols()) {
+            _symbols.intern(symbol);
+        }
+
+        _current.gid = record.gid();
+        _current.flags = static_cast<uint8_t>(record.flags());
+        _current.queryCount = record.query_count();
+        decodeBitset(record.databases(), _current.databases);
+        decodeBitset(record.read_columns(), _current.readColumns);
+        decodeBitset(record.write_columns(), _current.writeColumns);
+        decodeBitset(record.item_columns(), _current.itemColumns);
+        _hasCurrent = true;
+
+        return true;
+    }
+}
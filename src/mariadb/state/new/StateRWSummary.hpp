@@ -0,0 +1,93 @@
+#ifndef ULTRAVERSE_STATE_STATERWSUMMARY_HPP
+#define ULTRAVERSE_STATE_STATERWSUMMARY_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Transaction.hpp"
+#include "StateSymbolTable.hpp"
+
+namespace ultraverse::state::v2 {
+    namespace proto {
+        class TransactionRWSummary;
+    }
+
+    /**
+     * @brief 트랜잭션 본문을 디코딩하지 않고 의존성 분석을 하기 위한 트랜잭션 요약
+     * @details 컬럼 / 데이터베이스 이름은 StateRWSummaryReader::symbol()로 얻는 심볼 id로 담긴다.
+     *          DDL 쿼리의 컬럼은 TaintAnalyzer::collectColumnRW()와 같이 포함하지 않는다.
+     */
+    struct TransactionRWSummary {
+        gid_t gid = 0;
+        uint8_t flags = 0;
+        uint32_t queryCount = 0;
+
+        std::vector<uint32_t> databases;
+        std::vector<uint32_t> readColumns;
+        std::vector<uint32_t> writeColumns;
+        /** read / write set의 (최상위) StateItem이 가리키는 컬럼들 */
+        std::vector<uint32_t> itemColumns;
+    };
+
+    /**
+     * @brief 트랜잭션 요약 (.ultsummary)을 로그와 같은 순서로 이어 쓰는 클래스
+     * @details .ultsummary는 [uint32_t size][proto::TransactionRWSummary]의 연속이다.
+     *          이름은 파일 전체에서 하나의 심볼 테이블을 공유하며, 레코드에는 처음 나온 이름만 함께 기록한다.
+     */
+    class StateRWSummaryWriter {
+    public:
+        /**
+         * @param truncate true면 기존 요약을 비우고 새로 쓴다.
+         *                 false면 기존 요약의 심볼 테이블을 이어받고, 덜 쓰인 마지막 레코드는 잘라낸다.
+         */
+        StateRWSummaryWriter(const std::string &logPath, const std::string &logName, bool truncate);
+        StateRWSummaryWriter(StateRWSummaryWriter &) = delete;
+
+        ~StateRWSummaryWriter();
+
+        void write(Transaction &transaction);
+        void flush();
+    private:
+        uint32_t intern(const std::string &symbol, proto::TransactionRWSummary &record);
+
+        std::ofstream _stream;
+        StateSymbolTable _symbols;
+    };
+
+    /**
+     * @brief .ultsummary를 앞에서부터 순서대로 읽는 클래스
+     */
+    class StateRWSummaryReader {
+    public:
+        /**
+         * @throws std::runtime_error 요약 파일이 없는 경우
+         */
+        StateRWSummaryReader(const std::string &logPath, const std::string &logName);
+
+        static bool exists(const std::string &logPath, const std::string &logName);
+
+        /**
+         * @brief gid의 요약이 나올 때까지 앞으로 읽는다.
+         * @return gid의 요약. 요약에 gid가 없으면 nullptr을 반환한다. (다음 호출에 영향을 주지 않는다)
+         * @note gid는 호출할 때마다 증가해야 한다. 반환된 포인터는 다음 호출까지만 유효하다.
+         */
+        const TransactionRWSummary *advanceTo(gid_t gid);
+
+        const std::string &symbol(uint32_t id) const;
+
+        bool isRelatedToDatabase(const TransactionRWSummary &summary, const std::string &database) const;
+    private:
+        bool readNext();
+
+        std::ifstream _stream;
+        StateSymbolTable _symbols;
+
+        TransactionRWSummary _current;
+        bool _hasCurrent = false;
+        bool _isEOF = false;
+    };
+}
+
+#endif //ULTRAVERSE_STATE_STATERWSUMMARY_HPP
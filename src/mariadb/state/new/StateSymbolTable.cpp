@@ -0,0 +1,50 @@
+#include <cassert>
+#include <stdexcept>
+
+#include <google/protobuf/repeated_field.h>
+
+#include "StateSymbolTable.hpp"
+
+namespace ultraverse::state::v2 {
+    uint32_t StateSymbolTable::intern(const std::string &symbol) {
+        assert(_view == nullptr);
+
+        auto it = _ids.find(symbol);
+        if (it != _ids.end()) {
+            return it->second;
+        }
+
+        _symbols.push_back(symbol);
+        const auto id = static_cast<uint32_t>(_symbols.size());
+        _ids.emplace(symbol, id);
+
+        return id;
+    }
+
+    const std::string &StateSymbolTable::symbol(uint32_t id) const {
+        if (id == 0 || id > size()) {
+            throw std::out_of_range("invalid symbol id " + std::to_string(id));
+        }
+
+        return _view != nullptr ? (*_view)[static_cast<int>(id - 1)] : _symbols[id - 1];
+    }
+
+    size_t StateSymbolTable::size() const {
+        return _view != nullptr ? static_cast<size_t>(_view->size()) : _symbols.size();
+    }
+
+    void StateSymbolTable::toProtobuf(google::protobuf::RepeatedPtrField<std::string> *out) const {
+        out->Clear();
+        out->Reserve(static_cast<int>(_symbols.size()));
+        for (const auto &symbol: _symbols) {
+            *out->Add() = symbol;
+        }
+    }
+
+    void StateSymbolTable::fromProtobuf(const google::protobuf::RepeatedPtrField<std::string> &msg) {
+        // 디코딩할 때는 id로 찾기만 하므로 문자열을 복사하지 않는다
+        _ids.clear();
+        _symbols.clear();
+        _view = &msg;
+    }
+}
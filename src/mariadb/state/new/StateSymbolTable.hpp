@@ -0,0 +1,49 @@
+#ifndef ULTRAVERSE_STATE_STATESYMBOLTABLE_HPP
+#define ULTRAVERSE_STATE_STATESYMBOLTABLE_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace google::protobuf {
+    template <typename Element>
+    class RepeatedPtrField;
+}
+
+namespace ultraverse::state::v2 {
+    /**
+     * @brief 트랜잭션 레코드 하나 안에서 반복되는 이름 (컬럼, 테이블 이름)을 id로 바꿔 쓰기 위한 심볼 테이블
+     * @details id는 1부터 시작한다. protobuf에서 0은 "id 없음"이므로, 이 경우 원래의 문자열 필드를 읽는다.
+     *          레코드마다 테이블을 따로 두므로 각 레코드는 여전히 단독으로 디코딩할 수 있다.
+     * @note 로그 크기를 줄이기 위한 것이다. 디코딩한 Query / StateItem은 여전히 이름을 문자열로 갖는다.
+     */
+    class StateSymbolTable {
+    public:
+        /**
+         * @brief 심볼의 id를 반환한다. 처음 보는 심볼이면 추가한다.
+         */
+        uint32_t intern(const std::string &symbol);
+
+        /**
+         * @throws std::out_of_range id가 테이블에 없는 경우
+         */
+        const std::string &symbol(uint32_t id) const;
+
+        size_t size() const;
+
+        void toProtobuf(google::protobuf::RepeatedPtrField<std::string> *out) const;
+        /**
+         * @brief 레코드의 symbols를 복사하지 않고 참조한다. 이렇게 읽은 테이블에는 intern()할 수 없다.
+         * @note msg는 이 테이블로 디코딩하는 동안 살아 있어야 한다.
+         */
+        void fromProtobuf(const google::protobuf::RepeatedPtrField<std::string> &msg);
+    private:
+        const google::protobuf::RepeatedPtrField<std::string> *_view = nullptr;
+
+        std::vector<std::string> _symbols;
+        std::unordered_map<std::string, uint32_t> _ids;
+    };
+}
+
+#endif //ULTRAVERSE_STATE_STATESYMBOLTABLE_HPP
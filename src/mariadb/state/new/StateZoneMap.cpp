@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "ultraverse_state.pb.h"
+
+#include "utils/StringUtil.hpp"
+#include "Query.hpp"
+#include "StateIO.hpp"
+#include "StateZoneMap.hpp"
+
+namespace {
+    using ultraverse::state::v2::StateZone;
+
+    std::string zoneMapPath(const std::string &logPath, const std::string &logName) {
+        return fmt::format("{}/{}.ultzonemap", logPath, logName);
+    }
+
+    void toProtobuf(const StateZone &zone, ultraverse::state::v2::proto::StateZone *out) {
+        out->set_first_gid(zone.firstGid);
+        out->set_last_gid(zone.lastGid);
+        out->set_begin_pos(zone.beginPos);
+        out->set_end_pos(zone.endPos);
+
+        for (const auto &[name, counts] : zone.databases) {
+            auto *database = out->add_databases();
+            database->set_name(name);
+            database->set_transaction_count(counts.first);
+            database->set_query_count(counts.second);
+        }
+        for (const auto &column : zone.columns) {
+            out->add_columns(column);
+        }
+        for (const auto &column : zone.itemColumns) {
+            out->add_item_columns(column);
+        }
+
+        for (const auto &[name, keyColumn] : zone.keyColumns) {
+            auto *protoColumn = out->add_key_columns();
+            protoColumn->set_name(name);
+            keyColumn.toProtobuf(protoColumn->mutable_summary());
+        }
+    }
+
+    void fromProtobuf(const ultraverse::state::v2::proto::StateZone &record, StateZone &zone) {
+        zone.firstGid = record.first_gid();
+        zone.lastGid = record.last_gid();
+        zone.beginPos = record.begin_pos();
+        zone.endPos = record.end_pos();
+
+        for (const auto &database : record.databases()) {
+            zone.databases[database.name()] = { database.transaction_count(), database.query_count() };
+        }
+        zone.columns.insert(record.columns().begin(), record.columns().end());
+        zone.itemColumns.insert(record.item_columns().begin(), record.item_columns().end());
+
+        for (const auto &protoColumn : record.key_columns()) {
+            zone.keyColumns[protoColumn.name()].fromProtobuf(protoColumn.summary());
+        }
+    }
+}
+
+namespace ultraverse::state::v2 {
+    StateZoneMapWriter::StateZoneMapWriter(const std::string &logPath, const std::string &logName,
+                                           const std::set<std::string> &indexedColumns, uint32_t transactionsPerZone,
+                                           bool truncate):
+        _transactionsPerZone(std::max<uint32_t>(transactionsPerZone, 1))
+    {
+        for (const auto &column : indexedColumns) {
+            _indexedColumns.insert(utility::toLower(column));
+        }
+
+        auto path = zoneMapPath(logPath, logName);
+
+        if (!truncate && std::filesystem::exists(path)) {
+            truncateTornRecords<proto::StateZone>(path);
+        }
+
+        _stream.open(path, std::ios::out | std::ios::binary | (truncate ? std::ios::trunc : std::ios::app));
+        if (!_stream) {
+            throw std::runtime_error(fmt::format("failed to open {}", path));
+        }
+    }
+
+    StateZoneMapWriter::~StateZoneMapWriter() {
+        try {
+            flush();
+        } catch (std::exception &) {
+            // 소멸자에서는 예외를 던지지 않는다
+        }
+        _stream.close();
+    }
+
+    void StateZoneMapWriter::write(Transaction &transaction, uint64_t beginPos, uint64_t endPos) {
+        if (_pendingTransactions == 0) {
+            _zone.firstGid = transaction.gid();
+            _zone.beginPos = beginPos;
+        }
+        _zone.lastGid = transaction.gid();
+        _zone.endPos = endPos;
+
+        std::set<std::string> databases;
+        for (const auto &query : transaction.queries()) {
+            if (databases.insert(query->database()).second) {
+                // analyzeReplayPlan()은 database에 접근한 트랜잭션의 쿼리를 모두 세므로,
+                // 다른 database의 쿼리도 함께 센다
+                auto &counts = _zone.databases[query->database()];
+                counts.first++;
+                counts.second += transaction.queries().size();
+            }
+
+            if (query->flags() & Query::FLAG_IS_DDL) {
+                continue;
+            }
+
+            _zone.columns.insert(query->readColumns().begin(), query->readColumns().end());
+            _zone.columns.insert(query->writeColumns().begin(), query->writeColumns().end());
+        }
+
+        auto collect = [this](CombinedIterator<StateItem> it) {
+            const auto end = it.end();
+
+            for (; it != end; ++it) {
+                const auto &item = *it;
+                if (item.name.empty()) {
+                    continue;
+                }
+
+                auto column = utility::toLower(item.name);
+                _zone.itemColumns.insert(column);
+
+                if (_indexedColumns.find(column) == _indexedColumns.end()) {
+                    continue;
+                }
+
+                _zone.keyColumns[column].add(item.MakeRange2());
+            }
+        };
+
+        collect(transaction.readSet_begin());
+        collect(transaction.writeSet_begin());
+
+        if (++_pendingTransactions >= _transactionsPerZone) {
+            flush();
+        }
+    }
+
+    void StateZoneMapWriter::flush() {
+        if (_pendingTransactions == 0) {
+            return;
+        }
+
+        proto::StateZone record;
+        toProtobuf(_zone, &record);
+
+        std::string serialized;
+        if (!record.SerializeToString(&serialized)) {
+            throw std::runtime_error("failed to serialize state zone protobuf");
+        }
+
+        auto size = static_cast<uint32_t>(serialized.size());
+        _stream.write(reinterpret_cast<const char *>(&size), sizeof(uint32_t));
+        _stream.write(serialized.data(), static_cast<std::streamsize>(serialized.size()));
+        _stream.flush();
+
+        _zone = StateZone {};
+        _pendingTransactions = 0;
+    }
+
+    StateZoneMapReader::StateZoneMapReader(const std::string &logPath, const std::string &logName) {
+        auto path = zoneMapPath(logPath, logName);
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if (!stream) {
+            throw std::runtime_error(fmt::format("failed to open {}", path));
+        }
+
+        std::string buffer;
+        proto::StateZone record;
+        while (readRecord(stream, buffer, record)) {
+            StateZone zone;
+            fromProtobuf(record, zone);
+            _zones.push_back(std::move(zone));
+        }
+    }
+
+    bool StateZoneMapReader::exists(const std::string &logPath, const std::string &logName) {
+        return std::filesystem::exists(zoneMapPath(logPath, logName));
+    }
+
+    const std::vector<StateZone> &StateZoneMapReader::zones() const {
+        return _zones;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef ULTRAVERSE_STATE_STATEZONEMAP_HPP
+#define ULTRAVERSE_STATE_STATEZONEMAP_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Transaction.hpp"
+#include "mariadb/state/StateItem.h"
+#include "StateColumnSummary.hpp"
+
+namespace ultraverse::state::v2 {
+    /**
+     * @brief state log의 연속된 트랜잭션 묶음 (zone) 하나의 요약
+     * @details beginPos / endPos는 IStateLogReader::seek()에 그대로 넘길 수 있는 위치이다.
+     *          (압축된 로그에서는 논리 위치)
+     */
+    struct StateZone {
+        gid_t firstGid = 0;
+        gid_t lastGid = 0;
+        uint64_t beginPos = 0;
+        uint64_t endPos = 0;
+
+        /** database -> (database에 접근한 트랜잭션 수, 그 트랜잭션들의 전체 쿼리 수) */
+        std::map<std::string, std::pair<uint64_t, uint64_t>> databases;
+        std::set<std::string> columns;
+        std::set<std::string> itemColumns;
+        /** 키 컬럼 -> 이 zone에서 접근한 값들의 요약 */
+        std::map<std::string, StateColumnSummary> keyColumns;
+    };
+
+    /**
+     * @brief 트랜잭션 transactionsPerZone개마다 zone map (.ultzonemap)을 이어 쓰는 클래스
+     * @details .ultzonemap은 [uint32_t size][proto::StateZone]의 연속이다.
+     *          컬럼 이름은 StateKeyIndexWriter와 같이 foreign key를 해결하기 전의 이름 그대로 기록한다.
+     */
+    class StateZoneMapWriter {
+    public:
+        /**
+         * @param indexedColumns min / max와 bloom filter를 기록할 컬럼 (table.column)
+         * @param truncate true면 기존 zone map을 비우고 새로 쓴다.
+         *                 false면 덜 쓰인 마지막 레코드를 잘라내고 이어 쓴다.
+         */
+        StateZoneMapWriter(const std::string &logPath, const std::string &logName,
+                           const std::set<std::string> &indexedColumns, uint32_t transactionsPerZone,
+                           bool truncate);
+        StateZoneMapWriter(StateZoneMapWriter &) = delete;
+
+        ~StateZoneMapWriter();
+
+        /**
+         * @param beginPos 트랜잭션 헤더의 위치
+         * @param endPos 트랜잭션 레코드가 끝나는 위치 (다음 헤더의 위치)
+         */
+        void write(Transaction &transaction, uint64_t beginPos, uint64_t endPos);
+        /**
+         * 모인 트랜잭션을 (transactionsPerZone개가 되지 않았더라도) zone 하나로 쓴다.
+         */
+        void flush();
+    private:
+        std::ofstream _stream;
+
+        std::set<std::string> _indexedColumns;
+        uint32_t _transactionsPerZone;
+
+        StateZone _zone;
+        uint32_t _pendingTransactions = 0;
+    };
+
+    /**
+     * @brief .ultzonemap의 모든 zone을 읽는다.
+     */
+    class StateZoneMapReader {
+    public:
+        /**
+         * @throws std::runtime_error zone map 파일이 없는 경우
+         */
+        StateZoneMapReader(const std::string &logPath, const std::string &logName);
+
+        static bool exists(const std::string &logPath, const std::string &logName);
+
+        /**
+         * @return gid 순으로 정렬된 zone 목록
+         */
+        const std::vector<StateZone> &zones() const;
+    private:
+        std::vector<StateZone> _zones;
+    };
+}
+
+#endif //ULTRAVERSE_STATE_STATEZONEMAP_HPP
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "StateIO.hpp"
+#include "TimestampIndex.hpp"
+
+namespace {
+    std::string timestampIndexPath(const std::string &logPath, const std::string &logName) {
+        return fmt::format("{}/{}.ulttimeindex", logPath, logName);
+    }
+}
+
+namespace ultraverse::state::v2 {
+    TimestampIndexWriter::TimestampIndexWriter(const std::string &logPath, const std::string &logName,
+                                               uint32_t interval, bool truncate):
+        _interval(std::max<uint32_t>(interval, 1)),
+        _sinceLastEntry(0),
+        _maxTimestamp(0)
+    {
+        auto path = timestampIndexPath(logPath, logName);
+
+        if (!truncate && std::filesystem::exists(path)) {
+            TimestampIndexReader existing(logPath, logName);
+            if (!existing.entries().empty()) {
+                _maxTimestamp = existing.entries().back().timestamp;
+            }
+        }
+
+        _stream.open(path, std::ios::out | std::ios::binary | (truncate ? std::ios::trunc : std::ios::app));
+        if (!_stream) {
+            throw std::runtime_error(fmt::format("failed to open {}", path));
+        }
+    }
+
+    TimestampIndexWriter::~TimestampIndexWriter() {
+        _stream.flush();
+        _stream.close();
+    }
+
+    void TimestampIndexWriter::write(gid_t gid, uint64_t timestamp, uint64_t offset) {
+        _maxTimestamp = std::max(_maxTimestamp, timestamp);
+
+        // 이어 쓰는 경우에도 첫 트랜잭션은 항상 기록한다
+        if (_sinceLastEntry % _interval == 0) {
+            TimestampIndexEntry entry { _maxTimestamp, gid, offset };
+            _stream.write(reinterpret_cast<const char *>(&entry), sizeof(TimestampIndexEntry));
+        }
+
+        _sinceLastEntry++;
+    }
+
+    void TimestampIndexWriter::flush() {
+        _stream.flush();
+    }
+
+    TimestampIndexReader::TimestampIndexReader(const std::string &logPath, const std::string &logName) {
+        auto path = timestampIndexPath(logPath, logName);
+        std::ifstream stream(path, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!stream) {
+            throw std::runtime_error(fmt::format("failed to open {}", path));
+        }
+
+        // 마지막 엔트리가 덜 쓰여 있으면 버린다
+        auto size = static_cast<size_t>(stream.tellg());
+        _entries.resize(size / sizeof(TimestampIndexEntry));
+        stream.seekg(0);
+        stream.read(reinterpret_cast<char *>(_entries.data()),
+                    static_cast<std::streamsize>(_entries.size() * sizeof(TimestampIndexEntry)));
+    }
+
+    std::optional<TimestampIndexEntry> TimestampIndexReader::lastBefore(uint64_t timestamp) const {
+        auto it = std::lower_bound(_entries.begin(), _entries.end(), timestamp,
+                                   [](const TimestampIndexEntry &entry, uint64_t value) {
+            return entry.timestamp < value;
+        });
+
+        if (it == _entries.begin()) {
+            return std::nullopt;
+        }
+
+        return *std::prev(it);
+    }
+
+    std::optional<TimestampIndexEntry> TimestampIndexReader::lastAtOrBefore(uint64_t timestamp) const {
+        auto it = std::upper_bound(_entries.begin(), _entries.end(), timestamp,
+                                   [](uint64_t value, const TimestampIndexEntry &entry) {
+            return value < entry.timestamp;
+        });
+
+        if (it == _entries.begin()) {
+            return std::nullopt;
+        }
+
+        return *std::prev(it);
+    }
+
+    const std::vector<TimestampIndexEntry> &TimestampIndexReader::entries() const {
+        return _entries;
+    }
+
+    std::optional<std::pair<gid_t, gid_t>> resolveTimeRange(IStateLogReader &reader,
+                                                            const TimestampIndexReader &index,
+                                                            uint64_t startTime, uint64_t endTime) {
+        if (startTime > endTime) {
+            return std::nullopt;
+        }
+
+        auto seekTo = [&reader](const std::optional<TimestampIndexEntry> &entry) {
+            // 이전 탐색에서 로그 끝에 닿았을 수 있으므로 다시 연다
+            reader.reset();
+            if (entry.has_value()) {
+                reader.seek(entry->offset);
+            }
+
+            return entry.has_value() ? entry->timestamp : 0;
+        };
+
+        std::optional<gid_t> startGid;
+        uint64_t maxTimestamp = seekTo(index.lastBefore(startTime));
+        while (reader.nextHeader()) {
+            auto header = reader.txnHeader();
+            maxTimestamp = std::max<uint64_t>(maxTimestamp, header->timestamp);
+            if (maxTimestamp >= startTime) {
+                startGid = static_cast<gid_t>(header->gid);
+                break;
+            }
+            reader.skipTransaction();
+        }
+
+        if (!startGid.has_value() || maxTimestamp > endTime) {
+            return std::nullopt;
+        }
+
+        gid_t endGid = *startGid;
+        auto endEntry = index.lastAtOrBefore(endTime);
+        if (endEntry.has_value() && endEntry->gid > endGid) {
+            maxTimestamp = seekTo(endEntry);
+        } else {
+            // 시작 지점에서 이어서 읽는다
+            reader.skipTransaction();
+        }
+
+        while (reader.nextHeader()) {
+            auto header = reader.txnHeader();
+            maxTimestamp = std::max<uint64_t>(maxTimestamp, header->timestamp);
+            if (maxTimestamp > endTime) {
+                break;
+            }
+            endGid = std::max<gid_t>(endGid, header->gid);
+            reader.skipTransaction();
+        }
+
+        return std::make_pair(*startGid, endGid);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef ULTRAVERSE_STATE_TIMESTAMPINDEX_HPP
+#define ULTRAVERSE_STATE_TIMESTAMPINDEX_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Transaction.hpp"
+
+namespace ultraverse::state::v2 {
+    class IStateLogReader;
+
+    /**
+     * @brief .ulttimeindex의 엔트리
+     * @details timestamp는 해당 트랜잭션까지의 "누적 최대" 타임스탬프이다.
+     *          binlog의 타임스탬프는 커밋 순서와 조금씩 어긋날 수 있으므로, 누적 최대값을 써서 인덱스가 항상 정렬되도록 한다.
+     */
+    struct TimestampIndexEntry {
+        uint64_t timestamp;
+        gid_t gid;
+        /** 트랜잭션 헤더의 로그 오프셋 (.ultindex와 같은 논리 위치) */
+        uint64_t offset;
+    } __attribute__ ((packed));
+
+    /**
+     * @brief 트랜잭션 interval개마다 (timestamp, gid, offset)을 .ulttimeindex에 기록한다.
+     */
+    class TimestampIndexWriter {
+    public:
+        /**
+         * @param truncate false면 기존 인덱스 뒤에 이어 쓰고, 마지막 엔트리의 타임스탬프부터 누적 최대값을 이어간다.
+         */
+        TimestampIndexWriter(const std::string &logPath, const std::string &logName, uint32_t interval, bool truncate);
+        TimestampIndexWriter(TimestampIndexWriter &) = delete;
+
+        ~TimestampIndexWriter();
+
+        void write(gid_t gid, uint64_t timestamp, uint64_t offset);
+        void flush();
+    private:
+        std::ofstream _stream;
+
+        uint32_t _interval;
+        uint32_t _sinceLastEntry;
+        uint64_t _maxTimestamp;
+    };
+
+    /**
+     * @brief .ulttimeindex를 읽어 타임스탬프를 gid로 바꿔준다.
+     */
+    class TimestampIndexReader {
+    public:
+        /**
+         * @throws std::runtime_error 인덱스 파일이 없는 경우
+         */
+        TimestampIndexReader(const std::string &logPath, const std::string &logName);
+
+        /**
+         * @brief 누적 최대 타임스탬프가 timestamp보다 작은 마지막 엔트리를 반환한다.
+         * @details 이 엔트리 이전의 트랜잭션은 모두 timestamp보다 이르므로, 여기서부터 읽기 시작하면 된다.
+         */
+        std::optional<TimestampIndexEntry> lastBefore(uint64_t timestamp) const;
+        /**
+         * @brief 누적 최대 타임스탬프가 timestamp 이하인 마지막 엔트리를 반환한다.
+         */
+        std::optional<TimestampIndexEntry> lastAtOrBefore(uint64_t timestamp) const;
+
+        const std::vector<TimestampIndexEntry> &entries() const;
+    private:
+        std::vector<TimestampIndexEntry> _entries;
+    };
+
+    /**
+     * @brief [startTime, endTime] 사이에 커밋된 트랜잭션의 gid 범위를 구한다.
+     * @details 인덱스로 시작 / 끝 지점 근처까지 seek한 뒤, 엔트리 간격만큼만 헤더를 읽는다.
+     *          gid 범위는 누적 최대 타임스탬프를 기준으로 정한다.
+     * @return 범위에 해당하는 트랜잭션이 없으면 std::nullopt
+     */
+    std::optional<std::pair<gid_t, gid_t>> resolveTimeRange(IStateLogReader &reader,
+                                                            const TimestampIndexReader &index,
+                                                            uint64_t startTime, uint64_t endTime);
+}
+
+#endif //ULTRAVERSE_STATE_TIMESTAMPINDEX_HPP
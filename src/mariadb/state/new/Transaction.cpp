@@ -4,6 +4,7 @@
 
 #include "utils/StringUtil.hpp"
 #include "Transaction.hpp"
+#include "StateSymbolTable.hpp"
 
 #include "ultraverse_state.pb.h"
 
@@ -132,7 +133,7 @@ namespace ultraverse::state::v2 {
         return *this;
     }
 
-    void Transaction::toProtobuf(ultraverse::state::v2::proto::Transaction *out) const {
+    void Transaction::toProtobuf(ultraverse::state::v2::proto::Transaction *out, bool useSymbolTable) const {
         if (out == nullptr) {
             return;
         }
@@ -149,12 +150,17 @@ namespace ultraverse::state::v2 {
             out->add_dependencies(dep);
         }
 
+        StateSymbolTable symbols;
         for (const auto &query : _queries) {
             if (!query) {
                 continue;
             }
             auto *queryMsg = out->add_queries();
-            query->toProtobuf(queryMsg);
+            query->toProtobuf(queryMsg, useSymbolTable ? &symbols : nullptr);
+        }
+
+        if (symbols.size() > 0) {
+            symbols.toProtobuf(out->mutable_symbols());
         }
     }
 
@@ -172,11 +178,14 @@ namespace ultraverse::state::v2 {
             _dependencies.push_back(dep);
         }
 
+        StateSymbolTable symbols;
+        symbols.fromProtobuf(msg.symbols());
+
         _queries.clear();
         _queries.reserve(static_cast<size_t>(msg.queries_size()));
         for (const auto &queryMsg : msg.queries()) {
             auto query = std::make_shared<Query>();
-            query->fromProtobuf(queryMsg);
+            query->fromProtobuf(queryMsg, msg.symbols_size() > 0 ? &symbols : nullptr);
             _queries.emplace_back(std::move(query));
         }
     }
@@ -126,7 +126,10 @@ namespace ultraverse::state::v2 {
         
         Transaction &operator+=(TransactionHeader &header);
         
-        void toProtobuf(ultraverse::state::v2::proto::Transaction *out) const;
+        /**
+         * @param useSymbolTable true면 쿼리들의 컬럼 / 테이블 이름을 레코드의 심볼 테이블 (symbols)에 모으고 id로 기록한다.
+         */
+        void toProtobuf(ultraverse::state::v2::proto::Transaction *out, bool useSymbolTable = false) const;
         void fromProtobuf(const ultraverse::state::v2::proto::Transaction &msg);
     private:
         friend class StateLogReader;
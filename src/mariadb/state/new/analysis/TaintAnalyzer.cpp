@@ -9,6 +9,7 @@
 #include "mariadb/state/new/cluster/RowCluster.hpp"
 #include "mariadb/state/new/cluster/StateCluster.hpp"
 #include "mariadb/state/new/cluster/StateRelationshipResolver.hpp"
+#include "mariadb/state/new/StateRWSummary.hpp"
 #include "utils/StringUtil.hpp"
 
 namespace ultraverse::state::v2::analysis {
@@ -24,6 +25,18 @@ namespace ultraverse::state::v2::analysis {
         return rw;
     }
 
+    TaintAnalyzer::ColumnRW TaintAnalyzer::collectColumnRW(const TransactionRWSummary &summary,
+                                                           const StateRWSummaryReader &reader) {
+        ColumnRW rw;
+        for (auto id : summary.readColumns) {
+            rw.read.insert(reader.symbol(id));
+        }
+        for (auto id : summary.writeColumns) {
+            rw.write.insert(reader.symbol(id));
+        }
+        return rw;
+    }
+
     bool TaintAnalyzer::isColumnRelated(const std::string &columnA,
                                         const std::string &columnB,
                                         const std::vector<ForeignKey> &foreignKeys) {
@@ -113,4 +126,19 @@ namespace ultraverse::state::v2::analysis {
 
         return false;
     }
+
+    bool TaintAnalyzer::hasKeyColumnItems(const TransactionRWSummary &summary,
+                                          const StateRWSummaryReader &reader,
+                                          const StateCluster &cluster,
+                                          const RelationshipResolver &resolver) {
+        StateItem item;
+        for (auto id : summary.itemColumns) {
+            item.name = reader.symbol(id);
+            if (cluster.isKeyColumnItem(resolver, item)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
 }
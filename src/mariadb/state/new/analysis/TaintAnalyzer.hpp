@@ -16,6 +16,8 @@
 namespace ultraverse::state::v2 {
     class StateCluster;
     class RelationshipResolver;
+    class StateRWSummaryReader;
+    struct TransactionRWSummary;
 }
 
 namespace ultraverse::state::v2::analysis {
@@ -27,6 +29,10 @@ namespace ultraverse::state::v2::analysis {
         };
 
         static ColumnRW collectColumnRW(const Transaction &transaction);
+        /**
+         * @brief .ultsummary의 요약으로 collectColumnRW(transaction)과 같은 결과를 만든다.
+         */
+        static ColumnRW collectColumnRW(const TransactionRWSummary &summary, const StateRWSummaryReader &reader);
 
         static bool isColumnRelated(const std::string &columnA,
                                     const std::string &columnB,
@@ -39,6 +45,10 @@ namespace ultraverse::state::v2::analysis {
         static bool hasKeyColumnItems(const Transaction &transaction,
                                       const StateCluster &cluster,
                                       const RelationshipResolver &resolver);
+        static bool hasKeyColumnItems(const TransactionRWSummary &summary,
+                                      const StateRWSummaryReader &reader,
+                                      const StateCluster &cluster,
+                                      const RelationshipResolver &resolver);
     };
 }
 
@@ -366,6 +366,37 @@ namespace ultraverse::state::v2 {
         }
     }
     
+    template <typename T>
+    std::vector<std::string> StateCluster::missingCompositeKeyColumns(const std::map<std::string, T> &items) const {
+        std::vector<std::string> missingColumns;
+        
+        for (size_t groupIndex = 0; groupIndex < _keyColumnGroups.size(); groupIndex++) {
+            if (groupIndex >= _groupIsComposite.size() || !_groupIsComposite[groupIndex]) {
+                continue;
+            }
+            const auto &group = _keyColumnGroups[groupIndex];
+            if (group.empty()) {
+                continue;
+            }
+
+            size_t foundColumns = std::count_if(group.begin(), group.end(), [&items](const auto &keyColumn) {
+                return items.find(keyColumn) != items.end();
+            });
+
+            if (foundColumns == 0 || foundColumns == group.size()) {
+                continue;
+            }
+
+            for (const auto &keyColumn : group) {
+                if (items.find(keyColumn) == items.end()) {
+                    missingColumns.push_back(keyColumn);
+                }
+            }
+        }
+        
+        return missingColumns;
+    }
+    
     std::pair<std::vector<StateItem>, std::vector<StateItem>>
     StateCluster::extractItems(Transaction &transaction, const RelationshipResolver &resolver) const {
         
@@ -459,50 +490,11 @@ namespace ultraverse::state::v2 {
         }
         
         
-        for (size_t groupIndex = 0; groupIndex < _keyColumnGroups.size(); groupIndex++) {
-            if (groupIndex >= _groupIsComposite.size() || !_groupIsComposite[groupIndex]) {
-                continue;
-            }
-            const auto &group = _keyColumnGroups[groupIndex];
-            if (group.empty()) {
-                continue;
-            }
-
-            {
-                std::set<std::string> foundReadColumns;
-                for (const auto &keyColumn : group) {
-                    if (readKeyItems.find(keyColumn) != readKeyItems.end()) {
-                        foundReadColumns.insert(keyColumn);
-                    }
-                }
-
-                if (!foundReadColumns.empty() && foundReadColumns.size() != group.size()) {
-                    for (const auto &keyColumn : group) {
-                        if (foundReadColumns.find(keyColumn) != foundReadColumns.end()) {
-                            continue;
-                        }
-                        readKeyItems[keyColumn] = StateItem::Wildcard(keyColumn);
-                    }
-                }
-            }
-
-            {
-                std::set<std::string> foundWriteColumns;
-                for (const auto &keyColumn : group) {
-                    if (writeKeyItems.find(keyColumn) != writeKeyItems.end()) {
-                        foundWriteColumns.insert(keyColumn);
-                    }
-                }
-
-                if (!foundWriteColumns.empty() && foundWriteColumns.size() != group.size()) {
-                    for (const auto &keyColumn : group) {
-                        if (foundWriteColumns.find(keyColumn) != foundWriteColumns.end()) {
-                            continue;
-                        }
-                        writeKeyItems[keyColumn] = StateItem::Wildcard(keyColumn);
-                    }
-                }
-            }
+        for (const auto &keyColumn : missingCompositeKeyColumns(readKeyItems)) {
+            readKeyItems[keyColumn] = StateItem::Wildcard(keyColumn);
+        }
+        for (const auto &keyColumn : missingCompositeKeyColumns(writeKeyItems)) {
+            writeKeyItems[keyColumn] = StateItem::Wildcard(keyColumn);
         }
         
         // insert all values to vector
@@ -537,6 +529,16 @@ namespace ultraverse::state::v2 {
         });
     }
     
+    void StateCluster::insert(StateCluster::ClusterType type, const std::map<std::string, StateRange> &ranges, gid_t gid) {
+        for (const auto &pair : ranges) {
+            insert2(type, pair.first, pair.second, gid);
+        }
+        
+        for (const auto &keyColumn : missingCompositeKeyColumns(ranges)) {
+            insert2(type, keyColumn, StateItem::Wildcard(keyColumn).MakeRange2(), gid);
+        }
+    }
+    
     void StateCluster::insert(const std::shared_ptr<Transaction>& transaction, const RelationshipResolver &resolver) {
         const auto &rwItemsPair = extractItems(*transaction, resolver);
         
@@ -753,6 +755,7 @@ namespace ultraverse::state::v2 {
 
                             if (itRead != cluster.read.end()) {
                                 entry.read = &itRead->second;
+                                entry.readRange = &itRead->first;
                                 cache.read[column] = itRead->first;
                             }
                         }
@@ -761,6 +764,7 @@ namespace ultraverse::state::v2 {
                             auto itWrite = cluster.write.find(range);
                             if (itWrite != cluster.write.end()) {
                                 entry.write = &itWrite->second;
+                                entry.writeRange = &itWrite->first;
                                 cache.write[column] = itWrite->first;
                             }
                         }
@@ -778,6 +782,25 @@ namespace ultraverse::state::v2 {
         invalidateTargetCache(resolver);
     }
     
+    std::unordered_map<std::string, std::vector<StateRange>> StateCluster::targetClusterRanges() {
+        std::shared_lock<std::shared_mutex> lock(_targetCacheLock);
+        std::unordered_map<std::string, std::vector<StateRange>> ranges;
+
+        for (const auto &[column, cacheMap] : _targetCache) {
+            auto &columnRanges = ranges[column];
+            for (const auto &pair : cacheMap) {
+                if (pair.second.readRange != nullptr) {
+                    columnRanges.push_back(*pair.second.readRange);
+                }
+                if (pair.second.writeRange != nullptr) {
+                    columnRanges.push_back(*pair.second.writeRange);
+                }
+            }
+        }
+
+        return ranges;
+    }
+
     bool StateCluster::shouldReplay(gid_t gid) {
         std::shared_lock<std::shared_mutex> lock(_targetCacheLock);
         if (_rollbackTargets.find(gid) != _rollbackTargets.end()) {
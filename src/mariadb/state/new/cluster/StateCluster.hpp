@@ -5,6 +5,7 @@
 #ifndef ULTRAVERSE_STATECLUSTER_HPP
 #define ULTRAVERSE_STATECLUSTER_HPP
 
+#include <map>
 #include <string>
 #include <vector>
 #include <unordered_set>
@@ -115,6 +116,11 @@ namespace ultraverse::state::v2 {
         
         void insert2(ClusterType type, const std::string &columnName, const StateRange &range, gid_t gid);
         void insert(ClusterType type, const std::vector<StateItem> &items, gid_t gid);
+        /**
+         * @brief 한 트랜잭션이 접근한 (정규화된) 키 컬럼별 범위를 추가한다.
+         * @details composite key group의 일부 컬럼만 접근했다면, 나머지 컬럼은 wildcard로 추가한다.
+         */
+        void insert(ClusterType type, const std::map<std::string, StateRange> &ranges, gid_t gid);
         
         /**
          * @brief 주어진 트랜잭션을 클러스터에 추가한다.
@@ -156,6 +162,13 @@ namespace ultraverse::state::v2 {
 
         void refreshTargetCache(const RelationshipResolver &resolver);
 
+        /**
+         * @brief 키 컬럼별로, rollback / prepend 대상과 겹치는 (병합된) 클러스터 범위들을 반환한다.
+         * @details shouldReplay()가 true를 반환하는 트랜잭션은 반드시 이 범위들 중 하나에 접근한다.
+         *          refreshTargetCache() 이후에 호출해야 한다.
+         */
+        std::unordered_map<std::string, std::vector<StateRange>> targetClusterRanges();
+
     private:
         /**
          * @brief rollback / append 대상 트랜잭션 관련 데이터를 캐싱하기 위한 클래스
@@ -177,6 +190,8 @@ namespace ultraverse::state::v2 {
         struct TargetGidSetRef {
             const std::unordered_set<gid_t> *read = nullptr;
             const std::unordered_set<gid_t> *write = nullptr;
+            const StateRange *readRange = nullptr;
+            const StateRange *writeRange = nullptr;
 
             bool contains(gid_t gid) const {
                 if (read != nullptr && read->find(gid) != read->end()) {
@@ -200,6 +215,12 @@ namespace ultraverse::state::v2 {
             const RelationshipResolver &resolver
         ) const;
         
+        /**
+         * @brief composite key group 중 일부 컬럼만 items에 있는 경우, 빠진 컬럼들을 반환한다.
+         */
+        template <typename T>
+        std::vector<std::string> missingCompositeKeyColumns(const std::map<std::string, T> &items) const;
+        
         /**
          * rollback / append 대상 트랜잭션의 캐시를 갱신한다.
          */
@@ -0,0 +1,105 @@
+#include "CompactRowGraphStore.hpp"
+
+namespace ultraverse::state::v2 {
+    RowGraphId CompactRowGraphStore::encode(uint64_t index) {
+        return reinterpret_cast<RowGraphId>(static_cast<uintptr_t>(index + 1));
+    }
+
+    uint64_t CompactRowGraphStore::decode(RowGraphId id) {
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(id)) - 1;
+    }
+
+    RowGraphId CompactRowGraphStore::add() {
+        const uint64_t index = _nextIndex++;
+        const size_t chunkIndex = index / kChunkSize;
+
+        if (chunkIndex >= _chunks.size()) {
+            _chunks.push_back(std::make_shared<Chunk>());
+        }
+
+        auto &chunk = *_chunks[chunkIndex];
+        auto &slot = chunk.slots[index % kChunkSize];
+        slot.node.id = index;
+        slot.live = true;
+        chunk.liveCount++;
+        _size++;
+
+        return encode(index);
+    }
+
+    CompactRowGraphStore::Slot *CompactRowGraphStore::slotFor(RowGraphId id) const {
+        if (id == nullptr) {
+            return nullptr;
+        }
+
+        const uint64_t index = decode(id);
+        if (index >= _nextIndex) {
+            return nullptr;
+        }
+
+        const auto &chunk = _chunks[index / kChunkSize];
+        if (chunk == nullptr) {
+            return nullptr;
+        }
+
+        auto &slot = chunk->slots[index % kChunkSize];
+        return slot.live ? &slot : nullptr;
+    }
+
+    RowGraphNode *CompactRowGraphStore::get(RowGraphId id) const {
+        auto *slot = slotFor(id);
+        return slot != nullptr ? &slot->node : nullptr;
+    }
+
+    std::shared_ptr<RowGraphNode> CompactRowGraphStore::share(RowGraphId id) const {
+        auto *slot = slotFor(id);
+        if (slot == nullptr) {
+            return nullptr;
+        }
+
+        // aliasing constructor: 노드 단위 할당 없이 청크의 수명을 공유한다.
+        return std::shared_ptr<RowGraphNode>(_chunks[decode(id) / kChunkSize], &slot->node);
+    }
+
+    void CompactRowGraphStore::addEdge(RowGraphId from, RowGraphId to) {
+        auto *slot = slotFor(from);
+        if (slot == nullptr) {
+            return;
+        }
+
+        slot->successors.push_back(to);
+    }
+
+    const CompactRowGraphStore::SuccessorList *CompactRowGraphStore::successors(RowGraphId id) const {
+        auto *slot = slotFor(id);
+        return slot != nullptr ? &slot->successors : nullptr;
+    }
+
+    void CompactRowGraphStore::remove(RowGraphId id) {
+        auto *slot = slotFor(id);
+        if (slot == nullptr) {
+            return;
+        }
+
+        slot->live = false;
+        SuccessorList().swap(slot->successors);
+        std::atomic_store(&slot->node.transaction, std::shared_ptr<Transaction>());
+        _size--;
+
+        const size_t chunkIndex = decode(id) / kChunkSize;
+        auto &chunk = _chunks[chunkIndex];
+        const bool isFilled = _nextIndex >= (chunkIndex + 1) * kChunkSize;
+
+        if (--chunk->liveCount == 0 && isFilled) {
+            chunk.reset();
+
+            while (_firstChunk < _chunks.size() && _chunks[_firstChunk] == nullptr) {
+                _firstChunk++;
+            }
+        }
+    }
+
+    size_t CompactRowGraphStore::size() const {
+        return _size;
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef ULTRAVERSE_COMPACTROWGRAPHSTORE_HPP
+#define ULTRAVERSE_COMPACTROWGRAPHSTORE_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+
+#include "RowGraph.hpp"
+
+namespace ultraverse::state::v2 {
+
+    /**
+     * @brief RowGraph의 compact 저장소
+     * @details 노드를 고정 크기 청크 배열에 dense id 순서대로 저장하고, 간선은 노드별 small-vector에
+     *          후속 노드 ID만 보관한다. 선행 노드 목록은 두지 않으며, 스케줄링은 RowGraphNode::pendingDependencies로 한다.
+     *
+     *          - RowGraphId는 (dense id + 1)을 포인터로 인코딩한 값이므로 nullptr는 여전히 "노드 없음"을 뜻한다.
+     *          - dense id는 재사용하지 않는다. 청크의 노드가 모두 제거되면 청크 자체가 해제되며,
+     *            nodeFor()로 얻은 shared_ptr가 남아 있는 동안에는 청크가 유지된다.
+     *
+     * @note 스레드 안전하지 않다. RowGraph::_graphMutex 하에서 사용해야 한다.
+     */
+    class CompactRowGraphStore {
+    public:
+        static constexpr size_t kChunkSize = 1024;
+
+        using SuccessorList = boost::container::small_vector<RowGraphId, 4>;
+
+        static RowGraphId encode(uint64_t index);
+        static uint64_t decode(RowGraphId id);
+
+        /**
+         * @brief 새 노드를 할당하고 ID를 반환한다.
+         */
+        RowGraphId add();
+
+        /**
+         * @brief 노드를 반환한다. 이미 제거된 노드면 nullptr를 반환한다.
+         */
+        RowGraphNode *get(RowGraphId id) const;
+
+        /**
+         * @brief get()과 같으나, 청크의 수명을 공유하는 shared_ptr를 반환한다.
+         */
+        std::shared_ptr<RowGraphNode> share(RowGraphId id) const;
+
+        void addEdge(RowGraphId from, RowGraphId to);
+        const SuccessorList *successors(RowGraphId id) const;
+
+        /**
+         * @brief 노드와 노드의 후속 간선을 제거한다.
+         * @note 다른 노드의 후속 목록에 남아 있는 ID는 지우지 않는다.
+         *       finalize된 노드만 제거되므로, 그 선행 노드들의 후속 목록은 다시 순회되지 않는다.
+         */
+        void remove(RowGraphId id);
+
+        size_t size() const;
+
+        template <typename Fn>
+        void forEach(Fn &&fn) const {
+            for (size_t chunkIndex = _firstChunk; chunkIndex < _chunks.size(); chunkIndex++) {
+                const auto &chunk = _chunks[chunkIndex];
+                if (chunk == nullptr) {
+                    continue;
+                }
+
+                const uint64_t base = chunkIndex * kChunkSize;
+                const uint64_t limit = std::min<uint64_t>(kChunkSize, _nextIndex - base);
+                for (uint64_t offset = 0; offset < limit; offset++) {
+                    auto &slot = chunk->slots[offset];
+                    if (slot.live) {
+                        fn(encode(base + offset), slot.node);
+                    }
+                }
+            }
+        }
+
+    private:
+        struct Slot {
+            RowGraphNode node;
+            SuccessorList successors;
+            bool live = false;
+        };
+
+        struct Chunk {
+            std::array<Slot, kChunkSize> slots;
+            uint32_t liveCount = 0;
+        };
+
+        Slot *slotFor(RowGraphId id) const;
+
+        std::vector<std::shared_ptr<Chunk>> _chunks;
+        size_t _firstChunk = 0;
+        uint64_t _nextIndex = 0;
+        size_t _size = 0;
+    };
+}
+
+#endif //ULTRAVERSE_COMPACTROWGRAPHSTORE_HPP
@@ -7,6 +7,7 @@
 #include <execution>
 #include <fstream>
 #include <optional>
+#include <type_traits>
 #include <unordered_set>
 
 #include <fmt/format.h>
@@ -15,11 +16,17 @@
 #include "utils/StringUtil.hpp"
 
 #include "RowGraph.hpp"
+#include "CompactRowGraphStore.hpp"
 
 #include "../cluster/StateRelationshipResolver.hpp"
 
 namespace ultraverse::state::v2 {
     namespace {
+        /** @brief 증분 GC에서 retire list가 이만큼 쌓이면 회수를 요청한다. */
+        constexpr size_t kReclaimBatchSize = 256;
+        /** @brief 샤드 스레드가 한 워커를 연속으로 처리하는 최대 태스크 수. 넘으면 같은 샤드의 다른 워커에게 양보한다. */
+        constexpr size_t kShardDrainLimit = 64;
+
         std::set<std::string> normalizeKeyColumns(const std::set<std::string> &keyColumns) {
             std::set<std::string> normalized;
 
@@ -128,6 +135,45 @@ namespace ultraverse::state::v2 {
             return mapping;
         }
 
+        /**
+         * @brief removed에 포함된 노드를 가리키는 RWStateHolder를 비우고, 비어버린 nodeMap 엔트리를 제거한다.
+         */
+        template <typename Worker, typename NodeSet>
+        void evictStaleHolders(Worker &worker, const NodeSet &removed) {
+            std::lock_guard<std::mutex> mapLock(worker.mapMutex);
+            std::vector<typename decltype(worker.nodeMap)::key_type> toRemoveRanges;
+
+            auto evict = [&removed](RowGraph::RWStateHolder &holder) {
+                std::scoped_lock<std::mutex> holderLock(holder.mutex);
+
+                if (removed.find(holder.read) != removed.end()) {
+                    holder.read = nullptr;
+                    holder.readGid = 0;
+                }
+
+                if (removed.find(holder.write) != removed.end()) {
+                    holder.write = nullptr;
+                    holder.writeGid = 0;
+                }
+
+                return holder.read == nullptr && holder.write == nullptr;
+            };
+
+            for (auto &pair : worker.nodeMap) {
+                if (evict(pair.second)) {
+                    toRemoveRanges.emplace_back(pair.first);
+                }
+            }
+
+            if (worker.hasWildcard && evict(worker.wildcardHolder)) {
+                worker.hasWildcard = false;
+            }
+
+            for (auto &range : toRemoveRanges) {
+                worker.nodeMap.erase(range);
+            }
+        }
+
         std::unordered_map<std::string, std::vector<std::string>>
         buildKeyColumnsByTable(const std::set<std::string> &keyColumns) {
             std::unordered_map<std::string, std::vector<std::string>> mapping;
@@ -147,7 +193,8 @@ namespace ultraverse::state::v2 {
 
     RowGraph::RowGraph(const std::set<std::string> &keyColumns,
                        const RelationshipResolver &resolver,
-                       const std::vector<std::vector<std::string>> &keyColumnGroups):
+                       const std::vector<std::vector<std::string>> &keyColumnGroups,
+                       size_t workerShards):
         _logger(createLogger("RowGraph")),
         _resolver(resolver),
         _keyColumns(normalizeKeyColumns(keyColumns)),
@@ -166,6 +213,12 @@ namespace ultraverse::state::v2 {
         _compositeGroupsByTable = buildCompositeGroupsByTable(_keyColumnGroups, _groupIsComposite);
         _compositeWorkers.resize(_keyColumnGroups.size());
 
+        const bool useShards = workerShards > 0;
+        const size_t columnPartitions = useShards ? workerShards : 1;
+        for (size_t index = 0; index < workerShards; index++) {
+            _shards.push_back(std::make_unique<WorkerShard>());
+        }
+
         for (size_t index = 0; index < _keyColumnGroups.size(); index++) {
             const auto &group = _keyColumnGroups[index];
             if (group.empty()) {
@@ -182,7 +235,11 @@ namespace ultraverse::state::v2 {
                 _compositeColumns.insert(group.begin(), group.end());
                 auto worker = std::make_unique<CompositeWorker>();
                 worker->columns = group;
-                worker->worker = std::thread(&RowGraph::compositeWorkerLoop, this, std::ref(*worker));
+                if (useShards) {
+                    worker->shard = index % _shards.size();
+                } else {
+                    worker->worker = std::thread(&RowGraph::compositeWorkerLoop, this, std::ref(*worker));
+                }
                 _compositeWorkers[index] = std::move(worker);
                 continue;
             }
@@ -191,19 +248,41 @@ namespace ultraverse::state::v2 {
                 if (_columnWorkers.find(column) != _columnWorkers.end()) {
                     continue;
                 }
-                auto worker = std::make_unique<ColumnWorker>();
-                worker->column = column;
-                worker->worker = std::thread(&RowGraph::columnWorkerLoop, this, std::ref(*worker));
-                _columnWorkers.emplace(column, std::move(worker));
+                
+                auto &partitions = _columnWorkers[column];
+                const auto columnHash = std::hash<std::string>()(column);
+                for (size_t partition = 0; partition < columnPartitions; partition++) {
+                    auto worker = std::make_unique<ColumnWorker>();
+                    worker->column = column;
+                    if (useShards) {
+                        // 파티션들을 서로 다른 샤드에 흩어 놓아, 키 컬럼이 적어도 모든 샤드가 일하게 한다.
+                        worker->shard = (columnHash + partition) % _shards.size();
+                    } else {
+                        worker->worker = std::thread(&RowGraph::columnWorkerLoop, this, std::ref(*worker));
+                    }
+                    partitions.push_back(std::move(worker));
+                }
             }
         }
 
-        _workerCount = static_cast<uint32_t>(_columnWorkers.size());
+        _workerCount = 0;
+        forEachColumnWorker([this](ColumnWorker &) {
+            ++_workerCount;
+        });
         for (const auto &workerPtr : _compositeWorkers) {
             if (workerPtr) {
                 ++_workerCount;
             }
         }
+
+        if (useShards) {
+            _workerThreadCount = static_cast<uint32_t>(_shards.size());
+            for (auto &shard : _shards) {
+                shard->thread = std::thread(&RowGraph::shardWorkerLoop, this, std::ref(*shard));
+            }
+        } else {
+            _workerThreadCount = _workerCount;
+        }
     }
     
     RowGraph::~RowGraph() {
@@ -213,14 +292,13 @@ namespace ultraverse::state::v2 {
         }
         _gcCv.notify_all();
 
-        for (auto &pair : _columnWorkers) {
-            auto &worker = pair.second;
+        forEachColumnWorker([](ColumnWorker &worker) {
             {
-                std::lock_guard<std::mutex> lock(worker->queueMutex);
-                worker->running = false;
+                std::lock_guard<std::mutex> lock(worker.queueMutex);
+                worker.running = false;
             }
-            worker->queueCv.notify_all();
-        }
+            worker.queueCv.notify_all();
+        });
 
         for (auto &workerPtr : _compositeWorkers) {
             if (!workerPtr) {
@@ -234,13 +312,20 @@ namespace ultraverse::state::v2 {
             worker.queueCv.notify_all();
         }
 
-        for (auto &pair : _columnWorkers) {
-            auto &worker = pair.second;
-            if (worker->worker.joinable()) {
-                worker->worker.join();
+        for (auto &shard : _shards) {
+            {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                shard->running = false;
             }
+            shard->cv.notify_all();
         }
 
+        forEachColumnWorker([](ColumnWorker &worker) {
+            if (worker.worker.joinable()) {
+                worker.worker.join();
+            }
+        });
+
         for (auto &workerPtr : _compositeWorkers) {
             if (!workerPtr) {
                 continue;
@@ -250,6 +335,12 @@ namespace ultraverse::state::v2 {
                 worker.worker.join();
             }
         }
+
+        for (auto &shard : _shards) {
+            if (shard->thread.joinable()) {
+                shard->thread.join();
+            }
+        }
     }
 
     bool RowGraph::CompositeRange::isGlobalWildcard() const {
@@ -278,15 +369,26 @@ namespace ultraverse::state::v2 {
     }
     
     RowGraphId RowGraph::addNode(std::shared_ptr<Transaction> transaction, bool hold) {
-        auto node = std::make_shared<RowGraphNode>();
-        std::atomic_store(&node->transaction, std::move(transaction));
-        node->hold = hold;
-        
+        std::shared_ptr<RowGraphNode> node;
         RowGraphId id = nullptr;
-        {
+        
+        if (_compactStore != nullptr) {
+            WriteLock _lock(_graphMutex);
+            id = _compactStore->add();
+            node = _compactStore->share(id);
+            std::atomic_store(&node->transaction, std::move(transaction));
+            node->hold = hold;
+            node->pendingDependencies = hold ? 2 : 1;
+        } else {
+            node = std::make_shared<RowGraphNode>();
+            std::atomic_store(&node->transaction, std::move(transaction));
+            node->hold = hold;
+            node->pendingDependencies = hold ? 2 : 1;
+            
             WriteLock _lock(_graphMutex);
             id = boost::add_vertex(node, _graph);
         }
+        _addedNodes.fetch_add(1, std::memory_order_acq_rel);
         
         std::unordered_map<std::string, ColumnTask> tasksByColumn;
         tasksByColumn.reserve(_keyColumns.size());
@@ -302,7 +404,7 @@ namespace ultraverse::state::v2 {
         bool globalWriteWildcard = false;
         const auto transactionPtr = std::atomic_load(&node->transaction);
         if (!transactionPtr) {
-            node->ready = true;
+            markNodeReady(id, *node);
             return id;
         }
 
@@ -634,7 +736,7 @@ namespace ultraverse::state::v2 {
         const auto totalTasks = static_cast<uint32_t>(tasksByColumn.size() + compositeTasks.size());
         node->pendingColumns = totalTasks;
         if (totalTasks == 0) {
-            node->ready = true;
+            markNodeReady(id, *node);
             return id;
         }
 
@@ -660,6 +762,17 @@ namespace ultraverse::state::v2 {
         
         std::unordered_set<RowGraphId> result;
         
+        if (_compactStore != nullptr) {
+            // 선행 노드 목록이 없으므로 pendingDependencies로 판정한다.
+            _compactStore->forEach([&result](RowGraphId id, const RowGraphNode &node) {
+                if (!node.finalized && !node.hold && node.pendingDependencies == 0) {
+                    result.insert(id);
+                }
+            });
+            
+            return result;
+        }
+        
         auto it = boost::vertices(_graph).first;
         const auto itEnd = boost::vertices(_graph).second;
         
@@ -699,6 +812,15 @@ namespace ultraverse::state::v2 {
     
     bool RowGraph::isFinalized() {
         ConcurrentReadLock _lock(_graphMutex);
+        
+        if (_compactStore != nullptr) {
+            bool result = true;
+            _compactStore->forEach([&result](RowGraphId, const RowGraphNode &node) {
+                result = result && node.finalized;
+            });
+            return result;
+        }
+        
         auto pair = boost::vertices(_graph);
         
         return std::all_of(std::execution::unseq, pair.first, pair.second, [this](auto id) {
@@ -707,6 +829,10 @@ namespace ultraverse::state::v2 {
     }
     
     RowGraphId RowGraph::entrypoint(int workerId) {
+        if (_readyQueueEnabled) {
+            return popReadyNode(workerId);
+        }
+
         ConcurrentReadLock _lock(_graphMutex);
         
         auto itBeg = boost::vertices(_graph).first;
@@ -741,9 +867,113 @@ namespace ultraverse::state::v2 {
             return nullptr;
         }
     }
+
+    RowGraphId RowGraph::waitEntrypoint(int workerId, std::chrono::milliseconds timeout) {
+        if (!_readyQueueEnabled) {
+            auto nodeId = entrypoint(workerId);
+            if (nodeId == nullptr) {
+                std::unique_lock<std::mutex> lock(_readyQueueMutex);
+                _readyQueueCv.wait_for(lock, std::min(timeout, std::chrono::milliseconds(5)), [this]() {
+                    return _readyQueueClosed;
+                });
+            }
+            return nodeId;
+        }
+
+        RowGraphId nodeId = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(_readyQueueMutex);
+            _readyQueueCv.wait_for(lock, timeout, [this]() { return !_readyQueue.empty() || _readyQueueClosed; });
+            if (_readyQueue.empty()) {
+                return nullptr;
+            }
+            nodeId = _readyQueue.front();
+            _readyQueue.pop_front();
+        }
+
+        nodeFor(nodeId)->processedBy = workerId;
+        return nodeId;
+    }
+
+    void RowGraph::markFinalized(RowGraphId nodeId) {
+        std::vector<RowGraphId> readyNodes;
+        {
+            ConcurrentReadLock _lock(_graphMutex);
+            auto *node = _compactStore != nullptr ? _compactStore->get(nodeId) : _graph[nodeId].get();
+            if (node == nullptr || node->finalized.exchange(true)) {
+                return;
+            }
+
+            if (_compactStore != nullptr) {
+                for (auto target : *_compactStore->successors(nodeId)) {
+                    auto *targetNode = _compactStore->get(target);
+                    if (targetNode != nullptr &&
+                        targetNode->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        readyNodes.push_back(target);
+                    }
+                }
+            } else if (_readyQueueEnabled) {
+                // 간선 추가는 WriteLock 하에서 이루어지므로, 여기서 보이는 out-edge들이
+                // pendingDependencies에 반영된 간선 전부이다.
+                auto pair = boost::out_edges(nodeId, _graph);
+                for (auto it = pair.first; it != pair.second; ++it) {
+                    auto target = boost::target(*it, _graph);
+                    if (_graph[target]->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        readyNodes.push_back(target);
+                    }
+                }
+            }
+        }
+
+        for (auto readyNodeId : readyNodes) {
+            pushReadyNode(readyNodeId);
+        }
+
+        if (_incrementalGCEnabled) {
+            retireNode(nodeId);
+        }
+
+        _finalizedNodes.fetch_add(1, std::memory_order_acq_rel);
+        {
+            std::lock_guard<std::mutex> progressLock(_progressMutex);
+        }
+        _progressCv.notify_all();
+    }
+
+    uint64_t RowGraph::pendingNodeCount() const {
+        // _finalizedNodes를 먼저 읽어야 음수가 되지 않는다.
+        const auto finalized = _finalizedNodes.load(std::memory_order_acquire);
+        return _addedNodes.load(std::memory_order_acquire) - finalized;
+    }
+
+    void RowGraph::waitForCapacity(uint64_t maxPending) {
+        if (pendingNodeCount() <= maxPending) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(_progressMutex);
+        _progressCv.wait(lock, [this, maxPending]() {
+            return pendingNodeCount() <= maxPending;
+        });
+    }
+
+    void RowGraph::waitUntilAllFinalized() {
+        waitForCapacity(0);
+    }
+
+    void RowGraph::closeReadyQueue() {
+        {
+            std::lock_guard<std::mutex> lock(_readyQueueMutex);
+            _readyQueueClosed = true;
+        }
+        _readyQueueCv.notify_all();
+    }
     
     std::shared_ptr<RowGraphNode> RowGraph::nodeFor(RowGraphId nodeId) {
         ConcurrentReadLock _lock(_graphMutex);
+        if (_compactStore != nullptr) {
+            return _compactStore->share(nodeId);
+        }
         return _graph[nodeId];
     }
 
@@ -752,7 +982,28 @@ namespace ultraverse::state::v2 {
             return;
         }
         WriteLock lock(_graphMutex);
+        addEdgeLocked(from, to);
+    }
+
+    void RowGraph::addEdgeLocked(RowGraphId from, RowGraphId to) {
+        if (_compactStore != nullptr) {
+            auto *source = _compactStore->get(from);
+            auto *target = _compactStore->get(to);
+            // 이미 제거된 노드는 finalize된 노드이므로 간선을 만들 필요가 없다.
+            if (source == nullptr || target == nullptr || source->finalized) {
+                return;
+            }
+            _compactStore->addEdge(from, to);
+            target->pendingDependencies.fetch_add(1, std::memory_order_acq_rel);
+            return;
+        }
+        
         boost::add_edge(from, to, _graph);
+
+        // 이미 finalize된 노드로부터의 간선은 markFinalized()에서 다시 감소되지 않으므로 세지 않는다.
+        if (_readyQueueEnabled && !_graph[from]->finalized) {
+            _graph[to]->pendingDependencies.fetch_add(1, std::memory_order_acq_rel);
+        }
     }
 
     void RowGraph::releaseNode(RowGraphId nodeId) {
@@ -760,7 +1011,9 @@ namespace ultraverse::state::v2 {
         if (node == nullptr) {
             return;
         }
-        node->hold = false;
+        if (node->hold.exchange(false) && _readyQueueEnabled) {
+            releaseDependency(nodeId, *node);
+        }
     }
     
     void RowGraph::pauseWorkers() {
@@ -773,7 +1026,7 @@ namespace ultraverse::state::v2 {
         std::unique_lock<std::mutex> lock(_gcMutex);
         _gcCv.wait(lock, [this]() {
             return _activeTasks.load(std::memory_order_acquire) == 0 &&
-                   _pausedWorkers.load(std::memory_order_acquire) >= _workerCount;
+                   _pausedWorkers.load(std::memory_order_acquire) >= _workerThreadCount;
         });
     }
 
@@ -787,15 +1040,21 @@ namespace ultraverse::state::v2 {
     }
 
     void RowGraph::notifyAllWorkers() {
-        for (auto &pair : _columnWorkers) {
-            pair.second->queueCv.notify_all();
-        }
+        forEachColumnWorker([](ColumnWorker &worker) {
+            worker.queueCv.notify_all();
+        });
         for (auto &workerPtr : _compositeWorkers) {
             if (!workerPtr) {
                 continue;
             }
             workerPtr->queueCv.notify_all();
         }
+        for (auto &shard : _shards) {
+            {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+            }
+            shard->cv.notify_all();
+        }
     }
 
     void RowGraph::gcInternal() {
@@ -805,173 +1064,178 @@ namespace ultraverse::state::v2 {
         std::set<RowGraphId> toRemove;
         
         {
-            boost::graph_traits<RowGraphInternal>::vertex_iterator vi, vi_end;
-            boost::tie(vi, vi_end) = boost::vertices(_graph);
-            
-            std::for_each(vi, vi_end, [this, &toRemove](const auto &id) {
-                auto node = _graph[id];
-
-                const auto transactionPtr = std::atomic_load(&node->transaction);
-                if (node->finalized && transactionPtr == nullptr) {
-                    toRemove.emplace(id);
-                }
-            });
+            auto isRemovable = [](const RowGraphNode &node) {
+                const auto transactionPtr = std::atomic_load(&node.transaction);
+                return node.finalized && transactionPtr == nullptr;
+            };
             
-            for (auto id: toRemove) {
-                // remove edges
-                {
-                    std::set<RowGraphId> edgeSources;
-                    
-                    auto pair = boost::in_edges(id, _graph);
-                    auto it = pair.first;
-                    const auto itEnd = pair.second;
-                    
-                    while (it != itEnd) {
-                        auto edge = *it;
-                        auto source = boost::source(edge, _graph);
-                        
-                        edgeSources.emplace(source);
-                        
-                        ++it;
-                    }
-                    
-                    for (auto source: edgeSources) {
-                        boost::remove_edge(source, id, _graph);
+            if (_compactStore != nullptr) {
+                _compactStore->forEach([&toRemove, &isRemovable](RowGraphId id, const RowGraphNode &node) {
+                    if (isRemovable(node)) {
+                        toRemove.emplace(id);
                     }
-                }
+                });
+            } else {
+                boost::graph_traits<RowGraphInternal>::vertex_iterator vi, vi_end;
+                boost::tie(vi, vi_end) = boost::vertices(_graph);
                 
-                {
-                    std::set<RowGraphId> edgeTargets;
-                    
-                    auto pair = boost::out_edges(id, _graph);
-                    auto it = pair.first;
-                    const auto itEnd = pair.second;
-                    
-                    while (it != itEnd) {
-                        auto edge = *it;
-                        auto target = boost::target(edge, _graph);
-                        
-                        edgeTargets.emplace(target);
-                        
-                        ++it;
+                std::for_each(vi, vi_end, [this, &toRemove, &isRemovable](const auto &id) {
+                    if (isRemovable(*_graph[id])) {
+                        toRemove.emplace(id);
                     }
-                    
-                    for (auto target: edgeTargets) {
-                        boost::remove_edge(id, target, _graph);
-                    }
-                }
-                
-                boost::remove_vertex(id, _graph);
+                });
             }
             
-            
-            for (auto &pair: _columnWorkers) {
-                auto &worker = pair.second;
-                std::lock_guard<std::mutex> mapLock(worker->mapMutex);
-                std::vector<StateRange> toRemoveRanges;
-                
-                for (auto &pair2: worker->nodeMap) {
-                    auto &holder = pair2.second;
-                    std::scoped_lock<std::mutex> holderLock(holder.mutex);
-                    
-                    if (toRemove.find(holder.read) != toRemove.end()) {
-                        holder.read = nullptr;
-                        holder.readGid = 0;
-                    }
-                    
-                    if (toRemove.find(holder.write) != toRemove.end()) {
-                        holder.write = nullptr;
-                        holder.writeGid = 0;
-                    }
-                    
-                    if (holder.read == nullptr && holder.write == nullptr) {
-                        toRemoveRanges.emplace_back(pair2.first);
-                    }
-                }
-
-                if (worker->hasWildcard) {
-                    auto &holder = worker->wildcardHolder;
-                    std::scoped_lock<std::mutex> holderLock(holder.mutex);
-
-                    if (toRemove.find(holder.read) != toRemove.end()) {
-                        holder.read = nullptr;
-                        holder.readGid = 0;
-                    }
-
-                    if (toRemove.find(holder.write) != toRemove.end()) {
-                        holder.write = nullptr;
-                        holder.writeGid = 0;
-                    }
-
-                    if (holder.read == nullptr && holder.write == nullptr) {
-                        worker->hasWildcard = false;
-                    }
-                }
-                
-                for (auto &range: toRemoveRanges) {
-                    worker->nodeMap.erase(range);
-                }
+            for (auto id: toRemove) {
+                removeNodeLocked(id);
             }
+            
+            
+            forEachColumnWorker([&toRemove](ColumnWorker &worker) {
+                evictStaleHolders(worker, toRemove);
+            });
 
             for (auto &workerPtr : _compositeWorkers) {
                 if (!workerPtr) {
                     continue;
                 }
-                auto &worker = *workerPtr;
-                std::lock_guard<std::mutex> mapLock(worker.mapMutex);
-                std::vector<CompositeRange> toRemoveRanges;
+                evictStaleHolders(*workerPtr, toRemove);
+            }
+            
+        }
+        
+        if (!toRemove.empty()) {
+            _logger->info("gc(): {} nodes removed", toRemove.size());
+        }
+    }
 
-                for (auto &pair2 : worker.nodeMap) {
-                    auto &holder = pair2.second;
-                    std::scoped_lock<std::mutex> holderLock(holder.mutex);
+    void RowGraph::removeNodeLocked(RowGraphId id) {
+        if (_compactStore != nullptr) {
+            _compactStore->remove(id);
+            return;
+        }
+        
+        // remove edges
+        {
+            std::set<RowGraphId> edgeSources;
+            
+            auto pair = boost::in_edges(id, _graph);
+            auto it = pair.first;
+            const auto itEnd = pair.second;
+            
+            while (it != itEnd) {
+                auto edge = *it;
+                auto source = boost::source(edge, _graph);
+                
+                edgeSources.emplace(source);
+                
+                ++it;
+            }
+            
+            for (auto source: edgeSources) {
+                boost::remove_edge(source, id, _graph);
+            }
+        }
+        
+        {
+            std::set<RowGraphId> edgeTargets;
+            
+            auto pair = boost::out_edges(id, _graph);
+            auto it = pair.first;
+            const auto itEnd = pair.second;
+            
+            while (it != itEnd) {
+                auto edge = *it;
+                auto target = boost::target(edge, _graph);
+                
+                edgeTargets.emplace(target);
+                
+                ++it;
+            }
+            
+            for (auto target: edgeTargets) {
+                boost::remove_edge(id, target, _graph);
+            }
+        }
+        
+        boost::remove_vertex(id, _graph);
+    }
 
-                    if (toRemove.find(holder.read) != toRemove.end()) {
-                        holder.read = nullptr;
-                        holder.readGid = 0;
-                    }
+    void RowGraph::retireNode(RowGraphId nodeId) {
+        std::vector<RowGraphId> nodes;
+        {
+            std::lock_guard<std::mutex> lock(_retiredMutex);
+            _retiredNodes.push_back(nodeId);
+            if (_retiredNodes.size() < kReclaimBatchSize) {
+                return;
+            }
+            nodes.swap(_retiredNodes);
+        }
 
-                    if (toRemove.find(holder.write) != toRemove.end()) {
-                        holder.write = nullptr;
-                        holder.writeGid = 0;
-                    }
+        dispatchReclaimBatch(std::move(nodes));
+    }
 
-                    if (holder.read == nullptr && holder.write == nullptr) {
-                        toRemoveRanges.emplace_back(pair2.first);
-                    }
-                }
+    void RowGraph::flushRetiredNodes() {
+        std::vector<RowGraphId> nodes;
+        {
+            std::lock_guard<std::mutex> lock(_retiredMutex);
+            nodes.swap(_retiredNodes);
+        }
 
-                if (worker.hasWildcard) {
-                    auto &holder = worker.wildcardHolder;
-                    std::scoped_lock<std::mutex> holderLock(holder.mutex);
+        if (!nodes.empty()) {
+            dispatchReclaimBatch(std::move(nodes));
+        }
+    }
 
-                    if (toRemove.find(holder.read) != toRemove.end()) {
-                        holder.read = nullptr;
-                        holder.readGid = 0;
-                    }
+    void RowGraph::dispatchReclaimBatch(std::vector<RowGraphId> nodes) {
+        auto batch = std::make_shared<ReclaimBatch>();
+        batch->nodes.insert(nodes.begin(), nodes.end());
 
-                    if (toRemove.find(holder.write) != toRemove.end()) {
-                        holder.write = nullptr;
-                        holder.writeGid = 0;
-                    }
+        if (_workerCount == 0) {
+            batch->remainingWorkers = 1;
+            acknowledgeReclaimBatch(*batch);
+            return;
+        }
 
-                    if (holder.read == nullptr && holder.write == nullptr) {
-                        worker.hasWildcard = false;
-                    }
-                }
+        batch->remainingWorkers = _workerCount;
 
-                for (auto &range : toRemoveRanges) {
-                    worker.nodeMap.erase(range);
-                }
+        forEachColumnWorker([this, &batch](ColumnWorker &worker) {
+            {
+                std::lock_guard<std::mutex> lock(worker.queueMutex);
+                worker.reclaimQueue.push_back(batch);
             }
-            
+            wakeWorker(worker);
+        });
+
+        for (auto &workerPtr : _compositeWorkers) {
+            if (!workerPtr) {
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(workerPtr->queueMutex);
+                workerPtr->reclaimQueue.push_back(batch);
+            }
+            wakeWorker(*workerPtr);
         }
-        
-        if (!toRemove.empty()) {
-            _logger->info("gc(): {} nodes removed", toRemove.size());
+    }
+
+    void RowGraph::acknowledgeReclaimBatch(ReclaimBatch &batch) {
+        if (batch.remainingWorkers.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+
+        WriteLock _lock(_graphMutex);
+        for (auto id : batch.nodes) {
+            removeNodeLocked(id);
         }
     }
 
     void RowGraph::gc() {
+        if (_incrementalGCEnabled) {
+            flushRetiredNodes();
+            return;
+        }
+
         bool expected = false;
         if (!_isGCRunning.compare_exchange_strong(expected, true)) {
             return;
@@ -982,19 +1246,112 @@ namespace ultraverse::state::v2 {
         _isGCRunning.store(false, std::memory_order_release);
     }
     
+    template <typename Fn>
+    void RowGraph::forEachColumnWorker(Fn &&fn) {
+        for (auto &pair : _columnWorkers) {
+            for (auto &worker : pair.second) {
+                fn(*worker);
+            }
+        }
+    }
+
+    template <typename Worker>
+    void RowGraph::wakeWorker(Worker &worker) {
+        if (_shards.empty()) {
+            worker.queueCv.notify_one();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(worker.queueMutex);
+            if (worker.scheduled) {
+                return;
+            }
+            worker.scheduled = true;
+        }
+
+        WorkerShard::Entry entry;
+        if constexpr (std::is_same_v<Worker, ColumnWorker>) {
+            entry.column = &worker;
+        } else {
+            entry.composite = &worker;
+        }
+
+        auto &shard = *_shards[worker.shard];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.runnable.push_back(entry);
+        }
+        shard.cv.notify_one();
+    }
+
     void RowGraph::enqueueTask(const std::string &column, ColumnTask task) {
         auto it = _columnWorkers.find(column);
-        if (it == _columnWorkers.end()) {
+        if (it == _columnWorkers.end() || it->second.empty()) {
             markColumnTaskDone(task.nodeId);
             return;
         }
         
-        auto &worker = it->second;
-        {
-            std::lock_guard<std::mutex> lock(worker->queueMutex);
-            worker->queue.push_back(std::move(task));
+        auto &partitions = it->second;
+        auto pushTask = [this](ColumnWorker &worker, ColumnTask task) {
+            {
+                std::lock_guard<std::mutex> lock(worker.queueMutex);
+                worker.queue.push_back(std::move(task));
+            }
+            wakeWorker(worker);
+        };
+
+        // INTERSECT에서는 서로 다른 Range끼리도 의존할 수 있으므로 파티션을 나누지 않는다.
+        if (partitions.size() == 1 || rangeComparisonMethod() != RangeComparisonMethod::EQ_ONLY) {
+            pushTask(*partitions.front(), std::move(task));
+            return;
+        }
+
+        // EQ_ONLY에서는 같은 Range끼리만 의존하므로 Range 해시로 파티션을 고를 수 있다.
+        // 와일드카드는 모든 Range와 겹치므로 모든 파티션에 보낸다.
+        std::vector<ColumnTask> split(partitions.size());
+        auto route = [&split](std::vector<StateItem> &items, std::vector<StateItem> ColumnTask::*target) {
+            for (auto &item : items) {
+                const auto &range = item.MakeRange2();
+                if (item.function_type == FUNCTION_WILDCARD || range.wildcard()) {
+                    for (auto &partTask : split) {
+                        (partTask.*target).push_back(item);
+                    }
+                    continue;
+                }
+                const auto partition = std::hash<StateRange>()(range) % split.size();
+                (split[partition].*target).push_back(std::move(item));
+            }
+        };
+        route(task.readItems, &ColumnTask::readItems);
+        route(task.writeItems, &ColumnTask::writeItems);
+
+        uint32_t partTaskCount = 0;
+        for (const auto &partTask : split) {
+            if (!partTask.readItems.empty() || !partTask.writeItems.empty()) {
+                partTaskCount++;
+            }
+        }
+
+        if (partTaskCount == 0) {
+            markColumnTaskDone(task.nodeId);
+            return;
+        }
+
+        if (partTaskCount > 1) {
+            // 이 태스크 몫의 1은 이미 세어져 있으므로, 늘어난 만큼만 더한다.
+            auto node = nodeFor(task.nodeId);
+            node->pendingColumns.fetch_add(partTaskCount - 1, std::memory_order_acq_rel);
+        }
+
+        for (size_t partition = 0; partition < split.size(); partition++) {
+            auto &partTask = split[partition];
+            if (partTask.readItems.empty() && partTask.writeItems.empty()) {
+                continue;
+            }
+            partTask.nodeId = task.nodeId;
+            pushTask(*partitions[partition], std::move(partTask));
         }
-        worker->queueCv.notify_one();
     }
 
     void RowGraph::enqueueCompositeTask(size_t groupIndex, CompositeTask task) {
@@ -1012,45 +1369,46 @@ namespace ultraverse::state::v2 {
             std::lock_guard<std::mutex> lock(worker.queueMutex);
             worker.queue.push_back(std::move(task));
         }
-        worker.queueCv.notify_one();
+        wakeWorker(worker);
     }
     
     void RowGraph::columnWorkerLoop(ColumnWorker &worker) {
         bool paused = false;
         while (true) {
             ColumnTask task;
+            std::shared_ptr<ReclaimBatch> reclaimBatch;
             {
                 std::unique_lock<std::mutex> lock(worker.queueMutex);
                 worker.queueCv.wait(lock, [this, &worker]() {
-                    return !worker.queue.empty() || !worker.running ||
+                    return !worker.queue.empty() || !worker.reclaimQueue.empty() || !worker.running ||
                            _gcPause.load(std::memory_order_acquire);
                 });
 
                 if (_gcPause.load(std::memory_order_acquire)) {
                     lock.unlock();
-                    std::unique_lock<std::mutex> pauseLock(_gcMutex);
-                    if (!paused) {
-                        _pausedWorkers.fetch_add(1, std::memory_order_acq_rel);
-                        paused = true;
-                        _gcCv.notify_all();
-                    }
-                    _gcCv.wait(pauseLock, [this]() {
-                        return !_gcPause.load(std::memory_order_acquire);
-                    });
-                    if (paused) {
-                        _pausedWorkers.fetch_sub(1, std::memory_order_acq_rel);
-                        paused = false;
-                        _gcCv.notify_all();
-                    }
+                    parkForGC(paused);
                     continue;
                 }
 
-                if (!worker.running && worker.queue.empty()) {
-                    return;
+                if (!worker.reclaimQueue.empty()) {
+                    reclaimBatch = std::move(worker.reclaimQueue.front());
+                    worker.reclaimQueue.pop_front();
+                } else {
+                    if (!worker.running && worker.queue.empty()) {
+                        return;
+                    }
+
+                    task = std::move(worker.queue.front());
+                    worker.queue.pop_front();
                 }
+            }
 
-                task = std::move(worker.queue.front());
-                worker.queue.pop_front();
+            if (reclaimBatch != nullptr) {
+                // 이 워커는 태스크를 순차적으로 처리하므로, 여기까지 왔다면 이전 태스크들은
+                // 더 이상 회수 대상 노드를 참조하지 않는다.
+                evictStaleHolders(worker, reclaimBatch->nodes);
+                acknowledgeReclaimBatch(*reclaimBatch);
+                continue;
             }
 
             _activeTasks.fetch_add(1, std::memory_order_acq_rel);
@@ -1065,46 +1423,139 @@ namespace ultraverse::state::v2 {
         bool paused = false;
         while (true) {
             CompositeTask task;
+            std::shared_ptr<ReclaimBatch> reclaimBatch;
             {
                 std::unique_lock<std::mutex> lock(worker.queueMutex);
                 worker.queueCv.wait(lock, [this, &worker]() {
-                    return !worker.queue.empty() || !worker.running ||
+                    return !worker.queue.empty() || !worker.reclaimQueue.empty() || !worker.running ||
                            _gcPause.load(std::memory_order_acquire);
                 });
 
                 if (_gcPause.load(std::memory_order_acquire)) {
                     lock.unlock();
-                    std::unique_lock<std::mutex> pauseLock(_gcMutex);
-                    if (!paused) {
-                        _pausedWorkers.fetch_add(1, std::memory_order_acq_rel);
-                        paused = true;
-                        _gcCv.notify_all();
-                    }
-                    _gcCv.wait(pauseLock, [this]() {
-                        return !_gcPause.load(std::memory_order_acquire);
-                    });
-                    if (paused) {
-                        _pausedWorkers.fetch_sub(1, std::memory_order_acq_rel);
-                        paused = false;
-                        _gcCv.notify_all();
+                    parkForGC(paused);
+                    continue;
+                }
+
+                if (!worker.reclaimQueue.empty()) {
+                    reclaimBatch = std::move(worker.reclaimQueue.front());
+                    worker.reclaimQueue.pop_front();
+                } else {
+                    if (!worker.running && worker.queue.empty()) {
+                        return;
                     }
+
+                    task = std::move(worker.queue.front());
+                    worker.queue.pop_front();
+                }
+            }
+
+            if (reclaimBatch != nullptr) {
+                // 이 워커는 태스크를 순차적으로 처리하므로, 여기까지 왔다면 이전 태스크들은
+                // 더 이상 회수 대상 노드를 참조하지 않는다.
+                evictStaleHolders(worker, reclaimBatch->nodes);
+                acknowledgeReclaimBatch(*reclaimBatch);
+                continue;
+            }
+
+            _activeTasks.fetch_add(1, std::memory_order_acq_rel);
+            processCompositeTask(worker, task);
+            _activeTasks.fetch_sub(1, std::memory_order_acq_rel);
+            _gcCv.notify_all();
+            markColumnTaskDone(task.nodeId);
+        }
+    }
+    
+    void RowGraph::shardWorkerLoop(WorkerShard &shard) {
+        bool paused = false;
+        while (true) {
+            WorkerShard::Entry entry;
+            {
+                std::unique_lock<std::mutex> lock(shard.mutex);
+                shard.cv.wait(lock, [this, &shard]() {
+                    return !shard.runnable.empty() || !shard.running ||
+                           _gcPause.load(std::memory_order_acquire);
+                });
+
+                if (_gcPause.load(std::memory_order_acquire)) {
+                    lock.unlock();
+                    parkForGC(paused);
                     continue;
                 }
 
-                if (!worker.running && worker.queue.empty()) {
+                if (shard.runnable.empty()) {
                     return;
                 }
 
-                task = std::move(worker.queue.front());
-                worker.queue.pop_front();
+                entry = shard.runnable.front();
+                shard.runnable.pop_front();
+            }
+
+            const bool hasMore = entry.column != nullptr ?
+                drainWorker(*entry.column, &RowGraph::processColumnTask) :
+                drainWorker(*entry.composite, &RowGraph::processCompositeTask);
+
+            if (hasMore) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.runnable.push_back(entry);
+            }
+        }
+    }
+
+    template <typename Worker, typename Task>
+    bool RowGraph::drainWorker(Worker &worker, void (RowGraph::*process)(Worker &, Task &)) {
+        for (size_t count = 0; count < kShardDrainLimit; count++) {
+            if (_gcPause.load(std::memory_order_acquire)) {
+                return true;
+            }
+
+            Task task;
+            std::shared_ptr<ReclaimBatch> reclaimBatch;
+            {
+                std::lock_guard<std::mutex> lock(worker.queueMutex);
+                if (!worker.reclaimQueue.empty()) {
+                    reclaimBatch = std::move(worker.reclaimQueue.front());
+                    worker.reclaimQueue.pop_front();
+                } else if (!worker.queue.empty()) {
+                    task = std::move(worker.queue.front());
+                    worker.queue.pop_front();
+                } else {
+                    worker.scheduled = false;
+                    return false;
+                }
+            }
+
+            if (reclaimBatch != nullptr) {
+                evictStaleHolders(worker, reclaimBatch->nodes);
+                acknowledgeReclaimBatch(*reclaimBatch);
+                continue;
             }
 
             _activeTasks.fetch_add(1, std::memory_order_acq_rel);
-            processCompositeTask(worker, task);
+            (this->*process)(worker, task);
             _activeTasks.fetch_sub(1, std::memory_order_acq_rel);
             _gcCv.notify_all();
             markColumnTaskDone(task.nodeId);
         }
+
+        return true;
+    }
+
+    void RowGraph::parkForGC(bool &paused) {
+        std::unique_lock<std::mutex> pauseLock(_gcMutex);
+        if (!paused) {
+            _pausedWorkers.fetch_add(1, std::memory_order_acq_rel);
+            paused = true;
+            _gcCv.notify_all();
+        }
+        _gcCv.wait(pauseLock, [this]() {
+            return !_gcPause.load(std::memory_order_acquire);
+        });
+        if (paused) {
+            _pausedWorkers.fetch_sub(1, std::memory_order_acq_rel);
+            paused = false;
+            _gcCv.notify_all();
+        }
     }
     
     void RowGraph::processColumnTask(ColumnWorker &worker, ColumnTask &task) {
@@ -1246,7 +1697,7 @@ namespace ultraverse::state::v2 {
         if (!edgeSources.empty()) {
             WriteLock lock(_graphMutex);
             for (auto source : edgeSources) {
-                boost::add_edge(source, task.nodeId, _graph);
+                addEdgeLocked(source, task.nodeId);
             }
         }
     }
@@ -1406,7 +1857,7 @@ namespace ultraverse::state::v2 {
         if (!edgeSources.empty()) {
             WriteLock lock(_graphMutex);
             for (auto source : edgeSources) {
-                boost::add_edge(source, task.nodeId, _graph);
+                addEdgeLocked(source, task.nodeId);
             }
         }
     }
@@ -1419,10 +1870,46 @@ namespace ultraverse::state::v2 {
         
         auto remaining = node->pendingColumns.fetch_sub(1);
         if (remaining == 1) {
-            node->ready = true;
+            markNodeReady(nodeId, *node);
         }
     }
 
+    void RowGraph::markNodeReady(RowGraphId nodeId, RowGraphNode &node) {
+        node.ready = true;
+        if (_readyQueueEnabled) {
+            releaseDependency(nodeId, node);
+        }
+    }
+
+    void RowGraph::releaseDependency(RowGraphId nodeId, RowGraphNode &node) {
+        if (node.pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pushReadyNode(nodeId);
+        }
+    }
+
+    void RowGraph::pushReadyNode(RowGraphId nodeId) {
+        {
+            std::lock_guard<std::mutex> lock(_readyQueueMutex);
+            _readyQueue.push_back(nodeId);
+        }
+        _readyQueueCv.notify_one();
+    }
+
+    RowGraphId RowGraph::popReadyNode(int workerId) {
+        RowGraphId nodeId = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(_readyQueueMutex);
+            if (_readyQueue.empty()) {
+                return nullptr;
+            }
+            nodeId = _readyQueue.front();
+            _readyQueue.pop_front();
+        }
+
+        nodeFor(nodeId)->processedBy = workerId;
+        return nodeId;
+    }
+
     void RowGraph::dump() {
     }
     
@@ -1434,6 +1921,44 @@ namespace ultraverse::state::v2 {
         _rangeComparisonMethod = rangeComparisonMethod;
     }
 
+    bool RowGraph::isReadyQueueEnabled() const {
+        return _readyQueueEnabled;
+    }
+
+    void RowGraph::setReadyQueueEnabled(bool enabled) {
+        _readyQueueRequested = enabled;
+        // compact 저장소는 ready queue 없이 스케줄링할 수 없다.
+        _readyQueueEnabled = enabled || _compactStore != nullptr;
+    }
+
+    bool RowGraph::isIncrementalGCEnabled() const {
+        return _incrementalGCEnabled;
+    }
+
+    void RowGraph::setIncrementalGCEnabled(bool enabled) {
+        _incrementalGCEnabled = enabled;
+    }
+
+    size_t RowGraph::workerShardCount() const {
+        return _shards.size();
+    }
+
+    bool RowGraph::isCompactStorageEnabled() const {
+        return _compactStore != nullptr;
+    }
+
+    void RowGraph::setCompactStorageEnabled(bool enabled) {
+        if (enabled) {
+            if (_compactStore == nullptr) {
+                _compactStore = std::make_unique<CompactRowGraphStore>();
+            }
+            _readyQueueEnabled = true;
+        } else {
+            _compactStore.reset();
+            _readyQueueEnabled = _readyQueueRequested;
+        }
+    }
+
 // #ifdef ULTRAVERSE_TESTING
     size_t RowGraph::debugNodeMapSize(const std::string &column) {
         const auto normalized = utility::toLower(column);
@@ -1455,18 +1980,28 @@ namespace ultraverse::state::v2 {
             std::lock_guard<std::mutex> lock(worker.mapMutex);
             return worker.nodeMap.size();
         }
-        auto &worker = it->second;
-        std::lock_guard<std::mutex> lock(worker->mapMutex);
-        return worker->nodeMap.size();
-    }
-
-    size_t RowGraph::debugTotalNodeMapSize() {
         size_t total = 0;
-        for (auto &pair : _columnWorkers) {
-            auto &worker = pair.second;
+        for (auto &worker : it->second) {
             std::lock_guard<std::mutex> lock(worker->mapMutex);
             total += worker->nodeMap.size();
         }
+        return total;
+    }
+
+    size_t RowGraph::debugNodeCount() {
+        ConcurrentReadLock _lock(_graphMutex);
+        if (_compactStore != nullptr) {
+            return _compactStore->size();
+        }
+        return boost::num_vertices(_graph);
+    }
+
+    size_t RowGraph::debugTotalNodeMapSize() {
+        size_t total = 0;
+        forEachColumnWorker([&total](ColumnWorker &worker) {
+            std::lock_guard<std::mutex> lock(worker.mapMutex);
+            total += worker.nodeMap.size();
+        });
         for (auto &workerPtr : _compositeWorkers) {
             if (!workerPtr) {
                 continue;
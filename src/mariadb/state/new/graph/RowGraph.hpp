@@ -6,6 +6,7 @@
 #define ULTRAVERSE_ROWGRAPH_HPP
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <map>
@@ -32,6 +33,7 @@
 namespace ultraverse::state::v2 {
     
     class RelationshipResolver;
+    class CompactRowGraphStore;
     
     struct RowGraphNode {
         uint64_t id;
@@ -45,6 +47,12 @@ namespace ultraverse::state::v2 {
         std::atomic_bool finalized = false;
         std::atomic_bool willBeRemoved = false;
         std::atomic_uint32_t pendingColumns = 0;
+        /**
+         * @brief ready queue 모드에서 아직 해소되지 않은 선행 조건 수
+         * @details 미완료 선행 노드 수 + (의존성 해결 대기 중이면 1) + (hold 중이면 1).
+         *          0이 되는 순간 ready queue에 들어간다.
+         */
+        std::atomic_int32_t pendingDependencies = 0;
     };
     
     using RowGraphInternal =
@@ -75,6 +83,15 @@ namespace ultraverse::state::v2 {
             
             std::mutex mutex;
         };
+        /**
+         * @brief 증분 GC에서 한 번에 회수할 노드 묶음
+         * @details 모든 컬럼 / 복합 워커가 자신의 nodeMap에서 이 노드들을 비운 뒤 (remainingWorkers == 0)
+         *          그래프에서 실제로 제거된다.
+         */
+        struct ReclaimBatch {
+            std::unordered_set<RowGraphId> nodes;
+            std::atomic_uint32_t remainingWorkers = 0;
+        };
         struct ColumnTask {
             RowGraphId nodeId;
             std::vector<StateItem> readItems;
@@ -90,8 +107,14 @@ namespace ultraverse::state::v2 {
             std::mutex queueMutex;
             std::condition_variable queueCv;
             std::deque<ColumnTask> queue;
+            std::deque<std::shared_ptr<ReclaimBatch>> reclaimQueue;
             std::atomic_bool running = true;
             std::thread worker;
+
+            /** @brief 샤드 워커 풀 모드에서 이 워커를 실행하는 샤드 */
+            size_t shard = 0;
+            /** @brief 샤드의 실행 대기열에 올라가 있거나 실행 중인지 여부 (queueMutex로 보호) */
+            bool scheduled = false;
         };
         struct CompositeRange {
             std::vector<StateRange> ranges;
@@ -120,12 +143,39 @@ namespace ultraverse::state::v2 {
             std::mutex queueMutex;
             std::condition_variable queueCv;
             std::deque<CompositeTask> queue;
+            std::deque<std::shared_ptr<ReclaimBatch>> reclaimQueue;
             std::atomic_bool running = true;
             std::thread worker;
+
+            size_t shard = 0;
+            bool scheduled = false;
         };
+        /**
+         * @brief 샤드 워커 풀의 스레드 하나
+         * @details 할 일이 생긴 컬럼 / 복합 워커가 runnable에 들어오고, 스레드는 워커의 큐를 순서대로 비운다.
+         *          하나의 워커는 항상 같은 샤드에서만 실행되므로 워커 단위의 처리 순서가 유지된다.
+         */
+        struct WorkerShard {
+            struct Entry {
+                ColumnWorker *column = nullptr;
+                CompositeWorker *composite = nullptr;
+            };
+
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::deque<Entry> runnable;
+            bool running = true;
+            std::thread thread;
+        };
+        /**
+         * @param workerShards 0이면 키 컬럼 / 복합 그룹마다 전용 스레드를 띄운다.
+         *                     0보다 크면 그 수만큼의 샤드 스레드 풀에서 의존성 해결 태스크를 처리한다.
+         *                     이 때 각 키 컬럼은 workerShards개의 파티션으로 나뉘며, 태스크는 (컬럼, Range) 해시로 파티션에 배정된다.
+         */
         explicit RowGraph(const std::set<std::string> &keyColumns,
                           const RelationshipResolver &resolver,
-                          const std::vector<std::vector<std::string>> &keyColumnGroups = {});
+                          const std::vector<std::vector<std::string>> &keyColumnGroups = {},
+                          size_t workerShards = 0);
         
         ~RowGraph();
         
@@ -160,6 +210,41 @@ namespace ultraverse::state::v2 {
          * @return 노드 ID를 반환한다. 단, 당장 처리할 수 있는 노드가 없으면 nullptr를 반환한다.
          */
         RowGraphId entrypoint(int workerId);
+
+        /**
+         * @brief entrypoint()와 같으나, 처리할 수 있는 노드가 생길 때까지 최대 timeout 만큼 대기한다.
+         * @return 노드 ID를 반환한다. timeout 이내에 노드를 얻지 못하면 nullptr를 반환한다.
+         */
+        RowGraphId waitEntrypoint(int workerId, std::chrono::milliseconds timeout);
+
+        /**
+         * @brief 노드를 처리 완료로 표시한다.
+         * @details ready queue 모드에서는 후속 노드들의 pendingDependencies를 감소시키고,
+         *          0이 된 노드를 ready queue에 넣는다.
+         */
+        void markFinalized(RowGraphId nodeId);
+
+        /**
+         * @brief 추가되었지만 아직 markFinalized()되지 않은 노드 수를 반환한다.
+         */
+        uint64_t pendingNodeCount() const;
+
+        /**
+         * @brief 미완료 노드 수가 maxPending 이하가 될 때까지 대기한다.
+         * @details 피더가 그래프에 노드를 너무 많이 쌓지 않도록 하는 backpressure 용도로 사용한다.
+         */
+        void waitForCapacity(uint64_t maxPending);
+
+        /**
+         * @brief 추가된 모든 노드가 markFinalized()될 때까지 대기한다.
+         * @note 더 이상 노드가 추가되지 않는 시점에 호출해야 한다.
+         */
+        void waitUntilAllFinalized();
+
+        /**
+         * @brief waitEntrypoint()에서 대기 중인 워커들을 깨우고, 이후 호출은 즉시 반환되게 한다.
+         */
+        void closeReadyQueue();
         
         /**
          * @brief 노드 ID로 노드에 액세스한다.
@@ -178,6 +263,7 @@ namespace ultraverse::state::v2 {
         
         /**
          * @brief 가비지 콜렉팅을 실시한다. (처리된 노드들을 제거한다.)
+         * @note 증분 GC 모드에서는 워커를 멈추지 않고, 아직 묶음을 채우지 못한 retire list를 회수 요청한다.
          */
         void gc();
         
@@ -189,9 +275,42 @@ namespace ultraverse::state::v2 {
         RangeComparisonMethod rangeComparisonMethod() const;
         void setRangeComparisonMethod(RangeComparisonMethod rangeComparisonMethod);
 
+        /**
+         * @brief ready queue 스케줄러 사용 여부
+         * @details 활성화하면 entrypoint()가 전체 노드를 스캔하는 대신 ready queue에서 노드를 꺼낸다.
+         *          노드를 추가하기 전에 설정해야 한다.
+         */
+        bool isReadyQueueEnabled() const;
+        void setReadyQueueEnabled(bool enabled);
+
+        /**
+         * @brief 증분 GC 사용 여부
+         * @details 활성화하면 markFinalized()된 노드가 retire list에 쌓이고, 일정 수가 모이면
+         *          워커를 멈추지 않고 작은 묶음 단위로 nodeMap과 그래프에서 제거된다.
+         *          노드를 추가하기 전에 설정해야 하며, 활성화한 뒤에는 finalize된 노드에 nodeFor()로 접근하면 안 된다.
+         */
+        bool isIncrementalGCEnabled() const;
+        void setIncrementalGCEnabled(bool enabled);
+
+        /**
+         * @brief compact 저장소 사용 여부
+         * @details 활성화하면 boost::adjacency_list 대신 CompactRowGraphStore에 노드와 간선을 저장한다.
+         *          선행 노드 목록이 없으므로 ready queue 스케줄러가 함께 활성화되고,
+         *          비활성화하면 setReadyQueueEnabled()로 지정한 설정으로 돌아간다.
+         *          노드를 추가하기 전에 설정해야 한다.
+         */
+        bool isCompactStorageEnabled() const;
+        void setCompactStorageEnabled(bool enabled);
+
+        /**
+         * @brief 샤드 워커 풀의 스레드 수를 반환한다. 전용 스레드 모드이면 0을 반환한다.
+         */
+        size_t workerShardCount() const;
+
 // #ifdef ULTRAVERSE_TESTING
         size_t debugNodeMapSize(const std::string &column);
         size_t debugTotalNodeMapSize();
+        size_t debugNodeCount();
 // #endif
         
     private:
@@ -203,12 +322,46 @@ namespace ultraverse::state::v2 {
         void columnWorkerLoop(ColumnWorker &worker);
         void processColumnTask(ColumnWorker &worker, ColumnTask &task);
         void compositeWorkerLoop(CompositeWorker &worker);
+        void shardWorkerLoop(WorkerShard &shard);
+        /**
+         * @brief 워커에 새 태스크나 회수 묶음이 들어왔음을 알린다.
+         */
+        template <typename Worker>
+        void wakeWorker(Worker &worker);
+        /**
+         * @brief 샤드 스레드에서 워커의 큐를 처리한다.
+         * @return 큐를 다 비우지 못했으면 (GC 일시 정지, 공정성 제한) true를 반환한다.
+         */
+        template <typename Worker, typename Task>
+        bool drainWorker(Worker &worker, void (RowGraph::*process)(Worker &, Task &));
+        template <typename Fn>
+        void forEachColumnWorker(Fn &&fn);
         void processCompositeTask(CompositeWorker &worker, CompositeTask &task);
         void markColumnTaskDone(RowGraphId nodeId);
+        /**
+         * @brief 간선을 추가한다. _graphMutex의 WriteLock을 잡은 상태에서 호출해야 한다.
+         */
+        void addEdgeLocked(RowGraphId from, RowGraphId to);
+        void markNodeReady(RowGraphId nodeId, RowGraphNode &node);
+        void releaseDependency(RowGraphId nodeId, RowGraphNode &node);
+        void pushReadyNode(RowGraphId nodeId);
+        RowGraphId popReadyNode(int workerId);
         void pauseWorkers();
+        /**
+         * @brief GC가 끝날 때까지 현재 스레드를 멈춘다. 워커 / 샤드 스레드에서 호출한다.
+         */
+        void parkForGC(bool &paused);
         void resumeWorkers();
         void notifyAllWorkers();
         void gcInternal();
+        /**
+         * @brief 노드와 노드에 연결된 간선을 제거한다. _graphMutex의 WriteLock을 잡은 상태에서 호출해야 한다.
+         */
+        void removeNodeLocked(RowGraphId id);
+        void retireNode(RowGraphId nodeId);
+        void flushRetiredNodes();
+        void dispatchReclaimBatch(std::vector<RowGraphId> nodes);
+        void acknowledgeReclaimBatch(ReclaimBatch &batch);
         
         LoggerPtr _logger;
         const RelationshipResolver &_resolver;
@@ -222,13 +375,18 @@ namespace ultraverse::state::v2 {
         std::unordered_set<std::string> _compositeColumns;
         
         RowGraphInternal _graph;
+        /**
+         * @brief compact 저장소 모드에서만 사용한다. 이 때 _graph는 비어 있다.
+         */
+        std::unique_ptr<CompactRowGraphStore> _compactStore;
         
         /**
          * @brief (컬럼, Range)를 가장 마지막으로 읽고 쓴 노드 ID를 저장하는 맵
          * @details 노드간 간선을 빠르게 추가하기 위해 사용한다.
          */
-        std::unordered_map<std::string, std::unique_ptr<ColumnWorker>> _columnWorkers;
+        std::unordered_map<std::string, std::vector<std::unique_ptr<ColumnWorker>>> _columnWorkers;
         std::vector<std::unique_ptr<CompositeWorker>> _compositeWorkers;
+        std::vector<std::unique_ptr<WorkerShard>> _shards;
         
         
         RWMutex _graphMutex;
@@ -241,8 +399,27 @@ namespace ultraverse::state::v2 {
         std::atomic_uint32_t _activeTasks = 0;
         std::atomic_uint32_t _pausedWorkers = 0;
         uint32_t _workerCount = 0;
+        /** @brief GC 일시 정지 시 멈춰야 하는 스레드 수 */
+        uint32_t _workerThreadCount = 0;
         
         RangeComparisonMethod _rangeComparisonMethod;
+
+        bool _readyQueueEnabled = false;
+        /** @brief setReadyQueueEnabled()로 지정한 값. compact 저장소를 끄면 이 값으로 돌아간다. */
+        bool _readyQueueRequested = false;
+        std::mutex _readyQueueMutex;
+        std::condition_variable _readyQueueCv;
+        std::deque<RowGraphId> _readyQueue;
+        bool _readyQueueClosed = false;
+
+        std::atomic_uint64_t _addedNodes = 0;
+        std::atomic_uint64_t _finalizedNodes = 0;
+        std::mutex _progressMutex;
+        std::condition_variable _progressCv;
+
+        bool _incrementalGCEnabled = false;
+        std::mutex _retiredMutex;
+        std::vector<RowGraphId> _retiredNodes;
     };
 }
 
@@ -26,6 +26,7 @@ class StateClusterCluster;
 class StateCluster;
 class ProcCall;
 class StateChangeReplayPlan;
+class ColumnSummary;
 }
 
 #endif // ULTRAVERSE_STATE_PROTO_FWD_HPP
@@ -1,8 +1,15 @@
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <optional>
 
 #include "mariadb/state/new/StateLogReader.hpp"
+#include "mariadb/state/new/SegmentedStateLogReader.hpp"
+#include "mariadb/state/new/BlockCompressedStateLog.hpp"
+#include "mariadb/state/new/TimestampIndex.hpp"
 
 #include "utils/log.hpp"
+#include "utils/StringUtil.hpp"
 
 #include "Application.hpp"
 
@@ -18,7 +25,7 @@ public:
     }
     
     std::string optString() override {
-        return "i:s:e:vVh";
+        return "i:s:e:t:T:mavVh";
     }
     
     template <typename Iterator>
@@ -88,6 +95,11 @@ public:
             "    -i statelog    specify state log\n"
             "    -s startgid    \n"
             "    -e endgid      \n"
+            "    -t starttime   print transactions committed at or after starttime\n"
+            "    -T endtime     print transactions committed at or before endtime\n"
+            "                   (UNIX timestamp or UTC \"YYYY-MM-DD HH:MM:SS\"; resolved with .ulttimeindex)\n"
+            "    -m             print segments of a segmented state log and verify their checksums\n"
+            "    -a             skip segments deleted from archive/ instead of failing (prints the missing gids)\n"
             "    -v             print additional info (prints itemset, whereset)\n"
             "    -V             print more additional info (prints beforehash, afterhash)\n"
             "    -h             print this help and exit application\n";
@@ -102,11 +114,78 @@ public:
         gid_t endGid = isArgSet('e') ? std::stoul(getArg('e')) : UINT32_MAX;
         
         
-        v2::StateLogReader reader(".", getArg('i'));
-        reader.open();
+        const bool isSegmented = v2::StateLogManifest::exists(".", getArg('i'));
+
+        if (isArgSet('m')) {
+            if (!isSegmented) {
+                _logger->error("{} is not a segmented state log", getArg('i'));
+                return 1;
+            }
+            return printManifest(v2::StateLogManifest(".", getArg('i')));
+        }
+
+        std::unique_ptr<v2::IStateLogReader> reader;
+        if (isSegmented) {
+            auto segmentedReader = std::make_unique<v2::SegmentedStateLogReader>(".", getArg('i'), isArgSet('a'));
+            _logger->info("reading segmented state log ({} segments)", segmentedReader->manifest().segments().size());
+            segmentedReader->setGidRange(startGid, endGid);
+            for (const auto &segment : segmentedReader->missingSegments()) {
+                _logger->warn("segment {} (gid {} - {}) was deleted from the archive; skipping",
+                              segment.name, segment.firstGid, segment.lastGid);
+            }
+            reader = std::move(segmentedReader);
+        } else {
+            if (v2::isBlockCompressedStateLog(".", getArg('i'))) {
+                _logger->info("reading block-compressed state log");
+            }
+            reader = std::make_unique<v2::StateLogReader>(".", getArg('i'));
+        }
+        reader->open();
+
+        if (isArgSet('t') || isArgSet('T')) {
+            if (isSegmented) {
+                // .ulttimeindex는 세그먼트마다 따로 있으므로 세그먼트 안의 위치만 가리킨다
+                _logger->error("-t / -T is not supported for segmented state logs; see -m for timestamp ranges of segments");
+                return 1;
+            }
+
+            auto startTime = isArgSet('t') ? utility::parseTimestamp(getArg('t')) : std::make_optional<uint64_t>(0);
+            auto endTime = isArgSet('T') ? utility::parseTimestamp(getArg('T')) : std::make_optional<uint64_t>(UINT64_MAX);
+            if (!startTime.has_value() || !endTime.has_value()) {
+                _logger->error("invalid time format, expected UNIX timestamp or \"YYYY-MM-DD HH:MM:SS\"");
+                return 1;
+            }
+
+            std::unique_ptr<v2::TimestampIndexReader> timestampIndex;
+            try {
+                timestampIndex = std::make_unique<v2::TimestampIndexReader>(".", getArg('i'));
+            } catch (std::exception &e) {
+                _logger->error("cannot resolve time range: {}", e.what());
+                return 1;
+            }
+
+            auto gidRange = v2::resolveTimeRange(*reader, *timestampIndex, *startTime, *endTime);
+            if (!gidRange.has_value()) {
+                _logger->info("no transactions between {} and {}", *startTime, *endTime);
+                return 0;
+            }
+
+            _logger->info("time range {}...{} resolved to gid range {}...{}",
+                          *startTime, *endTime, gidRange->first, gidRange->second);
+
+            startGid = std::max(startGid, static_cast<gid_t>(gidRange->first));
+            endGid = std::min(endGid, static_cast<gid_t>(gidRange->second));
+
+            // 시작 gid 직전의 인덱스 엔트리부터 읽는다
+            auto seekEntry = timestampIndex->lastBefore(*startTime);
+            reader->reset();
+            if (seekEntry.has_value()) {
+                reader->seek(seekEntry->offset);
+            }
+        }
         
-        while (reader.next()) {
-            auto transactionHeader = reader.txnHeader();
+        while (reader->nextHeader() && reader->nextTransaction()) {
+            auto transactionHeader = reader->txnHeader();
             
             if (transactionHeader == nullptr || transactionHeader->gid > endGid) {
                 break;
@@ -114,7 +193,7 @@ public:
                 continue;
             }
             
-            auto transaction = reader.txnBody();
+            auto transaction = reader->txnBody();
             
             _logger->info("Transaction #{}", transaction->gid());
             /*
@@ -189,6 +268,31 @@ public:
     }
     
 private:
+    int printManifest(const v2::StateLogManifest &manifest) {
+        bool isValid = true;
+
+        for (const auto &segment: manifest.segments()) {
+            std::string state = segment.archived ? "archived" : (segment.sealed ? "sealed" : "live");
+            if (segment.sealed && !segment.archived) {
+                if (manifest.verify(segment)) {
+                    state += ", checksum ok";
+                } else {
+                    state += ", CHECKSUM MISMATCH";
+                    isValid = false;
+                }
+            }
+
+            _logger->info("Segment {} ({})", segment.name, state);
+            _logger->info("    - Gid: {}...{} ({} transactions)",
+                          segment.firstGid, segment.lastGid, segment.transactionCount);
+            _logger->info("    - Timestamp: {}...{}", segment.minTimestamp, segment.maxTimestamp);
+            _logger->info("    - Size: {}", segment.size);
+            _logger->info("    - SHA-256: {}", segment.checksum);
+        }
+
+        return isValid ? 0 : 1;
+    }
+
     LoggerPtr _logger;
 };
 
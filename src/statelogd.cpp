@@ -1,14 +1,17 @@
 #include <algorithm>
 #include <atomic>
 #include <cctype>
+#include <chrono>
 #include <condition_variable>
 #include <cstring>
+#include <filesystem>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <fstream>
 #include <limits>
 #include <optional>
+#include <set>
 #include <sstream>
 #include <pthread.h>
 #include <signal.h>
@@ -23,6 +26,8 @@
 #include "mariadb/state/new/Transaction.hpp"
 #include "mariadb/state/new/ColumnDependencyGraph.hpp"
 #include "mariadb/state/new/StateLogWriter.hpp"
+#include "mariadb/state/new/StateLogIngestPart.hpp"
+#include "mariadb/state/new/StateLogCheckpoint.hpp"
 #include "mariadb/state/StateHash.hpp"
 
 #include "mariadb/DBHandle.hpp"
@@ -68,6 +73,29 @@ struct PendingTransaction {
     std::string tmp;
 };
 
+/**
+ * @brief 트랜잭션 하나를 XID 이벤트까지 읽었을 때의 binlog 위치
+ */
+struct BinlogCursor {
+    gid_t gid = 0;
+    int binlogIndex = 0;
+    std::string binlogFile;
+    uint64_t binlogPos = 0;
+};
+
+struct PendingWrite {
+    std::shared_ptr<std::promise<std::shared_ptr<state::v2::Transaction>>> transaction;
+    BinlogCursor cursor;
+};
+
+/**
+ * @brief binlog 하나를 읽으면서 아직 XID 이벤트를 만나지 못한 트랜잭션의 상태
+ */
+struct IngestContext {
+    std::shared_ptr<PendingTransaction> currentTransaction = std::make_shared<PendingTransaction>();
+    std::shared_ptr<mariadb::RowQueryEvent> pendingRowQueryEvent;
+};
+
 struct RowQueryTaskInput {
     std::string database;
     std::string statement;
@@ -135,6 +163,8 @@ public:
         const auto &config = *configOpt;
 
         _binlogIndexPath = config.binlog.path + "/" + config.binlog.indexName;
+        _useMemoryMappedBinlog = config.binlog.memoryMappedReader;
+        _payloadDecodeThreads = config.binlog.payloadDecodeThreads;
         _stateLogName = config.stateLog.path + "/" + config.stateLog.name;
         _keyColumnGroups = utility::parseKeyColumnGroups(config.keyColumns);
         _keyColumns = utility::flattenKeyColumnGroups(_keyColumnGroups);
@@ -147,6 +177,28 @@ public:
             config.statelogd.developmentFlags.end(), "print-queries") != config.statelogd.developmentFlags.end();
         _procedureLogPath = config.statelogd.procedureLogPath;
         _oneshotMode = config.statelogd.oneshotMode;
+        _checkpointInterval = config.statelogd.checkpointInterval;
+        _parallelFiles = config.statelogd.parallelFiles;
+        if (_parallelFiles > 1 && !_oneshotMode) {
+            _logger->warn("statelogd.parallelFiles is only used in oneshot mode; reading binlogs sequentially");
+            _parallelFiles = 0;
+        }
+        _compressionBlockSize = config.stateLog.compressionBlockSize;
+        _compressionLevel = config.stateLog.compressionLevel;
+        _useSymbolTable = config.stateLog.symbolTable;
+        _timestampIndexInterval = config.stateLog.timestampIndexInterval;
+        if (config.stateLog.keyIndex) {
+            _keyIndexColumns.insert(_keyColumns.begin(), _keyColumns.end());
+            _keyIndexColumns.insert(config.stateLog.keyIndexColumns.begin(), config.stateLog.keyIndexColumns.end());
+        }
+        _segmentSize = static_cast<uint64_t>(config.stateLog.segmentSizeMB) * 1024 * 1024;
+        _retainedSegments = config.stateLog.retainedSegments;
+        _useRWSummary = config.stateLog.rwSummary;
+        _transactionsPerZone = config.stateLog.zoneMapInterval;
+        if (_transactionsPerZone > 0) {
+            _zoneMapColumns.insert(_keyColumns.begin(), _keyColumns.end());
+            _zoneMapColumns.insert(config.stateLog.keyIndexColumns.begin(), config.stateLog.keyIndexColumns.end());
+        }
 
         if (_threadNum <= 0) {
             _threadNum = 1;
@@ -184,6 +236,8 @@ public:
             }
         }
         _binlogReader->setPollDisabled(_oneshotMode);
+        _binlogReader->setMemoryMapped(_useMemoryMappedBinlog);
+        _binlogReader->setPayloadDecodeThreads(_payloadDecodeThreads);
 
         if (!_procedureLogPath.empty()) {
             _procLogReader = std::make_unique<state::v2::ProcLogReader>();
@@ -192,13 +246,22 @@ public:
 
 
         _stateLogWriter = std::make_unique<state::v2::StateLogWriter>(".", _stateLogName);
+        _stateLogWriter->setBlockCompression(_compressionBlockSize, _compressionLevel);
+        _stateLogWriter->setSymbolTableEncoding(_useSymbolTable);
+        _stateLogWriter->setTimestampIndexInterval(_timestampIndexInterval);
+        _stateLogWriter->setKeyIndexColumns(_keyIndexColumns);
+        _stateLogWriter->setSegmentation(_segmentSize, _retainedSegments);
+        _stateLogWriter->setRWSummaryEnabled(_useRWSummary);
+        _stateLogWriter->setZoneMap(_transactionsPerZone, _zoneMapColumns);
 
         // _pendingTxn = std::make_shared<state::v2::Transaction>();
         // _pendingQuery = std::make_shared<state::v2::Query>();
         
         _writerThread = std::thread([this]() {
+            int uncheckpointedTransactions = 0;
+
             while (true) {
-                std::shared_ptr<std::promise<std::shared_ptr<state::v2::Transaction>>> promise;
+                PendingWrite pendingWrite;
                 {
                     std::unique_lock<std::mutex> lock(_txnQueueMutex);
                     _txnQueueCv.wait(lock, [this]() {
@@ -211,12 +274,12 @@ public:
                         }
                         continue;
                     }
-                    promise = std::move(_pendingTransactions.front());
+                    pendingWrite = std::move(_pendingTransactions.front());
                     _pendingTransactions.pop();
                 }
                 _txnQueueCv.notify_all();
 
-                auto transaction = std::move(promise->get_future().get());
+                auto transaction = std::move(pendingWrite.transaction->get_future().get());
 
                 if (transaction != nullptr) {
                     if (_printTransactions) {
@@ -236,35 +299,57 @@ public:
                     }
                 }
                 *_stateLogWriter << *transaction;
+                _lastWritten = std::move(pendingWrite.cursor);
+
+                if (_checkpointInterval > 0 && ++uncheckpointedTransactions >= _checkpointInterval) {
+                    saveCheckpoint(*_lastWritten);
+                    uncheckpointedTransactions = 0;
+                }
             }
         });
 
-        if (!_checkpointPath.empty()) {
-            _stateLogWriter->open(std::ios::out | std::ios::binary | std::ios::app);
-            _logger->info("ultraverse state loaded: {}", _checkpointPath);
-            int pos = 0;
-            std::ifstream is(_checkpointPath, std::ios::binary);
-            if (is) {
-                _logger->warn("checkpoint restore is not supported with protobuf-based logs yet");
-
-                _logger->info("gid: {}", _gid);
-            } else {
-                throw std::runtime_error(
-                        fmt::format("cannot find file {}.", _checkpointPath)
-                );
-            }
-            if (_gid >= _binlogReader->logFileListSize()) {
-                _gid = _binlogReader->logFileListSize() - 1;
-            }
-            _binlogReader->seek(_gid, pos);
+        gid_t global_gid = 0;
+        std::optional<state::v2::StateLogCheckpoint> checkpoint;
+        if (_checkpointInterval > 0) {
+            checkpoint = state::v2::StateLogCheckpoint::load(".", _stateLogName);
         }
-        else {
+
+        if (checkpoint.has_value()) {
+            restoreCheckpoint(*checkpoint);
+            global_gid = checkpoint->nextGid;
+        } else {
             _stateLogWriter->open(std::ios::out | std::ios::binary);
         }
 
-        std::shared_ptr<mariadb::RowQueryEvent> pendingRowQueryEvent;
-        gid_t global_gid = 0;
-        std::shared_ptr<PendingTransaction> currentTransaction = std::make_shared<PendingTransaction>();
+        if (_parallelFiles > 1) {
+            ingestFilesInParallel(global_gid);
+        } else {
+            ingestSequentially(global_gid);
+        }
+
+        requestStop();
+        
+        if (_writerThread.joinable()) {
+            _writerThread.join();
+        }
+
+        if (_checkpointInterval > 0 && _lastWritten.has_value()) {
+            // 정상 종료할 때에도 체크포인트를 남겨서 다음 실행이 이어서 읽도록 한다
+            saveCheckpoint(*_lastWritten);
+        }
+        
+        _stateLogWriter->close();
+        {
+            std::lock_guard<std::mutex> lock(_binlogMutex);
+            _binlogReader.reset();
+        }
+    }
+    
+    /**
+     * @brief binlog를 하나의 reader로 처음부터 (또는 체크포인트부터) 순서대로 읽는다.
+     */
+    void ingestSequentially(gid_t &global_gid) {
+        IngestContext context;
 
         while (true) {
             if (_stopRequested.load(std::memory_order_acquire)) {
@@ -278,228 +363,411 @@ public:
             if (event == nullptr) {
                 continue;
             }
-            
-            switch (event->eventType()) {
-                case event_type::QUERY: {
-                    auto queryEvent = std::dynamic_pointer_cast<mariadb::QueryEvent>(event);
-                    if (queryEvent == nullptr) {
-                        break;
-                    }
 
-                    const auto &statement = queryEvent->statement();
-                    if (statement == "COMMIT" || statement == "ROLLBACK") {
-                        currentTransaction = std::make_shared<PendingTransaction>();
-                        pendingRowQueryEvent = nullptr;
-                        break;
-                    }
-                    if (statement == "BEGIN") {
-                        currentTransaction->statementContext.clear();
+            auto transaction = dispatchEvent(context, event);
+            if (transaction != nullptr) {
+                gid_t gid = global_gid++;
+                PendingWrite pendingWrite;
+                pendingWrite.cursor.gid = gid;
+                pendingWrite.cursor.binlogIndex = _binlogReader->currentIndex();
+                pendingWrite.cursor.binlogFile = _binlogReader->currentLogFile();
+                pendingWrite.cursor.binlogPos = _binlogReader->pos();
+                pendingWrite.transaction = postTransaction(std::move(transaction), gid);
+
+                enqueueWrite(std::move(pendingWrite));
+            }
+        }
+    }
+
+    /**
+     * @brief (oneshot 모드) binlog 파일들을 _parallelFiles개의 스레드에서 동시에 읽는다.
+     * @details 트랜잭션은 binlog 파일을 넘어가지 않으므로 파일마다 따로 디코딩할 수 있다.
+     *          각 스레드는 파일 하나를 읽어 임시 state log (<stateLogName>.ingest/part-N)에 쓰고,
+     *          이 스레드는 그 결과를 binlog 순서대로 다시 읽어 gid를 매긴 뒤 writer 스레드로 넘긴다.
+     *          트랜잭션마다 XID 이벤트의 위치를 함께 넘기므로 체크포인트는 순차 모드와 똑같이 남는다.
+     */
+    void ingestFilesInParallel(gid_t &global_gid) {
+        namespace fs = std::filesystem;
+
+        const int startIndex = _binlogReader->currentIndex();
+        const int64_t startPos = _binlogReader->pos();
+        const int fileCount = _binlogReader->logFileListSize();
+
+        if (startIndex >= fileCount) {
+            return;
+        }
+
+        const std::string ingestPath = _stateLogName + ".ingest";
+        fs::create_directories(ingestPath);
+
+        std::vector<std::promise<std::vector<BinlogCursor>>> results(fileCount - startIndex);
+        std::vector<std::future<std::vector<BinlogCursor>>> futures;
+        for (auto &result: results) {
+            futures.emplace_back(result.get_future());
+        }
+
+        std::atomic<int> nextIndex{startIndex};
+        std::vector<std::thread> workers;
+        const int workerCount = std::min(_parallelFiles, fileCount - startIndex);
+
+        _logger->info("ingesting {} binlog files with {} threads", fileCount - startIndex, workerCount);
+
+        for (int i = 0; i < workerCount; i++) {
+            workers.emplace_back([&, this]() {
+                while (true) {
+                    const int index = nextIndex.fetch_add(1);
+                    if (index >= fileCount) {
                         break;
                     }
 
-                    auto ctx = currentTransaction->statementContext;
-                    currentTransaction->statementContext.clear();
-                    auto promise = _taskExecutor->post<std::shared_ptr<state::v2::Query>>(
-                        [this, queryEvent, ctx]() mutable {
-                            return processQueryEvent(queryEvent, &ctx);
-                        });
-                    currentTransaction->queries.push(std::move(promise));
+                    auto &result = results[index - startIndex];
+                    try {
+                        result.set_value(ingestFile(ingestPath, index, index == startIndex ? startPos : 4));
+                    } catch (...) {
+                        result.set_exception(std::current_exception());
+                    }
                 }
+            });
+        }
+
+        for (int index = startIndex; index < fileCount; index++) {
+            if (_stopRequested.load(std::memory_order_acquire)) {
+                break;
+            }
+
+            std::vector<BinlogCursor> cursors;
+            try {
+                cursors = futures[index - startIndex].get();
+            } catch (std::exception &e) {
+                _logger->error("failed to ingest binlog #{}: {}", index, e.what());
+                _stopRequested.store(true, std::memory_order_release);
+                break;
+            }
+
+            state::v2::StateLogIngestPart part(ingestPath, index);
+            try {
+                size_t cursorIndex = 0;
+                global_gid = part.merge(global_gid, cursors.size(), [&](std::shared_ptr<state::v2::Transaction> transaction) {
+                    auto &cursor = cursors[cursorIndex++];
+                    cursor.gid = transaction->gid();
+
+                    PendingWrite pendingWrite;
+                    pendingWrite.transaction = std::make_shared<std::promise<std::shared_ptr<state::v2::Transaction>>>();
+                    pendingWrite.transaction->set_value(std::move(transaction));
+                    pendingWrite.cursor = std::move(cursor);
+
+                    enqueueWrite(std::move(pendingWrite));
+                });
+            } catch (std::exception &e) {
+                _logger->error("failed to merge binlog #{}: {}", index, e.what());
+                _stopRequested.store(true, std::memory_order_release);
+                break;
+            }
+
+            part.remove();
+        }
+
+        // 중간에 멈췄으면 아직 읽고 있는 스레드들도 _stopRequested를 보고 곧 끝난다
+        for (auto &worker: workers) {
+            worker.join();
+        }
+
+        std::error_code errorCode;
+        fs::remove_all(ingestPath, errorCode);
+    }
+
+    /**
+     * @brief index번째 binlog를 따로 열어 position부터 끝까지 읽고, 트랜잭션들을 임시 state log에 쓴다.
+     * @return 쓴 트랜잭션마다 XID 이벤트까지 읽었을 때의 binlog 위치 (gid는 병합할 때 매긴다)
+     */
+    std::vector<BinlogCursor> ingestFile(const std::string &ingestPath, int index, int64_t position) {
+        using PendingPart = std::pair<std::shared_ptr<std::promise<std::shared_ptr<state::v2::Transaction>>>, BinlogCursor>;
+
+        std::vector<BinlogCursor> cursors;
+        std::queue<PendingPart> pendingParts;
+
+        // open()한 reader는 offset 0 (magic number)에 있으므로 항상 seek한다.
+        // 4보다 뒤로 seek하면 reader가 FORMAT_DESCRIPTION_EVENT를 먼저 읽어 둔다
+        auto binlogReader = _binlogReader->openLogFile(index);
+        if (!binlogReader->seek(std::max<int64_t>(position, 4))) {
+            throw std::runtime_error(fmt::format("could not seek binlog #{} to {}", index, position));
+        }
+
+        state::v2::StateLogIngestPart part(ingestPath, index);
+        part.open();
+
+        auto writeFront = [&]() {
+            auto &[promise, cursor] = pendingParts.front();
+            auto transaction = promise->get_future().get();
+
+            part.write(*transaction);
+            cursors.push_back(std::move(cursor));
+            pendingParts.pop();
+        };
+
+        IngestContext context;
+        BinlogCursor cursor;
+        cursor.binlogIndex = index;
+        cursor.binlogFile = _binlogReader->logFileAt(index);
+
+        while (!_stopRequested.load(std::memory_order_acquire) && binlogReader->next()) {
+            auto event = binlogReader->currentEvent();
+            if (event == nullptr) {
+                continue;
+            }
+
+            auto transaction = dispatchEvent(context, event);
+            if (transaction == nullptr) {
+                continue;
+            }
+
+            cursor.binlogPos = binlogReader->pos();
+            pendingParts.emplace(postTransaction(std::move(transaction), std::nullopt), cursor);
+
+            if (pendingParts.size() >= kMaxPendingTransactions) {
+                writeFront();
+            }
+        }
+
+        while (!pendingParts.empty()) {
+            writeFront();
+        }
+
+        part.close();
+        binlogReader->close();
+
+        return cursors;
+    }
+
+    /**
+     * @brief 이벤트 하나를 현재 트랜잭션에 반영한다.
+     * @return XID 이벤트를 만나면 다 읽은 트랜잭션을, 아니면 nullptr
+     */
+    std::shared_ptr<PendingTransaction> dispatchEvent(IngestContext &context, const std::shared_ptr<base::DBEvent> &event) {
+        auto &currentTransaction = context.currentTransaction;
+        auto &pendingRowQueryEvent = context.pendingRowQueryEvent;
+
+        switch (event->eventType()) {
+            case event_type::QUERY: {
+                auto queryEvent = base::eventCast<mariadb::QueryEvent>(event);
+                if (queryEvent == nullptr) {
                     break;
-                case event_type::TXNID: {
-                    currentTransaction->tidEvent = std::dynamic_pointer_cast<mariadb::TransactionIDEvent>(event);
-                    gid_t gid = global_gid++;
-                    auto pendingTxn = _taskExecutor->post<std::shared_ptr<state::v2::Transaction>>(
-                        [this, currentTransaction = std::move(currentTransaction), gid]() {
-                            while (!currentTransaction->queries.empty()) {
-                                auto promise = std::move(currentTransaction->queries.front());
-                                currentTransaction->queries.pop();
-                                
-                                currentTransaction->queryObjs.push(
-                                    promise->get_future().get()
-                                );
-                            }
-                            
-                            return processTransactionIDEvent(currentTransaction, gid);
-                        });
-                    {
-                        std::unique_lock<std::mutex> lock(_txnQueueMutex);
-                        _txnQueueCv.wait(lock, [this]() {
-                            return _pendingTransactions.size() < kMaxPendingTransactions;
-                        });
-                        _pendingTransactions.push(std::move(pendingTxn));
-                    }
-                    _txnQueueCv.notify_one();
-                    
+                }
+
+                const auto &statement = queryEvent->statement();
+                if (statement == "COMMIT" || statement == "ROLLBACK") {
                     currentTransaction = std::make_shared<PendingTransaction>();
+                    pendingRowQueryEvent = nullptr;
+                    break;
                 }
+                if (statement == "BEGIN") {
+                    currentTransaction->statementContext.clear();
                     break;
-                case event_type::INTVAR: {
-                    auto intVarEvent = std::dynamic_pointer_cast<mariadb::IntVarEvent>(event);
-                    if (intVarEvent == nullptr) {
-                        break;
-                    }
-                    if (intVarEvent->type() == mariadb::IntVarEvent::LAST_INSERT_ID) {
-                        currentTransaction->statementContext.hasLastInsertId = true;
-                        currentTransaction->statementContext.lastInsertId = intVarEvent->value();
-                    } else if (intVarEvent->type() == mariadb::IntVarEvent::INSERT_ID) {
-                        currentTransaction->statementContext.hasInsertId = true;
-                        currentTransaction->statementContext.insertId = intVarEvent->value();
-                    }
                 }
+
+                auto ctx = currentTransaction->statementContext;
+                currentTransaction->statementContext.clear();
+                auto promise = _taskExecutor->post<std::shared_ptr<state::v2::Query>>(
+                    [this, queryEvent, ctx]() mutable {
+                        return processQueryEvent(queryEvent, &ctx);
+                    });
+                currentTransaction->queries.push(std::move(promise));
+            }
+                break;
+            case event_type::TXNID: {
+                auto transaction = std::move(currentTransaction);
+                transaction->tidEvent = base::eventCast<mariadb::TransactionIDEvent>(event);
+                currentTransaction = std::make_shared<PendingTransaction>();
+
+                return transaction;
+            }
+            case event_type::INTVAR: {
+                auto intVarEvent = base::eventCast<mariadb::IntVarEvent>(event);
+                if (intVarEvent == nullptr) {
                     break;
-                case event_type::RAND: {
-                    auto randEvent = std::dynamic_pointer_cast<mariadb::RandEvent>(event);
-                    if (randEvent == nullptr) {
-                        break;
-                    }
-                    currentTransaction->statementContext.hasRandSeed = true;
-                    currentTransaction->statementContext.randSeed1 = randEvent->seed1();
-                    currentTransaction->statementContext.randSeed2 = randEvent->seed2();
                 }
+                if (intVarEvent->type() == mariadb::IntVarEvent::LAST_INSERT_ID) {
+                    currentTransaction->statementContext.hasLastInsertId = true;
+                    currentTransaction->statementContext.lastInsertId = intVarEvent->value();
+                } else if (intVarEvent->type() == mariadb::IntVarEvent::INSERT_ID) {
+                    currentTransaction->statementContext.hasInsertId = true;
+                    currentTransaction->statementContext.insertId = intVarEvent->value();
+                }
+            }
+                break;
+            case event_type::RAND: {
+                auto randEvent = base::eventCast<mariadb::RandEvent>(event);
+                if (randEvent == nullptr) {
                     break;
-                case event_type::USER_VAR: {
-                    auto userVarEvent = std::dynamic_pointer_cast<mariadb::UserVarEvent>(event);
-                    if (userVarEvent == nullptr) {
-                        break;
-                    }
-                    state::v2::Query::UserVar userVar;
-                    userVar.name = userVarEvent->name();
-                    userVar.type = static_cast<state::v2::Query::UserVar::ValueType>(userVarEvent->type());
-                    userVar.isNull = userVarEvent->isNull();
-                    userVar.isUnsigned = userVarEvent->isUnsigned();
-                    userVar.charset = userVarEvent->charset();
-                    userVar.value = userVarEvent->value();
-                    currentTransaction->statementContext.userVars.emplace_back(std::move(userVar));
                 }
+                currentTransaction->statementContext.hasRandSeed = true;
+                currentTransaction->statementContext.randSeed1 = randEvent->seed1();
+                currentTransaction->statementContext.randSeed2 = randEvent->seed2();
+            }
+                break;
+            case event_type::USER_VAR: {
+                auto userVarEvent = base::eventCast<mariadb::UserVarEvent>(event);
+                if (userVarEvent == nullptr) {
                     break;
-                // row events
-                case event_type::TABLE_MAP:
-                    processTableMapEvent(currentTransaction, std::dynamic_pointer_cast<mariadb::TableMapEvent>(event));
+                }
+                state::v2::Query::UserVar userVar;
+                userVar.name = userVarEvent->name();
+                userVar.type = static_cast<state::v2::Query::UserVar::ValueType>(userVarEvent->type());
+                userVar.isNull = userVarEvent->isNull();
+                userVar.isUnsigned = userVarEvent->isUnsigned();
+                userVar.charset = userVarEvent->charset();
+                userVar.value = userVarEvent->value();
+                currentTransaction->statementContext.userVars.emplace_back(std::move(userVar));
+            }
+                break;
+            // row events
+            case event_type::TABLE_MAP:
+                processTableMapEvent(currentTransaction, base::eventCast<mariadb::TableMapEvent>(event));
+                break;
+            case event_type::ROW_EVENT: {
+                auto rowEvent = base::eventCast<mariadb::RowEvent>(event);
+                if (rowEvent == nullptr) {
+                    _logger->warn("ROW_EVENT cast failed; skipping");
                     break;
-                case event_type::ROW_EVENT: {
-                    auto rowEvent = std::dynamic_pointer_cast<mariadb::RowEvent>(event);
-                    if (rowEvent == nullptr) {
-                        _logger->warn("ROW_EVENT cast failed; skipping");
-                        break;
+                }
+                auto tableMapIt = currentTransaction->tableMaps.find(rowEvent->tableId());
+                if (tableMapIt == currentTransaction->tableMaps.end() || tableMapIt->second == nullptr) {
+                    if (!_warnedMissingTableMap) {
+                        _logger->warn("ROW_EVENT missing TABLE_MAP for table id {}; skipping row event", rowEvent->tableId());
+                        _warnedMissingTableMap = true;
                     }
-                    auto tableMapIt = currentTransaction->tableMaps.find(rowEvent->tableId());
-                    if (tableMapIt == currentTransaction->tableMaps.end() || tableMapIt->second == nullptr) {
-                        if (!_warnedMissingTableMap) {
-                            _logger->warn("ROW_EVENT missing TABLE_MAP for table id {}; skipping row event", rowEvent->tableId());
-                            _warnedMissingTableMap = true;
-                        }
-                        if (rowEvent->flags() & 1) {
-                            pendingRowQueryEvent = nullptr;
-                        }
-                        break;
+                    if (rowEvent->flags() & 1) {
+                        pendingRowQueryEvent = nullptr;
                     }
-                    auto tableMapEvent = tableMapIt->second;
-
-                    auto promise = std::make_shared<std::promise<std::shared_ptr<state::v2::Query>>>();
-                    /*
-                    auto promise = _taskExecutor.post<std::shared_ptr<state::v2::Query>>([this, currentTransaction, rowEvent = std::move(rowEvent), pendingRowQueryEvent, tableMapEvent]() {
-                        auto pendingQuery = std::make_shared<state::v2::Query>();
-                        
-                        processRowEvent(
-                            currentTransaction,
-                            rowEvent,
-                            pendingRowQueryEvent,
-                            pendingQuery,
-                            tableMapEvent
-                        );
-                        // processRowQueryEvent(pendingRowQueryEvent, pendingQuery);
-                        
-                        return pendingQuery;
-                    });
-                     */
-                    auto pendingQuery = std::make_shared<state::v2::Query>();
-                    RowQueryTaskInput rowQueryTaskInput;
-                    RowQueryTaskInput *rowQueryTaskInputPtr = pendingRowQueryEvent != nullptr
-                        ? &rowQueryTaskInput
-                        : nullptr;
+                    break;
+                }
+                auto tableMapEvent = tableMapIt->second;
 
-                    const bool processed = processRowEvent(
+                auto promise = std::make_shared<std::promise<std::shared_ptr<state::v2::Query>>>();
+                /*
+                auto promise = _taskExecutor.post<std::shared_ptr<state::v2::Query>>([this, currentTransaction, rowEvent = std::move(rowEvent), pendingRowQueryEvent, tableMapEvent]() {
+                    auto pendingQuery = std::make_shared<state::v2::Query>();
+                    
+                    processRowEvent(
                         currentTransaction,
                         rowEvent,
                         pendingRowQueryEvent,
                         pendingQuery,
-                        tableMapEvent,
-                        &currentTransaction->statementContext,
-                        rowQueryTaskInputPtr
+                        tableMapEvent
                     );
                     // processRowQueryEvent(pendingRowQueryEvent, pendingQuery);
-                    if (processed) {
-                        if (pendingRowQueryEvent != nullptr) {
-                            auto rowQueryPromise = _taskExecutor->post<std::shared_ptr<state::v2::Query>>(
-                                [this,
-                                 transaction = currentTransaction,
-                                 pendingQuery,
-                                 rowQueryTaskInput = std::move(rowQueryTaskInput)]() mutable {
-                                    auto result = parseRowQueryEvent(std::move(rowQueryTaskInput));
-
-                                    pendingQuery->readSet().insert(
-                                        pendingQuery->readSet().end(),
-                                        result.readSet.begin(), result.readSet.end()
-                                    );
-                                    pendingQuery->writeSet().insert(
-                                        pendingQuery->writeSet().end(),
-                                        result.writeSet.begin(), result.writeSet.end()
-                                    );
-                                    pendingQuery->readColumns().insert(
-                                        result.readColumns.begin(), result.readColumns.end()
-                                    );
-                                    pendingQuery->writeColumns().insert(
-                                        result.writeColumns.begin(), result.writeColumns.end()
-                                    );
-                                    pendingQuery->varMap().insert(
-                                        pendingQuery->varMap().end(),
-                                        result.varMap.begin(), result.varMap.end()
-                                    );
-
-                                    if (result.isProcedureHint) {
-                                        std::scoped_lock lock(transaction->_procCallMutex);
-                                        assert(transaction->procCall == nullptr);
-                                        transaction->procCall = prepareProcedureCall(pendingQuery->writeSet());
-                                    }
-
-                                    return pendingQuery;
-                                });
-                            currentTransaction->queries.push(std::move(rowQueryPromise));
-                        } else {
-                            promise->set_value(pendingQuery);
-                            currentTransaction->queries.push(promise);
-                        }
-                    }
-                    if (rowEvent->flags() & 1) {
-                        pendingRowQueryEvent = nullptr;
+                    
+                    return pendingQuery;
+                });
+                 */
+                auto pendingQuery = std::make_shared<state::v2::Query>();
+                RowQueryTaskInput rowQueryTaskInput;
+                RowQueryTaskInput *rowQueryTaskInputPtr = pendingRowQueryEvent != nullptr
+                    ? &rowQueryTaskInput
+                    : nullptr;
+
+                const bool processed = processRowEvent(
+                    currentTransaction,
+                    rowEvent,
+                    pendingRowQueryEvent,
+                    pendingQuery,
+                    tableMapEvent,
+                    &currentTransaction->statementContext,
+                    rowQueryTaskInputPtr
+                );
+                // processRowQueryEvent(pendingRowQueryEvent, pendingQuery);
+                if (processed) {
+                    if (pendingRowQueryEvent != nullptr) {
+                        auto rowQueryPromise = _taskExecutor->post<std::shared_ptr<state::v2::Query>>(
+                            [this,
+                             transaction = currentTransaction,
+                             pendingQuery,
+                             rowQueryTaskInput = std::move(rowQueryTaskInput)]() mutable {
+                                auto result = parseRowQueryEvent(std::move(rowQueryTaskInput));
+
+                                pendingQuery->readSet().insert(
+                                    pendingQuery->readSet().end(),
+                                    result.readSet.begin(), result.readSet.end()
+                                );
+                                pendingQuery->writeSet().insert(
+                                    pendingQuery->writeSet().end(),
+                                    result.writeSet.begin(), result.writeSet.end()
+                                );
+                                pendingQuery->readColumns().insert(
+                                    result.readColumns.begin(), result.readColumns.end()
+                                );
+                                pendingQuery->writeColumns().insert(
+                                    result.writeColumns.begin(), result.writeColumns.end()
+                                );
+                                pendingQuery->varMap().insert(
+                                    pendingQuery->varMap().end(),
+                                    result.varMap.begin(), result.varMap.end()
+                                );
+
+                                if (result.isProcedureHint) {
+                                    std::scoped_lock lock(transaction->_procCallMutex);
+                                    assert(transaction->procCall == nullptr);
+                                    transaction->procCall = prepareProcedureCall(pendingQuery->writeSet());
+                                }
+
+                                return pendingQuery;
+                            });
+                        currentTransaction->queries.push(std::move(rowQueryPromise));
+                    } else {
+                        promise->set_value(pendingQuery);
+                        currentTransaction->queries.push(promise);
                     }
                 }
-                    break;
-                case event_type::ROW_QUERY:
-                    pendingRowQueryEvent = std::dynamic_pointer_cast<mariadb::RowQueryEvent>(event);
-                    break;
-                    
-                default:
-                    break;
+                if (rowEvent->flags() & 1) {
+                    pendingRowQueryEvent = nullptr;
+                }
             }
-            
-            if (_stopRequested.load(std::memory_order_acquire)) {
                 break;
-            }
+            case event_type::ROW_QUERY:
+                pendingRowQueryEvent = base::eventCast<mariadb::RowQueryEvent>(event);
+                break;
+                
+            default:
+                break;
         }
 
-        requestStop();
-        
-        if (_writerThread.joinable()) {
-            _writerThread.join();
-        }
-        
-        _stateLogWriter->close();
+        return nullptr;
+    }
+
+    /**
+     * @brief 트랜잭션의 쿼리들이 다 처리되면 Transaction 객체로 만드는 작업을 _taskExecutor에 넘긴다.
+     * @param gid std::nullopt면 gid를 매기지 않는다. (병렬 ingest에서는 병합할 때 매긴다)
+     */
+    std::shared_ptr<std::promise<std::shared_ptr<state::v2::Transaction>>> postTransaction(
+        std::shared_ptr<PendingTransaction> transaction, std::optional<gid_t> gid
+    ) {
+        return _taskExecutor->post<std::shared_ptr<state::v2::Transaction>>(
+            [this, transaction = std::move(transaction), gid]() {
+                while (!transaction->queries.empty()) {
+                    auto promise = std::move(transaction->queries.front());
+                    transaction->queries.pop();
+                    
+                    transaction->queryObjs.push(
+                        promise->get_future().get()
+                    );
+                }
+                
+                return processTransactionIDEvent(transaction, gid);
+            });
+    }
+
+    /**
+     * @brief writer 스레드에 넘긴다. 밀린 트랜잭션이 kMaxPendingTransactions개를 넘으면 기다린다.
+     */
+    void enqueueWrite(PendingWrite pendingWrite) {
         {
-            std::lock_guard<std::mutex> lock(_binlogMutex);
-            _binlogReader.reset();
+            std::unique_lock<std::mutex> lock(_txnQueueMutex);
+            _txnQueueCv.wait(lock, [this]() {
+                return _pendingTransactions.size() < kMaxPendingTransactions;
+            });
+            _pendingTransactions.push(std::move(pendingWrite));
         }
+        _txnQueueCv.notify_one();
     }
     
     /**
@@ -746,35 +1014,60 @@ public:
          */
     }
     
-    std::shared_ptr<state::v2::Transaction> processTransactionIDEvent(std::shared_ptr<PendingTransaction> transaction, gid_t gid) {
+    /**
+     * 트랜잭션의 타임스탬프를 커밋 (XID 이벤트) 시각으로 지정한다. XID 이벤트가 없으면 첫 쿼리의 시각을 쓴다.
+     */
+    void updateTransactionTimestamp(const std::shared_ptr<PendingTransaction> &transaction,
+                                    const std::shared_ptr<state::v2::Transaction> &transactionObj) {
+        if (transaction->tidEvent != nullptr) {
+            transactionObj->setTimestamp(transaction->tidEvent->timestamp());
+        } else if (!transactionObj->queries().empty()) {
+            transactionObj->setTimestamp(transactionObj->queries().front()->timestamp());
+        }
+    }
+    
+    /**
+     * @brief gid가 아직 매겨지지 않았으면 (병렬 ingest) gid 없이 출력한다. gid는 writer 스레드가 쓸 때 출력한다.
+     */
+    std::string describeGid(std::optional<gid_t> gid) {
+        return gid.has_value() ? fmt::format("gid {}", *gid) : std::string("gid (assigned on merge)");
+    }
+
+    std::shared_ptr<state::v2::Transaction> processTransactionIDEvent(std::shared_ptr<PendingTransaction> transaction, std::optional<gid_t> gid) {
         if (transaction->tidEvent == nullptr) {
-            _logger->error("Transaction ID event is not available: {}", gid);
+            _logger->error("Transaction ID event is not available: {}", describeGid(gid));
         } else {
             _logger->info("Transaction ID #{} processed.", transaction->tidEvent->transactionId());
         }
         
         if (transaction->procCall != nullptr) {
             auto transactionObj = finalizeTransaction(transaction, transaction->procCall);
-            transactionObj->setGid(gid);
+            if (gid.has_value()) {
+                transactionObj->setGid(*gid);
+            }
+            updateTransactionTimestamp(transaction, transactionObj);
 
             if (_printTransactions) {
                 if (transaction->tidEvent == nullptr) {
-                    _logger->info("processed transaction gid {}", gid);
+                    _logger->info("processed transaction {}", describeGid(gid));
                 } else {
-                    _logger->info("processed transaction gid {} (xid {})", gid, transaction->tidEvent->transactionId());
+                    _logger->info("processed transaction {} (xid {})", describeGid(gid), transaction->tidEvent->transactionId());
                 }
             }
             
             return transactionObj;
         } else {
             auto transactionObj = finalizeTransaction(transaction);
-            transactionObj->setGid(gid);
+            if (gid.has_value()) {
+                transactionObj->setGid(*gid);
+            }
+            updateTransactionTimestamp(transaction, transactionObj);
 
             if (_printTransactions) {
                 if (transaction->tidEvent == nullptr) {
-                    _logger->info("processed transaction gid {}", gid);
+                    _logger->info("processed transaction {}", describeGid(gid));
                 } else {
-                    _logger->info("processed transaction gid {} (xid {})", gid, transaction->tidEvent->transactionId());
+                    _logger->info("processed transaction {} (xid {})", describeGid(gid), transaction->tidEvent->transactionId());
                 }
             }
             
@@ -923,16 +1216,54 @@ public:
         return result;
     }
     
-    void terminateProcess() {
-        std::string checkpointPath = _stateLogName.substr(0, _stateLogName.find_last_of('.')) + ".ultchkpoint";
-        int pos = _binlogReader->pos();
-        _logger->info("ultraverse state saved: {}", checkpointPath);
-        std::ofstream os(checkpointPath, std::ios::binary);
-        if (os.is_open()) {
-            _logger->warn("checkpoint save is not supported with protobuf-based logs yet");
-            os.close();
+    /**
+     * @brief 체크포인트 뒤에 쓰인 내용을 버리고, 로그를 이어 쓰도록 연 뒤 binlog를 체크포인트 위치로 옮긴다.
+     */
+    void restoreCheckpoint(const state::v2::StateLogCheckpoint &checkpoint) {
+        const int binlogIndex = _binlogReader->indexOf(checkpoint.binlogFile);
+        if (binlogIndex < 0) {
+            throw std::runtime_error(fmt::format(
+                "binary log {} of the checkpoint is not in the index; remove {}.ultcheckpoint to start over",
+                checkpoint.binlogFile, _stateLogName
+            ));
+        }
+
+        _stateLogWriter->restore(checkpoint);
+        _stateLogWriter->open(std::ios::out | std::ios::binary | std::ios::app);
+
+        _binlogReader->seek(binlogIndex, static_cast<int64_t>(checkpoint.binlogPos));
+
+        if (_procLogReader != nullptr) {
+            std::scoped_lock lock(_procLogMutex);
+            _procLogReader->seek(checkpoint.procLogPos);
+        }
+
+        _logger->info("resuming from checkpoint: binlog {}:{}, gid {}, state log {}:{}",
+                      checkpoint.binlogFile, checkpoint.binlogPos, checkpoint.nextGid,
+                      checkpoint.logName, checkpoint.logOffset);
+    }
+
+    /**
+     * @brief written까지 쓴 state log를 파일에 내려쓰고 체크포인트를 저장한다.
+     * @note writer 스레드에서 (또는 writer 스레드가 끝난 뒤에) 호출해야 한다.
+     */
+    void saveCheckpoint(const BinlogCursor &written) {
+        state::v2::StateLogCheckpoint checkpoint;
+        checkpoint.binlogIndex = written.binlogIndex;
+        checkpoint.binlogFile = written.binlogFile;
+        checkpoint.binlogPos = written.binlogPos;
+        checkpoint.nextGid = written.gid + 1;
+        checkpoint.timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count();
+
+        if (_procLogReader != nullptr) {
+            std::scoped_lock lock(_procLogMutex);
+            checkpoint.procLogPos = _procLogReader->pos();
         }
 
+        _stateLogWriter->checkpoint(checkpoint);
+        _logger->debug("checkpoint saved: binlog {}:{}, gid {}", checkpoint.binlogFile, checkpoint.binlogPos, checkpoint.nextGid);
     }
 
     bool isProcedureHint(const std::string &statement) {
@@ -1389,14 +1720,27 @@ private:
     std::unique_ptr<TaskExecutor> _taskExecutor;
 
     std::string _binlogIndexPath;
+    bool _useMemoryMappedBinlog = false;
+    int _payloadDecodeThreads = 0;
     std::string _stateLogName;
     
-    std::string _checkpointPath;
-    bool _discardCheckpoint = false;
+    int _checkpointInterval = 0;
+    std::optional<BinlogCursor> _lastWritten;
     
     int _threadNum = 1;
     bool _oneshotMode = false;
+    int _parallelFiles = 0;
     std::string _procedureLogPath;
+    int _compressionBlockSize = 0;
+    int _compressionLevel = 3;
+    bool _useSymbolTable = false;
+    int _timestampIndexInterval = 1024;
+    std::set<std::string> _keyIndexColumns;
+    uint64_t _segmentSize = 0;
+    uint32_t _retainedSegments = 0;
+    bool _useRWSummary = false;
+    uint32_t _transactionsPerZone = 0;
+    std::set<std::string> _zoneMapColumns;
     
     int _gid = 0;
     bool _printTransactions = false;
@@ -1413,9 +1757,7 @@ private:
     std::unique_ptr<state::v2::ProcLogReader> _procLogReader;
     std::mutex _procLogMutex;
     
-    std::queue<std::shared_ptr<std::promise<
-        std::shared_ptr<state::v2::Transaction>>
-    >> _pendingTransactions;
+    std::queue<PendingWrite> _pendingTransactions;
 
     std::unordered_map<uint64_t, std::shared_ptr<mariadb::TableMapEvent>> _tableMap;
     std::unordered_map<std::string, state::StateHash> _stateHashMap;
@@ -1432,8 +1774,8 @@ private:
     std::atomic<bool> _stopRequested{false};
     std::atomic<bool> _terminateRequested{false};
 
-    bool _warnedMissingRowQuery = false;
-    bool _warnedMissingTableMap = false;
+    std::atomic<bool> _warnedMissingRowQuery{false};
+    std::atomic<bool> _warnedMissingTableMap{false};
 };
 
 int main(int argc, char **argv) {
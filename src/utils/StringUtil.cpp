@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <cctype>
+#include <ctime>
+#include <iomanip>
 #include <sstream>
 #include <utility>
 #include <vector>
@@ -144,4 +146,33 @@ namespace ultraverse::utility {
 
         return std::move(columns);
     }
+
+    std::optional<uint64_t> parseTimestamp(const std::string &expression) {
+        if (expression.empty()) {
+            return std::nullopt;
+        }
+
+        if (std::all_of(expression.begin(), expression.end(), [](unsigned char ch) { return std::isdigit(ch); })) {
+            try {
+                return std::stoull(expression);
+            } catch (const std::exception &) {
+                return std::nullopt;
+            }
+        }
+
+        std::tm timeInfo {};
+        std::istringstream sstream(expression);
+        sstream >> std::get_time(&timeInfo, "%Y-%m-%d %H:%M:%S");
+        if (sstream.fail()) {
+            return std::nullopt;
+        }
+
+        // binlog 타임스탬프는 UTC 기준이므로 호스트의 시간대와 관계없이 UTC로 해석한다
+        auto time = timegm(&timeInfo);
+        if (time < 0) {
+            return std::nullopt;
+        }
+
+        return static_cast<uint64_t>(time);
+    }
 }
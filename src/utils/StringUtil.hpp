@@ -5,6 +5,8 @@
 #ifndef ULTRAVERSE_STRINGUTIL_HPP
 #define ULTRAVERSE_STRINGUTIL_HPP
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 #include <utility>
@@ -23,6 +25,11 @@ namespace ultraverse::utility {
     std::vector<std::vector<std::string>> parseKeyColumnGroups(const std::string &expression);
     std::vector<std::vector<std::string>> parseKeyColumnGroups(const std::vector<std::string> &expressions);
     std::vector<std::string> flattenKeyColumnGroups(const std::vector<std::vector<std::string>> &groups);
+
+    /**
+     * @brief UNIX 타임스탬프 (초) 또는 UTC 시각 "YYYY-MM-DD HH:MM:SS"를 UNIX 타임스탬프로 바꾼다.
+     */
+    std::optional<uint64_t> parseTimestamp(const std::string &expression);
 }
 
 
@@ -0,0 +1,785 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <zstd.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "base/EventArena.hpp"
+#include "base/TaskExecutor.hpp"
+#include "mariadb/DBEvent.hpp"
+#include "mariadb/binlog/BinaryLogSequentialReader.hpp"
+#include "mariadb/binlog/MySQLBinaryLogReaderV2.hpp"
+
+namespace {
+    using ultraverse::mariadb::BinaryLogReaderBase;
+    using ultraverse::mariadb::BinaryLogSequentialReader;
+    using ultraverse::mariadb::MySQLBinaryLogReaderV2;
+    using ultraverse::mariadb::QueryEvent;
+    using ultraverse::mariadb::TransactionIDEvent;
+
+    namespace binlog_event = mysql::binlog::event;
+
+    constexpr const char *kServerVersion = "8.0.36";
+    constexpr uint32_t kTimestamp = 1700000000;
+    constexpr int kBinlogTransactions = 40;
+
+    std::string makeTempDir(const std::string &prefix) {
+        static std::atomic<uint64_t> counter{0};
+        auto suffix = std::to_string(counter.fetch_add(1));
+        auto dir = std::filesystem::temp_directory_path() / (prefix + "_" + suffix);
+        std::filesystem::create_directories(dir);
+        return dir.string();
+    }
+
+    void putUint(std::string &out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+        }
+    }
+
+    /**
+     * @brief net_field_length()로 읽는 길이 인코딩
+     */
+    std::string packedUint(uint64_t value) {
+        std::string out;
+        if (value < 251) {
+            putUint(out, value, 1);
+        } else if (value < (1 << 16)) {
+            out.push_back(static_cast<char>(0xfc));
+            putUint(out, value, 2);
+        } else if (value < (1 << 24)) {
+            out.push_back(static_cast<char>(0xfd));
+            putUint(out, value, 3);
+        } else {
+            out.push_back(static_cast<char>(0xfe));
+            putUint(out, value, 8);
+        }
+        return out;
+    }
+
+    /**
+     * @brief binlog 이벤트 체크섬 (CRC-32, zlib의 crc32()와 같다)
+     */
+    uint32_t checksumOf(const std::string &bytes) {
+        uint32_t crc = 0xffffffff;
+        for (auto byte : bytes) {
+            crc ^= static_cast<unsigned char>(byte);
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+            }
+        }
+        return ~crc;
+    }
+
+    std::string statementFor(int index) {
+        // 이벤트 크기가 제각각이 되도록 길이를 바꾼다
+        return "INSERT INTO t VALUES (" + std::to_string(index) + ", '" + std::string((index % 7) * 37, 'x') + "')";
+    }
+
+    /**
+     * @brief 테스트용 binlog (v4, CRC32 체크섬)를 만든다.
+     * @details FORMAT_DESCRIPTION_EVENT의 post header 길이는 binlog event 라이브러리의 기본값을 그대로 쓴다.
+     */
+    class BinlogBuilder {
+    public:
+        BinlogBuilder():
+            _bytes("\xfe" "bin", 4)
+        {
+            binlog_event::Format_description_event fde(BINLOG_VERSION, kServerVersion);
+            _payloadPostHeaderLen = fde.post_header_len[binlog_event::TRANSACTION_PAYLOAD_EVENT - 1];
+
+            std::string body;
+            putUint(body, BINLOG_VERSION, 2);
+
+            std::string serverVersion(kServerVersion);
+            serverVersion.resize(ST_SERVER_VER_LEN, '\0');
+            body += serverVersion;
+
+            putUint(body, 0, 4);
+            body.push_back(static_cast<char>(LOG_EVENT_HEADER_LEN));
+            for (auto length : fde.post_header_len) {
+                body.push_back(static_cast<char>(length));
+            }
+            body.push_back(static_cast<char>(binlog_event::BINLOG_CHECKSUM_ALG_CRC32));
+
+            append(binlog_event::FORMAT_DESCRIPTION_EVENT, body);
+        }
+
+        void transaction(const std::string &statement, uint64_t xid) {
+            query("BEGIN");
+            query(statement);
+            this->xid(xid);
+        }
+
+        /**
+         * @brief binlog_transaction_compression = ON일 때와 같이 트랜잭션 하나를 zstd로 압축한 TRANSACTION_PAYLOAD_EVENT로 쓴다.
+         */
+        void compressedTransaction(const std::string &statement, uint64_t xid) {
+            std::string events;
+            events += innerEvent(binlog_event::QUERY_EVENT, queryBody("BEGIN"));
+            events += innerEvent(binlog_event::QUERY_EVENT, queryBody(statement));
+            events += innerEvent(binlog_event::XID_EVENT, xidBody(xid));
+
+            std::string compressed(ZSTD_compressBound(events.size()), '\0');
+            auto size = ZSTD_compress(compressed.data(), compressed.size(), events.data(), events.size(), 3);
+            REQUIRE_FALSE(ZSTD_isError(size));
+            compressed.resize(size);
+
+            payload(compressed, events.size());
+        }
+
+        /**
+         * @brief payload를 (zstd로 압축되었다고 표시해서) 그대로 TRANSACTION_PAYLOAD_EVENT로 쓴다.
+         */
+        void payload(const std::string &compressed, uint64_t uncompressedSize) {
+            auto field = [](std::string &out, uint64_t type, uint64_t value) {
+                auto encoded = packedUint(value);
+                out += packedUint(type);
+                out += packedUint(encoded.size());
+                out += encoded;
+            };
+
+            std::string body(_payloadPostHeaderLen, '\0');
+            field(body, PAYLOAD_SIZE_FIELD, compressed.size());
+            field(body, COMPRESSION_TYPE_FIELD, COMPRESSION_ZSTD);
+            field(body, UNCOMPRESSED_SIZE_FIELD, uncompressedSize);
+            body += packedUint(HEADER_END_MARK);
+            body += compressed;
+
+            append(binlog_event::TRANSACTION_PAYLOAD_EVENT, body);
+        }
+
+        /**
+         * @brief 마지막 이벤트의 체크섬 직전 바이트를 바꾼다. (체크섬은 다시 계산하지 않는다)
+         */
+        void corruptLastEvent() {
+            _bytes[_bytes.size() - BINLOG_CHECKSUM_LEN - 1] ^= 0x5a;
+        }
+
+        void query(const std::string &statement) {
+            append(binlog_event::QUERY_EVENT, queryBody(statement));
+        }
+
+        void xid(uint64_t xid) {
+            append(binlog_event::XID_EVENT, xidBody(xid));
+        }
+
+        const std::string &bytes() const {
+            return _bytes;
+        }
+
+        /**
+         * @brief 체크섬 없이 (TRANSACTION_PAYLOAD_EVENT 안에 들어가는 형태로) 이벤트를 만든다.
+         */
+        static std::string innerEvent(binlog_event::Log_event_type type, const std::string &body) {
+            return makeEvent(type, body, 0, false);
+        }
+
+        static std::string queryBody(const std::string &statement) {
+            const std::string database = "test";
+
+            std::string body;
+            putUint(body, 1, 4);                // thread id
+            putUint(body, 0, 4);                // exec time
+            putUint(body, database.size(), 1);
+            putUint(body, 0, 2);                // error code
+            putUint(body, 0, 2);                // status vars length
+            body += database;
+            body.push_back('\0');
+            body += statement;
+
+            return body;
+        }
+
+        static std::string xidBody(uint64_t xid) {
+            std::string body;
+            putUint(body, xid, 8);
+            return body;
+        }
+
+    protected:
+        void append(binlog_event::Log_event_type type, const std::string &body) {
+            const auto endPos = _bytes.size() + LOG_EVENT_HEADER_LEN + body.size() + BINLOG_CHECKSUM_LEN;
+            _bytes += makeEvent(type, body, static_cast<uint32_t>(endPos), true);
+        }
+
+    private:
+        static constexpr uint64_t HEADER_END_MARK = 0;
+        static constexpr uint64_t PAYLOAD_SIZE_FIELD = 1;
+        static constexpr uint64_t COMPRESSION_TYPE_FIELD = 2;
+        static constexpr uint64_t UNCOMPRESSED_SIZE_FIELD = 3;
+        static constexpr uint64_t COMPRESSION_ZSTD = 0;
+
+        static std::string makeEvent(binlog_event::Log_event_type type, const std::string &body,
+                                     uint32_t endPos, bool withChecksum) {
+            const auto size = LOG_EVENT_HEADER_LEN + body.size() + (withChecksum ? BINLOG_CHECKSUM_LEN : 0);
+
+            std::string event;
+            putUint(event, kTimestamp, 4);
+            putUint(event, type, 1);
+            putUint(event, 1, 4);               // server id
+            putUint(event, size, 4);
+            putUint(event, endPos, 4);
+            putUint(event, 0, 2);               // flags
+            event += body;
+
+            if (withChecksum) {
+                putUint(event, checksumOf(event), 4);
+            }
+
+            return event;
+        }
+
+        std::string _bytes;
+        size_t _payloadPostHeaderLen = 0;
+    };
+
+    BinlogBuilder makeBinlog(int transactions) {
+        BinlogBuilder builder;
+        for (int i = 0; i < transactions; i++) {
+            builder.transaction(statementFor(i), 1000 + i);
+        }
+        return builder;
+    }
+
+    void writeFile(const std::string &path, const std::string &bytes) {
+        std::ofstream stream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        stream.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    void appendFile(const std::string &path, const std::string &bytes) {
+        std::ofstream stream(path, std::ios::out | std::ios::binary | std::ios::app);
+        stream.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    /**
+     * @brief (이벤트를 넘겨준 뒤의 pos(), 이벤트 종류, 쿼리 또는 xid)
+     */
+    using ReadEvent = std::tuple<int, int, std::string>;
+
+    /**
+     * @brief reader.next()가 예외를 던져도 그 전까지 읽은 이벤트는 events에 남는다.
+     */
+    template <typename Reader>
+    void readEvents(Reader &reader, std::vector<ReadEvent> &events) {
+        while (reader.next()) {
+            auto event = reader.currentEvent();
+            if (event == nullptr) {
+                // FORMAT_DESCRIPTION_EVENT
+                continue;
+            }
+
+            std::string value;
+            if (auto query = std::dynamic_pointer_cast<QueryEvent>(event)) {
+                value = query->statement();
+            } else if (auto xid = std::dynamic_pointer_cast<TransactionIDEvent>(event)) {
+                value = std::to_string(xid->transactionId());
+            }
+
+            events.emplace_back(reader.pos(), static_cast<int>(event->eventType()), value);
+        }
+    }
+
+    template <typename Reader>
+    std::vector<ReadEvent> readEvents(Reader &reader) {
+        std::vector<ReadEvent> events;
+        readEvents(reader, events);
+        return events;
+    }
+
+    /**
+     * @brief FORMAT_DESCRIPTION_EVENT를 빼고 count개의 이벤트를 읽는다. poll하는 reader를 끝까지 읽으면 멈추므로 개수로 센다.
+     */
+    void skipEvents(BinaryLogSequentialReader &reader, size_t count) {
+        while (count > 0) {
+            REQUIRE(reader.next());
+            if (reader.currentEvent() != nullptr) {
+                count--;
+            }
+        }
+    }
+
+    void reopenAt(BinaryLogReaderBase &reader, int position) {
+        reader.close();
+        reader.open();
+        REQUIRE(reader.seek(position));
+    }
+
+    std::vector<ReadEvent> readFile(const std::string &path, bool memoryMapped,
+                                    TaskExecutor *payloadDecoder = nullptr) {
+        MySQLBinaryLogReaderV2 reader(path, memoryMapped, payloadDecoder);
+        reader.open();
+        REQUIRE(reader.seek(4));
+
+        auto events = readEvents(reader);
+        reader.close();
+
+        return events;
+    }
+}
+
+TEST_CASE("mmap and stream binlog readers return the same events", "[binlog]") {
+    auto dir = makeTempDir("binlogreader_mmap");
+    auto path = dir + "/mysql-bin.000001";
+    auto builder = makeBinlog(kBinlogTransactions);
+    writeFile(path, builder.bytes());
+
+    auto streamEvents = readFile(path, false);
+    auto mappedEvents = readFile(path, true);
+
+    REQUIRE(streamEvents.size() == kBinlogTransactions * 3);
+    REQUIRE(mappedEvents == streamEvents);
+
+    for (int i = 0; i < kBinlogTransactions; i++) {
+        REQUIRE(std::get<2>(streamEvents[i * 3]) == "BEGIN");
+        REQUIRE(std::get<2>(streamEvents[i * 3 + 1]) == statementFor(i));
+        REQUIRE(std::get<2>(streamEvents[i * 3 + 2]) == std::to_string(1000 + i));
+    }
+    REQUIRE(std::get<0>(streamEvents.back()) == static_cast<int>(builder.bytes().size()));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("binlog readers handle a log that grows during the read", "[binlog]") {
+    auto dir = makeTempDir("binlogreader_grow");
+    auto path = dir + "/mysql-bin.000001";
+
+    auto full = makeBinlog(kBinlogTransactions);
+    auto half = makeBinlog(kBinlogTransactions / 2);
+    writeFile(path, half.bytes());
+
+    const auto expected = readFile(path, false);
+
+    SECTION("mmap reader stops at the size it was opened with") {
+        MySQLBinaryLogReaderV2 reader(path, true);
+        reader.open();
+        REQUIRE(reader.seek(4));
+
+        auto events = readEvents(reader);
+        appendFile(path, full.bytes().substr(half.bytes().size()));
+
+        REQUIRE_FALSE(reader.next());
+        REQUIRE(events == expected);
+        REQUIRE(reader.pos() == static_cast<int>(half.bytes().size()));
+        reader.close();
+
+        REQUIRE(readFile(path, true) == readFile(path, false));
+    }
+
+    SECTION("stream reader continues from pos() after the log is appended to") {
+        MySQLBinaryLogReaderV2 reader(path, false);
+        reader.open();
+        REQUIRE(reader.seek(4));
+
+        auto events = readEvents(reader);
+        REQUIRE(events == expected);
+
+        appendFile(path, full.bytes().substr(half.bytes().size()));
+
+        // BinaryLogSequentialReader::pollNext()와 같이 다시 열고, 마지막으로 넘겨준 위치에서 읽는다
+        reopenAt(reader, reader.pos());
+        auto appended = readEvents(reader);
+        events.insert(events.end(), appended.begin(), appended.end());
+        reader.close();
+
+        REQUIRE(events == readFile(path, true));
+    }
+
+    SECTION("sequential reader maps completed binlogs and streams the live one") {
+        auto completedPath = dir + "/mysql-bin.000000";
+        auto completed = makeBinlog(kBinlogTransactions);
+        writeFile(completedPath, completed.bytes());
+
+        {
+            std::ofstream index(dir + "/mysql-bin.index");
+            index << "mysql-bin.000000\n" << "mysql-bin.000001\n";
+        }
+
+        BinaryLogSequentialReader reader(dir, "mysql-bin.index");
+        reader.setMemoryMapped(true);
+        reader.setPollDisabled(true);
+
+        size_t queries = 0;
+        auto countQueries = [&]() {
+            while (reader.next()) {
+                if (std::dynamic_pointer_cast<QueryEvent>(reader.currentEvent()) != nullptr) {
+                    queries++;
+                }
+            }
+        };
+
+        countQueries();
+        REQUIRE(reader.currentIndex() == 1);
+        REQUIRE(queries == (kBinlogTransactions + kBinlogTransactions / 2) * 2);
+
+        appendFile(path, full.bytes().substr(half.bytes().size()));
+
+        countQueries();
+        REQUIRE(queries == (kBinlogTransactions + kBinlogTransactions) * 2);
+        REQUIRE(reader.pos() == static_cast<int>(full.bytes().size()));
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("binlog readers resume from a position past the format description event", "[binlog]") {
+    auto dir = makeTempDir("binlogreader_resume");
+    auto path = dir + "/mysql-bin.000001";
+
+    BinlogBuilder builder;
+    for (int i = 0; i < kBinlogTransactions; i++) {
+        if (i % 2 == 0) {
+            builder.transaction(statementFor(i), 1000 + i);
+        } else {
+            builder.compressedTransaction(statementFor(i), 1000 + i);
+        }
+    }
+    writeFile(path, builder.bytes());
+
+    const auto expected = readFile(path, false);
+    REQUIRE(expected.size() == kBinlogTransactions * 3);
+
+    // 체크포인트처럼 트랜잭션이 끝난 위치에서, offset 4의 FORMAT_DESCRIPTION_EVENT를 읽지 않은 새 reader로 이어 읽는다
+    const size_t resumeAt = (kBinlogTransactions / 2) * 3;
+    const int position = std::get<0>(expected[resumeAt - 1]);
+    const std::vector<ReadEvent> remaining(expected.begin() + resumeAt, expected.end());
+
+    SECTION("binlog reader") {
+        TaskExecutor payloadDecoder(4);
+
+        for (auto memoryMapped : { false, true }) {
+            for (auto *decoder : { static_cast<TaskExecutor *>(nullptr), &payloadDecoder }) {
+                MySQLBinaryLogReaderV2 reader(path, memoryMapped, decoder);
+                reader.open();
+                REQUIRE(reader.seek(position));
+
+                REQUIRE(readEvents(reader) == remaining);
+                reader.close();
+            }
+        }
+    }
+
+    SECTION("sequential reader restored from a checkpoint") {
+        {
+            std::ofstream index(dir + "/mysql-bin.index");
+            index << "mysql-bin.000001\n";
+        }
+
+        // statelogd의 restoreCheckpoint()와 같이 seek(binlogIndex, binlogPos)로 이어 읽는다
+        BinaryLogSequentialReader reader(dir, "mysql-bin.index");
+        reader.setPollDisabled(true);
+        REQUIRE(reader.seek(0, position));
+
+        REQUIRE(readEvents(reader) == remaining);
+    }
+
+    SECTION("binlog reopened for parallel ingest from a non-zero position") {
+        {
+            std::ofstream index(dir + "/mysql-bin.index");
+            index << "mysql-bin.000001\n";
+        }
+
+        // statelogd의 ingestFile()과 같이 openLogFile()로 따로 연 reader를 position으로 옮긴다
+        BinaryLogSequentialReader sequentialReader(dir, "mysql-bin.index");
+        sequentialReader.setPayloadDecodeThreads(2);
+
+        auto reader = sequentialReader.openLogFile(0);
+        REQUIRE(reader->seek(position));
+        REQUIRE(readEvents(*reader) == remaining);
+        reader->close();
+
+        reader = sequentialReader.openLogFile(0);
+        REQUIRE(reader->seek(4));
+        REQUIRE(readEvents(*reader) == expected);
+        reader->close();
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+#ifdef __linux__
+TEST_CASE("sequential reader wakes up on binlog changes before the poll interval", "[binlog]") {
+    using namespace std::chrono_literals;
+
+    auto dir = makeTempDir("binlogreader_wakeup");
+    auto path = dir + "/mysql-bin.000001";
+
+    auto full = makeBinlog(kBinlogTransactions);
+    auto half = makeBinlog(kBinlogTransactions / 2);
+    writeFile(path, half.bytes());
+
+    {
+        std::ofstream index(dir + "/mysql-bin.index");
+        index << "mysql-bin.000001\n";
+    }
+
+    // POLL_INTERVAL이 지나서야 다시 확인했다면 이 안에 끝나지 않는다
+    constexpr auto kWakeupTimeout = BinaryLogSequentialReader::POLL_INTERVAL / 2;
+
+    BinaryLogSequentialReader reader(dir, "mysql-bin.index");
+    skipEvents(reader, (kBinlogTransactions / 2) * 3);
+
+    // 다음 next()는 읽을 이벤트가 없어 waitForChange()에서 기다린다
+    auto pending = std::async(std::launch::async, [&reader]() {
+        return reader.next();
+    });
+    // REQUIRE가 실패해도 pending의 소멸자가 끝없이 기다리지 않도록 한다
+    struct TerminateOnExit {
+        BinaryLogSequentialReader &reader;
+        ~TerminateOnExit() { reader.terminate(); }
+    } terminateOnExit { reader };
+
+    REQUIRE(pending.wait_for(200ms) == std::future_status::timeout);
+
+    SECTION("appending to the live binlog") {
+        appendFile(path, full.bytes().substr(half.bytes().size()));
+
+        REQUIRE(pending.wait_for(kWakeupTimeout) == std::future_status::ready);
+        REQUIRE(pending.get());
+
+        auto query = std::dynamic_pointer_cast<QueryEvent>(reader.currentEvent());
+        REQUIRE(query != nullptr);
+        REQUIRE(query->statement() == "BEGIN");
+        REQUIRE(reader.currentIndex() == 0);
+    }
+
+    SECTION("appending a new binlog to the index file") {
+        writeFile(dir + "/mysql-bin.000002", makeBinlog(2).bytes());
+        appendFile(dir + "/mysql-bin.index", "mysql-bin.000002\n");
+
+        REQUIRE(pending.wait_for(kWakeupTimeout) == std::future_status::ready);
+        REQUIRE(pending.get());
+        REQUIRE(reader.currentIndex() == 1);
+    }
+
+    SECTION("terminate() unblocks the waiting reader") {
+        reader.terminate();
+
+        REQUIRE(pending.wait_for(kWakeupTimeout) == std::future_status::ready);
+        REQUIRE_FALSE(pending.get());
+    }
+
+    std::filesystem::remove_all(dir);
+}
+#endif
+
+TEST_CASE("binlog readers stop before a truncated tail", "[binlog]") {
+    auto dir = makeTempDir("binlogreader_truncated");
+    auto path = dir + "/mysql-bin.000001";
+
+    auto builder = makeBinlog(kBinlogTransactions);
+    const auto &bytes = builder.bytes();
+    const auto expected = [&]() {
+        writeFile(path, bytes);
+        return readFile(path, false);
+    }();
+
+    // 마지막 XID 이벤트의 중간에서 자른다 (서버가 쓰는 도중에 읽은 경우)
+    const auto lastEventPos = static_cast<size_t>(std::get<0>(expected[expected.size() - 2]));
+    writeFile(path, bytes.substr(0, lastEventPos + 10));
+
+    const std::vector<ReadEvent> complete(expected.begin(), expected.end() - 1);
+
+    REQUIRE(readFile(path, true) == complete);
+    REQUIRE(readFile(path, false) == complete);
+
+    SECTION("stream reader resumes once the event is completed") {
+        MySQLBinaryLogReaderV2 reader(path, false);
+        reader.open();
+        REQUIRE(reader.seek(4));
+
+        auto events = readEvents(reader);
+        REQUIRE(events == complete);
+        REQUIRE(reader.pos() == static_cast<int>(lastEventPos));
+
+        appendFile(path, bytes.substr(lastEventPos + 10));
+
+        reopenAt(reader, reader.pos());
+        auto rest = readEvents(reader);
+        REQUIRE(rest.size() == 1);
+        REQUIRE(rest.front() == expected.back());
+        reader.close();
+    }
+
+    SECTION("header cut in the middle is not read as an event") {
+        writeFile(path, bytes.substr(0, lastEventPos + LOG_EVENT_HEADER_LEN - 1));
+
+        REQUIRE(readFile(path, true) == complete);
+        REQUIRE(readFile(path, false) == complete);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("pooled payload decoding returns events in binlog order", "[binlog]") {
+    auto dir = makeTempDir("binlogreader_payload");
+    auto path = dir + "/mysql-bin.000001";
+
+    // 압축된 트랜잭션 사이에 압축되지 않은 트랜잭션을 섞는다
+    BinlogBuilder builder;
+    for (int i = 0; i < kBinlogTransactions; i++) {
+        if (i % 3 == 0) {
+            builder.transaction(statementFor(i), 1000 + i);
+        } else {
+            builder.compressedTransaction(statementFor(i), 1000 + i);
+        }
+    }
+    writeFile(path, builder.bytes());
+
+    const auto expected = readFile(path, false);
+    REQUIRE(expected.size() == kBinlogTransactions * 3);
+    for (int i = 0; i < kBinlogTransactions; i++) {
+        REQUIRE(std::get<2>(expected[i * 3]) == "BEGIN");
+        REQUIRE(std::get<2>(expected[i * 3 + 1]) == statementFor(i));
+        REQUIRE(std::get<2>(expected[i * 3 + 2]) == std::to_string(1000 + i));
+    }
+
+    TaskExecutor payloadDecoder(4);
+
+    REQUIRE(readFile(path, false, &payloadDecoder) == expected);
+    REQUIRE(readFile(path, true, &payloadDecoder) == expected);
+    REQUIRE(readFile(path, true) == expected);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("decoded events outlive the payload and reader they came from", "[binlog]") {
+    using ultraverse::base::DBEvent;
+    using ultraverse::base::EventArena;
+
+    SECTION("events keep their arena alive") {
+        std::weak_ptr<EventArena> weakArena;
+        std::shared_ptr<DBEvent> event;
+
+        {
+            auto arena = std::make_shared<EventArena>();
+            weakArena = arena;
+
+            event = ultraverse::base::makeEvent<QueryEvent>(arena, "test", statementFor(0), kTimestamp);
+            // 같은 트랜잭션의 다른 이벤트가 먼저 해제되어도 arena는 남아 있어야 한다
+            ultraverse::base::makeEvent<TransactionIDEvent>(arena, 1000, kTimestamp);
+        }
+
+        REQUIRE_FALSE(weakArena.expired());
+        REQUIRE(ultraverse::base::eventCast<QueryEvent>(event)->statement() == statementFor(0));
+
+        event = nullptr;
+        REQUIRE(weakArena.expired());
+    }
+
+    SECTION("events decoded from payloads outlive the reader and the executor") {
+        auto dir = makeTempDir("binlogreader_arena");
+        auto path = dir + "/mysql-bin.000001";
+
+        BinlogBuilder builder;
+        for (int i = 0; i < kBinlogTransactions; i++) {
+            builder.compressedTransaction(statementFor(i), 1000 + i);
+        }
+        writeFile(path, builder.bytes());
+
+        for (auto memoryMapped : { false, true }) {
+            for (auto isPooled : { false, true }) {
+                std::vector<std::shared_ptr<DBEvent>> events;
+
+                {
+                    auto payloadDecoder = isPooled ? std::make_unique<TaskExecutor>(4) : nullptr;
+                    MySQLBinaryLogReaderV2 reader(path, memoryMapped, payloadDecoder.get());
+                    reader.open();
+                    REQUIRE(reader.seek(4));
+
+                    while (reader.next()) {
+                        if (reader.currentEvent() != nullptr) {
+                            events.push_back(reader.currentEvent());
+                        }
+                    }
+                    reader.close();
+                }
+
+                REQUIRE(events.size() == kBinlogTransactions * 3);
+                for (int i = 0; i < kBinlogTransactions; i++) {
+                    auto statement = ultraverse::base::eventCast<QueryEvent>(events[i * 3 + 1]);
+                    auto xid = ultraverse::base::eventCast<TransactionIDEvent>(events[i * 3 + 2]);
+
+                    REQUIRE(statement != nullptr);
+                    REQUIRE(statement->statement() == statementFor(i));
+                    REQUIRE(xid != nullptr);
+                    REQUIRE(xid->transactionId() == static_cast<uint64_t>(1000 + i));
+                }
+            }
+        }
+
+        std::filesystem::remove_all(dir);
+    }
+}
+
+TEST_CASE("eventCast() returns nullptr when the event type does not match", "[binlog]") {
+    using ultraverse::base::DBEvent;
+    using ultraverse::base::eventCast;
+
+    std::shared_ptr<DBEvent> query = std::make_shared<QueryEvent>("test", statementFor(0), kTimestamp);
+    std::shared_ptr<DBEvent> xid = std::make_shared<TransactionIDEvent>(1000, kTimestamp);
+
+    REQUIRE(eventCast<QueryEvent>(query).get() == query.get());
+    REQUIRE(eventCast<TransactionIDEvent>(query) == nullptr);
+
+    REQUIRE(eventCast<TransactionIDEvent>(xid).get() == xid.get());
+    REQUIRE(eventCast<QueryEvent>(xid) == nullptr);
+
+    REQUIRE(eventCast<QueryEvent>(nullptr) == nullptr);
+}
+
+TEST_CASE("payload decode errors reach the reader", "[binlog]") {
+    auto dir = makeTempDir("binlogreader_payload_error");
+    auto path = dir + "/mysql-bin.000001";
+
+    BinlogBuilder builder;
+    for (int i = 0; i < 6; i++) {
+        builder.compressedTransaction(statementFor(i), 1000 + i);
+    }
+    builder.transaction(statementFor(6), 1006);
+
+    // 깨진 payload 전까지의 이벤트는 그대로 넘겨주어야 한다
+    writeFile(path, builder.bytes());
+    const auto expected = readFile(path, false);
+
+    SECTION("payload that cannot be decompressed") {
+        builder.payload(std::string(64, '\x5a'), 1024);
+    }
+
+    SECTION("payload with a checksum mismatch") {
+        builder.compressedTransaction(statementFor(7), 1007);
+        builder.corruptLastEvent();
+    }
+
+    for (int i = 8; i < 12; i++) {
+        builder.compressedTransaction(statementFor(i), 1000 + i);
+    }
+    writeFile(path, builder.bytes());
+
+    TaskExecutor payloadDecoder(4);
+
+    for (auto memoryMapped : { false, true }) {
+        for (auto *decoder : { static_cast<TaskExecutor *>(nullptr), &payloadDecoder }) {
+            MySQLBinaryLogReaderV2 reader(path, memoryMapped, decoder);
+            reader.open();
+            REQUIRE(reader.seek(4));
+
+            std::vector<ReadEvent> events;
+            REQUIRE_THROWS_AS(readEvents(reader, events), std::runtime_error);
+            REQUIRE(events == expected);
+
+            reader.close();
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+}
@@ -4,12 +4,15 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <cstdlib>
+#include <ctime>
 #include <vector>
 
 #include "utils/StringUtil.hpp"
 
 using ultraverse::utility::flattenKeyColumnGroups;
 using ultraverse::utility::parseKeyColumnGroups;
+using ultraverse::utility::parseTimestamp;
 
 TEST_CASE("parseKeyColumnGroups parses vector entries with composite keys", "[keyColumns]") {
     std::vector<std::string> input{
@@ -40,3 +43,23 @@ TEST_CASE("parseKeyColumnGroups trims whitespace and skips empty entries", "[key
         "table3.column3"
     });
 }
+
+TEST_CASE("parseTimestamp reads date-time expressions as UTC regardless of the host time zone", "[timestamp]") {
+    const char *previous = std::getenv("TZ");
+    const std::string previousTZ = previous != nullptr ? previous : "";
+
+    setenv("TZ", "Asia/Seoul", 1);
+    tzset();
+
+    CHECK(parseTimestamp("1970-01-02 00:00:00") == 86400);
+    CHECK(parseTimestamp("2023-07-10 12:34:56") == 1688992496);
+    CHECK(parseTimestamp("1688992496") == 1688992496);
+    CHECK_FALSE(parseTimestamp("2023/07/10").has_value());
+
+    if (previous != nullptr) {
+        setenv("TZ", previousTZ.c_str(), 1);
+    } else {
+        unsetenv("TZ");
+    }
+    tzset();
+}
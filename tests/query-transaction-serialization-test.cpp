@@ -234,3 +234,47 @@ TEST_CASE("StateItem protobuf round-trip preserves fields", "[stateitem][protobu
 
     requireStateItemEqual(original, restored);
 }
+
+TEST_CASE("Transaction protobuf symbol table replaces repeated names with ids", "[transaction][protobuf]") {
+    Transaction txn;
+    txn.setGid(7);
+
+    for (int i = 0; i < 4; i++) {
+        auto query = std::make_shared<Query>(buildQuery("db1", "UPDATE users SET name='alice' WHERE id=42", 100 + i, 1));
+        query->setBeforeHash("users", ultraverse::state::StateHash());
+        query->setAfterHash("users", ultraverse::state::StateHash());
+        query->readSet()[0].arg_list.push_back(makeItem("users.id", StateData(static_cast<int64_t>(i)), FUNCTION_EQ));
+        txn << query;
+    }
+
+    ultraverse::state::v2::proto::Transaction plainProto;
+    txn.toProtobuf(&plainProto);
+    REQUIRE(plainProto.symbols_size() == 0);
+
+    ultraverse::state::v2::proto::Transaction symbolProto;
+    txn.toProtobuf(&symbolProto, true);
+
+    // users.id, users.name, @v1, users
+    REQUIRE(symbolProto.symbols_size() == 4);
+    REQUIRE(symbolProto.queries(0).read_set(0).name().empty());
+    REQUIRE(symbolProto.queries(0).read_set(0).name_id() != 0);
+    REQUIRE(symbolProto.queries(0).read_columns_size() == 0);
+    REQUIRE(symbolProto.queries(0).before_hash_size() == 0);
+    REQUIRE(symbolProto.ByteSizeLong() < plainProto.ByteSizeLong());
+
+    std::string payload;
+    REQUIRE(symbolProto.SerializeToString(&payload));
+
+    ultraverse::state::v2::proto::Transaction restoredProto;
+    REQUIRE(restoredProto.ParseFromString(payload));
+
+    Transaction restored;
+    restored.fromProtobuf(restoredProto);
+
+    REQUIRE(restored.queries().size() == txn.queries().size());
+    for (size_t i = 0; i < txn.queries().size(); i++) {
+        requireQueryEqual(*txn.queries()[i], *restored.queries()[i]);
+        REQUIRE(restored.queries()[i]->beforeHash().count("users") == 1);
+        REQUIRE(restored.queries()[i]->afterHash().count("users") == 1);
+    }
+}
@@ -1,7 +1,11 @@
+#include <atomic>
 #include <chrono>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -423,3 +427,465 @@ TEST_CASE("RowGraph entrypoints scale with thousands of nodes") {
     REQUIRE(entryGids.find(1) != entryGids.end());
     REQUIRE(elapsed < std::chrono::milliseconds(2000));
 }
+
+TEST_CASE("RowGraph ready queue dispatches nodes in dependency order") {
+    NoopRelationshipResolver resolver;
+    RowGraph graph({"users.id"}, resolver);
+    graph.setReadyQueueEnabled(true);
+
+    auto txn1 = makeTxn(1, "test", {}, {makeEq("users.id", 1)});
+    auto txn2 = makeTxn(2, "test", {makeEq("users.id", 1)}, {});
+    auto txn3 = makeTxn(3, "test", {}, {makeEq("users.id", 1)});
+    auto txn4 = makeTxn(4, "test", {makeEq("users.id", 2)}, {});
+
+    auto n1 = graph.addNode(txn1);
+    auto n2 = graph.addNode(txn2);
+    auto n3 = graph.addNode(txn3);
+    auto n4 = graph.addNode(txn4);
+
+    REQUIRE(waitUntilAllReady(graph, {n1, n2, n3, n4}, std::chrono::milliseconds(5000)));
+
+    auto ready = drainReadyQueue(graph, 7);
+    REQUIRE(ready.size() == 2);
+    REQUIRE(ready.count(1) == 1);
+    REQUIRE(ready.count(4) == 1);
+    REQUIRE(graph.nodeFor(n1)->processedBy == 7);
+
+    graph.markFinalized(n1);
+    graph.markFinalized(n4);
+
+    ready = drainReadyQueue(graph);
+    REQUIRE(ready.size() == 1);
+    REQUIRE(ready.count(2) == 1);
+
+    graph.markFinalized(n2);
+
+    auto nodeId = graph.waitEntrypoint(0, std::chrono::milliseconds(1000));
+    REQUIRE(nodeId == n3);
+    REQUIRE(graph.waitEntrypoint(0, std::chrono::milliseconds(10)) == nullptr);
+
+    graph.markFinalized(n3);
+    REQUIRE(graph.isFinalized());
+}
+
+TEST_CASE("RowGraph ready queue honors hold and manual edges") {
+    NoopRelationshipResolver resolver;
+    RowGraph graph({"users.id"}, resolver);
+    graph.setReadyQueueEnabled(true);
+
+    auto prepend = makeTxn(10, "test", {}, {makeEq("users.id", 5)});
+    auto target = makeTxn(10, "test", {}, {makeEq("users.id", 6)});
+
+    auto prependId = graph.addNode(prepend);
+    auto targetId = graph.addNode(target, true);
+    REQUIRE(waitUntilAllReady(graph, {prependId, targetId}, std::chrono::milliseconds(5000)));
+
+    graph.addEdge(prependId, targetId);
+    REQUIRE(graph.waitEntrypoint(0, std::chrono::milliseconds(1000)) == prependId);
+    REQUIRE(graph.entrypoint(0) == nullptr);
+
+    graph.releaseNode(targetId);
+    REQUIRE(graph.entrypoint(0) == nullptr);
+
+    graph.markFinalized(prependId);
+    REQUIRE(graph.waitEntrypoint(0, std::chrono::milliseconds(1000)) == targetId);
+}
+
+TEST_CASE("RowGraph ready queue never dispatches a node before its dependencies") {
+    NoopRelationshipResolver resolver;
+    RowGraph graph({"users.id"}, resolver);
+    graph.setReadyQueueEnabled(true);
+
+    const int kNodes = 2000;
+    const int kWorkers = 4;
+
+    std::atomic_int processed = 0;
+    std::atomic_bool running = true;
+    std::atomic_bool violated = false;
+
+    std::mutex executedMutex;
+    std::unordered_set<ultraverse::state::v2::gid_t> executed;
+
+    std::vector<std::thread> workers;
+    for (int workerId = 0; workerId < kWorkers; workerId++) {
+        workers.emplace_back([&, workerId]() {
+            while (running) {
+                auto nodeId = graph.waitEntrypoint(workerId, std::chrono::milliseconds(20));
+                if (nodeId == nullptr) {
+                    continue;
+                }
+
+                auto node = graph.nodeFor(nodeId);
+                const auto gid = node->transaction->gid();
+                {
+                    // 같은 키를 쓰는 바로 앞 트랜잭션이 반드시 먼저 실행되어야 한다.
+                    std::scoped_lock lock(executedMutex);
+                    if (gid > 4 && executed.find(gid - 4) == executed.end()) {
+                        violated = true;
+                    }
+                    executed.insert(gid);
+                }
+
+                graph.markFinalized(nodeId);
+                processed++;
+            }
+        });
+    }
+
+    for (int i = 0; i < kNodes; i++) {
+        const ultraverse::state::v2::gid_t gid = static_cast<ultraverse::state::v2::gid_t>(i + 1);
+        graph.addNode(makeTxn(gid, "test", {}, {makeEq("users.id", i % 4)}));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (processed < kNodes && std::chrono::steady_clock::now() - start < std::chrono::seconds(30)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    running = false;
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    REQUIRE(processed == kNodes);
+    REQUIRE_FALSE(violated);
+    REQUIRE(graph.isFinalized());
+}
+
+TEST_CASE("RowGraph progress counters drive backpressure and completion") {
+    NoopRelationshipResolver resolver;
+    RowGraph graph({"users.id"}, resolver);
+    graph.setReadyQueueEnabled(true);
+
+    auto n1 = graph.addNode(makeTxn(1, "test", {}, {makeEq("users.id", 1)}));
+    auto n2 = graph.addNode(makeTxn(2, "test", {}, {makeEq("users.id", 1)}));
+    REQUIRE(waitUntilAllReady(graph, {n1, n2}, std::chrono::milliseconds(5000)));
+    REQUIRE(graph.pendingNodeCount() == 2);
+
+    std::atomic_bool capacityAvailable = false;
+    std::thread feeder([&]() {
+        graph.waitForCapacity(1);
+        capacityAvailable = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE_FALSE(capacityAvailable);
+
+    REQUIRE(graph.waitEntrypoint(0, std::chrono::milliseconds(1000)) == n1);
+    graph.markFinalized(n1);
+    feeder.join();
+    REQUIRE(capacityAvailable);
+    REQUIRE(graph.pendingNodeCount() == 1);
+
+    RowGraphId finishedId = nullptr;
+    std::thread finisher([&]() {
+        finishedId = graph.waitEntrypoint(1, std::chrono::milliseconds(1000));
+        if (finishedId != nullptr) {
+            graph.markFinalized(finishedId);
+        }
+    });
+    graph.waitUntilAllFinalized();
+    finisher.join();
+    REQUIRE(finishedId == n2);
+    REQUIRE(graph.pendingNodeCount() == 0);
+
+    auto start = std::chrono::steady_clock::now();
+    RowGraphId closedId = n1;
+    std::thread waiter([&]() {
+        closedId = graph.waitEntrypoint(0, std::chrono::seconds(30));
+    });
+    graph.closeReadyQueue();
+    waiter.join();
+    REQUIRE(closedId == nullptr);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+}
+
+TEST_CASE("RowGraph incremental GC reclaims finalized nodes without pausing workers") {
+    NoopRelationshipResolver resolver;
+    RowGraph graph({"users.id", "orders.id"}, resolver);
+    graph.setReadyQueueEnabled(true);
+    graph.setIncrementalGCEnabled(true);
+
+    const int kNodes = 3000;
+    const int kWorkers = 4;
+
+    std::atomic_int processed = 0;
+    std::atomic_bool running = true;
+
+    std::vector<std::thread> workers;
+    for (int workerId = 0; workerId < kWorkers; workerId++) {
+        workers.emplace_back([&, workerId]() {
+            while (running) {
+                auto nodeId = graph.waitEntrypoint(workerId, std::chrono::milliseconds(20));
+                if (nodeId == nullptr) {
+                    continue;
+                }
+
+                auto node = graph.nodeFor(nodeId);
+                graph.markFinalized(nodeId);
+                std::atomic_store(&node->transaction, std::shared_ptr<Transaction>{});
+                processed++;
+            }
+        });
+    }
+
+    size_t maxNodeCount = 0;
+    for (int i = 0; i < kNodes; i++) {
+        const ultraverse::state::v2::gid_t gid = static_cast<ultraverse::state::v2::gid_t>(i + 1);
+        graph.waitForCapacity(500);
+        graph.addNode(makeTxn(gid, "test", {makeEq("orders.id", i % 7)}, {makeEq("users.id", i)}));
+        maxNodeCount = std::max(maxNodeCount, graph.debugNodeCount());
+    }
+
+    graph.waitUntilAllFinalized();
+    running = false;
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    REQUIRE(processed == kNodes);
+
+    // 회수 묶음이 계속 처리되므로 그래프 크기는 전체 노드 수보다 훨씬 작게 유지된다.
+    REQUIRE(maxNodeCount < static_cast<size_t>(kNodes));
+
+    graph.gc();
+
+    auto start = std::chrono::steady_clock::now();
+    while ((graph.debugNodeCount() > 0 || graph.debugTotalNodeMapSize() > 0) &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    REQUIRE(graph.debugNodeCount() == 0);
+    REQUIRE(graph.debugTotalNodeMapSize() == 0);
+}
+
+TEST_CASE("RowGraph disabling compact storage restores the ready queue setting") {
+    NoopRelationshipResolver resolver;
+    RowGraph graph({"users.id"}, resolver);
+    REQUIRE_FALSE(graph.isReadyQueueEnabled());
+
+    graph.setCompactStorageEnabled(true);
+    REQUIRE(graph.isReadyQueueEnabled());
+    graph.setCompactStorageEnabled(false);
+    REQUIRE_FALSE(graph.isCompactStorageEnabled());
+    REQUIRE_FALSE(graph.isReadyQueueEnabled());
+
+    graph.setReadyQueueEnabled(true);
+    graph.setCompactStorageEnabled(true);
+    graph.setCompactStorageEnabled(false);
+    REQUIRE(graph.isReadyQueueEnabled());
+}
+
+TEST_CASE("RowGraph compact storage dispatches nodes in dependency order") {
+    NoopRelationshipResolver resolver;
+    RowGraph graph({"users.id"}, resolver);
+    graph.setCompactStorageEnabled(true);
+    REQUIRE(graph.isReadyQueueEnabled());
+
+    auto n1 = graph.addNode(makeTxn(1, "test", {}, {makeEq("users.id", 1)}));
+    auto n2 = graph.addNode(makeTxn(2, "test", {makeEq("users.id", 1)}, {}));
+    auto n3 = graph.addNode(makeTxn(3, "test", {}, {makeEq("users.id", 1)}));
+    auto n4 = graph.addNode(makeTxn(4, "test", {makeEq("users.id", 2)}, {}));
+    REQUIRE(n1 != nullptr);
+    REQUIRE(graph.nodeFor(n3)->transaction->gid() == 3);
+
+    REQUIRE(waitUntilAllReady(graph, {n1, n2, n3, n4}, std::chrono::milliseconds(5000)));
+    REQUIRE(graph.debugNodeCount() == 4);
+
+    auto ready = drainReadyQueue(graph);
+    REQUIRE(ready.size() == 2);
+    REQUIRE(ready.count(1) == 1);
+    REQUIRE(ready.count(4) == 1);
+
+    graph.markFinalized(n1);
+    graph.markFinalized(n4);
+    REQUIRE(graph.waitEntrypoint(0, std::chrono::milliseconds(1000)) == n2);
+    graph.markFinalized(n2);
+    REQUIRE(graph.waitEntrypoint(0, std::chrono::milliseconds(1000)) == n3);
+    graph.markFinalized(n3);
+    REQUIRE(graph.isFinalized());
+
+    for (auto nodeId : {n1, n2, n3, n4}) {
+        std::atomic_store(&graph.nodeFor(nodeId)->transaction, std::shared_ptr<Transaction>{});
+    }
+    graph.gc();
+
+    REQUIRE(graph.debugNodeCount() == 0);
+    REQUIRE(graph.debugTotalNodeMapSize() == 0);
+    REQUIRE(graph.nodeFor(n1) == nullptr);
+}
+
+TEST_CASE("RowGraph compact storage with incremental GC keeps dependency order") {
+    NoopRelationshipResolver resolver;
+    RowGraph graph({"users.id"}, resolver);
+    graph.setCompactStorageEnabled(true);
+    graph.setIncrementalGCEnabled(true);
+
+    const int kNodes = 5000;
+    const int kWorkers = 4;
+
+    std::atomic_int processed = 0;
+    std::atomic_bool running = true;
+    std::atomic_bool violated = false;
+
+    std::mutex executedMutex;
+    std::unordered_set<ultraverse::state::v2::gid_t> executed;
+
+    std::vector<std::thread> workers;
+    for (int workerId = 0; workerId < kWorkers; workerId++) {
+        workers.emplace_back([&, workerId]() {
+            while (running) {
+                auto nodeId = graph.waitEntrypoint(workerId, std::chrono::milliseconds(20));
+                if (nodeId == nullptr) {
+                    continue;
+                }
+
+                auto node = graph.nodeFor(nodeId);
+                const auto gid = node->transaction->gid();
+                {
+                    std::scoped_lock lock(executedMutex);
+                    if (gid > 4 && executed.find(gid - 4) == executed.end()) {
+                        violated = true;
+                    }
+                    executed.insert(gid);
+                }
+
+                graph.markFinalized(nodeId);
+                std::atomic_store(&node->transaction, std::shared_ptr<Transaction>{});
+                processed++;
+            }
+        });
+    }
+
+    for (int i = 0; i < kNodes; i++) {
+        const ultraverse::state::v2::gid_t gid = static_cast<ultraverse::state::v2::gid_t>(i + 1);
+        graph.waitForCapacity(500);
+        graph.addNode(makeTxn(gid, "test", {}, {makeEq("users.id", i % 4)}));
+    }
+
+    graph.waitUntilAllFinalized();
+    running = false;
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    REQUIRE(processed == kNodes);
+    REQUIRE_FALSE(violated);
+
+    graph.gc();
+
+    auto start = std::chrono::steady_clock::now();
+    while ((graph.debugNodeCount() > 0 || graph.debugTotalNodeMapSize() > 0) &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    REQUIRE(graph.debugNodeCount() == 0);
+    REQUIRE(graph.debugTotalNodeMapSize() == 0);
+}
+
+TEST_CASE("RowGraph sharded worker pool resolves dependencies like dedicated workers") {
+    NoopRelationshipResolver resolver;
+    RowGraph graph({"users.id", "orders.user_id", "orders.item_id"}, resolver,
+                   {{"orders.user_id", "orders.item_id"}}, 4);
+    REQUIRE(graph.workerShardCount() == 4);
+
+    auto n1 = graph.addNode(makeTxn(1, "test", {}, {makeEq("users.id", 1)}));
+    auto n2 = graph.addNode(makeTxn(2, "test", {makeEq("users.id", 1)}, {}));
+    auto n3 = graph.addNode(makeTxn(3, "test", {makeEq("users.id", 2)}, {}));
+    auto n4 = graph.addNode(makeTxn(4, "test", {}, {makeEq("orders.user_id", 1), makeEq("orders.item_id", 10)}));
+    auto n5 = graph.addNode(makeTxn(5, "test", {makeEq("orders.user_id", 1), makeEq("orders.item_id", 10)}, {}));
+    auto n6 = graph.addNode(makeTxn(6, "test", {}, {makeEq("users.name", 1)}));
+
+    REQUIRE(waitUntilAllReady(graph, {n1, n2, n3, n4, n5, n6}, std::chrono::milliseconds(5000)));
+
+    auto entryGids = entrypointGids(graph);
+    REQUIRE(entryGids == std::unordered_set<ultraverse::state::v2::gid_t>{1, 3, 4});
+    REQUIRE(graph.debugNodeMapSize("users.id") == 2);
+
+    for (auto nodeId : {n1, n2, n3}) {
+        auto node = graph.nodeFor(nodeId);
+        node->finalized = true;
+        std::atomic_store(&node->transaction, std::shared_ptr<Transaction>{});
+    }
+
+    entryGids = entrypointGids(graph);
+    REQUIRE(entryGids.find(6) != entryGids.end());
+
+    graph.gc();
+    REQUIRE(graph.debugNodeCount() == 3);
+}
+
+TEST_CASE("RowGraph sharded worker pool keeps per-range and wildcard ordering") {
+    NoopRelationshipResolver resolver;
+    RowGraph graph({"users.id"}, resolver, {}, 4);
+    graph.setReadyQueueEnabled(true);
+
+    const int kNodes = 3000;
+    const int kWorkers = 4;
+
+    std::atomic_int processed = 0;
+    std::atomic_bool running = true;
+    std::atomic_bool violated = false;
+
+    std::mutex executedMutex;
+    std::unordered_set<ultraverse::state::v2::gid_t> executed;
+
+    auto isWildcard = [](ultraverse::state::v2::gid_t gid) { return gid % 100 == 0; };
+
+    std::vector<std::thread> workers;
+    for (int workerId = 0; workerId < kWorkers; workerId++) {
+        workers.emplace_back([&, workerId]() {
+            while (running) {
+                auto nodeId = graph.waitEntrypoint(workerId, std::chrono::milliseconds(20));
+                if (nodeId == nullptr) {
+                    continue;
+                }
+
+                const auto gid = graph.nodeFor(nodeId)->transaction->gid();
+                {
+                    std::scoped_lock lock(executedMutex);
+                    if (isWildcard(gid)) {
+                        // 와일드카드 쓰기는 앞선 모든 트랜잭션 뒤에 실행되어야 한다.
+                        for (ultraverse::state::v2::gid_t prev = 1; prev < gid; prev++) {
+                            if (executed.find(prev) == executed.end()) {
+                                violated = true;
+                            }
+                        }
+                    } else {
+                        const auto lastWildcard = gid - gid % 100;
+                        if (lastWildcard > 0 && executed.find(lastWildcard) == executed.end()) {
+                            violated = true;
+                        }
+                        // 같은 키를 쓰는 바로 앞 트랜잭션 (와일드카드 이후에 있다면)
+                        if (gid > lastWildcard + 4 && executed.find(gid - 4) == executed.end()) {
+                            violated = true;
+                        }
+                    }
+                    executed.insert(gid);
+                }
+
+                graph.markFinalized(nodeId);
+                processed++;
+            }
+        });
+    }
+
+    for (int i = 0; i < kNodes; i++) {
+        const ultraverse::state::v2::gid_t gid = static_cast<ultraverse::state::v2::gid_t>(i + 1);
+        if (isWildcard(gid)) {
+            graph.addNode(makeTxn(gid, "test", {}, {makeEq("users.name", 1)}));
+        } else {
+            graph.addNode(makeTxn(gid, "test", {}, {makeEq("users.id", gid % 4)}));
+        }
+    }
+
+    graph.waitUntilAllFinalized();
+    running = false;
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    REQUIRE(processed == kNodes);
+    REQUIRE_FALSE(violated);
+}
@@ -250,4 +250,15 @@ namespace ultraverse::state::v2::test_helpers {
         }
         return gids;
     }
+
+    inline std::unordered_map<gid_t, RowGraphId> drainReadyQueue(RowGraph &graph, int workerId = 0) {
+        std::unordered_map<gid_t, RowGraphId> nodes;
+        while (auto id = graph.entrypoint(workerId)) {
+            auto node = graph.nodeFor(id);
+            if (node != nullptr && node->transaction != nullptr) {
+                nodes.emplace(node->transaction->gid(), id);
+            }
+        }
+        return nodes;
+    }
 }
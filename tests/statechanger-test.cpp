@@ -23,6 +23,7 @@
 #include "mariadb/state/new/StateChangeContext.hpp"
 #include "mariadb/state/new/StateChangeReplayPlan.hpp"
 #include "mariadb/state/new/StateIO.hpp"
+#include "mariadb/state/new/StateKeyIndex.hpp"
 #include "mariadb/state/new/cluster/StateCluster.hpp"
 #include "mariadb/state/new/cluster/StateRelationshipResolver.hpp"
 #include "utils/StringUtil.hpp"
@@ -36,6 +37,7 @@ namespace {
     using ultraverse::state::v2::StateChangePlan;
     using ultraverse::state::v2::StateChangeReplayPlan;
     using ultraverse::state::v2::StateCluster;
+    using ultraverse::state::v2::StateKeyIndexWriter;
     using ultraverse::state::v2::StateRelationshipResolver;
     using ultraverse::state::v2::CachedRelationshipResolver;
     using ultraverse::state::v2::MockedStateLogReader;
@@ -742,6 +744,90 @@ TEST_CASE("StateChanger prepare refreshes target cache after skipped rollback re
     REQUIRE(gids[0] == 3);
 }
 
+TEST_CASE("StateChanger prepare does not build the cluster from a key index that lags the log", "[statechanger][prepare][keyindex]") {
+    auto sharedState = std::make_shared<MockedDBHandle::SharedState>();
+    seedEmptyInfoSchemaResults(sharedState);
+
+    auto plan = makePlan(1);
+    plan.setUseKeyIndex(true);
+
+    StateItem key1 = StateItem::EQ("items.id", StateData(static_cast<int64_t>(1)));
+    StateItem key2 = StateItem::EQ("items.id", StateData(static_cast<int64_t>(2)));
+
+    std::vector<std::shared_ptr<Transaction>> transactions = {
+        makeTransaction(1, plan.dbName(), "/*TXN:1*/", {}, {key1}),
+        makeTransaction(2, plan.dbName(), "/*TXN:2*/", {key1}, {}),
+        makeTransaction(3, plan.dbName(), "/*TXN:3*/", {key2}, {}),
+        makeTransaction(4, plan.dbName(), "/*TXN:4*/", {key1}, {}),
+        makeTransaction(5, plan.dbName(), "/*TXN:5*/", {}, {key2}),
+        makeTransaction(6, plan.dbName(), "/*TXN:6*/", {key2}, {})
+    };
+    constexpr size_t kFlushedTransactions = 3;
+
+    StateCluster cluster(plan.keyColumns());
+    ultraverse::state::v2::StateChangeContext context;
+    StateRelationshipResolver resolver(plan, context);
+    CachedRelationshipResolver cachedResolver(resolver, 1000);
+
+    auto logReader = std::make_unique<MockedStateLogReader>();
+
+    // 실행 중인 statelogd처럼, 앞 트랜잭션들만 run으로 쓰고 나머지는 writer의 버퍼에 남겨 둔다
+    StateKeyIndexWriter keyIndexWriter(plan.stateLogPath(), plan.stateLogName(), { "items.id" }, true);
+
+    for (size_t i = 0; i < transactions.size(); i++) {
+        auto &transaction = transactions[i];
+
+        cluster.insert(transaction, cachedResolver);
+        logReader->addTransaction(transaction, transaction->gid());
+
+        keyIndexWriter.write(*transaction);
+        if (i + 1 == kFlushedTransactions) {
+            keyIndexWriter.flush();
+        }
+    }
+    cluster.merge();
+
+    auto clusterStore = std::make_unique<MockedStateClusterStore>();
+    clusterStore->save(cluster);
+
+    std::vector<uint64_t> expected;
+
+    SECTION("rollback target in the indexed part") {
+        // 색인되지 않은 #4도 #1이 쓴 키를 읽는다
+        plan.rollbackGids().push_back(1);
+        expected = { 2, 4 };
+    }
+
+    SECTION("rollback target still in the writer buffer") {
+        plan.rollbackGids().push_back(5);
+        expected = { 6 };
+    }
+
+    SECTION("fully indexed log") {
+        keyIndexWriter.flush();
+
+        plan.rollbackGids().push_back(1);
+        expected = { 2, 4 };
+    }
+
+    MockedDBHandlePool pool(1, sharedState);
+
+    StateChangerIO io;
+    io.stateLogReader = std::move(logReader);
+    io.clusterStore = std::move(clusterStore);
+    io.backupLoader = std::make_unique<NoopBackupLoader>();
+    io.closeStandardFds = false;
+
+    StateChanger changer(pool, plan, std::move(io));
+
+    changer.prepare();
+
+    auto gids = loadReplayPlanGids(plan);
+    std::sort(gids.begin(), gids.end());
+
+    REQUIRE(std::vector<uint64_t>(gids.begin(), gids.end()) == expected);
+}
+
 TEST_CASE("StateChanger replay respects dependency order within chains", "[statechanger][replay]") {
     auto sharedState = std::make_shared<MockedDBHandle::SharedState>();
     seedEmptyInfoSchemaResults(sharedState);
@@ -1022,3 +1108,493 @@ TEST_CASE("StateChanger replay-from accepts gid 0", "[statechanger][replay][repl
     const auto lastPreReplay = std::max(positionIndex[0], positionIndex[1]);
     REQUIRE(lastPreReplay < positionIndex[3]);
 }
+
+TEST_CASE("StateChanger replay returns as soon as the last transaction commits", "[statechanger][replay][ready-queue]") {
+    auto sharedState = std::make_shared<MockedDBHandle::SharedState>();
+    seedEmptyInfoSchemaResults(sharedState);
+
+    constexpr int kThreadNum = 2;
+    auto plan = makePlan(kThreadNum);
+    plan.setReadyQueueScheduler(true);
+    plan.setReplayFromGid(1);
+
+    auto planDir = makeTempDir("replay_event_driven");
+    const std::string planName = "plan";
+    plan.setStateLogPath(planDir);
+    plan.setStateLogName(planName);
+
+    auto logReader = std::make_unique<MockedStateLogReader>();
+    std::vector<ultraverse::state::v2::gid_t> replayGids;
+    for (ultraverse::state::v2::gid_t gid = 1; gid <= 40; gid++) {
+        StateItem keyItem = StateItem::EQ("items.id", StateData(static_cast<int64_t>(gid % 3)));
+        auto txn = makeTransaction(gid, plan.dbName(), "/*TXN:" + std::to_string(gid) + "*/", {}, {keyItem});
+        logReader->addTransaction(txn, gid);
+        if (gid > 20) {
+            replayGids.push_back(gid);
+        }
+    }
+
+    std::vector<ultraverse::state::v2::gid_t> rollbackGids{20};
+    writeReplayPlan(planDir, planName, replayGids, {}, rollbackGids);
+
+    MockedDBHandlePool pool(kThreadNum, sharedState);
+
+    StateChangerIO io;
+    io.stateLogReader = std::move(logReader);
+    io.clusterStore = std::make_unique<MockedStateClusterStore>();
+    io.backupLoader = std::make_unique<NoopBackupLoader>();
+    io.closeStandardFds = false;
+
+    StateChanger changer(pool, plan, std::move(io));
+
+    auto start = std::chrono::steady_clock::now();
+    changer.replay();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    std::vector<std::string> executedQueries;
+    {
+        std::scoped_lock lock(sharedState->mutex);
+        executedQueries = sharedState->queries;
+    }
+
+    auto executionOrder = extractExecutedGids(executedQueries);
+    auto positionIndex = buildPositionIndex(executionOrder);
+
+    REQUIRE(executionOrder.size() == 39);
+    REQUIRE(positionIndex.count(20) == 0);
+    for (ultraverse::state::v2::gid_t gid = 4; gid <= 40; gid++) {
+        if (gid == 20 || gid - 3 == 20) {
+            continue;
+        }
+        REQUIRE(positionIndex[gid - 3] < positionIndex[gid]);
+    }
+
+    // GC 주기(10s)나 폴링 간격을 기다리지 않고 종료되어야 한다.
+    REQUIRE(elapsed < std::chrono::seconds(5));
+}
+
+TEST_CASE("StateChanger replay keeps prepended user queries ordered with incremental GC", "[statechanger][replay][incremental-gc]") {
+    auto sharedState = std::make_shared<MockedDBHandle::SharedState>();
+    seedEmptyInfoSchemaResults(sharedState);
+
+    constexpr int kThreadNum = 3;
+    auto plan = makePlan(kThreadNum);
+    plan.setReadyQueueScheduler(true);
+    plan.setIncrementalGC(true);
+
+    auto planDir = makeTempDir("replay_incremental_gc");
+    const std::string planName = "plan";
+    plan.setStateLogPath(planDir);
+    plan.setStateLogName(planName);
+
+    auto logReader = std::make_unique<MockedStateLogReader>();
+    std::vector<ultraverse::state::v2::gid_t> replayGids;
+    for (ultraverse::state::v2::gid_t gid = 1; gid <= 600; gid++) {
+        StateItem keyItem = StateItem::EQ("items.id", StateData(static_cast<int64_t>(gid % 4)));
+        auto txn = makeTransaction(gid, plan.dbName(), "/*TXN:" + std::to_string(gid) + "*/", {}, {keyItem});
+        logReader->addTransaction(txn, gid);
+        replayGids.push_back(gid);
+    }
+
+    std::map<ultraverse::state::v2::gid_t, Transaction> userQueries;
+    {
+        StateItem keyItem = StateItem::EQ("items.id", StateData(static_cast<int64_t>(300 % 4)));
+        auto userTxn = makeTransaction(0, plan.dbName(), "/*TXN:100000*/", {}, {keyItem});
+        userQueries.emplace(300, *userTxn);
+    }
+    writeReplayPlan(planDir, planName, replayGids, userQueries);
+
+    MockedDBHandlePool pool(kThreadNum, sharedState);
+
+    StateChangerIO io;
+    io.stateLogReader = std::move(logReader);
+    io.clusterStore = std::make_unique<MockedStateClusterStore>();
+    io.backupLoader = std::make_unique<NoopBackupLoader>();
+    io.closeStandardFds = false;
+
+    StateChanger changer(pool, plan, std::move(io));
+    changer.replay();
+
+    std::vector<std::string> executedQueries;
+    {
+        std::scoped_lock lock(sharedState->mutex);
+        executedQueries = sharedState->queries;
+    }
+
+    auto executionOrder = extractExecutedGids(executedQueries);
+    auto positionIndex = buildPositionIndex(executionOrder);
+
+    REQUIRE(executionOrder.size() == replayGids.size() + 1);
+    REQUIRE(positionIndex.count(100000) == 1);
+    REQUIRE(positionIndex[296] < positionIndex[100000]);
+    REQUIRE(positionIndex[100000] < positionIndex[300]);
+    for (ultraverse::state::v2::gid_t gid = 5; gid <= 600; gid++) {
+        REQUIRE(positionIndex[gid - 4] < positionIndex[gid]);
+    }
+}
+
+TEST_CASE("StateChanger pipelined replay keeps several transactions in flight per worker", "[statechanger][replay][pipeline]") {
+    auto sharedState = std::make_shared<MockedDBHandle::SharedState>();
+    seedEmptyInfoSchemaResults(sharedState);
+    sharedState->asyncPendingPolls = 2;
+
+    constexpr int kThreadNum = 4;
+    auto plan = makePlan(kThreadNum);
+    plan.setReadyQueueScheduler(true);
+    // 풀 크기 4 / depth 4 -> 워커 하나가 커넥션 4개를 동시에 쓴다.
+    plan.setReplayPipelineDepth(4);
+
+    auto logReader = std::make_unique<MockedStateLogReader>();
+    logReader->open();
+
+    constexpr int kChains = 4;
+    std::vector<std::vector<ultraverse::state::v2::gid_t>> chains(kChains);
+    std::vector<ultraverse::state::v2::gid_t> gidsToReplay;
+
+    for (ultraverse::state::v2::gid_t gid = 1; gid <= 80; gid++) {
+        const int chainIndex = static_cast<int>(gid % kChains);
+        StateItem keyItem = StateItem::EQ("items.id", StateData(static_cast<int64_t>(chainIndex)));
+        auto txn = makeTransaction(gid, plan.dbName(), "/*TXN:" + std::to_string(gid) + "*/", {}, {keyItem});
+        logReader->addTransaction(txn, gid);
+        gidsToReplay.push_back(gid);
+        chains[chainIndex].push_back(gid);
+    }
+
+    auto planDir = makeTempDir("replay_pipelined");
+    const std::string planName = "plan";
+    plan.setStateLogPath(planDir);
+    plan.setStateLogName(planName);
+    writeReplayPlan(planDir, planName, gidsToReplay);
+
+    MockedDBHandlePool pool(kThreadNum, sharedState);
+
+    StateChangerIO io;
+    io.stateLogReader = std::move(logReader);
+    io.clusterStore = std::make_unique<MockedStateClusterStore>();
+    io.backupLoader = std::make_unique<NoopBackupLoader>();
+    io.closeStandardFds = false;
+
+    StateChanger changer(pool, plan, std::move(io));
+    changer.replay();
+
+    std::vector<std::string> executedQueries;
+    {
+        std::scoped_lock lock(sharedState->mutex);
+        executedQueries = sharedState->queries;
+    }
+
+    auto executionOrder = extractExecutedGids(executedQueries);
+    REQUIRE(executionOrder.size() == gidsToReplay.size());
+
+    auto positionIndex = buildPositionIndex(executionOrder);
+    for (const auto &chain : chains) {
+        for (size_t i = 1; i < chain.size(); i++) {
+            REQUIRE(positionIndex[chain[i - 1]] < positionIndex[chain[i]]);
+        }
+    }
+
+    int openTransactions = 0;
+    int maxOpenTransactions = 0;
+    int commits = 0;
+    for (const auto &query : executedQueries) {
+        if (query == "START TRANSACTION") {
+            maxOpenTransactions = std::max(maxOpenTransactions, ++openTransactions);
+        } else if (query == "COMMIT") {
+            openTransactions--;
+            commits++;
+        }
+    }
+
+    REQUIRE(commits >= static_cast<int>(gidsToReplay.size()));
+    REQUIRE(maxOpenTransactions > 1);
+}
+
+TEST_CASE("StateChanger pipelined replay drains the in-flight query before rolling back", "[statechanger][replay][pipeline]") {
+    auto sharedState = std::make_shared<MockedDBHandle::SharedState>();
+    seedEmptyInfoSchemaResults(sharedState);
+    sharedState->asyncPendingPolls = 2;
+    sharedState->throwingQueries.insert("/*TXN:5*/");
+
+    constexpr int kThreadNum = 4;
+    auto plan = makePlan(kThreadNum);
+    plan.setReadyQueueScheduler(true);
+    plan.setReplayPipelineDepth(4);
+
+    auto logReader = std::make_unique<MockedStateLogReader>();
+    logReader->open();
+
+    std::vector<ultraverse::state::v2::gid_t> gidsToReplay;
+    for (ultraverse::state::v2::gid_t gid = 1; gid <= 8; gid++) {
+        StateItem keyItem = StateItem::EQ("items.id", StateData(static_cast<int64_t>(gid % 4)));
+        auto txn = makeTransaction(gid, plan.dbName(), "/*TXN:" + std::to_string(gid) + "*/", {}, {keyItem});
+        logReader->addTransaction(txn, gid);
+        gidsToReplay.push_back(gid);
+    }
+
+    auto planDir = makeTempDir("replay_pipelined_cancel");
+    const std::string planName = "plan";
+    plan.setStateLogPath(planDir);
+    plan.setStateLogName(planName);
+    writeReplayPlan(planDir, planName, gidsToReplay);
+
+    MockedDBHandlePool pool(kThreadNum, sharedState);
+
+    StateChangerIO io;
+    io.stateLogReader = std::move(logReader);
+    io.clusterStore = std::make_unique<MockedStateClusterStore>();
+    io.backupLoader = std::make_unique<NoopBackupLoader>();
+    io.closeStandardFds = false;
+
+    StateChanger changer(pool, plan, std::move(io));
+    changer.replay();
+
+    std::vector<std::string> executedQueries;
+    int cancels = 0;
+    int outOfSyncQueries = 0;
+    {
+        std::scoped_lock lock(sharedState->mutex);
+        executedQueries = sharedState->queries;
+        cancels = sharedState->cancels;
+        outOfSyncQueries = sharedState->outOfSyncQueries;
+    }
+
+    REQUIRE(cancels == 1);
+    REQUIRE(outOfSyncQueries == 0);
+    REQUIRE(std::count(executedQueries.begin(), executedQueries.end(), std::string("ROLLBACK")) == 1);
+    REQUIRE(extractExecutedGids(executedQueries).size() == gidsToReplay.size());
+}
+
+TEST_CASE("StateChanger batched replay sends each transaction in one round trip", "[statechanger][replay][batch]") {
+    auto sharedState = std::make_shared<MockedDBHandle::SharedState>();
+    seedEmptyInfoSchemaResults(sharedState);
+    // 실패한 구문 뒤의 COMMIT은 두 번째 batch로 이어서 실행되어야 한다.
+    sharedState->failingQueries.insert("/*TXN:7*/");
+
+    constexpr int kThreadNum = 4;
+    auto plan = makePlan(kThreadNum);
+    plan.setReplayStatementBatching(true);
+
+    auto logReader = std::make_unique<MockedStateLogReader>();
+    logReader->open();
+
+    constexpr int kChains = 4;
+    std::vector<std::vector<ultraverse::state::v2::gid_t>> chains(kChains);
+    std::vector<ultraverse::state::v2::gid_t> gidsToReplay;
+
+    for (ultraverse::state::v2::gid_t gid = 1; gid <= 40; gid++) {
+        const int chainIndex = static_cast<int>(gid % kChains);
+        StateItem keyItem = StateItem::EQ("items.id", StateData(static_cast<int64_t>(chainIndex)));
+        auto txn = makeTransaction(gid, plan.dbName(), "/*TXN:" + std::to_string(gid) + "*/", {}, {keyItem});
+        logReader->addTransaction(txn, gid);
+        gidsToReplay.push_back(gid);
+        chains[chainIndex].push_back(gid);
+    }
+
+    auto planDir = makeTempDir("replay_batched");
+    const std::string planName = "plan";
+    plan.setStateLogPath(planDir);
+    plan.setStateLogName(planName);
+    writeReplayPlan(planDir, planName, gidsToReplay);
+
+    MockedDBHandlePool pool(kThreadNum, sharedState);
+
+    StateChangerIO io;
+    io.stateLogReader = std::move(logReader);
+    io.clusterStore = std::make_unique<MockedStateClusterStore>();
+    io.backupLoader = std::make_unique<NoopBackupLoader>();
+    io.closeStandardFds = false;
+
+    StateChanger changer(pool, plan, std::move(io));
+    changer.replay();
+
+    std::vector<std::string> executedQueries;
+    int batches = 0;
+    {
+        std::scoped_lock lock(sharedState->mutex);
+        executedQueries = sharedState->queries;
+        batches = sharedState->batches;
+    }
+
+    REQUIRE(batches == static_cast<int>(gidsToReplay.size()) + 1);
+
+    auto executionOrder = extractExecutedGids(executedQueries);
+    REQUIRE(executionOrder.size() == gidsToReplay.size());
+
+    auto positionIndex = buildPositionIndex(executionOrder);
+    for (const auto &chain : chains) {
+        for (size_t i = 1; i < chain.size(); i++) {
+            REQUIRE(positionIndex[chain[i - 1]] < positionIndex[chain[i]]);
+        }
+    }
+
+    const auto commits = std::count(executedQueries.begin(), executedQueries.end(), std::string("COMMIT"));
+    REQUIRE(commits >= static_cast<long>(gidsToReplay.size()));
+}
+
+TEST_CASE("StateChanger parallel full replay respects dependency order within chains", "[statechanger][full-replay][parallel]") {
+    auto sharedState = std::make_shared<MockedDBHandle::SharedState>();
+    seedEmptyInfoSchemaResults(sharedState);
+
+    constexpr int kThreadNum = 4;
+    auto plan = makePlan(kThreadNum);
+    plan.setParallelFullReplay(true);
+    plan.rollbackGids().push_back(10);
+
+    auto logReader = std::make_unique<MockedStateLogReader>();
+    logReader->open();
+
+    constexpr int kChains = 4;
+    std::vector<std::vector<ultraverse::state::v2::gid_t>> chains(kChains);
+
+    for (ultraverse::state::v2::gid_t gid = 1; gid <= 40; gid++) {
+        const int chainIndex = static_cast<int>(gid % kChains);
+        StateItem keyItem = StateItem::EQ("items.id", StateData(static_cast<int64_t>(chainIndex)));
+        auto txn = makeTransaction(gid, plan.dbName(), "/*TXN:" + std::to_string(gid) + "*/", {}, {keyItem});
+        logReader->addTransaction(txn, gid);
+        if (gid != 10) {
+            chains[chainIndex].push_back(gid);
+        }
+    }
+
+    MockedDBHandlePool pool(kThreadNum, sharedState);
+
+    StateChangerIO io;
+    io.stateLogReader = std::move(logReader);
+    io.clusterStore = std::make_unique<MockedStateClusterStore>();
+    io.backupLoader = std::make_unique<NoopBackupLoader>();
+    io.closeStandardFds = false;
+
+    StateChanger changer(pool, plan, std::move(io));
+    changer.fullReplay();
+
+    std::vector<std::string> executedQueries;
+    {
+        std::scoped_lock lock(sharedState->mutex);
+        executedQueries = sharedState->queries;
+    }
+
+    auto executionOrder = extractExecutedGids(executedQueries);
+    REQUIRE(executionOrder.size() == 39);
+    REQUIRE(std::find(executionOrder.begin(), executionOrder.end(), 10) == executionOrder.end());
+
+    auto positionIndex = buildPositionIndex(executionOrder);
+    for (const auto &chain : chains) {
+        for (size_t i = 1; i < chain.size(); i++) {
+            REQUIRE(positionIndex[chain[i - 1]] < positionIndex[chain[i]]);
+        }
+    }
+}
+
+TEST_CASE("StateChanger parallel full replay without key columns falls back to sequential order", "[statechanger][full-replay][parallel]") {
+    auto sharedState = std::make_shared<MockedDBHandle::SharedState>();
+    seedEmptyInfoSchemaResults(sharedState);
+
+    constexpr int kThreadNum = 4;
+    auto plan = makePlan(kThreadNum);
+    plan.keyColumns().clear();
+    plan.setParallelFullReplay(true);
+    plan.rollbackGids().push_back(10);
+
+    auto logReader = std::make_unique<MockedStateLogReader>();
+    logReader->open();
+
+    for (ultraverse::state::v2::gid_t gid = 1; gid <= 40; gid++) {
+        StateItem keyItem = StateItem::EQ("items.id", StateData(static_cast<int64_t>(gid % 4)));
+        auto txn = makeTransaction(gid, plan.dbName(), "/*TXN:" + std::to_string(gid) + "*/", {}, {keyItem});
+        logReader->addTransaction(txn, gid);
+    }
+
+    MockedDBHandlePool pool(kThreadNum, sharedState);
+
+    StateChangerIO io;
+    io.stateLogReader = std::move(logReader);
+    io.clusterStore = std::make_unique<MockedStateClusterStore>();
+    io.backupLoader = std::make_unique<NoopBackupLoader>();
+    io.closeStandardFds = false;
+
+    StateChanger changer(pool, plan, std::move(io));
+    changer.fullReplay();
+
+    std::vector<std::string> executedQueries;
+    {
+        std::scoped_lock lock(sharedState->mutex);
+        executedQueries = sharedState->queries;
+    }
+
+    auto executionOrder = extractExecutedGids(executedQueries);
+    REQUIRE(executionOrder.size() == 39);
+    REQUIRE(std::is_sorted(executionOrder.begin(), executionOrder.end()));
+    REQUIRE(std::find(executionOrder.begin(), executionOrder.end(), 10) == executionOrder.end());
+}
+
+TEST_CASE("StateChanger replay scan feeder skips non-target and missing transactions", "[statechanger][replay][scan]") {
+    auto sharedState = std::make_shared<MockedDBHandle::SharedState>();
+    seedEmptyInfoSchemaResults(sharedState);
+
+    constexpr int kThreadNum = 4;
+    auto plan = makePlan(kThreadNum);
+    plan.setReplayFeederMode(ultraverse::state::v2::ReplayFeederMode::SCAN);
+
+    auto logReader = std::make_unique<MockedStateLogReader>();
+    logReader->open();
+
+    // gid 30은 로그에 없다.
+    for (ultraverse::state::v2::gid_t gid = 1; gid <= 60; gid++) {
+        if (gid == 30) {
+            continue;
+        }
+        StateItem keyItem = StateItem::EQ("items.id", StateData(static_cast<int64_t>(gid % 2)));
+        auto txn = makeTransaction(gid, plan.dbName(), "/*TXN:" + std::to_string(gid) + "*/", {}, {keyItem});
+        logReader->addTransaction(txn, gid);
+    }
+
+    std::vector<ultraverse::state::v2::gid_t> gidsToReplay;
+    std::vector<ultraverse::state::v2::gid_t> expectedGids;
+    for (ultraverse::state::v2::gid_t gid = 3; gid <= 60; gid += 3) {
+        gidsToReplay.push_back(gid);
+        if (gid != 30) {
+            expectedGids.push_back(gid);
+        }
+    }
+    gidsToReplay.push_back(100);
+
+    auto planDir = makeTempDir("replay_scan");
+    const std::string planName = "plan";
+    plan.setStateLogPath(planDir);
+    plan.setStateLogName(planName);
+    writeReplayPlan(planDir, planName, gidsToReplay);
+
+    MockedDBHandlePool pool(kThreadNum, sharedState);
+
+    StateChangerIO io;
+    io.stateLogReader = std::move(logReader);
+    io.clusterStore = std::make_unique<MockedStateClusterStore>();
+    io.backupLoader = std::make_unique<NoopBackupLoader>();
+    io.closeStandardFds = false;
+
+    StateChanger changer(pool, plan, std::move(io));
+    changer.replay();
+
+    std::vector<std::string> executedQueries;
+    {
+        std::scoped_lock lock(sharedState->mutex);
+        executedQueries = sharedState->queries;
+    }
+
+    auto executionOrder = extractExecutedGids(executedQueries);
+    REQUIRE(executionOrder.size() == expectedGids.size());
+
+    auto executedSet = executionOrder;
+    std::sort(executedSet.begin(), executedSet.end());
+    REQUIRE(executedSet == expectedGids);
+
+    auto positionIndex = buildPositionIndex(executionOrder);
+    for (size_t i = 0; i < expectedGids.size(); i++) {
+        for (size_t j = i + 1; j < expectedGids.size(); j++) {
+            // 같은 키 (gid % 2)를 쓰는 트랜잭션끼리는 순서가 유지되어야 한다.
+            if (expectedGids[i] % 2 == expectedGids[j] % 2) {
+                REQUIRE(positionIndex[expectedGids[i]] < positionIndex[expectedGids[j]]);
+            }
+        }
+    }
+}
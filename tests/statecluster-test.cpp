@@ -1,4 +1,8 @@
 #include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -7,6 +11,8 @@
 
 #include "../src/mariadb/state/new/StateChangeContext.hpp"
 #include "../src/mariadb/state/new/StateChangePlan.hpp"
+#include "../src/mariadb/state/new/StateKeyIndex.hpp"
+#include "../src/mariadb/state/new/StateZoneMap.hpp"
 #include "../src/mariadb/state/new/cluster/StateRelationshipResolver.hpp"
 #include "../src/mariadb/state/new/cluster/StateCluster.hpp"
 #include "state_test_helpers.hpp"
@@ -25,6 +31,32 @@ namespace {
         }
         return output.str();
     }
+
+    std::string makeTempDir(const std::string &prefix) {
+        static std::atomic<uint64_t> counter{0};
+        auto suffix = std::to_string(counter.fetch_add(1));
+        auto dir = std::filesystem::temp_directory_path() / (prefix + "_" + suffix);
+        std::filesystem::create_directories(dir);
+        return dir.string();
+    }
+
+    /**
+     * @return "컬럼/R|W" -> WHERE 절 -> gid 목록
+     */
+    std::map<std::string, std::map<std::string, std::set<uint64_t>>> dumpCluster(const StateCluster &cluster) {
+        std::map<std::string, std::map<std::string, std::set<uint64_t>>> dump;
+
+        for (const auto &pair : cluster.clusters()) {
+            for (const auto &entry : pair.second.read) {
+                dump[pair.first + "/R"][entry.first.MakeWhereQuery(pair.first)].insert(entry.second.begin(), entry.second.end());
+            }
+            for (const auto &entry : pair.second.write) {
+                dump[pair.first + "/W"][entry.first.MakeWhereQuery(pair.first)].insert(entry.second.begin(), entry.second.end());
+            }
+        }
+
+        return dump;
+    }
 }
 
 TEST_CASE("StateCluster inserts and matches with alias/row-alias") {
@@ -391,3 +423,272 @@ TEST_CASE("StateCluster generateReplaceQuery uses write ranges without reads") {
     REQUIRE(query.find("DELETE FROM users WHERE") != std::string::npos);
     REQUIRE(query.find("REPLACE INTO users SELECT * FROM intermediate.users WHERE") != std::string::npos);
 }
+
+TEST_CASE("StateKeyIndex postings rebuild the cluster built from transactions") {
+    MockedRelationshipResolver resolver;
+    resolver.addForeignKey("posts.author_id", "users.id");
+
+    std::vector<std::shared_ptr<Transaction>> transactions {
+        makeTxn(1, "test", {}, {makeEq("users.id", 42), makeEq("orders.user_id", 42), makeEq("orders.item_id", 1)}),
+        makeTxn(2, "test", {makeEq("posts.author_id", 42)}, {makeEq("posts.id", 100)}),
+        makeTxn(3, "other", {}, {makeEq("users.id", 42)}),
+        makeTxn(4, "test", {makeBetween("users.id", 40, 50), makeEq("users.id", 3)}, {}),
+        makeTxn(5, "test", {makeEq("orders.user_id", 7)}, {})
+    };
+
+    auto dir = makeTempDir("ultraverse_keyindex");
+    const std::set<std::string> indexedColumns {"users.id", "posts.author_id", "orders.user_id", "orders.item_id"};
+
+    // 두 개의 run으로 나뉘어 쓰이도록 중간에 writer를 닫고 이어 쓴다
+    {
+        StateKeyIndexWriter writer(dir, "log", indexedColumns, true);
+        writer.write(*transactions[0]);
+        writer.write(*transactions[1]);
+    }
+    {
+        StateKeyIndexWriter writer(dir, "log", indexedColumns, false);
+        for (size_t i = 2; i < transactions.size(); i++) {
+            writer.write(*transactions[i]);
+        }
+    }
+
+    StateKeyIndexReader keyIndex(dir, "log");
+    REQUIRE(keyIndex.indexedColumns() == indexedColumns);
+    REQUIRE(keyIndex.observedColumns().count("posts.id") == 1);
+
+    REQUIRE(keyIndex.find(StateCluster::WRITE, "users.id", StateRange{42}) == std::vector<uint64_t>{1, 3});
+    REQUIRE(keyIndex.find(StateCluster::READ, "users.id", StateRange{45}) == std::vector<uint64_t>{4});
+    REQUIRE(keyIndex.find(StateCluster::READ, "users.id", StateRange{3}) == std::vector<uint64_t>{4});
+    REQUIRE(keyIndex.find(StateCluster::READ, "posts.author_id", StateRange{42}) == std::vector<uint64_t>{2});
+    REQUIRE(keyIndex.find(StateCluster::READ, "users.id", StateRange{1000}).empty());
+    REQUIRE(keyIndex.hasDatabase(1, "test"));
+    REQUIRE_FALSE(keyIndex.hasDatabase(3, "test"));
+    REQUIRE(keyIndex.hasDatabase(3, "other"));
+    REQUIRE_FALSE(keyIndex.hasDatabase(1000, "test"));
+
+    const std::vector<std::vector<std::string>> keyColumnGroups {{"users.id"}, {"orders.user_id", "orders.item_id"}};
+
+    StateCluster expected({"users.id", "orders.user_id", "orders.item_id"}, keyColumnGroups);
+    expected.normalizeWithResolver(resolver);
+    for (const auto &transaction : transactions) {
+        if (transaction->isRelatedToDatabase("test")) {
+            expected.insert(transaction, resolver);
+        }
+    }
+    expected.merge();
+
+    StateCluster actual({"users.id", "orders.user_id", "orders.item_id"}, keyColumnGroups);
+    actual.normalizeWithResolver(resolver);
+    for (const auto &transaction : transactions) {
+        const auto gid = transaction->gid();
+        if (!keyIndex.hasDatabase(gid, "test")) {
+            continue;
+        }
+
+        std::map<std::string, StateRange> readRanges;
+        std::map<std::string, StateRange> writeRanges;
+
+        keyIndex.forEachPostingOf(gid, [&](StateCluster::ClusterType type, const std::string &column,
+                                           const StateRange &range, const std::vector<uint64_t> &gids) {
+            REQUIRE(gids == std::vector<uint64_t>{gid});
+
+            auto keyColumn = resolver.resolveChain(column);
+            if (keyColumn.empty()) {
+                keyColumn = column;
+            }
+            if (actual.keyColumns().count(keyColumn) == 0) {
+                return;
+            }
+
+            mergeKeyIndexRange(type == StateCluster::READ ? readRanges : writeRanges, keyColumn, range);
+        });
+
+        if (!readRanges.empty()) {
+            actual.insert(StateCluster::READ, readRanges, gid);
+        }
+        if (!writeRanges.empty()) {
+            actual.insert(StateCluster::WRITE, writeRanges, gid);
+        }
+    }
+    actual.merge();
+
+    REQUIRE(dumpCluster(actual) == dumpCluster(expected));
+    REQUIRE(dumpCluster(actual).at("orders.item_id/R").size() == 1);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("StateKeyIndexReader reads only the runs that may match") {
+    auto dir = makeTempDir("ultraverse_keyindex_lazy");
+    const std::set<std::string> indexedColumns {"users.id"};
+
+    // run 하나에 트랜잭션 하나씩, users.id = gid * 10
+    for (uint64_t gid = 1; gid <= 8; gid++) {
+        StateKeyIndexWriter writer(dir, "log", indexedColumns, gid == 1);
+        auto transaction = makeTxn(gid, "test", {}, {makeEq("users.id", static_cast<int64_t>(gid * 10))});
+        writer.write(*transaction);
+    }
+
+    StateKeyIndexReader keyIndex(dir, "log");
+    REQUIRE(keyIndex.runCount() == 8);
+    REQUIRE(keyIndex.loadedRunCount() == 0);
+
+    REQUIRE(keyIndex.find(StateCluster::WRITE, "users.id", StateRange{30}) == std::vector<uint64_t>{3});
+    REQUIRE(keyIndex.loadedRunCount() == 1);
+
+    // 어느 run의 요약과도 겹치지 않으면 run을 읽지 않는다
+    REQUIRE(keyIndex.find(StateCluster::WRITE, "users.id", StateRange{35}).empty());
+    REQUIRE(keyIndex.find(StateCluster::READ, "users.id", StateRange{30}).empty());
+    REQUIRE(keyIndex.loadedRunCount() == 1);
+
+    size_t postings = 0;
+    keyIndex.forEachPostingOf(6, [&](StateCluster::ClusterType type, const std::string &column,
+                                     const StateRange &range, const std::vector<uint64_t> &) {
+        REQUIRE(type == StateCluster::WRITE);
+        REQUIRE(column == "users.id");
+        REQUIRE(range == StateRange{60});
+        postings++;
+    });
+    REQUIRE(postings == 1);
+    REQUIRE(keyIndex.loadedRunCount() == 2);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("StateColumnSummary summarizes key values with min / max and bloom filter") {
+    StateColumnSummary column;
+    REQUIRE_FALSE(column.mayIntersect(StateRange{1}));
+
+    column.add(StateRange{1});
+    column.add(StateRange{100});
+
+    REQUIRE(column.mayIntersect(StateRange{1}));
+    REQUIRE(column.mayIntersect(StateRange{100}));
+    REQUIRE_FALSE(column.mayIntersect(StateRange{1000}));
+    // min / max 안쪽이지만 bloom filter에 없는 값
+    REQUIRE_FALSE(column.mayIntersect(StateRange{50}));
+    REQUIRE_FALSE(column.mayIntersect(StateRange{"abc"}));
+
+    StateRange between;
+    between.SetBetween(StateData{int64_t{40}}, StateData{int64_t{60}});
+    REQUIRE(column.mayIntersect(between));
+
+    SECTION("range values disable the bloom filter") {
+        StateRange values;
+        values.SetBetween(StateData{int64_t{10}}, StateData{int64_t{20}});
+        column.add(values);
+
+        REQUIRE(column.mayIntersect(StateRange{50}));
+        REQUIRE_FALSE(column.mayIntersect(StateRange{1000}));
+    }
+
+    SECTION("open ranges make the column unbounded") {
+        StateRange open;
+        open.SetBegin(StateData{int64_t{500}}, true);
+        column.add(open);
+
+        REQUIRE(column.mayIntersect(StateRange{1000}));
+    }
+}
+
+TEST_CASE("StateZoneMap never hides transactions that shouldReplay") {
+    MockedRelationshipResolver resolver;
+    resolver.addForeignKey("posts.author_id", "users.id");
+
+    std::vector<std::shared_ptr<Transaction>> transactions {
+        makeTxn(1, "test", {}, {makeEq("users.id", 1)}),
+        makeTxn(2, "test", {makeBetween("users.id", 1, 5)}, {}),
+        makeTxn(3, "test", {makeEq("users.id", 5)}, {}),
+        makeTxn(4, "test", {makeEq("users.id", 100)}, {}),
+        makeTxn(5, "test", {makeEq("posts.author_id", 300)}, {makeEq("users.id", 200)}),
+        makeTxn(6, "test", {makeEq("users.id", 1000)}, {makeEq("posts.id", 1)})
+    };
+
+    auto dir = makeTempDir("ultraverse_zonemap");
+    {
+        StateZoneMapWriter writer(dir, "log", {"users.id", "posts.author_id"}, 2, true);
+        for (const auto &transaction : transactions) {
+            writer.write(*transaction, transaction->gid() * 100, (transaction->gid() + 1) * 100);
+        }
+    }
+
+    StateZoneMapReader zoneMap(dir, "log");
+    const auto &zones = zoneMap.zones();
+    REQUIRE(zones.size() == 3);
+    REQUIRE(zones[1].firstGid == 3);
+    REQUIRE(zones[1].lastGid == 4);
+    REQUIRE(zones[1].beginPos == 300);
+    REQUIRE(zones[1].endPos == 500);
+    REQUIRE(zones[2].databases.at("test") == std::make_pair<uint64_t, uint64_t>(2, 2));
+    REQUIRE(zones[2].itemColumns == std::set<std::string>{"posts.author_id", "posts.id", "users.id"});
+
+    StateCluster cluster({"users.id"});
+    cluster.normalizeWithResolver(resolver);
+    for (const auto &transaction : transactions) {
+        cluster.insert(transaction, resolver);
+    }
+    cluster.merge();
+
+    cluster.addRollbackTarget(transactions[0], resolver, true);
+
+    auto targetRanges = cluster.targetClusterRanges();
+    REQUIRE(targetRanges.count("users.id") == 1);
+
+    auto canSkip = [&](const StateZone &zone) {
+        for (const auto &[name, column] : zone.keyColumns) {
+            auto keyColumn = resolver.resolveChain(name);
+            if (keyColumn.empty()) {
+                keyColumn = name;
+            }
+
+            for (const auto &range : targetRanges[keyColumn]) {
+                if (column.mayIntersect(range)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    // gid 3은 병합된 클러스터 범위 [1, 5]를 통해 rollback 대상과 이어진다
+    REQUIRE(cluster.shouldReplay(3));
+    REQUIRE_FALSE(canSkip(zones[1]));
+
+    REQUIRE(canSkip(zones[2]));
+    for (const auto &zone : zones) {
+        if (!canSkip(zone)) {
+            continue;
+        }
+        for (auto gid = zone.firstGid; gid <= zone.lastGid; gid++) {
+            REQUIRE_FALSE(cluster.shouldReplay(gid));
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("StateZoneMap counts every query of a transaction per database") {
+    // analyzeReplayPlan()은 건너뛴 zone의 쿼리 수를 database별 카운트로 더하므로,
+    // 다른 database의 쿼리도 포함해야 디코딩한 경우와 같은 totalQueryCount가 나온다
+    auto mixed = makeTxn(1, "test", {}, {makeEq("users.id", 1)});
+    for (int i = 0; i < 2; i++) {
+        auto query = makeQuery("other", {}, {});
+        *mixed << query;
+    }
+    auto single = makeTxn(2, "other", {}, {});
+
+    auto dir = makeTempDir("ultraverse_zonemap_counts");
+    {
+        StateZoneMapWriter writer(dir, "log", {"users.id"}, 2, true);
+        writer.write(*mixed, 100, 200);
+        writer.write(*single, 200, 300);
+    }
+
+    StateZoneMapReader zoneMap(dir, "log");
+    const auto &zones = zoneMap.zones();
+    REQUIRE(zones.size() == 1);
+    REQUIRE(zones[0].databases.at("test") == std::make_pair<uint64_t, uint64_t>(1, 3));
+    REQUIRE(zones[0].databases.at("other") == std::make_pair<uint64_t, uint64_t>(2, 4));
+
+    std::filesystem::remove_all(dir);
+}
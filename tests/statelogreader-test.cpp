@@ -0,0 +1,839 @@
+#include <atomic>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "mariadb/state/new/BlockCompressedStateLog.hpp"
+#include "mariadb/state/new/GIDIndexReader.hpp"
+#include "mariadb/state/new/GIDIndexWriter.hpp"
+#include "mariadb/state/new/MmapStateLogReader.hpp"
+#include "mariadb/state/new/PrefetchingStateLogReader.hpp"
+#include "mariadb/state/new/SegmentedStateLogReader.hpp"
+#include "mariadb/state/new/StateLogCheckpoint.hpp"
+#include "mariadb/state/new/StateLogIngestPart.hpp"
+#include "mariadb/state/new/StateLogManifest.hpp"
+#include "mariadb/state/new/StateLogReader.hpp"
+#include "mariadb/state/new/StateLogWriter.hpp"
+#include "mariadb/state/new/TimestampIndex.hpp"
+
+namespace {
+    using ultraverse::state::v2::GIDIndexReader;
+    using ultraverse::state::v2::GIDIndexWriter;
+    using ultraverse::state::v2::IStateLogReader;
+    using ultraverse::state::v2::MmapStateLogReader;
+    using ultraverse::state::v2::PrefetchingStateLogReader;
+    using ultraverse::state::v2::Query;
+    using ultraverse::state::v2::SegmentedStateLogReader;
+    using ultraverse::state::v2::StateLogCheckpoint;
+    using ultraverse::state::v2::StateLogIngestPart;
+    using ultraverse::state::v2::StateLogManifest;
+    using ultraverse::state::v2::StateLogSegment;
+    using ultraverse::state::v2::StateLogReader;
+    using ultraverse::state::v2::StateLogWriter;
+    using ultraverse::state::v2::TimestampIndexReader;
+    using ultraverse::state::v2::Transaction;
+    using ultraverse::state::v2::gid_t;
+
+    constexpr gid_t kLogTransactions = 300;
+
+    std::string makeTempDir(const std::string &prefix) {
+        static std::atomic<uint64_t> counter{0};
+        auto suffix = std::to_string(counter.fetch_add(1));
+        auto dir = std::filesystem::temp_directory_path() / (prefix + "_" + suffix);
+        std::filesystem::create_directories(dir);
+        return dir.string();
+    }
+
+    std::string statementFor(gid_t gid) {
+        // 레코드 크기가 제각각이 되도록 길이를 바꾼다
+        return "/*TXN:" + std::to_string(gid) + "*/" + std::string((gid % 13) * 97, 'x');
+    }
+
+    void writeTransaction(StateLogWriter &writer, gid_t gid) {
+        Transaction transaction;
+        transaction.setGid(gid);
+        transaction.setTimestamp(1000 + gid);
+
+        auto query = std::make_shared<Query>();
+        query->setStatement(statementFor(gid));
+        transaction << query;
+
+        writer << transaction;
+    }
+
+    void writeLog(const std::string &dir, const std::string &name,
+                  uint32_t transactionsPerBlock = 0, gid_t startGid = 0, bool isAppend = false,
+                  uint64_t segmentSize = 0, uint32_t retainedSegments = 0) {
+        StateLogWriter writer(dir, name);
+        writer.setBlockCompression(transactionsPerBlock, 3);
+        writer.setSegmentation(segmentSize, retainedSegments);
+        writer.open(std::ios::out | std::ios::binary | (isAppend ? std::ios::app : std::ios::trunc));
+
+        for (gid_t gid = startGid; gid < startGid + kLogTransactions; gid++) {
+            writeTransaction(writer, gid);
+        }
+
+        writer.close();
+    }
+
+    /**
+     * @return 모든 트랜잭션의 (gid, 헤더 시작 위치, 레코드 끝 위치)
+     */
+    std::vector<std::tuple<gid_t, uint64_t, uint64_t>> readPositions(IStateLogReader &reader) {
+        std::vector<std::tuple<gid_t, uint64_t, uint64_t>> positions;
+
+        reader.open();
+        while (reader.nextHeader()) {
+            auto gid = reader.txnHeader()->gid;
+            auto headerPos = reader.pos() - sizeof(ultraverse::state::v2::TransactionHeader);
+
+            REQUIRE(reader.nextTransaction());
+            REQUIRE(reader.txnBody()->gid() == gid);
+
+            positions.emplace_back(gid, headerPos, reader.pos());
+        }
+        reader.close();
+
+        return positions;
+    }
+
+    /**
+     * @return 읽은 gid 목록. 3의 배수가 아닌 트랜잭션은 헤더만 읽고 건너뛴다.
+     */
+    std::vector<gid_t> readLog(IStateLogReader &reader) {
+        std::vector<gid_t> gids;
+
+        reader.open();
+        while (reader.nextHeader()) {
+            auto header = reader.txnHeader();
+            REQUIRE(header != nullptr);
+
+            if (header->gid % 3 != 0) {
+                reader.skipTransaction();
+                continue;
+            }
+
+            REQUIRE(reader.nextTransaction());
+            auto body = reader.txnBody();
+            REQUIRE(body != nullptr);
+            REQUIRE(body->gid() == header->gid);
+            REQUIRE(body->queries().size() == 1);
+            REQUIRE(body->queries()[0]->statement() == statementFor(header->gid));
+
+            gids.push_back(header->gid);
+        }
+        reader.close();
+
+        return gids;
+    }
+}
+
+TEST_CASE("MmapStateLogReader reads the same records as StateLogReader", "[statelog][mmap]") {
+    auto dir = makeTempDir("statelogreader_mmap");
+    writeLog(dir, "log");
+
+    StateLogReader streamReader(dir, "log");
+    MmapStateLogReader mmapReader(dir, "log");
+
+    auto expected = readLog(streamReader);
+    REQUIRE(expected.size() == kLogTransactions / 3);
+    REQUIRE(readLog(mmapReader) == expected);
+
+    SECTION("with read-ahead") {
+        streamReader.setReadAheadSize(4096);
+        mmapReader.setReadAheadSize(4096);
+        REQUIRE(readLog(streamReader) == expected);
+        REQUIRE(readLog(mmapReader) == expected);
+    }
+}
+
+TEST_CASE("MmapStateLogReader seeks by gid and keeps headers valid after close", "[statelog][mmap]") {
+    auto dir = makeTempDir("statelogreader_seek");
+    writeLog(dir, "log");
+
+    MmapStateLogReader reader(dir, "log");
+    reader.open();
+
+    REQUIRE(reader.seekGid(123));
+    REQUIRE(reader.nextHeader());
+    auto header = reader.txnHeader();
+    REQUIRE(header->gid == 123);
+    REQUIRE(header->timestamp == 1123);
+
+    REQUIRE(reader.nextTransaction());
+    REQUIRE(reader.txnBody()->queries()[0]->statement() == statementFor(123));
+
+    reader.close();
+    REQUIRE(header->gid == 123);
+    REQUIRE_FALSE(reader.nextHeader());
+}
+
+TEST_CASE("StateLogWriter maintains the gid index while appending", "[statelog][gidindex]") {
+    auto dir = makeTempDir("statelogreader_gidindex");
+    writeLog(dir, "log");
+    writeLog(dir, "log", 0, kLogTransactions, true);
+
+    StateLogReader reader(dir, "log");
+    auto positions = readPositions(reader);
+    REQUIRE(positions.size() == kLogTransactions * 2);
+
+    GIDIndexReader indexReader(dir, "log");
+    for (const auto &[gid, headerPos, endPos]: positions) {
+        REQUIRE(indexReader.offsetOf(gid) == headerPos);
+    }
+}
+
+TEST_CASE("GIDIndexWriter buffers offsets and fills gaps with zero", "[statelog][gidindex]") {
+    auto dir = makeTempDir("statelogreader_gidindex_writer");
+
+    {
+        GIDIndexWriter writer(dir, "log", true);
+        for (uint64_t gid = 0; gid < GIDIndexWriter::BUFFER_ENTRIES + 10; gid++) {
+            writer.append(gid * 100);
+        }
+        writer.write(GIDIndexWriter::BUFFER_ENTRIES + 20, 42);
+        writer.write(3, 7);
+    }
+
+    GIDIndexReader indexReader(dir, "log");
+    REQUIRE(indexReader.offsetOf(0) == 0);
+    REQUIRE(indexReader.offsetOf(3) == 7);
+    REQUIRE(indexReader.offsetOf(GIDIndexWriter::BUFFER_ENTRIES + 9) == (GIDIndexWriter::BUFFER_ENTRIES + 9) * 100);
+    REQUIRE(indexReader.offsetOf(GIDIndexWriter::BUFFER_ENTRIES + 15) == 0);
+    REQUIRE(indexReader.offsetOf(GIDIndexWriter::BUFFER_ENTRIES + 20) == 42);
+}
+
+TEST_CASE("GIDIndexReader detects an index that does not cover the whole log", "[statelog][gidindex]") {
+    auto dir = makeTempDir("statelogreader_gidindex_uptodate");
+    StateLogReader reader(dir, "log");
+
+    REQUIRE_FALSE(GIDIndexReader::isUpToDate(dir, "log", reader));
+
+    writeLog(dir, "log");
+    REQUIRE(GIDIndexReader::isUpToDate(dir, "log", reader));
+
+    {
+        StateLogWriter writer(dir, "log");
+        writer.setGidIndexEnabled(false);
+        writer.open(std::ios::out | std::ios::binary | std::ios::app);
+        writeTransaction(writer, kLogTransactions);
+        writer.close();
+    }
+    REQUIRE_FALSE(GIDIndexReader::isUpToDate(dir, "log", reader));
+}
+
+TEST_CASE("seekGid finds transactions the gid index has not covered yet", "[statelog][gidindex]") {
+    auto dir = makeTempDir("statelogreader_gidindex_partial");
+    writeLog(dir, "log");
+
+    // statelogd가 오프셋을 버퍼에 모아 두고 있는 중처럼, 인덱스를 앞 100개 항목과 덜 쓰인 항목 하나로 자른다
+    constexpr uint64_t kIndexedTransactions = 100;
+    const auto indexPath = dir + "/log.ultindex";
+    std::filesystem::resize_file(indexPath, kIndexedTransactions * sizeof(uint64_t) + 3);
+
+    {
+        StateLogReader reader(dir, "log");
+        REQUIRE(GIDIndexReader::coverageOf(dir, "log", reader) == GIDIndexReader::Coverage::PARTIAL);
+        REQUIRE_FALSE(GIDIndexReader::isUpToDate(dir, "log", reader));
+    }
+
+    auto checkSeekGid = [](IStateLogReader &reader) {
+        reader.open();
+
+        for (uint64_t gid : { uint64_t(0), kIndexedTransactions - 1, kIndexedTransactions,
+                              uint64_t(250), kLogTransactions - 1, uint64_t(42) }) {
+            REQUIRE(reader.seekGid(gid));
+            REQUIRE(reader.nextHeader());
+            REQUIRE(reader.txnHeader()->gid == gid);
+            REQUIRE(reader.nextTransaction());
+            REQUIRE(reader.txnBody()->queries().front()->statement() == statementFor(gid));
+        }
+
+        REQUIRE_FALSE(reader.seekGid(kLogTransactions));
+        reader.close();
+    };
+
+    SECTION("stream reader") {
+        StateLogReader reader(dir, "log");
+        checkSeekGid(reader);
+    }
+
+    SECTION("mmap reader") {
+        MmapStateLogReader reader(dir, "log");
+        checkSeekGid(reader);
+    }
+
+    SECTION("index that does not match the log") {
+        // 마지막 항목이 다른 트랜잭션을 가리킨다
+        std::filesystem::resize_file(indexPath, kIndexedTransactions * sizeof(uint64_t));
+        {
+            GIDIndexWriter writer(dir, "log");
+            writer.write(kIndexedTransactions, 0);
+        }
+
+        StateLogReader reader(dir, "log");
+        REQUIRE(GIDIndexReader::coverageOf(dir, "log", reader) == GIDIndexReader::Coverage::MISMATCHED);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Timestamp index resolves time windows to gid ranges", "[statelog][timeindex]") {
+    auto dir = makeTempDir("statelogreader_timeindex");
+
+    {
+        StateLogWriter writer(dir, "log");
+        writer.setTimestampIndexInterval(16);
+        writer.open(std::ios::out | std::ios::binary | std::ios::trunc);
+
+        for (uint64_t gid = 0; gid < kLogTransactions; gid++) {
+            Transaction transaction;
+            transaction.setGid(gid);
+            // 두 트랜잭션씩 같은 초에 커밋되고, #101만 시각이 앞서 있다
+            transaction.setTimestamp(1000 + gid / 2 + (gid == 101 ? 50 : 0));
+
+            auto query = std::make_shared<Query>();
+            query->setStatement(statementFor(gid));
+            transaction << query;
+
+            writer << transaction;
+        }
+
+        writer.close();
+    }
+
+    TimestampIndexReader index(dir, "log");
+    REQUIRE(index.entries().size() == (kLogTransactions + 15) / 16);
+
+    StateLogReader reader(dir, "log");
+    reader.open();
+
+    using ultraverse::state::v2::resolveTimeRange;
+    REQUIRE(resolveTimeRange(reader, index, 1010, 1040) == std::make_pair<uint64_t, uint64_t>(20, 81));
+    REQUIRE(resolveTimeRange(reader, index, 0, 1000) == std::make_pair<uint64_t, uint64_t>(0, 1));
+    REQUIRE(resolveTimeRange(reader, index, 1149, UINT64_MAX) == std::make_pair<uint64_t, uint64_t>(298, 299));
+    REQUIRE_FALSE(resolveTimeRange(reader, index, 5000, 6000).has_value());
+
+    SECTION("out-of-order timestamps extend the range to the running maximum") {
+        REQUIRE(resolveTimeRange(reader, index, 1060, 1100) == std::make_pair<uint64_t, uint64_t>(101, 201));
+    }
+}
+
+TEST_CASE("MmapStateLogReader treats a missing log as empty", "[statelog][mmap]") {
+    auto dir = makeTempDir("statelogreader_missing");
+
+    MmapStateLogReader reader(dir, "missing");
+    reader.open();
+    REQUIRE_FALSE(reader.nextHeader());
+    REQUIRE_FALSE(reader.nextTransaction());
+}
+
+TEST_CASE("PrefetchingStateLogReader returns records in log order", "[statelog][prefetch]") {
+    auto dir = makeTempDir("statelogreader_prefetch");
+    writeLog(dir, "log");
+
+    StateLogReader streamReader(dir, "log");
+    auto expected = readLog(streamReader);
+    auto expectedPositions = readPositions(streamReader);
+    REQUIRE(expectedPositions.size() == kLogTransactions);
+
+    SECTION("over StateLogReader with a small window") {
+        StateLogReader inner(dir, "log");
+        PrefetchingStateLogReader reader(inner, 4, 7);
+
+        REQUIRE(readLog(reader) == expected);
+        REQUIRE(readPositions(reader) == expectedPositions);
+    }
+
+    SECTION("over MmapStateLogReader") {
+        MmapStateLogReader inner(dir, "log");
+        PrefetchingStateLogReader reader(inner, 2);
+
+        REQUIRE(readLog(reader) == expected);
+        REQUIRE(readPositions(reader) == expectedPositions);
+    }
+
+    SECTION("discards prefetched records on seekGid") {
+        StateLogReader inner(dir, "log");
+        PrefetchingStateLogReader reader(inner, 2, 16);
+
+        reader.open();
+        REQUIRE(reader.nextHeader());
+        REQUIRE(reader.txnHeader()->gid == 0);
+
+        REQUIRE(reader.seekGid(200));
+        for (uint64_t gid = 200; gid < kLogTransactions; gid++) {
+            REQUIRE(reader.nextHeader());
+            REQUIRE(reader.txnHeader()->gid == gid);
+            REQUIRE(reader.nextTransaction());
+            REQUIRE(reader.txnBody()->queries()[0]->statement() == statementFor(gid));
+        }
+        REQUIRE_FALSE(reader.nextHeader());
+    }
+}
+
+TEST_CASE("StateLogReader reads block-compressed logs transparently", "[statelog][compression]") {
+    auto dir = makeTempDir("statelogreader_compressed");
+    writeLog(dir, "plain");
+    writeLog(dir, "packed", 16);
+
+    REQUIRE_FALSE(ultraverse::state::v2::isBlockCompressedStateLog(dir, "plain"));
+    REQUIRE(ultraverse::state::v2::isBlockCompressedStateLog(dir, "packed"));
+    REQUIRE(std::filesystem::exists(dir + "/packed.ultdict"));
+    REQUIRE(std::filesystem::file_size(dir + "/packed.ultstatelog") <
+            std::filesystem::file_size(dir + "/plain.ultstatelog") / 4);
+
+    StateLogReader plainReader(dir, "plain");
+    StateLogReader packedReader(dir, "packed");
+
+    auto expected = readLog(plainReader);
+    auto expectedPositions = readPositions(plainReader);
+
+    SECTION("records and logical positions match the uncompressed log") {
+        REQUIRE(readLog(packedReader) == expected);
+        REQUIRE(readPositions(packedReader) == expectedPositions);
+
+        packedReader.setReadAheadSize(4096);
+        REQUIRE(readLog(packedReader) == expected);
+    }
+
+    SECTION("seekGid uses the block index") {
+        packedReader.open();
+        for (uint64_t gid: {0, 15, 16, 123, 299}) {
+            REQUIRE(packedReader.seekGid(gid));
+            REQUIRE(packedReader.nextHeader());
+            REQUIRE(packedReader.txnHeader()->gid == gid);
+            REQUIRE(packedReader.nextTransaction());
+            REQUIRE(packedReader.txnBody()->queries()[0]->statement() == statementFor(gid));
+        }
+        REQUIRE_FALSE(packedReader.seekGid(kLogTransactions));
+    }
+
+    SECTION("gid index offsets are logical positions") {
+        GIDIndexReader indexReader(dir, "packed");
+
+        packedReader.open();
+        packedReader.seek(indexReader.offsetOf(200));
+        REQUIRE(packedReader.nextHeader());
+        REQUIRE(packedReader.txnHeader()->gid == 200);
+    }
+
+    SECTION("appending continues after the last block") {
+        writeLog(dir, "packed", 16, kLogTransactions, true);
+
+        auto positions = readPositions(packedReader);
+        REQUIRE(positions.size() == kLogTransactions * 2);
+        for (uint64_t i = 0; i < positions.size(); i++) {
+            REQUIRE(std::get<0>(positions[i]) == i);
+        }
+        REQUIRE(std::get<1>(positions[kLogTransactions]) == std::get<2>(positions[kLogTransactions - 1]));
+    }
+
+    SECTION("prefetching reader decodes compressed blocks") {
+        PrefetchingStateLogReader reader(packedReader, 2, 32);
+        REQUIRE(readLog(reader) == expected);
+    }
+
+    SECTION("memory-mapped reader refuses compressed logs") {
+        MmapStateLogReader reader(dir, "packed");
+        REQUIRE_THROWS(reader.open());
+    }
+}
+
+TEST_CASE("Segmented state log rotates into segments and reads them as one log", "[statelog][segment]") {
+    constexpr uint64_t kSegmentSize = 16 * 1024;
+
+    auto dir = makeTempDir("statelogreader_segmented");
+    writeLog(dir, "plain");
+    writeLog(dir, "log", 0, 0, false, kSegmentSize);
+
+    REQUIRE(StateLogManifest::exists(dir, "log"));
+    REQUIRE_FALSE(std::filesystem::exists(dir + "/log.ultstatelog"));
+
+    StateLogManifest manifest(dir, "log");
+    REQUIRE(manifest.segments().size() > 4);
+
+    uint64_t nextGid = 0;
+    for (const auto &segment: manifest.segments()) {
+        if (segment.transactionCount == 0) {
+            // 마지막 트랜잭션에서 세그먼트가 넘어가면 빈 세그먼트가 남는다
+            REQUIRE_FALSE(segment.sealed);
+            continue;
+        }
+
+        REQUIRE(segment.firstGid == nextGid);
+        REQUIRE(segment.transactionCount == segment.lastGid - segment.firstGid + 1);
+        REQUIRE(segment.minTimestamp == 1000 + segment.firstGid);
+        REQUIRE(segment.maxTimestamp == 1000 + segment.lastGid);
+        nextGid = segment.lastGid + 1;
+
+        if (segment.sealed) {
+            REQUIRE(segment.size >= kSegmentSize);
+            REQUIRE(std::filesystem::exists(dir + "/" + segment.name + ".ultindex"));
+            REQUIRE(manifest.verify(segment));
+        }
+    }
+    REQUIRE(nextGid == kLogTransactions);
+
+    StateLogReader plainReader(dir, "plain");
+    SegmentedStateLogReader reader(dir, "log");
+    auto expected = readLog(plainReader);
+
+    SECTION("records are read in log order across segments") {
+        REQUIRE(readLog(reader) == expected);
+
+        reader.setReadAheadSize(4096);
+        REQUIRE(readLog(reader) == expected);
+
+        PrefetchingStateLogReader prefetchingReader(reader, 2, 32);
+        REQUIRE(readLog(prefetchingReader) == expected);
+    }
+
+    SECTION("positions can be sought back within and across segments") {
+        auto positions = readPositions(reader);
+        REQUIRE(positions.size() == kLogTransactions);
+
+        reader.open();
+        for (auto index: {250, 3, 120}) {
+            reader.seek(std::get<1>(positions[index]));
+            REQUIRE(reader.nextHeader());
+            REQUIRE(reader.txnHeader()->gid == std::get<0>(positions[index]));
+        }
+    }
+
+    SECTION("seekGid opens the segment holding the gid") {
+        reader.open();
+        for (uint64_t gid: {0, 123, 299, 57}) {
+            REQUIRE(reader.seekGid(gid));
+            REQUIRE(reader.nextHeader());
+            REQUIRE(reader.txnHeader()->gid == gid);
+            REQUIRE(reader.nextTransaction());
+            REQUIRE(reader.txnBody()->queries()[0]->statement() == statementFor(gid));
+        }
+    }
+
+    SECTION("segments outside the gid range are skipped") {
+        reader.setGidRange(150, 160);
+
+        auto positions = readPositions(reader);
+        REQUIRE_FALSE(positions.empty());
+        REQUIRE(positions.size() < kLogTransactions / 2);
+        REQUIRE(std::get<0>(positions.front()) <= 150);
+        REQUIRE(std::get<0>(positions.back()) >= 160);
+    }
+
+    SECTION("forEachSegment reads every segment once") {
+        std::mutex lock;
+        std::vector<uint64_t> gids;
+
+        reader.forEachSegment(4, [&](const StateLogSegment &segment, IStateLogReader &segmentReader) {
+            std::vector<uint64_t> segmentGids;
+            while (segmentReader.nextHeader()) {
+                segmentGids.push_back(segmentReader.txnHeader()->gid);
+                segmentReader.skipTransaction();
+            }
+
+            std::scoped_lock _lock(lock);
+            gids.insert(gids.end(), segmentGids.begin(), segmentGids.end());
+        });
+
+        std::sort(gids.begin(), gids.end());
+        REQUIRE(gids.size() == kLogTransactions);
+        for (uint64_t i = 0; i < gids.size(); i++) {
+            REQUIRE(gids[i] == i);
+        }
+    }
+
+    SECTION("forEachSegment rethrows callback errors") {
+        REQUIRE_THROWS_AS(
+            reader.forEachSegment(2, [](const StateLogSegment &, IStateLogReader &) {
+                throw std::runtime_error("callback failed");
+            }),
+            std::runtime_error
+        );
+    }
+
+    SECTION("appending continues the live segment") {
+        writeLog(dir, "log", 0, kLogTransactions, true, kSegmentSize);
+
+        SegmentedStateLogReader appendedReader(dir, "log");
+        auto positions = readPositions(appendedReader);
+        REQUIRE(positions.size() == kLogTransactions * 2);
+        for (uint64_t i = 0; i < positions.size(); i++) {
+            REQUIRE(std::get<0>(positions[i]) == i);
+        }
+    }
+}
+
+TEST_CASE("Segmented state log archives segments beyond the retention count", "[statelog][segment]") {
+    auto dir = makeTempDir("statelogreader_retention");
+    writeLog(dir, "plain");
+    writeLog(dir, "log", 0, 0, false, 16 * 1024, 2);
+
+    StateLogManifest manifest(dir, "log");
+
+    size_t retained = 0;
+    size_t archived = 0;
+    for (const auto &segment: manifest.segments()) {
+        if (segment.archived) {
+            archived++;
+            REQUIRE(segment.sealed);
+            REQUIRE_FALSE(std::filesystem::exists(dir + "/" + segment.name + ".ultstatelog"));
+            REQUIRE(std::filesystem::exists(dir + "/archive/" + segment.name + ".ultstatelog"));
+            REQUIRE(std::filesystem::exists(dir + "/archive/" + segment.name + ".ultindex"));
+        } else if (segment.sealed) {
+            retained++;
+        }
+    }
+    REQUIRE(retained == 2);
+    REQUIRE(archived > 0);
+
+    StateLogReader plainReader(dir, "plain");
+    auto expected = readLog(plainReader);
+
+    SECTION("archived segments are still readable") {
+        SegmentedStateLogReader reader(dir, "log");
+        REQUIRE(readLog(reader) == expected);
+    }
+
+    SECTION("segments removed from the archive are reported as missing") {
+        std::filesystem::remove_all(dir + "/archive");
+
+        SegmentedStateLogReader reader(dir, "log");
+        REQUIRE_THROWS_AS(reader.open(), std::runtime_error);
+
+        // 지워진 세그먼트와 겹치지 않는 범위는 그대로 읽을 수 있다
+        reader.setGidRange(kLogTransactions - 1, kLogTransactions - 1);
+        REQUIRE(reader.missingSegments().empty());
+        REQUIRE_FALSE(readPositions(reader).empty());
+
+        REQUIRE_THROWS_AS(reader.setGidRange(0, kLogTransactions - 1), std::runtime_error);
+    }
+
+    SECTION("segments removed from the archive are skipped only when allowed") {
+        std::filesystem::remove_all(dir + "/archive");
+
+        SegmentedStateLogReader reader(dir, "log", true);
+        auto positions = readPositions(reader);
+        REQUIRE_FALSE(positions.empty());
+        REQUIRE(std::get<0>(positions.front()) > 0);
+        REQUIRE(std::get<0>(positions.back()) == kLogTransactions - 1);
+
+        const auto &missing = reader.missingSegments();
+        REQUIRE(missing.size() == archived);
+        REQUIRE(missing.front().firstGid == 0);
+        REQUIRE(missing.back().lastGid + 1 == std::get<0>(positions.front()));
+    }
+}
+
+TEST_CASE("StateLogWriter resumes from a checkpoint after a crash", "[statelog][checkpoint]") {
+    constexpr uint64_t kCheckpointGid = 150;
+    constexpr uint64_t kCrashGid = 220;
+
+    auto dir = makeTempDir("statelogreader_checkpoint");
+    uint64_t segmentSize = 0;
+
+    SECTION("single log") {
+        segmentSize = 0;
+    }
+    SECTION("segmented log rotated after the checkpoint") {
+        segmentSize = 16 * 1024;
+    }
+
+    REQUIRE_FALSE(StateLogCheckpoint::exists(dir, "log"));
+
+    {
+        StateLogWriter writer(dir, "log");
+        writer.setSegmentation(segmentSize, 0);
+        writer.setTimestampIndexInterval(16);
+        writer.setRWSummaryEnabled(true);
+        writer.open(std::ios::out | std::ios::binary | std::ios::trunc);
+
+        for (uint64_t gid = 0; gid < kCheckpointGid; gid++) {
+            writeTransaction(writer, gid);
+        }
+
+        StateLogCheckpoint checkpoint;
+        checkpoint.binlogIndex = 2;
+        checkpoint.binlogFile = "mysql-bin.000003";
+        checkpoint.binlogPos = 4096;
+        checkpoint.nextGid = kCheckpointGid;
+        writer.checkpoint(checkpoint);
+
+        REQUIRE(checkpoint.files.count(checkpoint.logName + ".ultstatelog") == 1);
+        REQUIRE(checkpoint.files[checkpoint.logName + ".ultstatelog"] == checkpoint.logOffset);
+        REQUIRE(checkpoint.segment.has_value() == (segmentSize > 0));
+
+        for (uint64_t gid = kCheckpointGid; gid < kCrashGid; gid++) {
+            writeTransaction(writer, gid);
+        }
+
+        // close()하지 않고 죽은 것처럼 둔다
+    }
+
+    auto checkpoint = StateLogCheckpoint::load(dir, "log");
+    REQUIRE(checkpoint.has_value());
+    REQUIRE(checkpoint->binlogIndex == 2);
+    REQUIRE(checkpoint->binlogFile == "mysql-bin.000003");
+    REQUIRE(checkpoint->binlogPos == 4096);
+    REQUIRE(checkpoint->nextGid == kCheckpointGid);
+
+    if (segmentSize > 0) {
+        REQUIRE(StateLogManifest(dir, "log").segments().back().index > checkpoint->segment->index);
+    }
+
+    {
+        // 마지막 레코드가 덜 쓰인 것처럼 꼬리에 쓰레기를 붙인다
+        std::ofstream stream(dir + "/" + checkpoint->logName + ".ultstatelog", std::ios::binary | std::ios::app);
+        stream << "torn";
+    }
+
+    {
+        StateLogWriter writer(dir, "log");
+        writer.setSegmentation(segmentSize, 0);
+        writer.setTimestampIndexInterval(16);
+        writer.setRWSummaryEnabled(true);
+        writer.restore(*checkpoint);
+        writer.open(std::ios::out | std::ios::binary | std::ios::app);
+
+        for (uint64_t gid = checkpoint->nextGid; gid < kLogTransactions; gid++) {
+            writeTransaction(writer, gid);
+        }
+
+        writer.close();
+    }
+
+    std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> positions;
+    if (segmentSize > 0) {
+        SegmentedStateLogReader reader(dir, "log");
+        positions = readPositions(reader);
+
+        uint64_t nextGid = 0;
+        for (const auto &segment: StateLogManifest(dir, "log").segments()) {
+            if (segment.transactionCount == 0) {
+                continue;
+            }
+            REQUIRE(segment.firstGid == nextGid);
+            REQUIRE(segment.transactionCount == segment.lastGid - segment.firstGid + 1);
+            nextGid = segment.lastGid + 1;
+        }
+        REQUIRE(nextGid == kLogTransactions);
+    } else {
+        StateLogReader reader(dir, "log");
+        positions = readPositions(reader);
+
+        // 체크포인트 뒤의 엔트리가 잘려나가서 다시 쓴 트랜잭션의 엔트리가 겹치지 않는다
+        TimestampIndexReader timestampIndex(dir, "log");
+        const auto &entries = timestampIndex.entries();
+        REQUIRE_FALSE(entries.empty());
+        for (size_t i = 1; i < entries.size(); i++) {
+            uint64_t previousGid = entries[i - 1].gid;
+            uint64_t currentGid = entries[i].gid;
+            REQUIRE(currentGid > previousGid);
+        }
+    }
+
+    REQUIRE(positions.size() == kLogTransactions);
+    for (uint64_t i = 0; i < positions.size(); i++) {
+        REQUIRE(std::get<0>(positions[i]) == i);
+    }
+}
+
+TEST_CASE("Ingest parts merge into one log in binlog order with contiguous gids", "[statelog][ingest]") {
+    auto dir = makeTempDir("statelogreader_ingest");
+    auto ingestPath = dir + "/log.ingest";
+    std::filesystem::create_directories(ingestPath);
+
+    // binlog 파일마다 트랜잭션 수가 다르며, 비어 있는 파일도 있다
+    const std::vector<uint64_t> partSizes = { 120, 0, 37, 143 };
+    std::vector<uint64_t> firstOrdinals;
+    uint64_t totalTransactions = 0;
+    for (auto size: partSizes) {
+        firstOrdinals.push_back(totalTransactions);
+        totalTransactions += size;
+    }
+
+    // 병렬 ingest처럼 part들을 동시에 쓴다. 트랜잭션의 binlog 순번을 쿼리에 남기고 gid는 매기지 않는다
+    std::vector<std::thread> writers;
+    for (int index = static_cast<int>(partSizes.size()) - 1; index >= 0; index--) {
+        writers.emplace_back([&, index]() {
+            StateLogIngestPart part(ingestPath, index);
+            part.open();
+
+            for (uint64_t ordinal = firstOrdinals[index]; ordinal < firstOrdinals[index] + partSizes[index]; ordinal++) {
+                Transaction transaction;
+                transaction.setTimestamp(1000 + ordinal);
+
+                auto query = std::make_shared<Query>();
+                query->setStatement(statementFor(ordinal));
+                transaction << query;
+
+                part.write(transaction);
+            }
+
+            part.close();
+        });
+    }
+    for (auto &writer: writers) {
+        writer.join();
+    }
+
+    // gid에 의존하는 사이드카는 part에 쓰지 않는다
+    for (const auto &entry: std::filesystem::directory_iterator(ingestPath)) {
+        REQUIRE(entry.path().extension() == ".ultstatelog");
+    }
+
+    StateLogWriter writer(dir, "log");
+    writer.open(std::ios::out | std::ios::binary | std::ios::trunc);
+
+    uint64_t nextGid = 0;
+    for (int index = 0; index < static_cast<int>(partSizes.size()); index++) {
+        StateLogIngestPart part(ingestPath, index);
+        nextGid = part.merge(nextGid, partSizes[index], [&](std::shared_ptr<Transaction> transaction) {
+            writer << *transaction;
+        });
+        part.remove();
+    }
+    writer.close();
+
+    REQUIRE(nextGid == totalTransactions);
+    REQUIRE(std::filesystem::is_empty(ingestPath));
+
+    StateLogReader reader(dir, "log");
+    reader.open();
+    for (uint64_t gid = 0; gid < totalTransactions; gid++) {
+        REQUIRE(reader.nextHeader());
+        REQUIRE(reader.txnHeader()->gid == gid);
+        REQUIRE(reader.txnHeader()->timestamp == 1000 + gid);
+
+        REQUIRE(reader.nextTransaction());
+        REQUIRE(reader.txnBody()->gid() == gid);
+        REQUIRE(reader.txnBody()->queries()[0]->statement() == statementFor(gid));
+    }
+    REQUIRE_FALSE(reader.nextHeader());
+
+    // 최종 로그의 gid index는 병합할 때 매긴 gid로 쓰인다
+    REQUIRE(reader.seekGid(firstOrdinals[3]));
+    REQUIRE(reader.nextHeader());
+    REQUIRE(reader.txnHeader()->gid == firstOrdinals[3]);
+    reader.close();
+
+    SECTION("merge fails when a part ends early") {
+        StateLogIngestPart part(ingestPath, 0);
+        part.open();
+        Transaction transaction;
+        part.write(transaction);
+        part.close();
+
+        REQUIRE_THROWS_AS(part.merge(0, 2, [](std::shared_ptr<Transaction>) {}), std::runtime_error);
+    }
+
+    std::filesystem::remove_all(dir);
+}
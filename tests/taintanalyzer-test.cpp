@@ -1,3 +1,4 @@
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <vector>
@@ -5,6 +6,7 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "../src/mariadb/state/new/analysis/TaintAnalyzer.hpp"
+#include "../src/mariadb/state/new/StateRWSummary.hpp"
 #include "../src/mariadb/state/new/cluster/StateCluster.hpp"
 #include "state_test_helpers.hpp"
 
@@ -251,3 +253,68 @@ TEST_CASE("TaintAnalyzer hasKeyColumnItems ignores DDL but considers other queri
 
     REQUIRE(TaintAnalyzer::hasKeyColumnItems(*txn, cluster, resolver));
 }
+
+TEST_CASE("TaintAnalyzer summary overloads match transaction-based results") {
+    auto dir = std::filesystem::temp_directory_path() / "taintanalyzer_rwsummary";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    auto txn1 = std::make_shared<Transaction>();
+    txn1->setGid(1);
+    auto q1 = makeQuery("test", {makeEq("users.id", 1)}, {makeEq("users.name", 1)});
+    auto ddl = makeQuery("other", {makeEq("ddl.table", 1)}, {makeEq("ddl.column", 1)});
+    ddl->setFlags(Query::FLAG_IS_DDL);
+    *txn1 << q1;
+    *txn1 << ddl;
+
+    auto txn2 = makeTxn(2, "test", {makeEq("posts.author_id", 1)}, {});
+    auto txn4 = makeTxn(4, "test", {makeEq("payments.id", 1)}, {makeEq("users.name", 2)});
+
+    {
+        StateRWSummaryWriter writer(dir.string(), "log", true);
+        writer.write(*txn1);
+        writer.write(*txn2);
+    }
+    {
+        // 이어 쓸 때도 심볼 id가 이어져야 한다
+        StateRWSummaryWriter writer(dir.string(), "log", false);
+        writer.write(*txn4);
+    }
+
+    MockedRelationshipResolver resolver;
+    resolver.addForeignKey("posts.author_id", "users.id");
+    StateCluster cluster({"users.id"});
+
+    StateRWSummaryReader reader(dir.string(), "log");
+
+    for (const auto &txn : {txn1, txn2}) {
+        auto *summary = reader.advanceTo(txn->gid());
+        REQUIRE(summary != nullptr);
+        REQUIRE(summary->gid == txn->gid());
+        REQUIRE(summary->queryCount == txn->queries().size());
+
+        auto expected = TaintAnalyzer::collectColumnRW(*txn);
+        auto actual = TaintAnalyzer::collectColumnRW(*summary, reader);
+        REQUIRE(actual.read == expected.read);
+        REQUIRE(actual.write == expected.write);
+
+        REQUIRE(TaintAnalyzer::hasKeyColumnItems(*summary, reader, cluster, resolver) ==
+                TaintAnalyzer::hasKeyColumnItems(*txn, cluster, resolver));
+        REQUIRE(reader.isRelatedToDatabase(*summary, "test"));
+    }
+
+    REQUIRE(reader.advanceTo(3) == nullptr);
+
+    auto *summary = reader.advanceTo(4);
+    REQUIRE(summary != nullptr);
+    REQUIRE_FALSE(reader.isRelatedToDatabase(*summary, "other"));
+    REQUIRE_FALSE(TaintAnalyzer::hasKeyColumnItems(*summary, reader, cluster, resolver));
+
+    auto rw = TaintAnalyzer::collectColumnRW(*summary, reader);
+    REQUIRE(rw.read.count("payments.id") == 1);
+    REQUIRE(rw.write.count("users.name") == 1);
+
+    REQUIRE(reader.advanceTo(5) == nullptr);
+
+    std::filesystem::remove_all(dir);
+}
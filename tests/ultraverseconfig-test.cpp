@@ -76,8 +76,14 @@ TEST_CASE("UltraverseConfig parses full JSON", "[config]") {
     REQUIRE(envReset.ok());
 
     const std::string json = R"({
-        "binlog": { "path": "/data/binlog", "indexName": "binlog.index" },
-        "stateLog": { "path": "/var/log/ultra", "name": "main-log" },
+        "binlog": { "path": "/data/binlog", "indexName": "binlog.index", "memoryMappedReader": true,
+                    "payloadDecodeThreads": 4 },
+        "stateLog": { "path": "/var/log/ultra", "name": "main-log", "memoryMappedReader": true,
+                      "compressionBlockSize": 64, "compressionLevel": 9,
+                      "symbolTable": true, "timestampIndexInterval": 256,
+                      "keyIndex": true, "keyIndexColumns": ["posts.author_id"],
+                      "segmentSizeMB": 512, "retainedSegments": 4, "allowMissingArchivedSegments": true,
+                      "rwSummary": true, "zoneMapInterval": 512 },
         "keyColumns": ["users.id", "orders.user_id"],
         "columnAliases": {
             "users.id": ["orders.user_id", "payments.user_id"],
@@ -94,13 +100,27 @@ TEST_CASE("UltraverseConfig parses full JSON", "[config]") {
             "threadCount": 4,
             "oneshotMode": true,
             "procedureLogPath": "/var/log/proc",
-            "developmentFlags": ["print-gids", "print-queries"]
+            "developmentFlags": ["print-gids", "print-queries"],
+            "checkpointInterval": 1000,
+            "parallelFiles": 8
         },
         "stateChange": {
             "threadCount": 2,
             "backupFile": "/tmp/backup.sql",
             "keepIntermediateDatabase": true,
-            "rangeComparisonMethod": "intersect"
+            "rangeComparisonMethod": "intersect",
+            "readyQueueScheduler": true,
+            "incrementalGC": true,
+            "compactRowGraph": true,
+            "shardedRowGraphWorkers": true,
+            "replayPipelineDepth": 4,
+            "replayStatementBatching": true,
+            "parallelFullReplay": true,
+            "replayFeederMode": "scan",
+            "logDecodeThreads": 3,
+            "useKeyIndex": true,
+            "useRWSummary": true,
+            "useZoneMap": true
         }
     })";
 
@@ -108,8 +128,22 @@ TEST_CASE("UltraverseConfig parses full JSON", "[config]") {
     REQUIRE(config.has_value());
     CHECK(config->binlog.path == "/data/binlog");
     CHECK(config->binlog.indexName == "binlog.index");
+    CHECK(config->binlog.memoryMappedReader);
+    CHECK(config->binlog.payloadDecodeThreads == 4);
     CHECK(config->stateLog.path == "/var/log/ultra");
     CHECK(config->stateLog.name == "main-log");
+    CHECK(config->stateLog.memoryMappedReader);
+    CHECK(config->stateLog.compressionBlockSize == 64);
+    CHECK(config->stateLog.compressionLevel == 9);
+    CHECK(config->stateLog.symbolTable);
+    CHECK(config->stateLog.timestampIndexInterval == 256);
+    CHECK(config->stateLog.keyIndex);
+    CHECK(config->stateLog.keyIndexColumns == std::vector<std::string>{"posts.author_id"});
+    CHECK(config->stateLog.segmentSizeMB == 512);
+    CHECK(config->stateLog.retainedSegments == 4);
+    CHECK(config->stateLog.allowMissingArchivedSegments);
+    CHECK(config->stateLog.rwSummary);
+    CHECK(config->stateLog.zoneMapInterval == 512);
     CHECK(config->keyColumns == std::vector<std::string>{"users.id", "orders.user_id"});
     CHECK(config->columnAliases.at("users.id") ==
           std::vector<std::string>{"orders.user_id", "payments.user_id"});
@@ -123,12 +157,26 @@ TEST_CASE("UltraverseConfig parses full JSON", "[config]") {
     CHECK(config->statelogd.threadCount == 4);
     CHECK(config->statelogd.oneshotMode);
     CHECK(config->statelogd.procedureLogPath == "/var/log/proc");
+    CHECK(config->statelogd.checkpointInterval == 1000);
+    CHECK(config->statelogd.parallelFiles == 8);
     CHECK(config->statelogd.developmentFlags ==
           std::vector<std::string>{"print-gids", "print-queries"});
     CHECK(config->stateChange.threadCount == 2);
     CHECK(config->stateChange.backupFile == "/tmp/backup.sql");
     CHECK(config->stateChange.keepIntermediateDatabase);
     CHECK(config->stateChange.rangeComparisonMethod == "intersect");
+    CHECK(config->stateChange.readyQueueScheduler);
+    CHECK(config->stateChange.incrementalGC);
+    CHECK(config->stateChange.compactRowGraph);
+    CHECK(config->stateChange.shardedRowGraphWorkers);
+    CHECK(config->stateChange.replayPipelineDepth == 4);
+    CHECK(config->stateChange.replayStatementBatching);
+    CHECK(config->stateChange.parallelFullReplay);
+    CHECK(config->stateChange.replayFeederMode == "scan");
+    CHECK(config->stateChange.logDecodeThreads == 3);
+    CHECK(config->stateChange.useKeyIndex);
+    CHECK(config->stateChange.useRWSummary);
+    CHECK(config->stateChange.useZoneMap);
 }
 
 TEST_CASE("UltraverseConfig validates required fields", "[config]") {
@@ -161,6 +209,74 @@ TEST_CASE("UltraverseConfig validates required fields", "[config]") {
         REQUIRE_FALSE(UltraverseConfig::loadFromString(json).has_value());
     }
 
+    SECTION("binlog.payloadDecodeThreads negative") {
+        const std::string json = R"({
+            "binlog": { "payloadDecodeThreads": -1 },
+            "stateLog": { "name": "test-log" },
+            "keyColumns": ["users.id"],
+            "database": { "name": "testdb" }
+        })";
+        REQUIRE_FALSE(UltraverseConfig::loadFromString(json).has_value());
+    }
+
+    SECTION("statelogd.parallelFiles negative") {
+        const std::string json = R"({
+            "stateLog": { "name": "test-log" },
+            "keyColumns": ["users.id"],
+            "database": { "name": "testdb" },
+            "statelogd": { "parallelFiles": -1 }
+        })";
+        REQUIRE_FALSE(UltraverseConfig::loadFromString(json).has_value());
+    }
+
+    SECTION("stateLog.compressionBlockSize negative") {
+        const std::string json = R"({
+            "stateLog": { "name": "test-log", "compressionBlockSize": -1 },
+            "keyColumns": ["users.id"],
+            "database": { "name": "testdb" }
+        })";
+        REQUIRE_FALSE(UltraverseConfig::loadFromString(json).has_value());
+    }
+
+    SECTION("stateLog.segmentSizeMB negative") {
+        const std::string json = R"({
+            "stateLog": { "name": "test-log", "segmentSizeMB": -1 },
+            "keyColumns": ["users.id"],
+            "database": { "name": "testdb" }
+        })";
+        REQUIRE_FALSE(UltraverseConfig::loadFromString(json).has_value());
+    }
+
+    SECTION("stateChange.replayPipelineDepth below 1") {
+        const std::string json = R"({
+            "stateLog": { "name": "test-log" },
+            "keyColumns": ["users.id"],
+            "database": { "name": "testdb" },
+            "stateChange": { "replayPipelineDepth": 0 }
+        })";
+        REQUIRE_FALSE(UltraverseConfig::loadFromString(json).has_value());
+    }
+
+    SECTION("stateChange.replayFeederMode invalid") {
+        const std::string json = R"({
+            "stateLog": { "name": "test-log" },
+            "keyColumns": ["users.id"],
+            "database": { "name": "testdb" },
+            "stateChange": { "replayFeederMode": "random" }
+        })";
+        REQUIRE_FALSE(UltraverseConfig::loadFromString(json).has_value());
+    }
+
+    SECTION("stateChange.logDecodeThreads negative") {
+        const std::string json = R"({
+            "stateLog": { "name": "test-log" },
+            "keyColumns": ["users.id"],
+            "database": { "name": "testdb" },
+            "stateChange": { "logDecodeThreads": -1 }
+        })";
+        REQUIRE_FALSE(UltraverseConfig::loadFromString(json).has_value());
+    }
+
     SECTION("database.name missing") {
         const std::string json = R"({
             "stateLog": { "name": "test-log" },
@@ -179,12 +295,40 @@ TEST_CASE("UltraverseConfig defaults optional fields", "[config]") {
     REQUIRE(config.has_value());
     CHECK(config->binlog.path == "/var/lib/mysql");
     CHECK(config->binlog.indexName == "mysql-bin.index");
+    CHECK_FALSE(config->binlog.memoryMappedReader);
+    CHECK(config->binlog.payloadDecodeThreads == 0);
     CHECK(config->stateLog.path == ".");
+    CHECK_FALSE(config->stateLog.memoryMappedReader);
+    CHECK(config->stateLog.compressionBlockSize == 0);
+    CHECK(config->stateLog.compressionLevel == 3);
+    CHECK_FALSE(config->stateLog.symbolTable);
+    CHECK(config->stateLog.timestampIndexInterval == 1024);
+    CHECK_FALSE(config->stateLog.keyIndex);
+    CHECK(config->stateLog.keyIndexColumns.empty());
+    CHECK(config->stateLog.segmentSizeMB == 0);
+    CHECK(config->stateLog.retainedSegments == 0);
+    CHECK_FALSE(config->stateLog.allowMissingArchivedSegments);
+    CHECK_FALSE(config->stateLog.rwSummary);
+    CHECK(config->stateLog.zoneMapInterval == 0);
     CHECK(config->database.port == 3306);
     CHECK(config->statelogd.threadCount == 0);
     CHECK_FALSE(config->statelogd.oneshotMode);
+    CHECK(config->statelogd.checkpointInterval == 0);
+    CHECK(config->statelogd.parallelFiles == 0);
     CHECK_FALSE(config->stateChange.keepIntermediateDatabase);
     CHECK(config->stateChange.rangeComparisonMethod == "eqonly");
+    CHECK_FALSE(config->stateChange.readyQueueScheduler);
+    CHECK_FALSE(config->stateChange.incrementalGC);
+    CHECK_FALSE(config->stateChange.compactRowGraph);
+    CHECK_FALSE(config->stateChange.shardedRowGraphWorkers);
+    CHECK(config->stateChange.replayPipelineDepth == 1);
+    CHECK_FALSE(config->stateChange.replayStatementBatching);
+    CHECK_FALSE(config->stateChange.parallelFullReplay);
+    CHECK(config->stateChange.replayFeederMode == "auto");
+    CHECK(config->stateChange.logDecodeThreads == 0);
+    CHECK_FALSE(config->stateChange.useKeyIndex);
+    CHECK_FALSE(config->stateChange.useRWSummary);
+    CHECK_FALSE(config->stateChange.useZoneMap);
 }
 
 TEST_CASE("UltraverseConfig uses environment fallbacks", "[config]") {